@@ -0,0 +1,103 @@
+/*
+ * Archivo: aggregate.c
+ * Descripción: Estadística incremental en enteros. Lógica pura, sin Zephyr.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "aggregate.h"
+#include "int_math.h"
+
+static void metric_add(struct agg_metric *m, int16_t value) {
+    int32_t x_q8 = (int32_t)value * 256;
+
+    if (m->count == UINT16_MAX) {
+        return;
+    }
+    if (m->count == 0) {
+        m->min = value;
+        m->max = value;
+    } else {
+        m->min = value < m->min ? value : m->min;
+        m->max = value > m->max ? value : m->max;
+    }
+    m->count++;
+
+    // Welford: delta antes y después de actualizar la media
+    int32_t delta = x_q8 - m->mean_q8;
+
+    m->mean_q8 += delta / m->count;
+    m->m2_q16 += (int64_t)delta * (x_q8 - m->mean_q8);
+}
+
+// Q8 -> entero redondeando al más cercano (también para negativos)
+static int32_t q8_round(int32_t q8) {
+    return q8 >= 0 ? (q8 + 128) / 256 : -((-q8 + 128) / 256);
+}
+
+static void metric_summary(const struct agg_metric *m, struct agg_stats *out) {
+    memset(out, 0, sizeof(*out));
+    if (m->count == 0) {
+        return;
+    }
+    out->min = m->min;
+    out->max = m->max;
+    out->mean = (int16_t)q8_round(m->mean_q8);
+    out->count = m->count;
+    if (m->count > 1 && m->m2_q16 > 0) {
+        // Varianza muestral en Q16 -> desviación en Q8
+        out->stddev = (uint16_t)q8_round((int32_t)isqrt64((uint64_t)m->m2_q16 / (m->count - 1)));
+    }
+}
+
+void aggregator_reset(struct aggregator *agg, int64_t now) {
+    memset(agg, 0, sizeof(*agg));
+    agg->start = now;
+}
+
+void aggregator_add(struct aggregator *agg, const struct sensor_sample *sensors, uint8_t sats,
+                    const struct geo_position *position, bool position_valid, size_t raw_len) {
+    if (sensors->valid & SENSOR_VALID_VBAT) {
+        metric_add(&agg->metric[AGG_METRIC_VBAT], sensors->battery_mv > INT16_MAX ? INT16_MAX : (int16_t)sensors->battery_mv);
+    }
+    if (sensors->valid & SENSOR_VALID_TEMP) {
+        metric_add(&agg->metric[AGG_METRIC_TEMP], sensors->modem_temp_c);
+    }
+    if (sensors->valid & SENSOR_VALID_ADC) {
+        for (uint8_t i = 0; i < sensors->adc_count && i < SENSOR_ADC_MAX_CHANNELS; i++) {
+            if (sensors->adc_mv[i] != INT16_MIN) {
+                metric_add(&agg->metric[AGG_METRIC_ADC0 + i], sensors->adc_mv[i]);
+            }
+        }
+    }
+    if (position_valid) {
+        metric_add(&agg->metric[AGG_METRIC_SATS], sats);
+        agg->position = *position;
+        agg->sats = sats;
+        agg->position_valid = true;
+    }
+    if (agg->samples < UINT16_MAX) {
+        agg->samples++;
+    }
+    agg->raw_bytes += raw_len;
+}
+
+bool aggregator_due(const struct aggregator *agg, int64_t now, uint32_t interval_s) {
+    return agg->samples > 0 && now - agg->start >= (int64_t)interval_s * 1000;
+}
+
+int aggregator_close(struct aggregator *agg, int64_t now, struct agg_summary *summary) {
+    if (agg->samples == 0) {
+        aggregator_reset(agg, now);
+        return -ENODATA;
+    }
+    summary->duration_s = (uint32_t)((now - agg->start) / 1000);
+    summary->samples = agg->samples;
+    summary->raw_bytes = agg->raw_bytes > UINT16_MAX ? UINT16_MAX : (uint16_t)agg->raw_bytes;
+    for (int i = 0; i < AGG_METRIC_COUNT; i++) {
+        metric_summary(&agg->metric[i], &summary->metric[i]);
+    }
+    aggregator_reset(agg, now);
+    return 0;
+}
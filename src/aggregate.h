@@ -0,0 +1,77 @@
+/*
+ * Archivo: aggregate.h
+ * Descripción: Agregación por intervalos de las muestras de telemetría: mínimo,
+ *              máximo, media, desviación típica y número de muestras por métrica
+ *              (Welford en punto fijo, memoria constante por métrica).
+ *
+ * Con PARAM_AGG_INTERVAL_S > 0 cada intervalo cerrado genera un único registro de
+ * uplink en lugar de uno por muestra; la posición es la última del intervalo.
+ */
+
+#ifndef AGGREGATE_H_
+#define AGGREGATE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "geo_position.h"
+#include "sensors.h"
+
+enum agg_metric_id {
+    AGG_METRIC_VBAT,            // mV
+    AGG_METRIC_TEMP,            // °C
+    AGG_METRIC_SATS,            // Satélites en el fix
+    AGG_METRIC_ADC0,            // mV, uno por canal ADC
+    AGG_METRIC_COUNT = AGG_METRIC_ADC0 + SENSOR_ADC_MAX_CHANNELS
+};
+
+// Resumen de una métrica en unidades enteras (media y desviación redondeadas)
+struct agg_stats {
+    int16_t min;
+    int16_t max;
+    int16_t mean;
+    uint16_t stddev;
+    uint16_t count;
+};
+
+// Payload de un registro agregado (ver uplink_record)
+struct agg_summary {
+    uint32_t duration_s;
+    uint16_t samples;
+    uint16_t raw_bytes;         // Lo que habrían ocupado las muestras en crudo (saturado)
+    struct agg_stats metric[AGG_METRIC_COUNT];
+};
+
+// Estado de Welford: media en Q8 y suma de cuadrados de desviaciones en Q16
+struct agg_metric {
+    int64_t m2_q16;
+    int32_t mean_q8;
+    uint16_t count;
+    int16_t min;
+    int16_t max;
+};
+
+struct aggregator {
+    int64_t start;              // Inicio del intervalo (ms de uptime)
+    uint32_t raw_bytes;
+    uint16_t samples;
+    uint8_t sats;               // Última posición vista en el intervalo
+    bool position_valid;
+    struct geo_position position;
+    struct agg_metric metric[AGG_METRIC_COUNT];
+};
+
+void aggregator_reset(struct aggregator *agg, int64_t now);
+
+// Añade una muestra: sensores válidos, satélites y la longitud que tendría en crudo
+void aggregator_add(struct aggregator *agg, const struct sensor_sample *sensors, uint8_t sats,
+                    const struct geo_position *position, bool position_valid, size_t raw_len);
+
+// Intervalo vencido con muestras pendientes
+bool aggregator_due(const struct aggregator *agg, int64_t now, uint32_t interval_s);
+
+// Cierra el intervalo en summary y empieza otro. -ENODATA si no había muestras.
+int aggregator_close(struct aggregator *agg, int64_t now, struct agg_summary *summary);
+
+#endif /* AGGREGATE_H_ */
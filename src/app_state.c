@@ -0,0 +1,22 @@
+/*
+ * Archivo: app_state.c
+ * Descripción: Transiciones de la máquina de estados principal.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "app_state.h"
+
+LOG_MODULE_DECLARE(ntn_app, LOG_LEVEL_INF);
+
+void app_state_transition(enum app_state *current, enum app_state *last_good, enum app_state new_state) {
+    if (new_state != *current) {
+        LOG_INF("State transition: %d -> %d", *current, new_state);
+        // MEJORA v3.2: Guardar último estado bueno para recovery
+        if (*current != STATE_ERROR && *current != STATE_RECOVERY) {
+            *last_good = *current;
+        }
+        *current = new_state;
+    }
+}
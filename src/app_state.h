@@ -0,0 +1,33 @@
+/*
+ * Archivo: app_state.h
+ * Descripción: Estados de la aplicación y del attachment Sateliot de dos pasos.
+ */
+
+#ifndef APP_STATE_H_
+#define APP_STATE_H_
+
+// --- ESTADOS DE LA MÁQUINA DE ESTADOS MEJORADA ---
+enum app_state {
+    STATE_INIT,
+    STATE_GETTING_GPS_FIX,
+    STATE_IDLE,
+    STATE_ATTEMPTING_CONNECTION_STEP1,  // Attach Step 1 - Expect Reject
+    STATE_ATTEMPTING_CONNECTION_STEP2,  // Attach Step 2 - Expect Accept
+    STATE_SENDING_DATA,
+    STATE_ERROR,
+    STATE_RECOVERY,  // MEJORA v3.2: Estado de recovery
+    STATE_TLE_UPDATE, // MEJORA v3.2: Estado de actualización TLE
+    STATE_ATTEMPTING_CONNECTION_TN      // Registro en red terrestre (LTE-M/NB-IoT)
+};
+
+// --- ESTADOS DE ATTACHMENT SATELIOT ---
+enum attachment_step {
+    ATTACH_STEP_1,      // Primer intento - Attach Reject esperado
+    ATTACH_STEP_2,      // Segundo intento - Attach Accept esperado
+    ATTACH_COMPLETE     // Attachment completado exitosamente
+};
+
+// Aplica la transición y guarda en last_good el último estado que no era de error
+void app_state_transition(enum app_state *current, enum app_state *last_good, enum app_state new_state);
+
+#endif /* APP_STATE_H_ */
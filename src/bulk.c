@@ -0,0 +1,380 @@
+/*
+ * Archivo: bulk.c
+ * Descripción: Sesión de transferencia masiva: BULK_DECODER_COUNT bloques en decodificación
+ *              a la vez, entregados en orden; posición y rango persistidos al final de
+ *              cada ventana de downlink.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <string.h>
+
+#include "bulk.h"
+#include "downlink_auth.h"
+#include "erasure.h"
+
+LOG_MODULE_DECLARE(ntn_app, LOG_LEVEL_INF);
+
+#define BULK_OBJECT_HDR_LEN 9
+#define BULK_BEGIN_LEN (BULK_OBJECT_HDR_LEN + DOWNLINK_AUTH_TAG_LEN)
+#define BULK_SYMBOL_HDR_LEN 13
+
+// Posición y etiqueta en curso. Se persiste al abrir y cerrar la sesión y al final de cada
+// ventana (bulk_suspend): un reinicio a mitad de ventana vuelve a esa posición y los
+// destinos ignoran los bloques que ya tenían (FOTA y módem persisten su propio offset).
+struct bulk_session {
+    uint32_t session_id;
+    uint32_t total_size;
+    uint16_t next_block;
+    uint8_t type;
+    bool active;
+    uint8_t tag[DOWNLINK_AUTH_TAG_LEN];
+    struct downlink_auth_stream mac;    // Bloques entregados hasta next_block
+};
+
+static struct bulk_session session;
+static const bulk_sink_t *bulk_sinks;
+
+// Scratch acotado (~2.3 KB por bloque): el bloque b se decodifica en slots[b % COUNT].
+// Cada slot se persiste entero en BULK_SETTINGS_KEY "/d<i>" para conservar el rango entre pases.
+struct bulk_decoder_slot {
+    uint32_t session_id;
+    int32_t block;              // -1 si está libre
+    uint16_t symbols_received;
+    uint32_t decode_cycles;
+    struct erasure_decoder decoder;
+};
+
+#define BULK_SLOT_KEY_PREFIX BULK_SETTINGS_KEY "/d"
+#define BULK_SLOT_KEY_SIZE (sizeof(BULK_SLOT_KEY_PREFIX) + 1)
+
+BUILD_ASSERT(BULK_DECODER_COUNT <= 8, "un dígito por clave y un bit por slot en slots_dirty");
+
+static struct bulk_decoder_slot slots[BULK_DECODER_COUNT];
+static bool session_dirty;
+static uint8_t slots_dirty;     // Bit i: slots[i] cambió desde el último bulk_suspend()
+
+static uint32_t get_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint16_t get_be16(const uint8_t *p) {
+    return ((uint16_t)p[0] << 8) | p[1];
+}
+
+static uint16_t bulk_block_count(uint32_t total_size) {
+    return (total_size + ERASURE_BLOCK_SIZE - 1) / ERASURE_BLOCK_SIZE;
+}
+
+static uint32_t bulk_block_len(uint16_t block) {
+    uint32_t offset = (uint32_t)block * ERASURE_BLOCK_SIZE;
+
+    return MIN(ERASURE_BLOCK_SIZE, session.total_size - offset);
+}
+
+static uint8_t bulk_block_k(uint16_t block) {
+    return (bulk_block_len(block) + ERASURE_SYMBOL_SIZE - 1) / ERASURE_SYMBOL_SIZE;
+}
+
+static struct bulk_decoder_slot *bulk_slot(uint16_t block) {
+    return &slots[block % BULK_DECODER_COUNT];
+}
+
+static void bulk_slot_key(char key[BULK_SLOT_KEY_SIZE], size_t index) {
+    memcpy(key, BULK_SLOT_KEY_PREFIX, sizeof(BULK_SLOT_KEY_PREFIX) - 1);
+    key[sizeof(BULK_SLOT_KEY_PREFIX) - 1] = (char)('0' + index);
+    key[sizeof(BULK_SLOT_KEY_PREFIX)] = '\0';
+}
+
+static void bulk_slot_release(struct bulk_decoder_slot *slot) {
+    slot->block = -1;
+    slots_dirty |= BIT(slot - slots);
+}
+
+static int bulk_persist(void) {
+    int err = settings_save_one(BULK_SETTINGS_KEY, &session, sizeof(session));
+
+    if (err) {
+        LOG_ERR("Fallo al guardar sesión bulk: %d", err);
+        return err;
+    }
+    session_dirty = false;
+    return 0;
+}
+
+static void bulk_put_status(struct downlink_response *resp) {
+    const struct bulk_decoder_slot *slot = bulk_slot(session.next_block);
+    bool current = slot->block == session.next_block;
+    uint8_t rank = current ? slot->decoder.rank : 0;
+    uint8_t k = current ? slot->decoder.k : 0;
+
+    downlink_resp_put_be32(resp, session.session_id);
+    downlink_resp_put_be32(resp, ((uint32_t)session.next_block << 16) | ((uint32_t)rank << 8) | k);
+}
+
+static int bulk_load_cb(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg, void *param) {
+    ARG_UNUSED(param);
+
+    if (!key) {
+        if (len != sizeof(session) || read_cb(cb_arg, &session, sizeof(session)) != sizeof(session)) {
+            memset(&session, 0, sizeof(session));
+        }
+        return 0;
+    }
+
+    // "d<i>": decodificador de un bloque a medias; se valida contra la sesión en bulk_init()
+    if (key[0] == 'd' && key[1] >= '0' && key[1] < '0' + BULK_DECODER_COUNT && key[2] == '\0') {
+        struct bulk_decoder_slot *slot = &slots[key[1] - '0'];
+
+        if (len != sizeof(*slot) || read_cb(cb_arg, slot, sizeof(*slot)) != sizeof(*slot)) {
+            slot->block = -1;
+        }
+    }
+    return 0;
+}
+
+// Un slot restaurado solo vale para la sesión activa y un bloque de la ventana actual
+static bool bulk_slot_valid(const struct bulk_decoder_slot *slot) {
+    if (!session.active || slot->session_id != session.session_id || slot->block < session.next_block ||
+        slot->block >= session.next_block + BULK_DECODER_COUNT ||
+        slot->block >= bulk_block_count(session.total_size)) {
+        return false;
+    }
+    return bulk_slot(slot->block) == slot && slot->decoder.k == bulk_block_k(slot->block) &&
+           slot->decoder.rank <= slot->decoder.k;
+}
+
+int bulk_init(const bulk_sink_t sinks[BULK_TYPE_COUNT]) {
+    bulk_sinks = sinks;
+    memset(&session, 0, sizeof(session));
+    for (size_t i = 0; i < BULK_DECODER_COUNT; i++) {
+        slots[i].block = -1;
+    }
+    session_dirty = false;
+    slots_dirty = 0;
+
+    int err = settings_load_subtree_direct(BULK_SETTINGS_KEY, bulk_load_cb, NULL);
+
+    if (err) {
+        LOG_ERR("Fallo al cargar sesión bulk: %d", err);
+        return err;
+    }
+    for (size_t i = 0; i < BULK_DECODER_COUNT; i++) {
+        if (slots[i].block >= 0 && !bulk_slot_valid(&slots[i])) {
+            slots[i].block = -1;
+        }
+    }
+    if (session.active) {
+        const struct bulk_decoder_slot *slot = bulk_slot(session.next_block);
+
+        LOG_INF("Bulk en curso: sesión %08x, bloque %u/%u (rango %u)", session.session_id,
+                session.next_block, bulk_block_count(session.total_size),
+                slot->block == session.next_block ? slot->decoder.rank : 0);
+    }
+    return 0;
+}
+
+void bulk_suspend(void) {
+    char key[BULK_SLOT_KEY_SIZE];
+
+    // Los slots antes que la sesión: uno más nuevo que la sesión restaurada sigue siendo
+    // válido si su bloque cae en la ventana, y uno más viejo se descarta en bulk_init()
+    for (size_t i = 0; i < BULK_DECODER_COUNT; i++) {
+        if (!(slots_dirty & BIT(i))) {
+            continue;
+        }
+        bulk_slot_key(key, i);
+
+        int err = slots[i].block >= 0 ? settings_save_one(key, &slots[i], sizeof(slots[i]))
+                                      : settings_delete(key);
+        if (err) {
+            LOG_ERR("Fallo al guardar decodificador bulk %u: %d", (unsigned int)i, err);
+            continue;
+        }
+        slots_dirty &= ~BIT(i);
+    }
+    if (session_dirty) {
+        bulk_persist();
+    }
+}
+
+static int bulk_start(uint32_t session_id, uint8_t type, uint32_t total_size, const uint8_t *tag) {
+    if (type == 0 || type >= BULK_TYPE_COUNT || !bulk_sinks || !bulk_sinks[type]) {
+        return -ENOTSUP;
+    }
+    if (total_size == 0 || bulk_block_count(total_size) == 0 || total_size > UINT16_MAX * ERASURE_BLOCK_SIZE) {
+        return -EFBIG;
+    }
+    session = (struct bulk_session) {
+        .session_id = session_id,
+        .total_size = total_size,
+        .type = type,
+        .active = true,
+    };
+    memcpy(session.tag, tag, sizeof(session.tag));
+    downlink_auth_begin(&session.mac, DOWNLINK_AUTH_IMAGE);
+
+    // Los decodificadores persistidos de la sesión anterior no pueden reaparecer con esta
+    // aunque repita el id
+    for (size_t i = 0; i < BULK_DECODER_COUNT; i++) {
+        char key[BULK_SLOT_KEY_SIZE];
+
+        slots[i].block = -1;
+        bulk_slot_key(key, i);
+        settings_delete(key);
+    }
+    slots_dirty = 0;
+    LOG_INF("Bulk sesión %08x: tipo %u, %u bytes en %u bloques", session_id, type, total_size,
+            bulk_block_count(total_size));
+    return bulk_persist();
+}
+
+// Entrega el bloque en curso ya completo y avanza; un error del destino descarta la sesión.
+// La nueva posición se persiste en bulk_suspend() salvo al cerrar la sesión.
+static int bulk_deliver_block(struct bulk_decoder_slot *slot) {
+    const uint8_t *data = erasure_decoder_source(&slot->decoder);
+    uint32_t len = bulk_block_len(session.next_block);
+    bool last = session.next_block + 1 == bulk_block_count(session.total_size);
+    uint32_t decode_us = k_cyc_to_us_floor32(slot->decode_cycles);
+    struct downlink_auth_stream mac = session.mac;
+
+    LOG_INF("Bloque %u decodificado: %u símbolos para K=%u, %u us (%u KB/s)", session.next_block,
+            slot->symbols_received, slot->decoder.k, decode_us,
+            decode_us ? (uint32_t)((uint64_t)len * 1000 / decode_us) : 0);
+
+    // El último bloque solo se entrega con el objeto entero autenticado: el destino
+    // confirma (TLE, geocercas) o cierra (FOTA, módem) al recibirlo. La etiqueta en curso
+    // solo avanza si el destino acepta el bloque.
+    downlink_auth_update(&mac, data, len);
+    if (last && downlink_auth_verify(&mac, session.tag) != 0) {
+        LOG_ERR("Bulk sesión %08x: la etiqueta del objeto no coincide - descartado", session.session_id);
+        session.active = false;
+        bulk_persist();
+        return -EACCES;
+    }
+
+    int err = bulk_sinks[session.type](session.session_id, (uint32_t)session.next_block * ERASURE_BLOCK_SIZE,
+                                       data, len, last);
+
+    // Destino aún no preparado (el módem borrando su área): el bloque espera en su slot y
+    // se reintenta con el siguiente símbolo
+    if (err == -EINPROGRESS) {
+        return err;
+    }
+    if (err) {
+        LOG_ERR("Destino bulk rechazó el bloque %u: %d", session.next_block, err);
+        session.active = false;
+        bulk_persist();
+        return err;
+    }
+
+    session.mac = mac;
+    session.next_block++;
+    bulk_slot_release(slot);
+    if (last) {
+        session.active = false;
+        LOG_INF("Bulk sesión %08x completa", session.session_id);
+        return bulk_persist();
+    }
+    session_dirty = true;
+    return 0;
+}
+
+int bulk_handle_begin(const uint8_t *payload, size_t len, struct downlink_response *resp) {
+    if (len != BULK_BEGIN_LEN) {
+        return -EBADMSG;
+    }
+
+    uint32_t session_id = get_be32(&payload[0]);
+    uint8_t type = payload[4];
+    uint32_t total_size = get_be32(&payload[5]);
+    const uint8_t *tag = &payload[BULK_OBJECT_HDR_LEN];
+    int err;
+
+    // Reenvío del BEGIN (ack perdido o nuevo pase): se reanuda donde se quedó
+    if (session.active && session_id == session.session_id) {
+        if (type != session.type || total_size != session.total_size ||
+            memcmp(tag, session.tag, sizeof(session.tag)) != 0) {
+            return -EINVAL;
+        }
+        bulk_put_status(resp);
+        return 0;
+    }
+    if (session.active) {
+        LOG_WRN("Bulk sesión %08x sustituida en el bloque %u", session.session_id, session.next_block);
+    }
+    err = bulk_start(session_id, type, total_size, tag);
+    if (err) {
+        return err;
+    }
+    bulk_put_status(resp);
+    return 0;
+}
+
+int bulk_handle_symbol(const uint8_t *payload, size_t len, struct downlink_response *resp) {
+    if (len != BULK_SYMBOL_HDR_LEN + ERASURE_SYMBOL_SIZE) {
+        return -EBADMSG;
+    }
+
+    uint32_t session_id = get_be32(&payload[0]);
+    uint8_t type = payload[4];
+    uint32_t total_size = get_be32(&payload[5]);
+    uint16_t block = get_be16(&payload[9]);
+    uint16_t esi = get_be16(&payload[11]);
+    int err;
+
+    // Los símbolos no están autenticados: nunca abren ni sustituyen una sesión
+    if (session_id != session.session_id || session.type == 0) {
+        bulk_put_status(resp);
+        return session.active ? -EBUSY : -ENOENT;
+    }
+    if (type != session.type || total_size != session.total_size) {
+        return -EINVAL;
+    }
+    // Sesión terminada o bloque ya entregado: solo se informa de la posición
+    if (!session.active || block < session.next_block) {
+        bulk_put_status(resp);
+        return 0;
+    }
+    // Fuera de la ventana de decodificadores o del objeto
+    if (block >= session.next_block + BULK_DECODER_COUNT || block >= bulk_block_count(total_size)) {
+        bulk_put_status(resp);
+        return -ERANGE;
+    }
+
+    struct bulk_decoder_slot *slot = bulk_slot(block);
+
+    if (slot->block != block) {
+        err = erasure_decoder_init(&slot->decoder, bulk_block_k(block));
+        if (err) {
+            return err;
+        }
+        slot->session_id = session_id;
+        slot->block = block;
+        slot->symbols_received = 0;
+        slot->decode_cycles = 0;
+    }
+
+    uint32_t start = k_cycle_get_32();
+
+    err = erasure_decoder_add(&slot->decoder, session_id, block, esi, &payload[BULK_SYMBOL_HDR_LEN]);
+    slot->decode_cycles += k_cycle_get_32() - start;
+    slot->symbols_received++;
+    slots_dirty |= BIT(slot - slots);
+    if (err < 0) {
+        return err;
+    }
+
+    // Un bloque completo fuera de orden espera en su slot hasta que le toque
+    err = 0;
+    while (err == 0 && session.active) {
+        slot = bulk_slot(session.next_block);
+        if (slot->block != session.next_block || !erasure_decoder_complete(&slot->decoder)) {
+            break;
+        }
+        err = bulk_deliver_block(slot);
+    }
+    bulk_put_status(resp);
+    return err;
+}
@@ -0,0 +1,61 @@
+/*
+ * Archivo: bulk.h
+ * Descripción: Transferencias masivas por downlink con código de borrado (ver erasure.h).
+ *              El objeto se divide en bloques de ERASURE_BLOCK_SIZE; cada bloque se
+ *              reconstruye con cualquier conjunto suficiente de símbolos recibidos en
+ *              uno o varios pases y se entrega en orden al destino según su tipo.
+ *
+ * BULK_BEGIN (privilegiado, payload tras el opcode, big-endian):
+ *   [sesión u32][tipo u8][tamaño objeto u32][etiqueta del objeto DOWNLINK_AUTH_TAG_LEN]
+ * BULK_SYMBOL:
+ *   [sesión u32][tipo u8][tamaño objeto u32][bloque u16][esi u16][símbolo ERASURE_SYMBOL_SIZE]
+ * Respuesta a ambos: [sesión][próximo bloque << 16 | rango << 8 | K del bloque en curso]
+ *
+ * Se decodifican a la vez el bloque en curso y los BULK_DECODER_COUNT - 1 siguientes: un
+ * bloque completo fuera de orden espera a los anteriores y un símbolo más adelante es
+ * -ERANGE. Un destino que aún no puede aceptar el bloque devuelve -EINPROGRESS y el bloque
+ * espera decodificado hasta el siguiente símbolo. La posición, la etiqueta en curso y el rango de cada bloque a medias se
+ * persisten al final de cada ventana de downlink (bulk_suspend), no por bloque; tras un
+ * reinicio se reanuda desde ahí y los destinos reciben de nuevo los bloques posteriores.
+ *
+ * Solo un BULK_BEGIN autenticado abre sesión; otro BEGIN con el mismo id la reanuda y uno
+ * con otro id la sustituye. Un símbolo sin sesión abierta es -ENOENT y uno de otro id con
+ * una sesión activa -EBUSY, ambos con la posición de la sesión en curso.
+ * La etiqueta (dominio DOWNLINK_AUTH_IMAGE sobre el objeto entero) se calcula bloque a
+ * bloque y se comprueba antes de entregar el último: un objeto manipulado nunca llega a
+ * completarse en el destino (-EACCES).
+ */
+
+#ifndef BULK_H_
+#define BULK_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "downlink.h"
+
+#define BULK_SETTINGS_KEY "ntn/bulk"
+#define BULK_DECODER_COUNT 3        // Bloques en decodificación a la vez (~2.3 KB cada uno)
+
+enum bulk_type {
+    BULK_TYPE_TLE = 1,      // Registros [índice u8][longitud u8][texto TLE], un solo bloque
+    BULK_TYPE_FOTA = 2,     // Parche delta de la sesión FOTA con el mismo id (ver fota.h)
+    BULK_TYPE_MODEM_DFU = 3,    // Delta del firmware del módem (ver modem_dfu.h)
+    BULK_TYPE_GEOFENCE = 4,     // Conjunto de geocercas (ver geofence.h)
+    BULK_TYPE_COUNT
+};
+
+// Destino de los bloques decodificados, llamado en orden de offset
+typedef int (*bulk_sink_t)(uint32_t session, uint32_t offset, const uint8_t *data, size_t len, bool last);
+
+// Registra los destinos por tipo y recupera la sesión en curso. Requiere settings_subsys_init().
+int bulk_init(const bulk_sink_t sinks[BULK_TYPE_COUNT]);
+
+int bulk_handle_begin(const uint8_t *payload, size_t len, struct downlink_response *resp);
+int bulk_handle_symbol(const uint8_t *payload, size_t len, struct downlink_response *resp);
+
+// Persiste la posición y los bloques a medias; llamar al cerrar cada ventana de downlink
+void bulk_suspend(void);
+
+#endif /* BULK_H_ */
@@ -0,0 +1,195 @@
+/*
+ * Archivo: cell_context.c
+ * Descripción: Parseo de %XMONITOR y persistencia del contexto de celda.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <string.h>
+
+#include "cell_context.h"
+
+LOG_MODULE_DECLARE(ntn_app, LOG_LEVEL_INF);
+
+// Campos de %XMONITOR: <reg_status>,<full_name>,<short_name>,<plmn>,<tac>,<AcT>,<band>,
+// <cell_id>,<phys_cell_id>,<EARFCN>,...
+#define XMONITOR_FIELD_REG_STATUS 0
+#define XMONITOR_FIELD_ACT 5
+#define XMONITOR_FIELD_BAND 6
+#define XMONITOR_FIELD_CELL_ID 7
+#define XMONITOR_FIELD_PCI 8
+#define XMONITOR_FIELD_EARFCN 9
+#define XMONITOR_FIELD_MAX_LEN 12
+
+// Última copia escrita en flash por ruta, para no reescribir contextos idénticos
+static struct cell_context persisted[CELL_CONTEXT_PATHS];
+
+static const char *const path_keys[CELL_CONTEXT_PATHS] = {
+    [NET_PATH_NTN] = CELL_CONTEXT_SETTINGS_KEY "/ntn",
+    [NET_PATH_TN] = CELL_CONTEXT_SETTINGS_KEY "/tn",
+};
+
+// Copia el campo idx (sin comillas) en out; los nombres de operador pueden estar vacíos
+static int xmonitor_field(const char *resp, int idx, char *out, size_t size) {
+    const char *p = strchr(resp, ':');
+    bool quoted = false;
+    size_t len = 0;
+
+    if (!p) {
+        return -EBADMSG;
+    }
+    p++;
+    while (*p == ' ') {
+        p++;
+    }
+    for (; *p && *p != '\r' && *p != '\n'; p++) {
+        if (*p == '"') {
+            quoted = !quoted;
+        } else if (*p == ',' && !quoted) {
+            if (idx-- == 0) {
+                break;
+            }
+        } else if (idx == 0) {
+            if (len + 1 >= size) {
+                return -EBADMSG;
+            }
+            out[len++] = *p;
+        }
+    }
+    if (idx > 0 || len == 0) {
+        return -EBADMSG;
+    }
+    out[len] = '\0';
+    return 0;
+}
+
+static int parse_number(const char *text, int base, uint32_t max, uint32_t *out) {
+    uint32_t value = 0;
+
+    for (; *text; text++) {
+        int digit;
+
+        if (*text >= '0' && *text <= '9') {
+            digit = *text - '0';
+        } else if (base == 16 && *text >= 'A' && *text <= 'F') {
+            digit = *text - 'A' + 10;
+        } else if (base == 16 && *text >= 'a' && *text <= 'f') {
+            digit = *text - 'a' + 10;
+        } else {
+            return -EBADMSG;
+        }
+        if (value > (max - digit) / base) {
+            return -EBADMSG;
+        }
+        value = value * base + digit;
+    }
+    *out = value;
+    return 0;
+}
+
+static int xmonitor_number(const char *resp, int idx, int base, uint32_t max, uint32_t *out) {
+    char field[XMONITOR_FIELD_MAX_LEN];
+    int err = xmonitor_field(resp, idx, field, sizeof(field));
+
+    return err ? err : parse_number(field, base, max, out);
+}
+
+int cell_context_parse_xmonitor(const char *resp, struct cell_context *ctx) {
+    uint32_t reg_status, act, band, cell_id, pci, earfcn;
+
+    if (xmonitor_number(resp, XMONITOR_FIELD_REG_STATUS, 10, 10, &reg_status)) {
+        return -EBADMSG;
+    }
+    // 1 = registrado en red propia, 5 = roaming (mismos valores que +CEREG)
+    if (reg_status != 1 && reg_status != 5) {
+        return -ENOENT;
+    }
+    if (xmonitor_number(resp, XMONITOR_FIELD_ACT, 10, UINT8_MAX, &act) ||
+        xmonitor_number(resp, XMONITOR_FIELD_BAND, 10, UINT8_MAX, &band) ||
+        xmonitor_number(resp, XMONITOR_FIELD_CELL_ID, 16, 0x0FFFFFFF, &cell_id) ||
+        xmonitor_number(resp, XMONITOR_FIELD_PCI, 10, 503, &pci) ||
+        xmonitor_number(resp, XMONITOR_FIELD_EARFCN, 10, 262143, &earfcn)) {
+        return -EBADMSG;
+    }
+    if (act != 7 && act != 9) {
+        return -EBADMSG;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->cell_id = cell_id;
+    ctx->earfcn = earfcn;
+    ctx->phys_cell_id = (uint16_t)pci;
+    ctx->act = (uint8_t)act;
+    ctx->band = (uint8_t)band;
+    ctx->valid = true;
+    return 0;
+}
+
+static int cell_context_read(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg,
+                             void *param) {
+    struct cell_context *ctx = param;
+    struct cell_context stored;
+    int path;
+
+    if (key && strcmp(key, "ntn") == 0) {
+        path = NET_PATH_NTN;
+    } else if (key && strcmp(key, "tn") == 0) {
+        path = NET_PATH_TN;
+    } else {
+        return 0;
+    }
+    if (len != sizeof(stored) || read_cb(cb_arg, &stored, sizeof(stored)) != sizeof(stored) ||
+        (stored.act != 7 && stored.act != 9)) {
+        LOG_WRN("Contexto de celda %s no válido - descartado", key);
+        return 0;
+    }
+    ctx[path] = stored;
+    persisted[path] = stored;
+    return 0;
+}
+
+int cell_context_load(struct cell_context ctx[CELL_CONTEXT_PATHS]) {
+    int err = settings_load_subtree_direct(CELL_CONTEXT_SETTINGS_KEY, cell_context_read, ctx);
+
+    if (err) {
+        LOG_ERR("Fallo al cargar contexto de celda: %d", err);
+        return err;
+    }
+    for (int i = 0; i < CELL_CONTEXT_PATHS; i++) {
+        if (ctx[i].valid) {
+            LOG_INF("Contexto %s: EARFCN %u, PCI %u, banda %u", net_path_str(i),
+                    ctx[i].earfcn, ctx[i].phys_cell_id, ctx[i].band);
+        }
+    }
+    return 0;
+}
+
+int cell_context_save(enum net_path path, const struct cell_context *ctx) {
+    if (path >= CELL_CONTEXT_PATHS) {
+        return -EINVAL;
+    }
+    if (memcmp(&persisted[path], ctx, sizeof(*ctx)) == 0) {
+        return 0;
+    }
+
+    int err = settings_save_one(path_keys[path], ctx, sizeof(*ctx));
+
+    if (err) {
+        LOG_ERR("Fallo al guardar contexto de celda %s: %d", net_path_str(path), err);
+        return err;
+    }
+    persisted[path] = *ctx;
+    return 0;
+}
+
+void acquisition_stats_record(struct acquisition_stats *stats, uint32_t elapsed_ms) {
+    if (stats->samples == UINT16_MAX) {
+        return;
+    }
+    stats->samples++;
+    stats->total_ms += elapsed_ms;
+    if (elapsed_ms > stats->max_ms) {
+        stats->max_ms = elapsed_ms;
+    }
+}
@@ -0,0 +1,51 @@
+/*
+ * Archivo: cell_context.h
+ * Descripción: Contexto de celda/canal del último registro correcto por ruta (TN/NTN),
+ *              persistido en settings para sembrar la siguiente búsqueda de red.
+ */
+
+#ifndef CELL_CONTEXT_H_
+#define CELL_CONTEXT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "net_path.h"
+
+#define CELL_CONTEXT_SETTINGS_KEY "ntn/cell"
+#define CELL_CONTEXT_PATHS 2                // Indexado por enum net_path
+
+// Canal Sateliot por defecto si no hay contexto NTN (1996 MHz UL, 2186 MHz DL)
+#define NTN_DEFAULT_ACT 9                   // NB-IoT
+#define NTN_DEFAULT_EARFCN 66296
+
+struct cell_context {
+    uint32_t cell_id;           // E-UTRAN cell id (28 bits)
+    uint32_t earfcn;
+    uint16_t phys_cell_id;
+    uint8_t act;                // 7 = LTE-M, 9 = NB-IoT
+    uint8_t band;
+    bool valid;
+};
+
+// Tiempo desde lte_lc_connect_async() hasta registro, separado en búsqueda sembrada y en frío
+struct acquisition_stats {
+    uint64_t total_ms;
+    uint32_t max_ms;
+    uint16_t samples;
+};
+
+// Extrae AcT, banda, cell id, PCI y EARFCN de una respuesta %XMONITOR.
+// -ENOENT si el módem no está registrado, -EBADMSG si la respuesta no es válida.
+int cell_context_parse_xmonitor(const char *resp, struct cell_context *ctx);
+
+// Carga los contextos persistidos (uno por ruta). Requiere settings_subsys_init() previo.
+int cell_context_load(struct cell_context ctx[CELL_CONTEXT_PATHS]);
+
+// Persiste el contexto de la ruta solo si cambió respecto a lo último escrito
+int cell_context_save(enum net_path path, const struct cell_context *ctx);
+
+void acquisition_stats_record(struct acquisition_stats *stats, uint32_t elapsed_ms);
+
+#endif /* CELL_CONTEXT_H_ */
@@ -0,0 +1,102 @@
+/*
+ * Archivo: downlink.c
+ * Descripción: Validación de tramas de downlink y despacho por opcode.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+
+#include "bulk.h"
+#include "downlink.h"
+#include "downlink_auth.h"
+#include "fota.h"
+#include "modem_dfu.h"
+#include "params.h"
+#include "uplink_fec.h"
+
+LOG_MODULE_DECLARE(ntn_app, LOG_LEVEL_INF);
+
+static bool downlink_privileged(uint8_t opcode) {
+    switch (opcode) {
+    case DOWNLINK_OP_PARAM_SET:
+    case DOWNLINK_OP_FOTA_BEGIN:
+    case DOWNLINK_OP_FOTA_ABORT:
+    case DOWNLINK_OP_MODEM_DFU_BEGIN:
+    case DOWNLINK_OP_MODEM_DFU_ABORT:
+    case DOWNLINK_OP_BULK_BEGIN:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static int downlink_execute(const uint8_t *frame, size_t len, struct downlink_response *resp) {
+    if (len < DOWNLINK_MIN_FRAME_LEN || len > DOWNLINK_MAX_FRAME_LEN) {
+        return -EMSGSIZE;
+    }
+
+    uint16_t crc = ((uint16_t)frame[len - 2] << 8) | frame[len - 1];
+
+    if (crc16_ccitt(0xFFFF, frame, len - 2) != crc) {
+        LOG_ERR("Downlink con CRC incorrecto - descartado");
+        return -EBADMSG;
+    }
+    // A partir de aquí len - 3 es la longitud del payload: sin CRC, contador ni etiqueta
+    if (downlink_privileged(frame[0])) {
+        if (len < DOWNLINK_MIN_FRAME_LEN + DOWNLINK_AUTH_FRAME_OVERHEAD) {
+            return -EBADMSG;
+        }
+        int err = downlink_auth_verify_frame(frame, len - 2);
+
+        if (err) {
+            LOG_ERR("Downlink 0x%02x sin autenticar o repetido (%d) - descartado", frame[0], err);
+            return err;
+        }
+        len -= DOWNLINK_AUTH_FRAME_OVERHEAD;
+    }
+
+    switch (frame[0]) {
+    case DOWNLINK_OP_PARAM_SET:
+        return params_apply_set(&frame[1], len - 3);
+    case DOWNLINK_OP_FOTA_BEGIN:
+        return fota_handle_begin(&frame[1], len - 3, resp);
+    case DOWNLINK_OP_FOTA_CHUNK:
+        return fota_handle_chunk(&frame[1], len - 3, resp);
+    case DOWNLINK_OP_FOTA_ABORT:
+        return fota_handle_abort(&frame[1], len - 3);
+    case DOWNLINK_OP_MODEM_DFU_BEGIN:
+        return modem_dfu_handle_begin(&frame[1], len - 3, resp);
+    case DOWNLINK_OP_MODEM_DFU_ABORT:
+        return modem_dfu_handle_abort(&frame[1], len - 3);
+    case DOWNLINK_OP_BULK_BEGIN:
+        return bulk_handle_begin(&frame[1], len - 3, resp);
+    case DOWNLINK_OP_BULK_SYMBOL:
+        return bulk_handle_symbol(&frame[1], len - 3, resp);
+    case DOWNLINK_OP_UPLINK_REPORT:
+        return uplink_fec_handle_report(&frame[1], len - 3);
+    default:
+        LOG_WRN("Opcode de downlink desconocido: 0x%02x", frame[0]);
+        return -ENOTSUP;
+    }
+}
+
+int downlink_dispatch(const uint8_t *frame, size_t len, struct downlink_response *resp) {
+    resp->len = DOWNLINK_ACK_LEN;
+
+    int err = downlink_execute(frame, len, resp);
+
+    resp->buf[0] = DOWNLINK_ACK_FLAG | (len > 0 ? frame[0] : 0);
+    resp->buf[1] = (uint8_t)-err;
+    return err;
+}
+
+void downlink_resp_put_be32(struct downlink_response *resp, uint32_t value) {
+    if (resp->len + 4 > sizeof(resp->buf)) {
+        return;
+    }
+    resp->buf[resp->len++] = value >> 24;
+    resp->buf[resp->len++] = value >> 16;
+    resp->buf[resp->len++] = value >> 8;
+    resp->buf[resp->len++] = value;
+}
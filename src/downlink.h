@@ -0,0 +1,52 @@
+/*
+ * Archivo: downlink.h
+ * Descripción: Comandos binarios recibidos del servidor VAS tras el uplink.
+ *
+ * Trama: [opcode][payload...][CRC-16/CCITT big-endian sobre opcode + payload]
+ * Los opcodes privilegiados (PARAM_SET, FOTA_BEGIN/ABORT, MODEM_DFU_BEGIN/ABORT, BULK_BEGIN) llevan
+ * además un contador anti-repetición y la etiqueta de downlink_auth.h sobre opcode + payload +
+ * contador, antes del CRC:
+ *   [opcode][payload...][contador u32][etiqueta DOWNLINK_AUTH_TAG_LEN][CRC-16]
+ * Una trama privilegiada con un contador ya visto se rechaza con -EALREADY.
+ * Los datos de FOTA_CHUNK y BULK_SYMBOL no la llevan: los cubre la etiqueta de objeto del BEGIN.
+ * Respuesta: [opcode | DOWNLINK_ACK_FLAG][estado][datos opcionales] con estado = -errno
+ * (0 = aplicado). Todos los enteros multibyte van en big-endian.
+ */
+
+#ifndef DOWNLINK_H_
+#define DOWNLINK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DOWNLINK_MAX_FRAME_LEN 256
+#define DOWNLINK_MIN_FRAME_LEN 3        // opcode + CRC
+#define DOWNLINK_ACK_FLAG 0x80
+#define DOWNLINK_ACK_LEN 2
+#define DOWNLINK_RESP_MAX_LEN 16
+
+enum downlink_opcode {
+    DOWNLINK_OP_PARAM_SET = 0x01,       // Ver params_apply_set()
+    DOWNLINK_OP_FOTA_BEGIN = 0x10,      // Ver fota.h
+    DOWNLINK_OP_FOTA_CHUNK = 0x11,
+    DOWNLINK_OP_FOTA_ABORT = 0x12,
+    DOWNLINK_OP_MODEM_DFU_BEGIN = 0x14, // Ver modem_dfu.h
+    DOWNLINK_OP_MODEM_DFU_ABORT = 0x15,
+    DOWNLINK_OP_BULK_SYMBOL = 0x20,     // Ver bulk.h
+    DOWNLINK_OP_BULK_BEGIN = 0x21,
+    DOWNLINK_OP_UPLINK_REPORT = 0x30,   // Ver uplink_fec.h
+};
+
+struct downlink_response {
+    uint8_t buf[DOWNLINK_RESP_MAX_LEN];
+    size_t len;
+};
+
+// Valida y ejecuta una trama. Deja la respuesta en resp y devuelve 0 o -errno
+// con el resultado del comando.
+int downlink_dispatch(const uint8_t *frame, size_t len, struct downlink_response *resp);
+
+// Añade un entero big-endian a los datos de la respuesta
+void downlink_resp_put_be32(struct downlink_response *resp, uint32_t value);
+
+#endif /* DOWNLINK_H_ */
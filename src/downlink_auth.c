@@ -0,0 +1,209 @@
+/*
+ * Archivo: downlink_auth.c
+ * Descripción: HMAC-SHA256 (RFC 2104) sobre la clave provisionada: PSA Crypto para las
+ *              tramas y SHA-256 de mbedTLS para las imágenes, cuyo cálculo se persiste.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <mbedtls/constant_time.h>
+#include <psa/crypto.h>
+#include <string.h>
+
+#include "downlink_auth.h"
+
+LOG_MODULE_DECLARE(ntn_app, LOG_LEVEL_INF);
+
+#define HMAC_BLOCK 64
+#define SHA256_DIGEST 32
+#define DOWNLINK_AUTH_ALG PSA_ALG_TRUNCATED_MAC(PSA_ALG_HMAC(PSA_ALG_SHA_256), DOWNLINK_AUTH_TAG_LEN)
+
+static uint8_t auth_key[DOWNLINK_AUTH_KEY_LEN];
+static bool auth_key_loaded;
+static psa_key_id_t auth_key_id = PSA_KEY_ID_NULL;
+static uint32_t auth_counter;       // Último contador de trama aceptado
+
+// Bloque de clave del HMAC: la clave (32 bytes) rellenada con ceros y XOR con pad
+static void hmac_key_block(mbedtls_sha256_context *sha, uint8_t pad) {
+    uint8_t block[HMAC_BLOCK];
+
+    memset(block, pad, sizeof(block));
+    for (size_t i = 0; i < sizeof(auth_key); i++) {
+        block[i] ^= auth_key[i];
+    }
+    mbedtls_sha256_update(sha, block, sizeof(block));
+}
+
+// Copia volátil de auth_key en PSA, solo para verificar etiquetas de DOWNLINK_AUTH_ALG
+static int auth_key_import(void) {
+    psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+    psa_status_t status = psa_crypto_init();
+
+    if (auth_key_id != PSA_KEY_ID_NULL) {
+        psa_destroy_key(auth_key_id);
+        auth_key_id = PSA_KEY_ID_NULL;
+    }
+    if (status == PSA_SUCCESS) {
+        psa_set_key_type(&attr, PSA_KEY_TYPE_HMAC);
+        psa_set_key_bits(&attr, DOWNLINK_AUTH_KEY_LEN * 8);
+        psa_set_key_usage_flags(&attr, PSA_KEY_USAGE_VERIFY_MESSAGE);
+        psa_set_key_algorithm(&attr, DOWNLINK_AUTH_ALG);
+        status = psa_import_key(&attr, auth_key, sizeof(auth_key), &auth_key_id);
+    }
+    if (status != PSA_SUCCESS) {
+        LOG_ERR("Fallo al importar la clave de downlink en PSA: %d", status);
+        return -EIO;
+    }
+    return 0;
+}
+
+static int auth_mac_verify(enum downlink_auth_domain domain, const uint8_t *data, size_t len,
+                           const uint8_t tag[DOWNLINK_AUTH_TAG_LEN]) {
+    psa_mac_operation_t op = PSA_MAC_OPERATION_INIT;
+    uint8_t byte = (uint8_t)domain;
+    psa_status_t status;
+
+    if (!auth_key_loaded) {
+        return -EACCES;
+    }
+    status = psa_mac_verify_setup(&op, auth_key_id, DOWNLINK_AUTH_ALG);
+    if (status == PSA_SUCCESS) {
+        status = psa_mac_update(&op, &byte, 1);
+    }
+    if (status == PSA_SUCCESS) {
+        status = psa_mac_update(&op, data, len);
+    }
+    if (status == PSA_SUCCESS) {
+        status = psa_mac_verify_finish(&op, tag, DOWNLINK_AUTH_TAG_LEN);
+    }
+    if (status != PSA_SUCCESS) {
+        psa_mac_abort(&op);
+        if (status != PSA_ERROR_INVALID_SIGNATURE) {
+            LOG_ERR("Fallo de PSA al verificar la etiqueta: %d", status);
+        }
+        return -EACCES;
+    }
+    return 0;
+}
+
+static int auth_load_cb(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg, void *param) {
+    uint32_t counter;
+
+    ARG_UNUSED(param);
+    if (!key) {
+        if (len == sizeof(auth_key) && read_cb(cb_arg, auth_key, sizeof(auth_key)) == sizeof(auth_key)) {
+            auth_key_loaded = true;
+        }
+    } else if (strcmp(key, "ctr") == 0) {  // DOWNLINK_AUTH_COUNTER_KEY dentro del subárbol
+        if (len == sizeof(counter) && read_cb(cb_arg, &counter, sizeof(counter)) == sizeof(counter)) {
+            auth_counter = counter;
+        }
+    }
+    return 0;
+}
+
+int downlink_auth_init(void) {
+    auth_key_loaded = false;
+    auth_counter = 0;
+
+    int err = settings_load_subtree_direct(DOWNLINK_AUTH_SETTINGS_KEY, auth_load_cb, NULL);
+
+    if (err) {
+        LOG_ERR("Fallo al cargar la clave de downlink: %d", err);
+        return err;
+    }
+    if (!auth_key_loaded) {
+        LOG_WRN("Sin clave de downlink provisionada: PARAM_SET, FOTA y DFU del módem rechazados");
+        return -ENOENT;
+    }
+    err = auth_key_import();
+    auth_key_loaded = err == 0;
+    return err;
+}
+
+int downlink_auth_provision(const uint8_t key[DOWNLINK_AUTH_KEY_LEN]) {
+    int err = settings_save_one(DOWNLINK_AUTH_SETTINGS_KEY, key, DOWNLINK_AUTH_KEY_LEN);
+
+    if (err) {
+        LOG_ERR("Fallo al guardar la clave de downlink: %d", err);
+        return err;
+    }
+    memcpy(auth_key, key, sizeof(auth_key));
+    err = auth_key_import();
+    auth_key_loaded = err == 0;
+    return err;
+}
+
+bool downlink_auth_ready(void) {
+    return auth_key_loaded;
+}
+
+void downlink_auth_begin(struct downlink_auth_stream *s, enum downlink_auth_domain domain) {
+    uint8_t byte = (uint8_t)domain;
+
+    mbedtls_sha256_init(&s->sha);
+    mbedtls_sha256_starts(&s->sha, 0);
+    hmac_key_block(&s->sha, 0x36);
+    mbedtls_sha256_update(&s->sha, &byte, 1);
+}
+
+void downlink_auth_update(struct downlink_auth_stream *s, const uint8_t *data, size_t len) {
+    mbedtls_sha256_update(&s->sha, data, len);
+}
+
+void downlink_auth_final(struct downlink_auth_stream *s, uint8_t tag[DOWNLINK_AUTH_TAG_LEN]) {
+    uint8_t inner[SHA256_DIGEST];
+    uint8_t outer[SHA256_DIGEST];
+
+    mbedtls_sha256_finish(&s->sha, inner);
+    mbedtls_sha256_starts(&s->sha, 0);
+    hmac_key_block(&s->sha, 0x5c);
+    mbedtls_sha256_update(&s->sha, inner, sizeof(inner));
+    mbedtls_sha256_finish(&s->sha, outer);
+    mbedtls_sha256_free(&s->sha);
+    memcpy(tag, outer, DOWNLINK_AUTH_TAG_LEN);
+}
+
+int downlink_auth_verify(struct downlink_auth_stream *s, const uint8_t tag[DOWNLINK_AUTH_TAG_LEN]) {
+    uint8_t expected[DOWNLINK_AUTH_TAG_LEN];
+
+    if (!auth_key_loaded) {
+        return -EACCES;
+    }
+    downlink_auth_final(s, expected);
+    return mbedtls_ct_memcmp(expected, tag, sizeof(expected)) != 0 ? -EACCES : 0;
+}
+
+int downlink_auth_verify_frame(const uint8_t *frame, size_t len) {
+    if (len < 1 + DOWNLINK_AUTH_FRAME_OVERHEAD) {
+        return -EACCES;
+    }
+    len -= DOWNLINK_AUTH_TAG_LEN;
+    if (auth_mac_verify(DOWNLINK_AUTH_FRAME, frame, len, &frame[len]) != 0) {
+        return -EACCES;
+    }
+
+    // El contador solo se mira con la etiqueta válida: uno falso no puede gastar el guardado
+    const uint8_t *p = &frame[len - DOWNLINK_AUTH_COUNTER_LEN];
+    uint32_t counter = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+
+    if (counter <= auth_counter) {
+        LOG_WRN("Downlink 0x%02x repetido: contador %u, último aceptado %u", frame[0], counter, auth_counter);
+        return -EALREADY;
+    }
+    // Guardado antes de ejecutar: tras un reinicio la misma trama sigue siendo una repetición
+    int err = settings_save_one(DOWNLINK_AUTH_COUNTER_KEY, &counter, sizeof(counter));
+
+    if (err) {
+        LOG_ERR("Fallo al guardar el contador de downlink: %d", err);
+        return err;
+    }
+    auth_counter = counter;
+    return 0;
+}
+
+int downlink_auth_verify_buf(enum downlink_auth_domain domain, const uint8_t *data, size_t len,
+                             const uint8_t tag[DOWNLINK_AUTH_TAG_LEN]) {
+    return auth_mac_verify(domain, data, len, tag);
+}
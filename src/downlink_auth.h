@@ -0,0 +1,80 @@
+/*
+ * Archivo: downlink_auth.h
+ * Descripción: Autenticación de los comandos de downlink que cambian el dispositivo
+ *              (PARAM_SET, FOTA, DFU del módem) con HMAC-SHA256 y una clave de
+ *              DOWNLINK_AUTH_KEY_LEN bytes provisionada en fábrica en settings.
+ *
+ * Etiqueta = primeros DOWNLINK_AUTH_TAG_LEN bytes de HMAC-SHA256(clave, dominio || datos),
+ * con un byte de dominio para que una etiqueta de trama no valga como etiqueta de imagen:
+ *   DOWNLINK_AUTH_FRAME: opcode + payload + contador de una trama privilegiada, que lleva
+ *                        el contador y la etiqueta entre el payload y el CRC (ver downlink.h)
+ *   DOWNLINK_AUTH_IMAGE: imagen reconstruida (FOTA) o delta completo (DFU del módem); la
+ *                        etiqueta viaja en el BEGIN autenticado y se comprueba antes de
+ *                        entregar la imagen a MCUboot o al módem
+ * Sin clave provisionada los comandos privilegiados se rechazan con -EACCES.
+ *
+ * Anti-repetición: el contador de trama (u32 big-endian) lo elige el servidor, monótono por
+ * dispositivo, y solo se acepta si es mayor que el último aceptado, que queda en settings
+ * (DOWNLINK_AUTH_COUNTER_KEY) antes de ejecutar el comando. Reprovisionar la clave no lo
+ * reinicia.
+ *
+ * Las tramas se verifican con PSA Crypto sobre una copia volátil de la clave. Las imágenes
+ * usan el SHA-256 de mbedTLS con el HMAC encima: su contexto es una estructura plana que
+ * se persiste con el progreso del DFU del módem y de bulk. Si otra versión de mbedTLS
+ * cambia su tamaño, la comprobación de longitud al cargar descarta ese progreso y la
+ * transferencia vuelve a empezar.
+ */
+
+#ifndef DOWNLINK_AUTH_H_
+#define DOWNLINK_AUTH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <mbedtls/sha256.h>
+
+#define DOWNLINK_AUTH_SETTINGS_KEY "ntn/mackey"
+#define DOWNLINK_AUTH_COUNTER_KEY DOWNLINK_AUTH_SETTINGS_KEY "/ctr"
+#define DOWNLINK_AUTH_KEY_LEN 32
+#define DOWNLINK_AUTH_TAG_LEN 16
+#define DOWNLINK_AUTH_COUNTER_LEN 4
+#define DOWNLINK_AUTH_FRAME_OVERHEAD (DOWNLINK_AUTH_COUNTER_LEN + DOWNLINK_AUTH_TAG_LEN)
+
+enum downlink_auth_domain {
+    DOWNLINK_AUTH_FRAME = 1,
+    DOWNLINK_AUTH_IMAGE = 2,
+};
+
+// HMAC en curso (SHA-256 de mbedTLS); copiable y persistible tal cual
+struct downlink_auth_stream {
+    mbedtls_sha256_context sha;
+};
+
+// Carga la clave provisionada y el último contador de trama. Requiere settings_subsys_init();
+// -ENOENT si no hay clave.
+int downlink_auth_init(void);
+
+// Provisión en fábrica: guarda la clave en settings y la activa
+int downlink_auth_provision(const uint8_t key[DOWNLINK_AUTH_KEY_LEN]);
+
+bool downlink_auth_ready(void);
+
+void downlink_auth_begin(struct downlink_auth_stream *s, enum downlink_auth_domain domain);
+void downlink_auth_update(struct downlink_auth_stream *s, const uint8_t *data, size_t len);
+
+// Etiqueta del cálculo en curso (lo consume). Lado servidor y pruebas.
+void downlink_auth_final(struct downlink_auth_stream *s, uint8_t tag[DOWNLINK_AUTH_TAG_LEN]);
+
+// Compara en tiempo constante. 0 si coincide, -EACCES si no o si no hay clave.
+int downlink_auth_verify(struct downlink_auth_stream *s, const uint8_t tag[DOWNLINK_AUTH_TAG_LEN]);
+
+// Trama privilegiada sin CRC: opcode + payload + contador + etiqueta. 0 si la etiqueta es
+// válida y el contador nuevo (queda guardado); -EACCES si no autentica, -EALREADY si el
+// contador no es mayor que el último aceptado o el error de settings al guardarlo.
+int downlink_auth_verify_frame(const uint8_t *frame, size_t len);
+
+// Atajo para un bloque completo de un dominio
+int downlink_auth_verify_buf(enum downlink_auth_domain domain, const uint8_t *data, size_t len,
+                             const uint8_t tag[DOWNLINK_AUTH_TAG_LEN]);
+
+#endif /* DOWNLINK_AUTH_H_ */
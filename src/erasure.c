@@ -0,0 +1,167 @@
+/*
+ * Archivo: erasure.c
+ * Descripción: Aritmética GF(256) y decodificador incremental. Lógica pura, sin Zephyr.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "erasure.h"
+
+#define GF_POLY 0x11D
+
+static uint8_t gf_exp[512];
+static uint8_t gf_log[256];
+static bool gf_ready;
+
+static void gf_init(void) {
+    uint16_t x = 1;
+
+    for (int i = 0; i < 255; i++) {
+        gf_exp[i] = (uint8_t)x;
+        gf_log[x] = (uint8_t)i;
+        x <<= 1;
+        if (x & 0x100) {
+            x ^= GF_POLY;
+        }
+    }
+    // Tabla duplicada: evita el módulo 255 en la multiplicación
+    for (int i = 255; i < 512; i++) {
+        gf_exp[i] = gf_exp[i - 255];
+    }
+    gf_ready = true;
+}
+
+static inline uint8_t gf_mul(uint8_t a, uint8_t b) {
+    return (a && b) ? gf_exp[gf_log[a] + gf_log[b]] : 0;
+}
+
+static inline uint8_t gf_inv(uint8_t a) {
+    return gf_exp[255 - gf_log[a]];
+}
+
+// dst ^= factor * src: bucle interno del decodificador
+static void gf_axpy(uint8_t *dst, const uint8_t *src, uint8_t factor, size_t len) {
+    if (factor == 0) {
+        return;
+    }
+    if (factor == 1) {
+        for (size_t i = 0; i < len; i++) {
+            dst[i] ^= src[i];
+        }
+        return;
+    }
+    uint16_t log_f = gf_log[factor];
+
+    for (size_t i = 0; i < len; i++) {
+        if (src[i]) {
+            dst[i] ^= gf_exp[log_f + gf_log[src[i]]];
+        }
+    }
+}
+
+static void gf_scale(uint8_t *buf, uint8_t factor, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = gf_mul(buf[i], factor);
+    }
+}
+
+int erasure_decoder_init(struct erasure_decoder *dec, uint8_t k) {
+    if (k == 0 || k > ERASURE_MAX_K) {
+        return -EINVAL;
+    }
+    if (!gf_ready) {
+        gf_init();
+    }
+    memset(dec, 0, sizeof(*dec));
+    dec->k = k;
+    return 0;
+}
+
+void erasure_coefficients(uint32_t session, uint16_t block, uint16_t esi, uint8_t k, uint8_t *coef) {
+    uint32_t state = session ^ ((uint32_t)block << 16) ^ ((uint32_t)esi * 0x9E3779B9u);
+
+    if (state == 0) {
+        state = 1;
+    }
+    for (uint8_t i = 0; i < k; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        coef[i] = (uint8_t)(1 + state % 255);
+    }
+}
+
+int erasure_decoder_add(struct erasure_decoder *dec, uint32_t session, uint16_t block, uint16_t esi,
+                        const uint8_t symbol[ERASURE_SYMBOL_SIZE]) {
+    if (dec->k == 0) {
+        return -EINVAL;
+    }
+    if (dec->rank == dec->k) {
+        return 0;
+    }
+
+    // La fila candidata se construye en el primer hueco libre
+    uint8_t *coef = dec->coef[dec->rank];
+    uint8_t *data = dec->data[dec->rank];
+
+    if (esi < dec->k) {
+        memset(coef, 0, dec->k);
+        coef[esi] = 1;
+    } else {
+        erasure_coefficients(session, block, esi, dec->k, coef);
+    }
+    memcpy(data, symbol, ERASURE_SYMBOL_SIZE);
+
+    // Reducir contra los pivotes existentes
+    for (uint8_t r = 0; r < dec->rank; r++) {
+        uint8_t factor = coef[dec->pivot_col[r]];
+
+        gf_axpy(coef, dec->coef[r], factor, dec->k);
+        gf_axpy(data, dec->data[r], factor, ERASURE_SYMBOL_SIZE);
+    }
+
+    uint8_t col = 0;
+
+    while (col < dec->k && coef[col] == 0) {
+        col++;
+    }
+    if (col == dec->k) {
+        return 0;       // Combinación de símbolos ya recibidos
+    }
+
+    uint8_t inv = gf_inv(coef[col]);
+
+    gf_scale(coef, inv, dec->k);
+    gf_scale(data, inv, ERASURE_SYMBOL_SIZE);
+
+    // Forma reducida: eliminar la nueva columna pivote del resto de filas
+    for (uint8_t r = 0; r < dec->rank; r++) {
+        uint8_t factor = dec->coef[r][col];
+
+        gf_axpy(dec->coef[r], coef, factor, dec->k);
+        gf_axpy(dec->data[r], data, factor, ERASURE_SYMBOL_SIZE);
+    }
+    dec->pivot_col[dec->rank++] = col;
+    return 1;
+}
+
+const uint8_t *erasure_decoder_source(struct erasure_decoder *dec) {
+    if (!erasure_decoder_complete(dec)) {
+        return NULL;
+    }
+    // Con rango completo la fila r es el símbolo fuente pivot_col[r]: permutar a su sitio
+    for (uint8_t r = 0; r < dec->k; r++) {
+        while (dec->pivot_col[r] != r) {
+            uint8_t dst = dec->pivot_col[r];
+            uint8_t tmp[ERASURE_SYMBOL_SIZE];
+
+            memcpy(tmp, dec->data[dst], ERASURE_SYMBOL_SIZE);
+            memcpy(dec->data[dst], dec->data[r], ERASURE_SYMBOL_SIZE);
+            memcpy(dec->data[r], tmp, ERASURE_SYMBOL_SIZE);
+            dec->pivot_col[r] = dec->pivot_col[dst];
+            dec->pivot_col[dst] = dst;
+        }
+    }
+    return &dec->data[0][0];
+}
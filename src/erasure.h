@@ -0,0 +1,55 @@
+/*
+ * Archivo: erasure.h
+ * Descripción: Código de borrado lineal aleatorio sobre GF(256) por bloques fijos.
+ *              Cualquier subconjunto de K símbolos linealmente independientes
+ *              reconstruye el bloque: los símbolos perdidos no requieren
+ *              retransmisión específica, basta con cualquier símbolo de reparación.
+ *
+ * Símbolos del bloque (K fuente + reparación, identificados por esi):
+ *   esi <  K: sistemático, el símbolo fuente esi tal cual
+ *   esi >= K: combinación lineal con coeficientes c[0..K-1] generados así:
+ *             semilla = session ^ (block << 16) ^ (esi * 0x9E3779B9), 1 si resulta 0
+ *             xorshift32 (13, 17, 5); c[i] = 1 + (siguiente % 255)
+ * Polinomio del cuerpo: x^8 + x^4 + x^3 + x^2 + 1 (0x11D).
+ */
+
+#ifndef ERASURE_H_
+#define ERASURE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ERASURE_MAX_K 16                // Símbolos fuente por bloque
+#define ERASURE_SYMBOL_SIZE 128         // Bytes por símbolo
+#define ERASURE_BLOCK_SIZE (ERASURE_MAX_K * ERASURE_SYMBOL_SIZE)
+
+// Eliminación de Gauss-Jordan incremental: las filas se mantienen en forma reducida,
+// de modo que con rango K cada fila es directamente un símbolo fuente.
+// Memoria acotada: ERASURE_MAX_K * (ERASURE_MAX_K + ERASURE_SYMBOL_SIZE) bytes.
+struct erasure_decoder {
+    uint8_t k;
+    uint8_t rank;
+    uint8_t pivot_col[ERASURE_MAX_K];           // Columna pivote de cada fila
+    uint8_t coef[ERASURE_MAX_K][ERASURE_MAX_K];
+    uint8_t data[ERASURE_MAX_K][ERASURE_SYMBOL_SIZE];
+};
+
+int erasure_decoder_init(struct erasure_decoder *dec, uint8_t k);
+
+// Coeficientes del símbolo esi (ver cabecera); coef tiene k entradas
+void erasure_coefficients(uint32_t session, uint16_t block, uint16_t esi, uint8_t k, uint8_t *coef);
+
+// Incorpora un símbolo. 1 si aumenta el rango, 0 si es redundante, -errno si no es válido.
+int erasure_decoder_add(struct erasure_decoder *dec, uint32_t session, uint16_t block, uint16_t esi,
+                        const uint8_t symbol[ERASURE_SYMBOL_SIZE]);
+
+static inline bool erasure_decoder_complete(const struct erasure_decoder *dec) {
+    return dec->k > 0 && dec->rank == dec->k;
+}
+
+// Con el bloque completo ordena las filas in situ y devuelve los K símbolos fuente
+// contiguos (dec->data), sin buffer adicional. NULL si falta rango.
+const uint8_t *erasure_decoder_source(struct erasure_decoder *dec);
+
+#endif /* ERASURE_H_ */
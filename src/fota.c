@@ -0,0 +1,509 @@
+/*
+ * Archivo: fota.c
+ * Descripción: Aplicación en streaming del parche delta sobre el slot secundario.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/dfu/mcuboot.h>
+#include <zephyr/sys/crc.h>
+#include <string.h>
+
+#include "downlink_auth.h"
+#include "fota.h"
+
+LOG_MODULE_DECLARE(ntn_app, LOG_LEVEL_INF);
+
+#define FOTA_BEGIN_LEN (24 + DOWNLINK_AUTH_TAG_LEN)
+#define FOTA_CHUNK_HDR_LEN 8
+#define FOTA_WRITE_BLOCK 16             // Múltiplo del bloque de escritura del NVMC (4 bytes)
+#define FOTA_ERASE_PAGE 4096            // Página de flash del nRF91
+#define FOTA_READ_BUF 64
+#define FOTA_PERSIST_INTERVAL (4 * 1024)    // Bytes de parche entre guardados del progreso
+
+#define DELTA_OP_COPY 0x01
+#define DELTA_OP_INSERT 0x02
+#define DELTA_COPY_HDR_LEN 9
+#define DELTA_INSERT_HDR_LEN 5
+
+enum fota_state {
+    FOTA_IDLE,
+    FOTA_ACTIVE,
+    FOTA_READY          // Imagen verificada y upgrade solicitado a MCUboot
+};
+
+// Progreso persistido cada FOTA_PERSIST_INTERVAL bytes de parche y al cerrar la ventana de
+// downlink: basta para reanudar en el próximo pase, incluido el parseo de una operación
+// partida entre fragmentos. Tras un reinicio se reaplica el parche desde ese punto y los
+// bloques que ya estaban escritos se comprueban en lugar de reescribirse.
+struct fota_progress {
+    uint32_t session_id;
+    uint32_t patch_size;
+    uint32_t patch_offset;      // Bytes del parche aplicados
+    uint32_t image_size;
+    uint32_t image_crc;
+    uint32_t base_size;
+    uint32_t out_offset;        // Bytes escritos en el slot secundario (múltiplo de FOTA_WRITE_BLOCK)
+    uint32_t erased_end;        // Fin de la zona ya borrada del slot secundario
+    uint32_t op_remaining;      // Bytes pendientes de la operación INSERT en curso
+    uint8_t state;
+    uint8_t hdr_len;
+    uint8_t tail_len;
+    uint8_t hdr[DELTA_COPY_HDR_LEN];
+    uint8_t tail[FOTA_WRITE_BLOCK];     // Salida pendiente de completar un bloque
+    uint8_t image_tag[DOWNLINK_AUTH_TAG_LEN];
+};
+
+static struct fota_progress progress;
+static uint32_t persisted_offset;       // patch_offset del último fota_persist()
+static const struct flash_area *primary;
+static const struct flash_area *secondary;
+static bool reboot_pending;
+
+static uint32_t get_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static int fota_persist(void) {
+    int err = settings_save_one(FOTA_SETTINGS_KEY, &progress, sizeof(progress));
+
+    if (err) {
+        LOG_ERR("Fallo al guardar progreso FOTA: %d", err);
+        return err;
+    }
+    persisted_offset = progress.patch_offset;
+    return 0;
+}
+
+static void fota_reset(void) {
+    memset(&progress, 0, sizeof(progress));
+    progress.state = FOTA_IDLE;
+}
+
+static int area_crc32(const struct flash_area *fa, uint32_t size, uint32_t *crc) {
+    uint8_t buf[FOTA_READ_BUF];
+    uint32_t value = 0;
+
+    for (uint32_t off = 0; off < size; off += sizeof(buf)) {
+        size_t n = MIN(sizeof(buf), size - off);
+        int err = flash_area_read(fa, off, buf, n);
+
+        if (err) {
+            return err;
+        }
+        value = crc32_ieee_update(value, buf, n);
+    }
+    *crc = value;
+    return 0;
+}
+
+// Etiqueta de la imagen reconstruida, leída del slot como area_crc32()
+static int area_auth_verify(const struct flash_area *fa, uint32_t size, const uint8_t *tag) {
+    struct downlink_auth_stream mac;
+    uint8_t buf[FOTA_READ_BUF];
+
+    downlink_auth_begin(&mac, DOWNLINK_AUTH_IMAGE);
+    for (uint32_t off = 0; off < size; off += sizeof(buf)) {
+        size_t n = MIN(sizeof(buf), size - off);
+        int err = flash_area_read(fa, off, buf, n);
+
+        if (err) {
+            return err;
+        }
+        downlink_auth_update(&mac, buf, n);
+    }
+    return downlink_auth_verify(&mac, tag);
+}
+
+// Escribe un bloque completo; borra la página siguiente cuando la salida llega a ella.
+// Entre out_offset y erased_end puede haber bloques escritos tras el último fota_persist():
+// un bloque idéntico se da por escrito y uno borrado se escribe; otro contenido es -EIO.
+static int fota_flush_block(void) {
+    uint8_t current[FOTA_WRITE_BLOCK];
+    int err;
+
+    if (progress.out_offset + FOTA_WRITE_BLOCK > progress.erased_end) {
+        err = flash_area_erase(secondary, progress.erased_end, FOTA_ERASE_PAGE);
+        if (err) {
+            return err;
+        }
+        progress.erased_end += FOTA_ERASE_PAGE;
+    }
+    err = flash_area_read(secondary, progress.out_offset, current, sizeof(current));
+    if (err) {
+        return err;
+    }
+    if (memcmp(current, progress.tail, FOTA_WRITE_BLOCK) != 0) {
+        for (size_t i = 0; i < sizeof(current); i++) {
+            if (current[i] != 0xFF) {
+                LOG_ERR("Slot secundario escrito con otro contenido en %u", progress.out_offset);
+                return -EIO;
+            }
+        }
+        err = flash_area_write(secondary, progress.out_offset, progress.tail, FOTA_WRITE_BLOCK);
+        if (err) {
+            return err;
+        }
+    }
+    progress.out_offset += FOTA_WRITE_BLOCK;
+    progress.tail_len = 0;
+    return 0;
+}
+
+static int fota_out_write(const uint8_t *data, size_t len) {
+    if (progress.out_offset + progress.tail_len + len > progress.image_size) {
+        return -EFBIG;
+    }
+    while (len > 0) {
+        size_t n = MIN(len, (size_t)(FOTA_WRITE_BLOCK - progress.tail_len));
+
+        memcpy(&progress.tail[progress.tail_len], data, n);
+        progress.tail_len += n;
+        data += n;
+        len -= n;
+        if (progress.tail_len == FOTA_WRITE_BLOCK) {
+            int err = fota_flush_block();
+
+            if (err) {
+                return err;
+            }
+        }
+    }
+    return 0;
+}
+
+static int delta_copy(uint32_t src, uint32_t len) {
+    uint8_t buf[FOTA_READ_BUF];
+
+    if (src > progress.base_size || len > progress.base_size - src) {
+        LOG_ERR("COPY fuera de la imagen base: %u+%u", src, len);
+        return -EINVAL;
+    }
+    while (len > 0) {
+        size_t n = MIN(sizeof(buf), len);
+        int err = flash_area_read(primary, src, buf, n);
+
+        if (err == 0) {
+            err = fota_out_write(buf, n);
+        }
+        if (err) {
+            return err;
+        }
+        src += n;
+        len -= n;
+    }
+    return 0;
+}
+
+// Aplica bytes del parche; las cabeceras de operación pueden quedar partidas entre fragmentos
+static int delta_feed(const uint8_t *data, size_t len) {
+    while (len > 0) {
+        if (progress.op_remaining > 0) {
+            size_t n = MIN(len, progress.op_remaining);
+            int err = fota_out_write(data, n);
+
+            if (err) {
+                return err;
+            }
+            data += n;
+            len -= n;
+            progress.op_remaining -= n;
+            continue;
+        }
+
+        progress.hdr[progress.hdr_len++] = *data++;
+        len--;
+
+        size_t need = progress.hdr[0] == DELTA_OP_COPY ? DELTA_COPY_HDR_LEN :
+                      progress.hdr[0] == DELTA_OP_INSERT ? DELTA_INSERT_HDR_LEN : 0;
+        if (need == 0) {
+            LOG_ERR("Operación delta desconocida: 0x%02x", progress.hdr[0]);
+            return -EILSEQ;
+        }
+        if (progress.hdr_len < need) {
+            continue;
+        }
+        progress.hdr_len = 0;
+
+        if (progress.hdr[0] == DELTA_OP_COPY) {
+            int err = delta_copy(get_be32(&progress.hdr[1]), get_be32(&progress.hdr[5]));
+
+            if (err) {
+                return err;
+            }
+        } else {
+            progress.op_remaining = get_be32(&progress.hdr[1]);
+        }
+    }
+    return 0;
+}
+
+// Completa el último bloque, verifica la imagen reconstruida y la entrega a MCUboot
+static int fota_finalize(void) {
+    uint32_t crc;
+    int err;
+
+    if (progress.op_remaining > 0 || progress.hdr_len > 0) {
+        LOG_ERR("Parche truncado: operación incompleta");
+        return -EILSEQ;
+    }
+    if (progress.tail_len > 0) {
+        memset(&progress.tail[progress.tail_len], 0xFF, FOTA_WRITE_BLOCK - progress.tail_len);
+        err = fota_flush_block();
+        if (err) {
+            return err;
+        }
+    }
+    if (progress.out_offset < progress.image_size) {
+        LOG_ERR("Imagen incompleta: %u de %u bytes", progress.out_offset, progress.image_size);
+        return -EILSEQ;
+    }
+    err = area_crc32(secondary, progress.image_size, &crc);
+    if (err) {
+        return err;
+    }
+    if (crc != progress.image_crc) {
+        LOG_ERR("CRC de imagen incorrecto: %08x != %08x", crc, progress.image_crc);
+        return -EBADMSG;
+    }
+    // El CRC solo detecta errores; la etiqueta prueba que la imagen es la del servidor
+    err = area_auth_verify(secondary, progress.image_size, progress.image_tag);
+    if (err) {
+        LOG_ERR("Etiqueta de imagen incorrecta - no se entrega a MCUboot");
+        return err;
+    }
+    err = boot_request_upgrade(BOOT_UPGRADE_TEST);
+    if (err) {
+        LOG_ERR("MCUboot rechazó la petición de upgrade: %d", err);
+        return err;
+    }
+
+    progress.state = FOTA_READY;
+    reboot_pending = true;
+    LOG_INF("FOTA completo: %u bytes de parche para %u de imagen (%u%%)", progress.patch_size,
+            progress.image_size, (uint32_t)((uint64_t)progress.patch_size * 100 / progress.image_size));
+    return 0;
+}
+
+static void fota_put_status(struct downlink_response *resp) {
+    downlink_resp_put_be32(resp, progress.session_id);
+    downlink_resp_put_be32(resp, progress.patch_offset);
+}
+
+static int fota_load_cb(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg, void *param) {
+    ARG_UNUSED(key);
+    ARG_UNUSED(param);
+
+    if (len != sizeof(progress) || read_cb(cb_arg, &progress, sizeof(progress)) != sizeof(progress)) {
+        LOG_WRN("Progreso FOTA incompatible - descartado");
+        fota_reset();
+    }
+    return 0;
+}
+
+int fota_init(void) {
+    int err = flash_area_open(FIXED_PARTITION_ID(slot0_partition), &primary);
+
+    if (err == 0) {
+        err = flash_area_open(FIXED_PARTITION_ID(slot1_partition), &secondary);
+    }
+    if (err) {
+        LOG_ERR("Slots MCUboot no disponibles: %d", err);
+        return err;
+    }
+
+    fota_reset();
+    reboot_pending = false;
+    err = settings_load_subtree_direct(FOTA_SETTINGS_KEY, fota_load_cb, NULL);
+    if (err) {
+        LOG_ERR("Fallo al cargar progreso FOTA: %d", err);
+        fota_reset();
+        return err;
+    }
+    persisted_offset = progress.patch_offset;
+
+    // READY solo vale hasta el reinicio: MCUboot ya tiene la petición en el trailer
+    if (progress.state == FOTA_READY) {
+        LOG_INF("FOTA de la sesión %08x instalado%s", progress.session_id,
+                fota_running_test_image() ? " (imagen en prueba)" : "");
+        fota_reset();
+        fota_persist();
+    } else if (progress.state == FOTA_ACTIVE) {
+        LOG_INF("FOTA en curso: sesión %08x, %u/%u bytes", progress.session_id,
+                progress.patch_offset, progress.patch_size);
+    }
+    return 0;
+}
+
+int fota_handle_begin(const uint8_t *payload, size_t len, struct downlink_response *resp) {
+    uint32_t session_id, base_crc, crc;
+    ssize_t image_max;
+    int err;
+
+    if (len != FOTA_BEGIN_LEN) {
+        return -EBADMSG;
+    }
+    if (!secondary) {
+        return -ENODEV;
+    }
+    // Con una imagen ya entregada a MCUboot el slot secundario no se toca hasta reiniciar
+    if (reboot_pending) {
+        return -EBUSY;
+    }
+    session_id = get_be32(&payload[0]);
+
+    // La imagen no puede invadir el trailer de MCUboot (estado del swap) al final del slot
+    image_max = boot_get_area_trailer_status_offset(secondary->fa_id);
+    if (image_max < 0) {
+        LOG_ERR("Trailer MCUboot del slot secundario desconocido: %d", (int)image_max);
+        return (int)image_max;
+    }
+
+    // BEGIN repetido (ack perdido): se contesta con el punto de reanudación
+    if (progress.state == FOTA_ACTIVE && progress.session_id == session_id) {
+        fota_put_status(resp);
+        return 0;
+    }
+
+    fota_reset();
+    progress.session_id = session_id;
+    progress.patch_size = get_be32(&payload[4]);
+    progress.image_size = get_be32(&payload[8]);
+    progress.image_crc = get_be32(&payload[12]);
+    progress.base_size = get_be32(&payload[16]);
+    base_crc = get_be32(&payload[20]);
+    memcpy(progress.image_tag, &payload[24], sizeof(progress.image_tag));
+
+    if (progress.patch_size == 0 || progress.image_size == 0 || progress.image_size > (size_t)image_max ||
+        progress.base_size > primary->fa_size) {
+        fota_reset();
+        return -EFBIG;
+    }
+
+    // El parche solo es válido contra la imagen exacta que está ejecutando el dispositivo
+    err = area_crc32(primary, progress.base_size, &crc);
+    if (err || crc != base_crc) {
+        LOG_ERR("Imagen base distinta de la del parche (%08x != %08x)", crc, base_crc);
+        fota_reset();
+        return err ? err : -ENOEXEC;
+    }
+
+    progress.state = FOTA_ACTIVE;
+    LOG_INF("FOTA sesión %08x: parche %u bytes, imagen %u bytes", session_id,
+            progress.patch_size, progress.image_size);
+    fota_put_status(resp);
+    return fota_persist();
+}
+
+int fota_write_patch(uint32_t session_id, uint32_t offset, const uint8_t *data, size_t len) {
+    int err;
+
+    if (progress.state != FOTA_ACTIVE || session_id != progress.session_id) {
+        return -ESRCH;
+    }
+    // Fuera de orden: el llamante contesta con el offset esperado para que se reenvíe
+    if (offset > progress.patch_offset) {
+        return -ERANGE;
+    }
+    // Duplicado o reenvío tras un reinicio: solo cuenta la parte aún no aplicada
+    if (offset < progress.patch_offset) {
+        uint32_t applied = progress.patch_offset - offset;
+
+        if (len <= applied) {
+            return 0;
+        }
+        data += applied;
+        len -= applied;
+    }
+    if (len > progress.patch_size - progress.patch_offset) {
+        return -EFBIG;
+    }
+
+    err = delta_feed(data, len);
+    if (err == 0) {
+        progress.patch_offset += len;
+        if (progress.patch_offset == progress.patch_size) {
+            err = fota_finalize();
+        }
+    }
+    if (err) {
+        // Parche corrupto o imagen no verificable: la sesión se descarta entera
+        LOG_ERR("FOTA sesión %08x abortada: %d", progress.session_id, err);
+        fota_reset();
+        fota_persist();
+        return err;
+    }
+
+    // Imagen entregada a MCUboot o FOTA_PERSIST_INTERVAL bytes desde el último guardado;
+    // el resto queda para fota_suspend() al cerrar la ventana
+    if (progress.state == FOTA_READY || progress.patch_offset - persisted_offset >= FOTA_PERSIST_INTERVAL) {
+        return fota_persist();
+    }
+    return 0;
+}
+
+void fota_suspend(void) {
+    if (progress.state == FOTA_ACTIVE && progress.patch_offset != persisted_offset) {
+        fota_persist();
+    }
+}
+
+int fota_handle_chunk(const uint8_t *payload, size_t len, struct downlink_response *resp) {
+    int err;
+
+    if (len <= FOTA_CHUNK_HDR_LEN) {
+        return -EBADMSG;
+    }
+    err = fota_write_patch(get_be32(&payload[0]), get_be32(&payload[4]), &payload[FOTA_CHUNK_HDR_LEN],
+                           len - FOTA_CHUNK_HDR_LEN);
+    if (err != -ESRCH) {
+        fota_put_status(resp);
+    }
+    return err;
+}
+
+int fota_handle_abort(const uint8_t *payload, size_t len) {
+    if (len != 4) {
+        return -EBADMSG;
+    }
+    if (progress.state != FOTA_ACTIVE || get_be32(payload) != progress.session_id) {
+        return -ESRCH;
+    }
+    LOG_WRN("FOTA sesión %08x cancelada por el servidor", progress.session_id);
+    fota_reset();
+    return fota_persist();
+}
+
+bool fota_resume_request(struct downlink_response *resp) {
+    if (progress.state != FOTA_ACTIVE) {
+        return false;
+    }
+    resp->buf[0] = DOWNLINK_ACK_FLAG | DOWNLINK_OP_FOTA_CHUNK;
+    resp->buf[1] = 0;
+    resp->len = DOWNLINK_ACK_LEN;
+    fota_put_status(resp);
+    return true;
+}
+
+bool fota_reboot_pending(void) {
+    return reboot_pending;
+}
+
+bool fota_running_test_image(void) {
+    return !boot_is_img_confirmed();
+}
+
+void fota_confirm_image(void) {
+    if (!fota_running_test_image()) {
+        return;
+    }
+    int err = boot_write_img_confirmed();
+
+    if (err) {
+        LOG_ERR("Fallo al confirmar la imagen: %d", err);
+    } else {
+        LOG_INF("Imagen nueva confirmada");
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * Archivo: fota.h
+ * Descripción: Actualización de firmware delta (MCUboot) por el canal UDP del VAS,
+ *              reanudable entre pases.
+ *
+ * El servidor envía un parche contra la imagen en ejecución (slot primario); el
+ * dispositivo reconstruye la imagen nueva en el slot secundario a medida que llegan
+ * los fragmentos y MCUboot la instala en modo test en el siguiente reinicio.
+ *
+ * Formato del parche: secuencia de operaciones
+ *   COPY   [0x01][origen u32][longitud u32]    bytes de la imagen actual
+ *   INSERT [0x02][longitud u32][datos...]      bytes nuevos
+ *
+ * Downlink (payload tras el opcode, big-endian):
+ *   FOTA_BEGIN [sesión][tamaño parche][tamaño imagen][CRC32 imagen][tamaño base][CRC32 base]
+ *              [etiqueta de la imagen (DOWNLINK_AUTH_IMAGE)]
+ *   FOTA_CHUNK [sesión][offset en el parche][datos...]
+ *   FOTA_ABORT [sesión]
+ * Respuesta a BEGIN/CHUNK: [sesión][próximo offset del parche que se espera]
+ *
+ * BEGIN y ABORT van autenticados (downlink_auth.h); los CHUNK no, pero la imagen
+ * reconstruida solo pasa a MCUboot si su etiqueta coincide con la del BEGIN.
+ * La imagen debe caber antes del trailer de MCUboot del slot secundario (-EFBIG).
+ *
+ * El progreso se persiste cada pocos KB de parche y en fota_suspend(), no por fragmento:
+ * tras un reinicio la respuesta indica un offset anterior y el servidor reenvía desde ahí.
+ */
+
+#ifndef FOTA_H_
+#define FOTA_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "downlink.h"
+
+#define FOTA_SETTINGS_KEY "ntn/fota"
+
+// Abre los slots y recupera una transferencia a medias. Requiere settings_subsys_init().
+int fota_init(void);
+
+int fota_handle_begin(const uint8_t *payload, size_t len, struct downlink_response *resp);
+int fota_handle_chunk(const uint8_t *payload, size_t len, struct downlink_response *resp);
+int fota_handle_abort(const uint8_t *payload, size_t len);
+
+// Aplica un tramo del parche de la sesión activa; común a FOTA_CHUNK y a la entrega por bulk.h
+int fota_write_patch(uint32_t session_id, uint32_t offset, const uint8_t *data, size_t len);
+
+// Persiste el progreso pendiente; llamar al cerrar cada ventana de downlink
+void fota_suspend(void);
+
+// Si hay una transferencia en curso prepara la petición de reanudación para el servidor
+bool fota_resume_request(struct downlink_response *resp);
+
+// Imagen nueva verificada y marcada para MCUboot: reiniciar entre pases
+bool fota_reboot_pending(void);
+
+// Ejecutando una imagen en prueba (aún sin confirmar)
+bool fota_running_test_image(void);
+
+// Confirma la imagen en prueba tras un ciclo completo (registro + envío) correcto
+void fota_confirm_image(void);
+
+#endif /* FOTA_H_ */
@@ -0,0 +1,94 @@
+/*
+ * Archivo: geo_position.c
+ * Descripción: Conversión del fix GNSS y distancias cortas entre posiciones en
+ *              enteros. Lógica pura, sin Zephyr.
+ */
+
+#include <math.h>
+
+#include "geo_position.h"
+#include "int_math.h"
+
+#define METERS_PER_DEG_LAT 111320
+
+static const int16_t cos_table_q15[91] = {
+    32767, 32762, 32747, 32722, 32687, 32642, 32587, 32523, 32448, 32364,
+    32269, 32165, 32051, 31927, 31794, 31650, 31498, 31335, 31163, 30982,
+    30791, 30591, 30381, 30162, 29934, 29697, 29451, 29196, 28932, 28659,
+    28377, 28087, 27788, 27481, 27165, 26841, 26509, 26169, 25821, 25465,
+    25101, 24730, 24351, 23964, 23571, 23170, 22762, 22347, 21925, 21497,
+    21062, 20621, 20173, 19720, 19260, 18794, 18323, 17846, 17364, 16876,
+    16384, 15886, 15383, 14876, 14364, 13848, 13328, 12803, 12275, 11743,
+    11207, 10668, 10126, 9580, 9032, 8481, 7927, 7371, 6813, 6252,
+    5690, 5126, 4560, 3993, 3425, 2856, 2286, 1715, 1144, 572,
+    0,
+};
+
+// value * scale redondeado al entero más cercano con llrint(): empates al par con el
+// modo de redondeo por defecto (FE_TONEAREST). El producto se redondea antes a double,
+// lo que solo cambia el resultado a menos de un ulp de un empate. Satura a int32.
+static int32_t scaled_round_even(double value, uint32_t scale) {
+    if (!isfinite(value)) {
+        return 0;               // NaN/infinito: no es un fix válido
+    }
+
+    double scaled = value * scale;
+
+    if (scaled >= INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (scaled <= INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)llrint(scaled);
+}
+
+void geo_position_from_fix(double lat_deg, double lon_deg, float alt_m, struct geo_position *pos,
+                           struct geo_modem_position *modem) {
+    pos->lat_udeg = scaled_round_even(lat_deg, UDEG_PER_DEG);
+    pos->lon_udeg = scaled_round_even(lon_deg, UDEG_PER_DEG);
+    pos->alt_dm = scaled_round_even(alt_m, 10);
+
+    // Mismas expresiones que la versión original: el módem recibe el valor truncado
+    modem->lon_param = 180000 + (int32_t)(lon_deg * 1000);
+    modem->lat_param = 90000 + (int32_t)(lat_deg * 1000);
+    modem->alt_mm = (int32_t)((double)alt_m * 1000);
+}
+
+int32_t geo_cos_q15(int32_t lat_udeg) {
+    uint32_t a = (uint32_t)abs(lat_udeg);
+
+    if (a >= 90 * UDEG_PER_DEG) {
+        return 0;
+    }
+    uint32_t deg = a / UDEG_PER_DEG;
+    uint32_t frac = a % UDEG_PER_DEG;
+    int32_t c0 = cos_table_q15[deg];
+    int32_t c1 = cos_table_q15[deg + 1];
+
+    return c0 + (int32_t)(((int64_t)(c1 - c0) * frac) / UDEG_PER_DEG);
+}
+
+void geo_offset_m(const struct geo_position *ref, const struct geo_position *p, int32_t *east_m,
+                  int32_t *north_m) {
+    int64_t dlat = (int64_t)p->lat_udeg - ref->lat_udeg;
+    int64_t dlon = (int64_t)p->lon_udeg - ref->lon_udeg;
+
+    // Cruce del antimeridiano: el camino corto
+    if (dlon > 180LL * UDEG_PER_DEG) {
+        dlon -= 360LL * UDEG_PER_DEG;
+    } else if (dlon < -180LL * UDEG_PER_DEG) {
+        dlon += 360LL * UDEG_PER_DEG;
+    }
+    int32_t cos_q15 = geo_cos_q15((int32_t)(((int64_t)ref->lat_udeg + p->lat_udeg) / 2));
+
+    *north_m = (int32_t)(dlat * METERS_PER_DEG_LAT / UDEG_PER_DEG);
+    *east_m = (int32_t)((dlon * METERS_PER_DEG_LAT / UDEG_PER_DEG) * cos_q15 / 32768);
+}
+
+uint32_t geo_distance_m(const struct geo_position *a, const struct geo_position *b) {
+    int32_t east, north;
+
+    geo_offset_m(a, b, &east, &north);
+    return isqrt64((uint64_t)((int64_t)east * east + (int64_t)north * north));
+}
@@ -0,0 +1,57 @@
+/*
+ * Archivo: geo_position.h
+ * Descripción: Posición del dispositivo en enteros (micro-grados y decímetros)
+ *              y macros para imprimirla sin soporte de coma flotante. Distancias
+ *              cortas para umbrales, geocercas y simplificación de trayectorias.
+ */
+
+#ifndef GEO_POSITION_H_
+#define GEO_POSITION_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define UDEG_PER_DEG 1000000
+
+// Imprime micro-grados como grados con 6 decimales sin usar %f
+#define UDEG_FMT "%s%d.%06d"
+#define UDEG_ARGS(v) ((v) < 0 ? "-" : ""), abs((v) / UDEG_PER_DEG), abs((v) % UDEG_PER_DEG)
+// Imprime decímetros como metros con 1 decimal sin usar %f
+#define DM_FMT "%s%d.%d"
+#define DM_ARGS(v) ((v) < 0 ? "-" : ""), abs((v) / 10), abs((v) % 10)
+
+// Posición en enteros: evita aritmética double emulada por software en el M33.
+// La resolución es la de la telemetría (%.6f y %.1f): cada campo sale del fix con un
+// único redondeo y se imprime sin volver a redondear.
+struct geo_position {
+    int32_t lat_udeg;           // Latitud en micro-grados (1e-6°)
+    int32_t lon_udeg;           // Longitud en micro-grados (1e-6°)
+    int32_t alt_dm;             // Altitud en decímetros
+};
+
+// Parámetros de AT%XSETGPSPOS tal y como los calculaba la versión con double:
+// (int)(x * 1000), es decir, truncados y no redondeados
+struct geo_modem_position {
+    int32_t lon_param;          // 180000 + longitud en milésimas de grado
+    int32_t lat_param;          // 90000 + latitud en milésimas de grado
+    int32_t alt_mm;             // Altitud en milímetros
+};
+
+// Única conversión desde la coma flotante del frame PVT del módem. lat/lon/alt se
+// redondean al entero más cercano (empates al par, como printf) a partir del valor
+// exacto del double/float, sin pasar por una resolución intermedia.
+void geo_position_from_fix(double lat_deg, double lon_deg, float alt_m, struct geo_position *pos,
+                           struct geo_modem_position *modem);
+
+// Coseno de la latitud en Q15 (tabla por grado con interpolación lineal)
+int32_t geo_cos_q15(int32_t lat_udeg);
+
+// Desplazamiento de p respecto a ref en metros (este, norte), proyección equirectangular
+// local: error < 0.5 % por debajo de ~100 km, suficiente para umbrales y geocercas
+void geo_offset_m(const struct geo_position *ref, const struct geo_position *p, int32_t *east_m,
+                  int32_t *north_m);
+
+// Distancia horizontal aproximada en metros (ver geo_offset_m)
+uint32_t geo_distance_m(const struct geo_position *a, const struct geo_position *b);
+
+#endif /* GEO_POSITION_H_ */
@@ -0,0 +1,385 @@
+/*
+ * Archivo: geofence.c
+ * Descripción: Motor de geocercas: bbox como pre-filtro y prueba exacta en enteros
+ *              (distancia equirectangular para círculos, cruce de rayo para polígonos).
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/crc.h>
+#include <string.h>
+
+#include "geofence.h"
+
+LOG_MODULE_DECLARE(ntn_app, LOG_LEVEL_INF);
+
+struct geofence_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t crc32;
+};
+
+struct geofence_record {
+    uint16_t id;
+    uint8_t type;
+    uint8_t vertex_count;
+    int32_t min_lat_udeg;
+    int32_t min_lon_udeg;
+    int32_t max_lat_udeg;
+    int32_t max_lon_udeg;
+};
+
+struct geofence_circle {
+    int32_t lat_udeg;
+    int32_t lon_udeg;
+    uint32_t radius_m;
+};
+
+struct geofence_vertex {
+    int32_t lat_udeg;
+    int32_t lon_udeg;
+};
+
+BUILD_ASSERT(sizeof(struct geofence_header) == 12, "cabecera de geocercas empaquetada");
+BUILD_ASSERT(sizeof(struct geofence_record) == 20, "registro de geocerca empaquetado");
+
+static size_t geofence_record_len(const struct geofence_record *rec) {
+    size_t body = rec->type == GEOFENCE_CIRCLE ? sizeof(struct geofence_circle)
+                                               : rec->vertex_count * sizeof(struct geofence_vertex);
+
+    return sizeof(*rec) + body;
+}
+
+static bool geofence_bit(const uint8_t *map, uint16_t i) {
+    return map[i / 8] & (1u << (i % 8));
+}
+
+static void geofence_set_bit(uint8_t *map, uint16_t i, bool value) {
+    if (value) {
+        map[i / 8] |= 1u << (i % 8);
+    } else {
+        map[i / 8] &= ~(1u << (i % 8));
+    }
+}
+
+static bool vertex_in_bbox(const struct geofence_record *rec, int32_t lat, int32_t lon) {
+    return lat >= rec->min_lat_udeg && lat <= rec->max_lat_udeg &&
+           lon >= rec->min_lon_udeg && lon <= rec->max_lon_udeg;
+}
+
+// La bbox la calcula el servidor; aquí solo se comprueba que cubre la geometría, porque
+// una bbox demasiado pequeña haría que el pre-filtro descartase posiciones interiores
+static bool geofence_record_valid(const struct geofence_record *rec) {
+    if (rec->min_lat_udeg > rec->max_lat_udeg || rec->min_lon_udeg > rec->max_lon_udeg) {
+        return false;
+    }
+
+    if (rec->type == GEOFENCE_CIRCLE) {
+        const struct geofence_circle *c = (const void *)(rec + 1);
+        struct geo_position center = {.lat_udeg = c->lat_udeg, .lon_udeg = c->lon_udeg};
+        struct geo_position corner = {.lat_udeg = rec->max_lat_udeg, .lon_udeg = rec->max_lon_udeg};
+        int32_t east, north;
+
+        if (!vertex_in_bbox(rec, c->lat_udeg, c->lon_udeg)) {
+            return false;
+        }
+        geo_offset_m(&center, &corner, &east, &north);
+        if ((uint32_t)east < c->radius_m || (uint32_t)north < c->radius_m) {
+            return false;
+        }
+        corner.lat_udeg = rec->min_lat_udeg;
+        corner.lon_udeg = rec->min_lon_udeg;
+        geo_offset_m(&center, &corner, &east, &north);
+        return (uint32_t)-east >= c->radius_m && (uint32_t)-north >= c->radius_m;
+    }
+
+    if (rec->type != GEOFENCE_POLYGON || rec->vertex_count < 3) {
+        return false;
+    }
+
+    const struct geofence_vertex *v = (const void *)(rec + 1);
+
+    for (uint8_t i = 0; i < rec->vertex_count; i++) {
+        if (!vertex_in_bbox(rec, v[i].lat_udeg, v[i].lon_udeg)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int geofence_set_bind(struct geofence_set *set, const uint8_t *blob, size_t len) {
+    const struct geofence_header *hdr = (const void *)blob;
+
+    memset(set, 0, sizeof(*set));
+
+    if (len < sizeof(*hdr) || ((uintptr_t)blob & 3) != 0) {
+        return -EINVAL;
+    }
+    if (hdr->magic != GEOFENCE_MAGIC || hdr->version != GEOFENCE_VERSION) {
+        return -EBADMSG;
+    }
+    if (hdr->count > GEOFENCE_MAX) {
+        return -E2BIG;
+    }
+    if (crc32_ieee(blob + sizeof(*hdr), len - sizeof(*hdr)) != hdr->crc32) {
+        return -EILSEQ;
+    }
+
+    size_t offset = sizeof(*hdr);
+
+    for (uint16_t i = 0; i < hdr->count; i++) {
+        const struct geofence_record *rec = (const void *)(blob + offset);
+
+        if (len - offset < sizeof(*rec) || len - offset < geofence_record_len(rec)) {
+            return -EMSGSIZE;
+        }
+        if (!geofence_record_valid(rec)) {
+            LOG_WRN("Geocerca %u inválida", rec->id);
+            return -EINVAL;
+        }
+        offset += geofence_record_len(rec);
+    }
+    if (offset != len) {
+        return -EMSGSIZE;
+    }
+
+    set->blob = blob;
+    set->len = len;
+    set->count = hdr->count;
+    return 0;
+}
+
+static bool circle_contains(const struct geofence_circle *c, const struct geo_position *p) {
+    struct geo_position center = {.lat_udeg = c->lat_udeg, .lon_udeg = c->lon_udeg};
+    int32_t east, north;
+
+    geo_offset_m(&center, p, &east, &north);
+    return (int64_t)east * east + (int64_t)north * north <= (int64_t)c->radius_m * c->radius_m;
+}
+
+// Cruce de rayo hacia +lon. El producto cruzado en int64 sustituye a la división del
+// algoritmo clásico: las diferencias en micro-grados caben en 32 bits y su producto en 64.
+static bool polygon_contains(const struct geofence_vertex *v, uint8_t n, const struct geo_position *p) {
+    bool inside = false;
+
+    for (uint8_t i = 0, j = n - 1; i < n; j = i++) {
+        int32_t yi = v[i].lat_udeg, yj = v[j].lat_udeg;
+
+        if ((yi > p->lat_udeg) == (yj > p->lat_udeg)) {
+            continue;
+        }
+
+        int64_t dy = (int64_t)yj - yi;
+        int64_t lhs = ((int64_t)p->lon_udeg - v[i].lon_udeg) * dy;
+        int64_t rhs = ((int64_t)v[j].lon_udeg - v[i].lon_udeg) * ((int64_t)p->lat_udeg - yi);
+
+        if (dy > 0 ? lhs < rhs : lhs > rhs) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+int geofence_set_evaluate(struct geofence_set *set, const struct geo_position *p, int64_t now,
+                          geofence_event_cb cb, void *ctx) {
+    size_t offset = sizeof(struct geofence_header);
+    int exact = 0;
+
+    for (uint16_t i = 0; i < set->count; i++) {
+        const struct geofence_record *rec = (const void *)(set->blob + offset);
+        bool raw = false;
+
+        offset += geofence_record_len(rec);
+
+        if (vertex_in_bbox(rec, p->lat_udeg, p->lon_udeg)) {
+            exact++;
+            raw = rec->type == GEOFENCE_CIRCLE
+                      ? circle_contains((const void *)(rec + 1), p)
+                      : polygon_contains((const void *)(rec + 1), rec->vertex_count, p);
+        }
+
+        // Cambio de estado solo si el fix anterior ya dio el mismo resultado
+        bool confirmed = raw == geofence_bit(set->last_raw, i);
+
+        geofence_set_bit(set->last_raw, i, raw);
+        if (!confirmed || raw == geofence_bit(set->inside, i)) {
+            continue;
+        }
+        geofence_set_bit(set->inside, i, raw);
+
+        struct geofence_event evt = {
+            .timestamp = now,
+            .position = *p,
+            .fence_id = rec->id,
+            .transition = raw ? GEOFENCE_ENTER : GEOFENCE_EXIT,
+        };
+
+        cb(&evt, ctx);
+    }
+    return exact;
+}
+
+// ========================================
+// ESTADO DEL MÓDULO
+// ========================================
+
+// El blob activo y el de recepción bulk van separados: la evaluación nunca ve un
+// conjunto a medio escribir
+static uint32_t active_blob[GEOFENCE_BLOB_MAX / 4];
+static uint32_t staging_blob[GEOFENCE_BLOB_MAX / 4];
+static uint32_t staging_session;
+static size_t staging_len;
+
+static struct geofence_set active_set;
+static K_MUTEX_DEFINE(set_lock);
+
+static struct k_spinlock fix_lock;
+static struct geo_position pending_fix;
+
+K_MSGQ_DEFINE(geofence_event_msgq, sizeof(struct geofence_event), GEOFENCE_EVENT_QUEUE_DEPTH, 8);
+
+struct geofence_cost {
+    uint32_t fixes;
+    uint32_t exact_checks;
+    uint32_t total_us;
+    uint32_t max_us;
+};
+
+static struct geofence_cost cost;
+
+static void geofence_queue_event(const struct geofence_event *evt, void *ctx) {
+    ARG_UNUSED(ctx);
+    LOG_INF("Geocerca %u: %s", evt->fence_id, evt->transition == GEOFENCE_ENTER ? "entrada" : "salida");
+
+    if (k_msgq_put(&geofence_event_msgq, evt, K_NO_WAIT) != 0) {
+        LOG_WRN("Cola de eventos de geocerca llena - evento %u descartado", evt->fence_id);
+    }
+}
+
+static void geofence_account(uint32_t start_cycles, int exact) {
+    uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start_cycles);
+
+    cost.fixes++;
+    cost.exact_checks += exact;
+    cost.total_us += us;
+    cost.max_us = MAX(cost.max_us, us);
+
+    if (cost.fixes % GEOFENCE_COST_LOG_INTERVAL == 0) {
+        LOG_INF("Geocercas: %u cercas, %u us/fix medio, %u us máx, %u pruebas exactas/fix",
+                active_set.count, cost.total_us / cost.fixes, cost.max_us, cost.exact_checks / cost.fixes);
+    }
+}
+
+static void geofence_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+
+    k_spinlock_key_t key = k_spin_lock(&fix_lock);
+    struct geo_position fix = pending_fix;
+
+    k_spin_unlock(&fix_lock, key);
+
+    k_mutex_lock(&set_lock, K_FOREVER);
+    if (active_set.count > 0) {
+        uint32_t start = k_cycle_get_32();
+        int exact = geofence_set_evaluate(&active_set, &fix, k_uptime_get(), geofence_queue_event, NULL);
+
+        geofence_account(start, exact);
+    }
+    k_mutex_unlock(&set_lock);
+}
+
+static K_WORK_DEFINE(geofence_work, geofence_work_handler);
+
+void geofence_submit_fix(const struct geo_position *p) {
+    k_spinlock_key_t key = k_spin_lock(&fix_lock);
+
+    // Si la evaluación anterior sigue pendiente, se evalúa directamente el fix más reciente
+    pending_fix = *p;
+    k_spin_unlock(&fix_lock, key);
+    k_work_submit(&geofence_work);
+}
+
+bool geofence_next_event(struct geofence_event *evt) {
+    return k_msgq_get(&geofence_event_msgq, evt, K_NO_WAIT) == 0;
+}
+
+static int geofence_load_cb(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg, void *param) {
+    ARG_UNUSED(key);
+
+    if (len > sizeof(active_blob) || read_cb(cb_arg, active_blob, len) != (ssize_t)len) {
+        LOG_WRN("Conjunto de geocercas persistido incompatible - descartado");
+        return 0;
+    }
+    *(size_t *)param = len;
+    return 0;
+}
+
+int geofence_init(void) {
+    size_t len = 0;
+    int err = settings_load_subtree_direct(GEOFENCE_SETTINGS_KEY, geofence_load_cb, &len);
+
+    if (err) {
+        LOG_ERR("Fallo al cargar geocercas: %d", err);
+        return err;
+    }
+    if (len == 0) {
+        LOG_INF("Sin geocercas configuradas");
+        return 0;
+    }
+
+    err = geofence_set_bind(&active_set, (const uint8_t *)active_blob, len);
+    if (err) {
+        LOG_ERR("Conjunto de geocercas persistido inválido: %d", err);
+        return err;
+    }
+
+    LOG_INF("Geocercas cargadas: %u (%u bytes)", active_set.count, len);
+    return 0;
+}
+
+int geofence_bulk_sink(uint32_t session, uint32_t offset, const uint8_t *data, size_t len, bool last) {
+    if (offset == 0) {
+        staging_session = session;
+        staging_len = 0;
+    }
+    if (session != staging_session || offset != staging_len) {
+        return -EINVAL;
+    }
+    if (len > sizeof(staging_blob) - staging_len) {
+        LOG_ERR("Conjunto de geocercas demasiado grande (> %d bytes)", GEOFENCE_BLOB_MAX);
+        return -EFBIG;
+    }
+
+    memcpy((uint8_t *)staging_blob + staging_len, data, len);
+    staging_len += len;
+    if (!last) {
+        return 0;
+    }
+
+    struct geofence_set candidate;
+    int err = geofence_set_bind(&candidate, (const uint8_t *)staging_blob, staging_len);
+
+    if (err) {
+        LOG_ERR("Conjunto de geocercas rechazado: %d", err);
+        return err;
+    }
+
+    err = settings_save_one(GEOFENCE_SETTINGS_KEY, staging_blob, staging_len);
+    if (err) {
+        LOG_ERR("Fallo al guardar geocercas: %d", err);
+        return err;
+    }
+
+    // Estado de dentro/fuera reiniciado: las cercas nuevas generan su entrada con el
+    // siguiente par de fixes
+    k_mutex_lock(&set_lock, K_FOREVER);
+    memcpy(active_blob, staging_blob, staging_len);
+    geofence_set_bind(&active_set, (const uint8_t *)active_blob, staging_len);
+    memset(&cost, 0, sizeof(cost));
+    k_mutex_unlock(&set_lock);
+
+    LOG_INF("Geocercas actualizadas: %u (%u bytes)", active_set.count, staging_len);
+    return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * Archivo: geofence.h
+ * Descripción: Geocercas (círculos y polígonos) evaluadas en cada fix GNSS. Las
+ *              transiciones de entrada/salida se encolan como registros de uplink.
+ *
+ * Conjunto de geocercas: blob little-endian alineado a 4 bytes que se evalúa en sitio,
+ * sin copia a estructuras en RAM. Llega como objeto bulk BULK_TYPE_GEOFENCE y se
+ * persiste en settings.
+ *   Cabecera: [magic u32][versión u16][número u16][CRC32 de los registros u32]
+ *   Registro: [id u16][tipo u8][vértices u8][bbox: lat mín, lon mín, lat máx, lon máx i32]
+ *     CIRCLE:  [lat i32][lon i32][radio m u32]
+ *     POLYGON: vértices x [lat i32][lon i32]
+ * Coordenadas en micro-grados; las geocercas no pueden cruzar el antimeridiano.
+ */
+
+#ifndef GEOFENCE_H_
+#define GEOFENCE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "geo_position.h"
+
+#define GEOFENCE_SETTINGS_KEY "ntn/geofence"
+#define GEOFENCE_MAGIC 0x31534647       // "GFS1"
+#define GEOFENCE_VERSION 1
+#define GEOFENCE_BLOB_MAX 3072          // Cabe en un registro NVS de settings
+#define GEOFENCE_MAX 256
+#define GEOFENCE_EVENT_QUEUE_DEPTH 8
+#define GEOFENCE_COST_LOG_INTERVAL 64   // Fixes entre resúmenes de coste
+
+enum geofence_type {
+    GEOFENCE_CIRCLE = 1,
+    GEOFENCE_POLYGON = 2
+};
+
+enum geofence_transition {
+    GEOFENCE_ENTER = 1,
+    GEOFENCE_EXIT = 2
+};
+
+struct geofence_event {
+    int64_t timestamp;
+    struct geo_position position;
+    uint16_t fence_id;
+    uint8_t transition;         // enum geofence_transition
+};
+
+// Estado de evaluación sobre un blob validado. Una transición exige dos fixes seguidos
+// con el mismo resultado (el ruido del GNSS en el borde no genera eventos).
+struct geofence_set {
+    const uint8_t *blob;
+    size_t len;
+    uint16_t count;
+    uint8_t inside[GEOFENCE_MAX / 8];
+    uint8_t last_raw[GEOFENCE_MAX / 8];
+};
+
+typedef void (*geofence_event_cb)(const struct geofence_event *evt, void *ctx);
+
+// Valida cabecera, CRC, tamaños y bbox del blob y reinicia el estado
+int geofence_set_bind(struct geofence_set *set, const uint8_t *blob, size_t len);
+
+// Evalúa una posición contra todas las geocercas. Devuelve cuántas pasaron el filtro de
+// bbox y necesitaron la prueba exacta.
+int geofence_set_evaluate(struct geofence_set *set, const struct geo_position *p, int64_t now,
+                          geofence_event_cb cb, void *ctx);
+
+// Carga el conjunto persistido. Requiere settings_subsys_init().
+int geofence_init(void);
+
+// Destino bulk: el conjunto nuevo se valida entero antes de sustituir al activo
+int geofence_bulk_sink(uint32_t session, uint32_t offset, const uint8_t *data, size_t len, bool last);
+
+// Desde el manejador GNSS (contexto de interrupción): la evaluación se difiere a un k_work
+void geofence_submit_fix(const struct geo_position *p);
+
+// Siguiente transición pendiente, para encolarla en el uplink desde el hilo principal
+bool geofence_next_event(struct geofence_event *evt);
+
+#endif /* GEOFENCE_H_ */
@@ -0,0 +1,123 @@
+/*
+ * Archivo: heap_guard.c
+ * Descripción: Envoltorios de enlace para malloc/calloc/realloc/free, que cuentan cada
+ *              llamada, y vigilancia en ejecución del heap del sistema.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/__assert.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/sys_heap.h>
+
+#include "heap_guard.h"
+
+LOG_MODULE_DECLARE(ntn_app, LOG_LEVEL_INF);
+
+// =================================================================
+//  ENVOLTORIOS DE ENLACE (-Wl,--wrap)
+// =================================================================
+// Toda referencia a malloc & co. de la imagen (aplicación, NCS, libc) acaba aquí.
+// Nada debería llegar: cada llamada devuelve NULL, como un heap agotado, queda
+// registrada y se cuenta. heap_guard_check() informa del contador una vez por ciclo
+// en lugar de detener la imagen, así un uso dentro de una librería que tolere el NULL
+// no tumba el dispositivo en campo y las pruebas comprueban que sigue a cero.
+
+static atomic_t libc_calls;
+
+void *__wrap_malloc(size_t size)
+{
+    atomic_inc(&libc_calls);
+    LOG_ERR("malloc(%u) en imagen sin heap", (unsigned int)size);
+    return NULL;
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+    atomic_inc(&libc_calls);
+    LOG_ERR("calloc(%u, %u) en imagen sin heap", (unsigned int)nmemb, (unsigned int)size);
+    return NULL;
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    atomic_inc(&libc_calls);
+    LOG_ERR("realloc(%p, %u) en imagen sin heap", ptr, (unsigned int)size);
+    return NULL;
+}
+
+void __wrap_free(void *ptr)
+{
+    // free(NULL) es válido; cualquier otro puntero no salió de malloc
+    if (ptr != NULL) {
+        atomic_inc(&libc_calls);
+        LOG_ERR("free(%p) en imagen sin heap", ptr);
+    }
+}
+
+uint32_t heap_guard_libc_calls(void)
+{
+    return (uint32_t)atomic_get(&libc_calls);
+}
+
+// =================================================================
+//  HEAP DEL SISTEMA (k_malloc)
+// =================================================================
+
+static size_t max_allocated;
+static uint32_t reported_libc_calls;
+
+#if defined(CONFIG_SYS_HEAP_RUNTIME_STATS) && (CONFIG_HEAP_MEM_POOL_SIZE > 0)
+extern struct k_heap _system_heap;
+
+static int system_heap_check(void)
+{
+    struct sys_memory_stats stats;
+    int err = sys_heap_runtime_stats_get(&_system_heap.heap, &stats);
+
+    if (err) {
+        return err;
+    }
+    if (stats.max_allocated_bytes > max_allocated) {
+        max_allocated = stats.max_allocated_bytes;
+        LOG_INF("Heap del sistema: máximo %u B (en uso %u B, presupuesto %u B)",
+                (unsigned int)max_allocated, (unsigned int)stats.allocated_bytes,
+                HEAP_GUARD_BUDGET_BYTES);
+    }
+    if (max_allocated > HEAP_GUARD_BUDGET_BYTES) {
+        LOG_ERR("Heap del sistema por encima del presupuesto: %u B", (unsigned int)max_allocated);
+        __ASSERT(false, "heap del sistema por encima del presupuesto");
+        return -ENOMEM;
+    }
+    return 0;
+}
+#else
+static int system_heap_check(void)
+{
+    return 0;
+}
+#endif
+
+int heap_guard_check(void)
+{
+    uint32_t calls = heap_guard_libc_calls();
+    int err = system_heap_check();
+
+    if (calls > reported_libc_calls) {
+        LOG_ERR("malloc & co. llamados %u veces desde el arranque (%u nuevas)", calls,
+                calls - reported_libc_calls);
+        reported_libc_calls = calls;
+    }
+    if (err) {
+        return err;
+    }
+    return calls > 0 ? -ENOMEM : 0;
+}
+
+size_t heap_guard_max_allocated(void)
+{
+    return max_allocated;
+}
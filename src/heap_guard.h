@@ -0,0 +1,35 @@
+/*
+ * Archivo: heap_guard.h
+ * Descripción: Garantía de imagen sin heap de aplicación. En enlace, malloc/calloc/
+ *              realloc/free de toda la imagen se redirigen (-Wl,--wrap, ver MakeLists.txt)
+ *              a envoltorios que devuelven NULL y cuentan la llamada; en ejecución se
+ *              vigilan ese contador y la marca máxima del heap del sistema, que solo usan
+ *              librerías del módem (k_malloc de lte_lc). tests/unit/heap_guard enlaza
+ *              igual y comprueba que la ruta de la aplicación deja el contador a cero.
+ */
+
+#ifndef HEAP_GUARD_H_
+#define HEAP_GUARD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Presupuesto del heap del sistema (CONFIG_HEAP_MEM_POOL_SIZE=2048): lte_lc reserva
+// un nodo por handler registrado (~24 B con cabecera). 3/4 del pool deja margen a
+// fragmentación sin que un uso nuevo pase desapercibido.
+#define HEAP_GUARD_BUDGET_BYTES 1536
+
+// Comprueba la marca máxima del heap del sistema y las llamadas a malloc & co.
+// Registra cada nuevo máximo y cada aumento del contador. Devuelve -ENOMEM si el heap
+// del sistema supera el presupuesto (y __ASSERT con CONFIG_ASSERT) o si algo ha
+// llamado a malloc & co. desde el arranque. Sin CONFIG_SYS_HEAP_RUNTIME_STATS solo
+// mira el contador.
+int heap_guard_check(void);
+
+// Llamadas a malloc/calloc/realloc (y free de un puntero no nulo) desde el arranque
+uint32_t heap_guard_libc_calls(void);
+
+// Marca máxima registrada en la última comprobación (0 si no hay estadísticas)
+size_t heap_guard_max_allocated(void);
+
+#endif /* HEAP_GUARD_H_ */
@@ -0,0 +1,31 @@
+/*
+ * Archivo: int_math.h
+ * Descripción: Utilidades aritméticas en enteros para el M33 (sin double emulado).
+ */
+
+#ifndef INT_MATH_H_
+#define INT_MATH_H_
+
+#include <stdint.h>
+
+// Raíz cuadrada entera (por defecto) bit a bit
+static inline uint32_t isqrt64(uint64_t v) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+#endif /* INT_MATH_H_ */
@@ -18,13 +18,50 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/net/socket.h>
 #include <zephyr/drivers/watchdog.h>
+#include <zephyr/drivers/hwinfo.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/reboot.h>
 
 #include <modem/lte_lc.h>
 #include <modem/at_cmd_parser.h>
 #include <modem/at_monitor.h>
+#include <modem/nrf_modem_lib.h>
+#include <date_time.h>
+#include <nrf_modem.h>
 #include <nrf_modem_at.h>
 #include <nrf_modem_gnss.h>
-#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "app_state.h"
+#include "bulk.h"
+#include "cell_context.h"
+#include "downlink.h"
+#include "downlink_auth.h"
+#include "fota.h"
+#include "geo_position.h"
+#include "geofence.h"
+#include "heap_guard.h"
+#include "modem_dfu.h"
+#include "net_path.h"
+#include "params.h"
+#include "pass_predictor.h"
+#include "recovery.h"
+#include "report_filter.h"
+#include "sample_control.h"
+#include "sensors.h"
+#include "telemetry.h"
+#include "text_writer.h"
+#include "tle.h"
+#include "trajectory.h"
+#include "uplink_fec.h"
+
+// Sin heap en la ruta de aplicación: todo buffer es estático o de pool fijo.
+// Cualquier uso nuevo de malloc/k_malloc en este archivo falla al compilar; en el
+// resto de la imagen, malloc & co. fallan vía --wrap (heap_guard.c).
+#pragma GCC poison malloc calloc realloc free k_malloc k_calloc k_free
 
 LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
 
@@ -32,97 +69,59 @@ LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
 //  CONFIGURACIÓN GENERAL
 // =================================================================
 
-// --- CONFIGURACIÓN DE GESTIÓN DE FASES ---
-enum integration_phase {
-    PHASE_TN_TESTING,
-    PHASE_NTN_TESTING
-};
-#define CURRENT_INTEGRATION_PHASE PHASE_NTN_TESTING
-
 // --- CONFIGURACIÓN SATELIOT ESPECÍFICA ---
+// Servidor y tiempos de abajo son valores por defecto: en campo se ajustan por
+// downlink (ver params.h) sin reflashear
 #define SATELIOT_PLMN "90197"
+#define VAS_SERVER_IP "your.vas.server.ip"
+#define VAS_SERVER_PORT 17777
 #define SATELIOT_BAND_64_MASK "1000000000000000000000000000000000000000000000000000000000000000"
-#define PAYLOAD_BUFFER_SIZE 256
+#define UPLINK_QUEUE_DEPTH 32           // Registros pendientes de envío entre pases
+#define UPLINK_AGG_QUEUE_DEPTH 8        // Intervalos agregados pendientes (cola propia, ver telemetry.h)
+#define AT_CMD_BUFFER_SIZE 64
+#define XMONITOR_RESPONSE_SIZE 192     // %XMONITOR incluye nombres de operador y timers
 
-// --- CONFIGURACIÓN DE LATENCIAS SATELIOT ---
-#define MAX_END_TO_END_DELAY_MS (26 * 60 * 60 * 1000)  // 26 horas máximo
-#define TYPICAL_REVISIT_TIME_MS (12 * 60 * 60 * 1000)   // 12 horas típico
-#define MIN_SATELLITE_PASS_DURATION_MS (30 * 1000)      // 30 segundos mínimo
-#define MAX_SATELLITE_PASS_DURATION_MS (8 * 60 * 1000)  // 8 minutos máximo
+// --- Disponibilidad del módem en recovery (sondeo de CFUN en lugar de esperas fijas) ---
+#define MODEM_READY_POLL_MS 50
+#define MODEM_OFFLINE_TIMEOUT_MS 5000
+#define MODEM_RESTART_TIMEOUT_MS 30000
+#define MODEM_HIST_TEXT_SIZE 96
 
-// --- MEJORAS v3.2: CONFIGURACIÓN DE RECOVERY Y TLE ---
-#define TLE_UPDATE_INTERVAL_HOURS 24
-#define MAX_ERROR_RECOVERY_ATTEMPTS 3
-#define MIN_BUFFER_SIZE_TELEMETRY 128
-#define TELEMETRY_SAFETY_MARGIN 32
+// --- Watchdog: las esperas largas (fix GNSS, Step 1/2, sueño entre pases) se trocean ---
+#define WDT_TIMEOUT_MS 60000
+#define WDT_FEED_PERIOD_MS 30000        // Mitad del timeout: un retraso de planificación no resetea
 
 // =================================================================
 //  ENUMERACIONES Y ESTRUCTURAS
 // =================================================================
 
-// --- ESTADOS DE LA MÁQUINA DE ESTADOS MEJORADA ---
-enum app_state {
-    STATE_INIT,
-    STATE_GETTING_GPS_FIX,
-    STATE_IDLE,
-    STATE_ATTEMPTING_CONNECTION_STEP1,  // Attach Step 1 - Expect Reject
-    STATE_ATTEMPTING_CONNECTION_STEP2,  // Attach Step 2 - Expect Accept
-    STATE_SENDING_DATA,
-    STATE_ERROR,
-    STATE_RECOVERY,  // MEJORA v3.2: Estado de recovery
-    STATE_TLE_UPDATE // MEJORA v3.2: Estado de actualización TLE
-};
-
-// --- ESTADOS DE ATTACHMENT SATELIOT ---
-enum attachment_step {
-    ATTACH_STEP_1,      // Primer intento - Attach Reject esperado
-    ATTACH_STEP_2,      // Segundo intento - Attach Accept esperado
-    ATTACH_COMPLETE     // Attachment completado exitosamente
-};
-
-// --- ESTRUCTURAS DE DATOS MEJORADAS ---
-struct sateliot_tle {
-    char satellite_name[16];    // SATELIOT_1, SATELIOT_2, etc.
-    char line1[70];             // TLE Line 1
-    char line2[70];             // TLE Line 2
-    int64_t epoch_time;         // Tiempo de época del TLE
-    bool valid;                 // Si el TLE es válido
-};
-
-struct satellite_pass {
-    int64_t start_time;         // Inicio del pase
-    int64_t end_time;           // Fin del pase
-    int max_elevation;          // Elevación máxima en grados
-    int satellite_id;           // ID del satélite (0-3 para SIC-4)
-    bool is_predicted;          // Si es predicción o dato real
-};
-
-// MEJORA v3.2: Estructura para gestión de TLEs
-struct tle_update_config {
-    int64_t last_update_time;
-    int update_interval_hours;
-    bool update_needed;
-    int consecutive_failures;
-};
-
-// MEJORA v3.2: Estructura para recovery de errores
-struct error_recovery_state {
-    int recovery_attempts;
-    int64_t last_recovery_time;
-    enum app_state last_good_state;
-    bool modem_reset_needed;
-};
-
+// Configuración caliente en RAM: solo datos binarios. Campos de 64 bits primero
+// para no generar relleno; las cadenas (TLE, servidor) viven en flash.
 struct sateliot_config {
-    char server_ip[16];         // IP del servidor VAS
-    uint16_t server_port;       // Puerto del servidor VAS
-    double device_lat;          // Latitud del dispositivo
-    double device_lon;          // Longitud del dispositivo
-    double device_alt;          // Altitud del dispositivo
-    struct sateliot_tle satellites[4];  // Constelación SIC-4
-    bool gps_coordinates_valid; // Si las coordenadas GPS son válidas
     struct tle_update_config tle_config;      // MEJORA v3.2
     struct error_recovery_state recovery;     // MEJORA v3.2
+    struct satellite_pass next_pass;          // Cursor de planificación
+    struct net_path_state net_path;           // Disponibilidad TN cacheada
+    struct tle_elements satellites[SATELIOT_CONSTELLATION_SIZE];  // Constelación SIC-4
+    struct geo_position position;       // Posición del dispositivo
+    struct geo_modem_position modem_position;   // La misma posición para AT%XSETGPSPOS
+    bool gps_coordinates_valid;         // Si las coordenadas GPS son válidas
+};
+
+// Antes: 792 bytes (TLE ASCII + IP en texto). Ahora 288 bytes con los contadores de
+// recovery por clase de fallo, la caché TN y la posición para XSETGPSPOS; servidor y
+// tiempos van en rt_params.
+BUILD_ASSERT(sizeof(struct sateliot_config) <= 288, "sateliot_config must stay compact");
+
+// Estado validado en RAM retenida (.noinit) para arranque en caliente tras watchdog/reset SW
+#define RETAINED_STATE_MAGIC 0x5A7E1109
+struct retained_state {
+    uint32_t magic;
+    uint32_t crc;               // CRC32 de todo lo que sigue
+    int64_t saved_uptime;       // Uptime al guardar: base para reajustar los tiempos
+    int64_t saved_wall_ms;      // Hora real (Unix ms) al guardar; 0 si date_time no la tenía
+    struct sateliot_config config;
+    enum attachment_step attachment_step;
 };
 
 // =================================================================
@@ -135,9 +134,57 @@ static K_SEM_DEFINE(lte_connected_sem, 0, 1);
 static K_SEM_DEFINE(gps_fix_sem, 0, 1);
 static struct nrf_modem_gnss_pvt_data_frame last_gps_data;
 static char payload_buffer[PAYLOAD_BUFFER_SIZE];
+static uint8_t fec_datagram[UPLINK_FEC_DATAGRAM_MAX];
+static bool uplink_fec_enabled;
+static uint8_t downlink_buffer[DOWNLINK_MAX_FRAME_LEN];
+static int uplink_sock = -1;
+K_MSGQ_DEFINE(uplink_msgq, sizeof(struct uplink_record), UPLINK_QUEUE_DEPTH, 8);
+K_MSGQ_DEFINE(uplink_agg_msgq, sizeof(struct uplink_aggregate), UPLINK_AGG_QUEUE_DEPTH, 8);
 static const struct device *const wdt_dev = DEVICE_DT_GET(DT_ALIAS(watchdog0));
 static int wdt_channel_id;
 static struct sateliot_config config;
+static __noinit struct retained_state retained;
+static bool gnss_running;
+static struct pass_rng pass_rng;
+static uint32_t device_id_seed;
+static int rach_attempts;
+static bool boot_to_sleep_logged;
+static enum net_path active_path = NET_PATH_NTN;
+static struct cell_context cell_ctx[CELL_CONTEXT_PATHS];
+static struct aggregator aggregator;
+static int64_t last_sample_time;
+static struct sensor_sample last_sensors;
+static struct report_filter report_filter;      // Estado del reporte por excepción
+static struct trajectory trajectory;            // Simplificador de la trayectoria en crudo
+static struct sample_control sample_ctrl;       // Previsión de capacidad de uplink
+static uint32_t sample_interval_s;              // Intervalo efectivo hasta el próximo pase
+static int64_t radio_on_start;                  // Inicio de la sesión de radio del pase
+static struct acquisition_stats acquisition[CELL_CONTEXT_PATHS][2];    // [ruta][sembrada]
+static int64_t connect_start_time;
+static bool connect_seeded;
+static K_SEM_DEFINE(modem_init_sem, 0, 1);
+static int modem_init_result;
+static volatile bool modem_faulted;
+static volatile uint32_t modem_fault_reason;
+
+// Éxitos vistos en los handlers (ISR de GNSS, hilo de lte_lc): el estado de recovery solo
+// lo toca el bucle principal, que los consume al empezar cada iteración
+enum recovery_success_event {
+    RECOVERY_SUCCESS_GNSS_FIX,
+    RECOVERY_SUCCESS_REGISTERED,
+};
+static ATOMIC_DEFINE(recovery_success_events, 2);
+static struct modem_ready_histogram offline_ready_hist;
+static struct modem_ready_histogram restart_ready_hist;
+
+// TLEs de ejemplo para SIC-4 (deben actualizarse con datos reales), solo en flash.
+// SATELIOT_1 TLE de ejemplo del documento; los demás se configurarían con sus TLEs.
+static const struct sateliot_tle_text default_tles[SATELIOT_CONSTELLATION_SIZE] = {
+    {
+        .line1 = "1 60550U 24149CL 25071.82076637 .00007488 00000+0 68187-3 0 9999",
+        .line2 = "2 60550 97.7148 150.0635 0007556 170.3117 189.8251 14.95428546 31058",
+    },
+};
 
 // =================================================================
 //  DECLARACIÓN DE FUNCIONES
@@ -148,142 +195,303 @@ static void gnss_event_handler(int event);
 static int setup_watchdog(void);
 static int configure_power_management(void);
 static int configure_nordic_for_sateliot(void);
-static int robust_data_send(const char *payload);
-static int format_telemetry_data(char *buffer, size_t buffer_size);
-static int calculate_sateliot_satellite_pass(struct satellite_pass *pass, double ground_lat, double ground_lon);
+static int configure_nordic_for_terrestrial(void);
+static int configure_nordic_for_active_path(void);
+static void start_network_search(void);
+static void capture_cell_context(void);
+static int robust_data_send(const void *data, size_t len);
+static void uplink_socket_close(void);
+static void receive_downlink(void);
+static void sync_runtime_params(void);
+static void enqueue_uplink_record(void);
+static void sample_telemetry(void);
+static void idle_sleep(int64_t duration_ms);
+static int64_t skipped_cycle_ms(void);
+static void wait_for_tx_slot(void);
+static void wdt_sleep_ms(int64_t duration_ms);
+static int wdt_sem_take(struct k_sem *sem, int64_t timeout_ms);
+static int wdt_poll(struct pollfd *fds, int64_t timeout_ms);
+static enum app_state pass_uplink_state(void);
+static int send_uplink_payload(const char *payload);
+static int send_pending_uplink_records(void);
 static int initialize_sateliot_config(void);
 static int update_device_coordinates(void);
+static int predict_next_pass(void);
+static uint32_t device_seed(void);
 static int gnss_init_and_start(void);
 static int gnss_stop(void);
+static void retained_state_save(void);
+static bool retained_state_restore(void);
+static void retained_state_rebase(void);
+static void wall_clock_from_gnss(void);
 static int modem_configure_for_sateliot_attachment(void);
 
 // MEJORA v3.2: Nuevas funciones
 static int attempt_error_recovery(enum app_state error_state);
+static int modem_soft_reset(void);
+static int modem_restart(void);
+static int apply_modem_dfu(void);
+static void report_fault(enum recovery_fault fault, int err);
 static int update_sateliot_tles(void);
-static bool validate_buffer_safety(size_t buffer_size, size_t required_size);
 
 // =================================================================
 //  FUNCIONES DE UTILIDAD
 // =================================================================
 
 static void set_state(enum app_state new_state) {
-    if (new_state != current_state) {
-        LOG_INF("State transition: %d -> %d", current_state, new_state);
-        // MEJORA v3.2: Guardar último estado bueno para recovery
-        if (current_state != STATE_ERROR && current_state != STATE_RECOVERY) {
-            config.recovery.last_good_state = current_state;
-        }
-        current_state = new_state;
-    }
+    app_state_transition(&current_state, &config.recovery.last_good_state, new_state);
+}
+
+// Clasifica el fallo para que el recovery elija la acción más barata suficiente
+static void report_fault(enum recovery_fault fault, int err) {
+    LOG_ERR("Fallo %s (%d) - estado %d", recovery_fault_str(fault), err, current_state);
+    recovery_record_fault(&config.recovery, fault, k_uptime_get());
+    set_state(STATE_ERROR);
 }
 
 // =================================================================
 //  MEJORAS v3.2: FUNCIONES DE VALIDACIÓN Y RECOVERY
 // =================================================================
 
-// MEJORA v3.2: Validación robusta de buffers
-static bool validate_buffer_safety(size_t buffer_size, size_t required_size) {
-    if (buffer_size < required_size + TELEMETRY_SAFETY_MARGIN) {
-        LOG_ERR("Buffer validation failed: size=%zu, required=%zu, margin=%d", 
-                buffer_size, required_size, TELEMETRY_SAFETY_MARGIN);
-        return false;
-    }
-    return true;
-}
-
 // MEJORA v3.2: Recovery automático de errores críticos
+// Devuelve 0 si se puede volver al último estado bueno, -EAGAIN si basta con esperar al
+// próximo ciclo y -EFAULT con los intentos agotados.
 static int attempt_error_recovery(enum app_state error_state) {
-    config.recovery.recovery_attempts++;
-    config.recovery.last_recovery_time = k_uptime_get();
-    
-    LOG_WRN("Attempting automatic recovery #%d from state: %d", 
-            config.recovery.recovery_attempts, error_state);
-    
-    if (config.recovery.recovery_attempts > MAX_ERROR_RECOVERY_ATTEMPTS) {
-        LOG_ERR("Maximum recovery attempts exceeded - system will continue with watchdog protection");
-        config.recovery.recovery_attempts = 0; // Reset para próximo ciclo
-        return -EFAULT;
-    }
-    
-    // Secuencia de recovery escalonada
-    if (config.recovery.recovery_attempts == 1) {
-        // Intento 1: Soft reset del módem
-        LOG_INF("Recovery attempt 1: Soft modem reset");
-        lte_lc_offline();
-        k_sleep(K_SECONDS(5));
-        return 0;
-    } else if (config.recovery.recovery_attempts == 2) {
-        // Intento 2: Hard reset del módem
-        LOG_INF("Recovery attempt 2: Hard modem reset");
-        int err = nrf_modem_at_printf("AT+CFUN=15");
+    enum recovery_action action = recovery_next_action(&config.recovery, k_uptime_get());
+    int err;
+
+    LOG_WRN("Attempting automatic recovery #%d (fallo %s) from state: %d",
+            config.recovery.recovery_attempts,
+            recovery_fault_str(config.recovery.last_fault), error_state);
+
+    switch (action) {
+    case RECOVERY_RETRY_NEXT_PASS:
+        // Fallo transitorio (p. ej. socket): el módem está bien, se reintenta en el próximo pase
+        LOG_INF("Recovery: reintento en el próximo pase");
+        return -EAGAIN;
+
+    case RECOVERY_RECONFIGURE:
+        LOG_INF("Recovery: reconfiguración AT (%s)", net_path_str(active_path));
+        return configure_nordic_for_active_path();
+
+    case RECOVERY_GNSS_RESTART:
+        LOG_INF("Recovery: reinicio de GNSS");
+        gnss_stop();
+        return gnss_init_and_start();
+
+    case RECOVERY_SOFT_MODEM_RESET:
+        LOG_INF("Recovery: Soft modem reset");
+        return modem_soft_reset();
+
+    case RECOVERY_HARD_MODEM_RESET:
+        LOG_INF("Recovery: Hard modem reset");
+        err = modem_restart();
         if (err) {
-            LOG_ERR("Failed to execute hard reset: %d", err);
+            return err;
         }
-        k_sleep(K_SECONDS(10));
-        
+
         // Reconfiguración completa
-        return configure_nordic_for_sateliot();
-    } else {
-        // Intento 3: Reset completo de configuración
-        LOG_INF("Recovery attempt 3: Full configuration reset");
+        return configure_nordic_for_active_path();
+
+    case RECOVERY_FULL_RESET:
+        LOG_INF("Recovery: Full configuration reset");
         current_attachment_step = ATTACH_STEP_1;
-        
+
         // Reinicializar configuración
-        int err = initialize_sateliot_config();
+        err = initialize_sateliot_config();
         if (err == 0) {
-            err = configure_nordic_for_sateliot();
+            err = configure_nordic_for_active_path();
         }
         return err;
+
+    case RECOVERY_EXHAUSTED:
+    default:
+        return -EFAULT;
     }
 }
 
+// =================================================================
+//  DISPONIBILIDAD DEL MÓDEM
+// =================================================================
+
+// La librería del módem notifica cada (re)inicialización; el recovery espera este evento
+static void on_modem_init(int ret, void *ctx) {
+    modem_init_result = ret;
+    k_sem_give(&modem_init_sem);
+}
+
+NRF_MODEM_LIB_ON_INIT(ntn_modem_init_hook, on_modem_init, NULL);
+
+// Contexto ISR (CONFIG_NRF_MODEM_LIB_ON_FAULT_APPLICATION_SPECIFIC): solo se anota y
+// el bucle principal lo clasifica como RECOVERY_FAULT_MODEM
+void nrf_modem_fault_handler(struct nrf_modem_fault_info *fault_info) {
+    modem_fault_reason = fault_info->reason;
+    modem_faulted = true;
+    k_sem_give(&modem_init_sem);
+}
+
+// Sondea CFUN hasta que el módem responde en el modo esperado; devuelve los ms de espera
+static int modem_wait_func_mode(enum lte_lc_func_mode expected, int32_t timeout_ms) {
+    int64_t start = k_uptime_get();
+    enum lte_lc_func_mode mode;
+
+    do {
+        if (modem_faulted) {
+            return -EIO;
+        }
+        if (lte_lc_func_mode_get(&mode) == 0 && mode == expected) {
+            return (int)(k_uptime_get() - start);
+        }
+        k_sleep(K_MSEC(MODEM_READY_POLL_MS));
+    } while (k_uptime_get() - start < timeout_ms);
+
+    LOG_ERR("Módem no alcanzó CFUN=%d en %d ms", expected, timeout_ms);
+    return -ETIMEDOUT;
+}
+
+static void modem_ready_log(const char *what, struct modem_ready_histogram *hist, int64_t start) {
+    static char text[MODEM_HIST_TEXT_SIZE];
+    uint32_t elapsed_ms = (uint32_t)(k_uptime_get() - start);
+
+    modem_ready_hist_record(hist, elapsed_ms);
+    modem_ready_hist_format(hist, text, sizeof(text));
+    LOG_INF("Módem listo tras %s en %u ms (%s)", what, elapsed_ms, text);
+}
+
+static int modem_soft_reset(void) {
+    int64_t start = k_uptime_get();
+    int err = lte_lc_offline();
+
+    if (err) {
+        LOG_ERR("Fallo al pasar el módem a offline: %d", err);
+        return err;
+    }
+    err = modem_wait_func_mode(LTE_LC_FUNC_MODE_OFFLINE, MODEM_OFFLINE_TIMEOUT_MS);
+    if (err < 0) {
+        return err;
+    }
+    modem_ready_log("offline", &offline_ready_hist, start);
+    return 0;
+}
+
+// Reinicio real del módem: shutdown + init de la librería y espera al hook de init
+static int modem_restart(void) {
+    int64_t start = k_uptime_get();
+    int err;
+
+    k_sem_reset(&modem_init_sem);
+    modem_faulted = false;
+
+    err = nrf_modem_lib_shutdown();
+    if (err) {
+        LOG_WRN("Fallo en shutdown del módem: %d", err);
+    }
+    // GNSS se detiene con el módem; se rearranca en STATE_GETTING_GPS_FIX
+    gnss_running = false;
+
+    // Un valor positivo es el resultado de un DFU del módem, no un fallo (ver modem_dfu.h)
+    err = nrf_modem_lib_init();
+    if (err < 0) {
+        LOG_ERR("Fallo al reinicializar el módem: %d", err);
+        return err;
+    }
+    if (k_sem_take(&modem_init_sem, K_MSEC(MODEM_RESTART_TIMEOUT_MS)) != 0) {
+        LOG_ERR("Sin notificación de init del módem");
+        return -ETIMEDOUT;
+    }
+    if (modem_faulted || modem_init_result < 0) {
+        LOG_ERR("Init del módem fallido: %d", modem_init_result);
+        return -EIO;
+    }
+    err = modem_wait_func_mode(LTE_LC_FUNC_MODE_POWER_OFF, MODEM_RESTART_TIMEOUT_MS);
+    if (err < 0) {
+        return err;
+    }
+    modem_ready_log("reinicio", &restart_ready_hist, start);
+    return 0;
+}
+
+// Instala el delta del módem con el enlace cerrado. La instalación ocurre dentro de
+// nrf_modem_lib_init(); la configuración de red se reaplica en el siguiente intento.
+static int apply_modem_dfu(void) {
+    int err = modem_dfu_schedule();
+
+    if (err) {
+        return err;
+    }
+    wdt_feed(wdt_dev, wdt_channel_id);
+    err = modem_restart();
+    if (err) {
+        return err;
+    }
+    modem_dfu_result(modem_init_result);
+    return 0;
+}
+
 // MEJORA v3.2: Sistema de actualización automática de TLEs
 static int update_sateliot_tles(void) {
-    int64_t current_time = k_uptime_get();
-    int64_t hours_since_update = (current_time - config.tle_config.last_update_time) / (60 * 60 * 1000);
-    
-    if (hours_since_update < config.tle_config.update_interval_hours && !config.tle_config.update_needed) {
-        LOG_DBG("TLE update not needed yet. Hours since last: %lld", hours_since_update);
-        return 0;
+    return tle_update_evaluate(&config.tle_config, (uint16_t)rt_params.tle_update_interval_h,
+                               config.satellites, SATELIOT_CONSTELLATION_SIZE, k_uptime_get());
+}
+
+// Destino bulk de TLEs: registros [índice u8][longitud u8][texto TLE]. El conjunto se
+// aplica entero solo si todos los registros son válidos.
+static int bulk_tle_sink(uint32_t session, uint32_t offset, const uint8_t *data, size_t len, bool last) {
+    struct tle_elements satellites[SATELIOT_CONSTELLATION_SIZE];
+    size_t pos = 0;
+    int updated = 0;
+
+    if (offset != 0 || !last) {
+        return -EFBIG;      // El objeto TLE debe caber en un bloque
     }
-    
-    LOG_INF("Initiating TLE update process...");
-    
-    // En una implementación real, aquí se descargarían los TLEs desde una fuente autorizada
-    // Por ahora, simulamos validación y actualización de timestamp
-    
-    // Verificar validez de TLEs actuales
-    bool any_invalid = false;
-    for (int i = 0; i < 4; i++) {
-        if (!config.satellites[i].valid) {
-            any_invalid = true;
-            LOG_WRN("Satellite %d TLE is invalid", i);
+    memcpy(satellites, config.satellites, sizeof(satellites));
+
+    while (pos + 2 <= len) {
+        uint8_t index = data[pos];
+        uint8_t rec_len = data[pos + 1];
+
+        // Relleno del último símbolo
+        if (index == 0 && rec_len == 0) {
+            break;
         }
+        if (index >= SATELIOT_CONSTELLATION_SIZE || pos + 2 + rec_len > len) {
+            return -EINVAL;
+        }
+        int err = tle_ingest(&data[pos + 2], rec_len, &satellites[index]);
+        if (err) {
+            LOG_ERR("TLE %u de la sesión %08x inválido: %d", index, session, err);
+            return err;
+        }
+        pos += 2 + rec_len;
+        updated++;
     }
-    
-    if (any_invalid) {
-        LOG_WRN("Some TLEs are invalid - using backup prediction algorithm");
-        config.tle_config.consecutive_failures++;
-    } else {
-        config.tle_config.consecutive_failures = 0;
-        LOG_INF("All TLEs validated successfully");
+    if (updated == 0) {
+        return -ENODATA;
     }
-    
-    // Actualizar timestamp de última actualización
-    config.tle_config.last_update_time = current_time;
+
+    memcpy(config.satellites, satellites, sizeof(satellites));
+    config.tle_config.last_update_time = k_uptime_get();
+    config.tle_config.consecutive_failures = 0;
     config.tle_config.update_needed = false;
-    
-    // Si hay muchos fallos consecutivos, extender el intervalo
-    if (config.tle_config.consecutive_failures > 3) {
-        config.tle_config.update_interval_hours = TLE_UPDATE_INTERVAL_HOURS * 2;
-        LOG_WRN("Extending TLE update interval due to consecutive failures");
-    } else {
-        config.tle_config.update_interval_hours = TLE_UPDATE_INTERVAL_HOURS;
-    }
-    
+    LOG_INF("%d TLEs actualizados por downlink", updated);
     return 0;
 }
 
+static int bulk_fota_sink(uint32_t session, uint32_t offset, const uint8_t *data, size_t len, bool last) {
+    return fota_write_patch(session, offset, data, len);
+}
+
+static int bulk_modem_dfu_sink(uint32_t session, uint32_t offset, const uint8_t *data, size_t len, bool last) {
+    return modem_dfu_write(session, offset, data, len);
+}
+
+static const bulk_sink_t bulk_sinks[BULK_TYPE_COUNT] = {
+    [BULK_TYPE_TLE] = bulk_tle_sink,
+    [BULK_TYPE_FOTA] = bulk_fota_sink,
+    [BULK_TYPE_MODEM_DFU] = bulk_modem_dfu_sink,
+    [BULK_TYPE_GEOFENCE] = geofence_bulk_sink,
+};
+
 // =================================================================
 //  INICIALIZACIÓN Y SISTEMA
 // =================================================================
@@ -296,7 +504,7 @@ static int setup_watchdog(void) {
     struct wdt_timeout_cfg wdt_config = {
         .flags = WDT_FLAG_RESET_SOC,
         .window.min = 0,
-        .window.max = 60000, // 60 segundos
+        .window.max = WDT_TIMEOUT_MS,
         .callback = NULL,
     };
     wdt_channel_id = wdt_install_timeout(wdt_dev, &wdt_config);
@@ -304,9 +512,176 @@ static int setup_watchdog(void) {
         LOG_ERR("Fallo al instalar el timeout del watchdog: %d", wdt_channel_id);
         return wdt_channel_id;
     }
+    // Sin pausa en sleep: un hilo bloqueado con la CPU dormida también resetea. Toda
+    // espera larga se trocea y alimenta el watchdog (wdt_sleep_ms, wdt_sem_take, wdt_poll).
     return wdt_setup(wdt_dev, WDT_OPT_PAUSE_HALTED_BY_DBG);
 }
 
+// Sleep troceado en periodos de alimentación del watchdog
+static void wdt_sleep_ms(int64_t duration_ms) {
+    int64_t wake = k_uptime_get() + duration_ms;
+
+    for (int64_t now = k_uptime_get(); now < wake; now = k_uptime_get()) {
+        k_sleep(K_MSEC(MIN(wake - now, WDT_FEED_PERIOD_MS)));
+        wdt_feed(wdt_dev, wdt_channel_id);
+    }
+}
+
+// k_sem_take troceado igual: 0 si llega el semáforo, -EAGAIN al vencer el timeout
+static int wdt_sem_take(struct k_sem *sem, int64_t timeout_ms) {
+    int64_t deadline = k_uptime_get() + timeout_ms;
+
+    for (int64_t now = k_uptime_get(); now < deadline; now = k_uptime_get()) {
+        if (k_sem_take(sem, K_MSEC(MIN(deadline - now, WDT_FEED_PERIOD_MS))) == 0) {
+            return 0;
+        }
+        wdt_feed(wdt_dev, wdt_channel_id);
+    }
+    return -EAGAIN;
+}
+
+// poll() troceado igual sobre un socket: >0 con datos, 0 al vencer el timeout, <0 en error
+static int wdt_poll(struct pollfd *fds, int64_t timeout_ms) {
+    int64_t deadline = k_uptime_get() + timeout_ms;
+
+    for (int64_t now = k_uptime_get(); now < deadline; now = k_uptime_get()) {
+        int ret = poll(fds, 1, (int)MIN(deadline - now, WDT_FEED_PERIOD_MS));
+
+        wdt_feed(wdt_dev, wdt_channel_id);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+static uint32_t retained_state_crc(void) {
+    const uint8_t *start = (const uint8_t *)&retained.saved_uptime;
+    const uint8_t *end = (const uint8_t *)&retained + sizeof(retained);
+
+    return crc32_ieee(start, end - start);
+}
+
+// Reajuste a la hora real tras un arranque en caliente. El uptime no ve el tiempo entre el
+// último guardado y el reset (un sueño entero si el watchdog salta en el ciclo siguiente):
+// retained_state_restore() lo toma como cero y, cuando date_time tiene hora (red o GNSS),
+// retained_state_rebase() descuenta el hueco real de los tiempos que siguen siendo los
+// restaurados.
+static struct {
+    bool pending;
+    int64_t saved_wall_ms;      // Hora real del guardado restaurado
+    int64_t restore_uptime;     // Uptime en retained_state_restore()
+    int64_t pass_start;         // Pase restaurado: uno recalculado después no se toca
+} wall_rebase;
+
+// Tiempo pasado en el reloj de uptime: 0 es "nunca" y se conserva, y con limit solo se
+// mueven los anteriores a la restauración (los posteriores ya son del arranque nuevo)
+static int64_t uptime_shift(int64_t t, int64_t shift, int64_t limit) {
+    return t != 0 && t <= limit ? t - shift : t;
+}
+
+static void config_times_shift(int64_t shift, int64_t limit) {
+    config.tle_config.last_update_time = uptime_shift(config.tle_config.last_update_time, shift, limit);
+    config.recovery.last_recovery_time = uptime_shift(config.recovery.last_recovery_time, shift, limit);
+    config.recovery.incident_start_time = uptime_shift(config.recovery.incident_start_time, shift, limit);
+    config.net_path.tn_last_seen = uptime_shift(config.net_path.tn_last_seen, shift, limit);
+    config.net_path.tn_last_probe = uptime_shift(config.net_path.tn_last_probe, shift, limit);
+}
+
+// Guarda el estado validado; se llama antes de dormir, cuando la planificación es consistente
+static void retained_state_save(void) {
+    int64_t wall_ms;
+
+    retained_state_rebase();
+    retained.saved_uptime = k_uptime_get();
+    retained.saved_wall_ms = date_time_now(&wall_ms) == 0 ? wall_ms : 0;
+    retained.config = config;
+    retained.attachment_step = current_attachment_step;
+    retained.crc = retained_state_crc();
+    retained.magic = RETAINED_STATE_MAGIC;
+}
+
+// Restaura el estado solo tras un reset en caliente (watchdog, software, lockup) con CRC válido
+static bool retained_state_restore(void) {
+    uint32_t reset_cause = 0;
+
+    hwinfo_get_reset_cause(&reset_cause);
+    hwinfo_clear_reset_cause();
+
+    if (!(reset_cause & (RESET_WATCHDOG | RESET_SOFTWARE | RESET_CPU_LOCKUP))) {
+        LOG_INF("Arranque en frío (causa de reset 0x%08x)", reset_cause);
+        retained.magic = 0;
+        return false;
+    }
+    if (retained.magic != RETAINED_STATE_MAGIC || retained.crc != retained_state_crc() ||
+        fota_running_test_image()) {
+        LOG_WRN("RAM retenida no válida - arranque en frío");
+        retained.magic = 0;
+        return false;
+    }
+
+    // El uptime vuelve a 0 tras el reset: los tiempos guardados pasan a ser relativos
+    int64_t now = k_uptime_get();
+    int64_t shift = retained.saved_uptime - now;
+
+    config = retained.config;
+    config_times_shift(shift, INT64_MAX);
+    config.next_pass.start_time -= shift;
+    config.next_pass.end_time -= shift;
+
+    wall_rebase.pending = retained.saved_wall_ms != 0;
+    wall_rebase.saved_wall_ms = retained.saved_wall_ms;
+    wall_rebase.restore_uptime = now;
+    wall_rebase.pass_start = config.next_pass.start_time;
+
+    // El módem pierde su contexto con el reset: solo el Step 2 en curso se reanuda
+    current_attachment_step = retained.attachment_step == ATTACH_STEP_2 ? ATTACH_STEP_2 : ATTACH_STEP_1;
+
+    LOG_INF("Arranque en caliente (causa 0x%08x): estado restaurado, próximo pase en %llds",
+            reset_cause, (config.next_pass.start_time - k_uptime_get()) / 1000);
+    return true;
+}
+
+// Descuenta de los tiempos restaurados el hueco real entre el guardado y el reset, en cuanto
+// date_time tiene hora. Sin hora al guardar (o sin hora todavía) se queda el reajuste por uptime.
+static void retained_state_rebase(void) {
+    int64_t wall_ms;
+
+    if (!wall_rebase.pending || date_time_now(&wall_ms) != 0) {
+        return;
+    }
+    wall_rebase.pending = false;
+
+    int64_t gap = wall_ms - (k_uptime_get() - wall_rebase.restore_uptime) - wall_rebase.saved_wall_ms;
+
+    if (gap <= 0) {
+        return;
+    }
+    config_times_shift(gap, wall_rebase.restore_uptime);
+    if (config.next_pass.start_time == wall_rebase.pass_start) {
+        config.next_pass.start_time -= gap;
+        config.next_pass.end_time -= gap;
+    }
+    LOG_INF("Hora real disponible: %llds entre el último guardado y el reset descontados", gap / 1000);
+}
+
+// La hora UTC del fix alimenta date_time cuando aún no hay hora de red
+static void wall_clock_from_gnss(void) {
+    const struct nrf_modem_gnss_datetime *dt = &last_gps_data.datetime;
+    struct tm utc = {
+        .tm_year = dt->year - 1900,
+        .tm_mon = dt->month - 1,
+        .tm_mday = dt->day,
+        .tm_hour = dt->hour,
+        .tm_min = dt->minute,
+        .tm_sec = dt->seconds,
+    };
+
+    if (!date_time_is_valid()) {
+        date_time_set(&utc);
+    }
+}
+
 static int configure_power_management(void) {
     int err;
     // T3324 (PSM Active Timer) = 1 minuto, T3412 (Periodic TAU Timer) = 4 horas
@@ -336,46 +711,48 @@ static int configure_power_management(void) {
 // =================================================================
 
 static int initialize_sateliot_config(void) {
-    // Configuración inicial por defecto
-    strncpy(config.server_ip, "your.vas.server.ip", sizeof(config.server_ip) - 1);
-    config.server_port = 17777;
-    
     // Coordenadas iniciales inválidas - se actualizarán con GPS
-    config.device_lat = 0.0;
-    config.device_lon = 0.0;
-    config.device_alt = 0.0;
+    memset(&config.position, 0, sizeof(config.position));
+    memset(&config.modem_position, 0, sizeof(config.modem_position));
     config.gps_coordinates_valid = false;
     
-    // MEJORA v3.2: Inicializar configuración de TLE y recovery
-    config.tle_config.last_update_time = 0;
-    config.tle_config.update_interval_hours = TLE_UPDATE_INTERVAL_HOURS;
-    config.tle_config.update_needed = true;
-    config.tle_config.consecutive_failures = 0;
-    
-    config.recovery.recovery_attempts = 0;
-    config.recovery.last_recovery_time = 0;
-    config.recovery.last_good_state = STATE_IDLE;
-    config.recovery.modem_reset_needed = false;
+    // MEJORA v3.2: Inicializar configuración de TLE. El historial de recovery no se toca:
+    // persiste entre resets completos de configuración y arranques (ver recovery_persist_load)
+    tle_update_init(&config.tle_config);
+    config.tle_config.update_interval_hours = rt_params.tle_update_interval_h;
+    net_path_init(&config.net_path);
     
-    // TLEs de ejemplo para SIC-4 (deben actualizarse con datos reales)
-    // SATELIOT_1 TLE de ejemplo del documento
-    strncpy(config.satellites[0].satellite_name, "SATELIOT_1", 15);
-    strncpy(config.satellites[0].line1, 
-            "1 60550U 24149CL 25071.82076637 .00007488 00000+0 68187-3 0 9999", 69);
-    strncpy(config.satellites[0].line2, 
-            "2 60550 97.7148 150.0635 0007556 170.3117 189.8251 14.95428546 31058", 69);
-    config.satellites[0].valid = true;
-    
-    // Los otros satélites se configurarían con sus TLEs específicos
-    for (int i = 1; i < 4; i++) {
-        snprintf(config.satellites[i].satellite_name, 15, "SATELIOT_%d", i + 1);
-        config.satellites[i].valid = false; // Se actualizarían con datos reales
+    // Elementos binarios a partir de los TLEs en flash (SATELIOT_1..4 por índice)
+    for (int i = 0; i < SATELIOT_CONSTELLATION_SIZE; i++) {
+        memset(&config.satellites[i], 0, sizeof(config.satellites[i]));
+        if (default_tles[i].line1 && parse_tle(&default_tles[i], &config.satellites[i]) != 0) {
+            LOG_WRN("TLE de SATELIOT_%d no válido", i + 1);
+        }
     }
     
     LOG_INF("Configuración Sateliot inicializada");
     return 0;
 }
 
+// XSETGPSPOS usa milésimas de grado desplazadas (lat + 90°, lon + 180°) y mm
+static int set_modem_gps_position(const struct geo_modem_position *pos) {
+    static char at_cmd[AT_CMD_BUFFER_SIZE];
+    struct text_writer w;
+
+    tw_init(&w, at_cmd, sizeof(at_cmd));
+    tw_str(&w, "AT%XSETGPSPOS=");
+    tw_int(&w, pos->lon_param);
+    tw_putc(&w, ',');
+    tw_int(&w, pos->lat_param);
+    tw_putc(&w, ',');
+    tw_int(&w, pos->alt_mm);
+    if (w.len >= sizeof(at_cmd)) {
+        return -ENOMEM;
+    }
+
+    return nrf_modem_at_printf("%s", at_cmd);
+}
+
 static int configure_nordic_for_sateliot(void) {
     int err;
     
@@ -395,8 +772,13 @@ static int configure_nordic_for_sateliot(void) {
         return err;
     }
     
-    // Configurar canales específicos (1996MHz UL, 2186MHz DL)
-    err = nrf_modem_at_printf("AT%%CHSELECT=2,9,66296");
+    // Canal del último registro Sateliot; por defecto 1996MHz UL, 2186MHz DL
+    const struct cell_context *ntn = &cell_ctx[NET_PATH_NTN];
+
+    connect_seeded = ntn->valid;
+    err = nrf_modem_at_printf("AT%%CHSELECT=2,%u,%u",
+                              ntn->valid ? ntn->act : NTN_DEFAULT_ACT,
+                              ntn->valid ? ntn->earfcn : NTN_DEFAULT_EARFCN);
     if (err) {
         LOG_ERR("Fallo al configurar canales: %d", err);
         return err;
@@ -411,17 +793,14 @@ static int configure_nordic_for_sateliot(void) {
     
     // Configurar coordenadas GPS si están disponibles
     if (config.gps_coordinates_valid) {
-        int lat_param = 90000 + (int)(config.device_lat * 1000);
-        int lon_param = 180000 + (int)(config.device_lon * 1000);
-        int alt_param = (int)(config.device_alt * 1000);
-        
-        err = nrf_modem_at_printf("AT%%XSETGPSPOS=%d,%d,%d", lon_param, lat_param, alt_param);
+        err = set_modem_gps_position(&config.modem_position);
         if (err) {
             LOG_ERR("Fallo al configurar coordenadas GPS: %d", err);
             return err;
         }
-        LOG_INF("Coordenadas GPS configuradas: lat=%.6f, lon=%.6f, alt=%.1f", 
-                config.device_lat, config.device_lon, config.device_alt);
+        LOG_INF("Coordenadas GPS configuradas: lat=" UDEG_FMT ", lon=" UDEG_FMT ", alt=" DM_FMT,
+                UDEG_ARGS(config.position.lat_udeg), UDEG_ARGS(config.position.lon_udeg),
+                DM_ARGS(config.position.alt_dm));
     }
     
     // Configurar PLMN Sateliot
@@ -435,84 +814,110 @@ static int configure_nordic_for_sateliot(void) {
     return 0;
 }
 
-// =================================================================
-//  ALGORITMO DE PREDICCIÓN SATELITAL MEJORADO PARA SATELIOT
-// =================================================================
+// Recovery: el módem vuelve a la configuración de la ruta en la que falló el ciclo
+static int configure_nordic_for_active_path(void) {
+    return active_path == NET_PATH_TN ? configure_nordic_for_terrestrial() : configure_nordic_for_sateliot();
+}
 
-static int calculate_sateliot_satellite_pass(struct satellite_pass *pass, double ground_lat, double ground_lon) {
-    if (!pass) {
-        LOG_ERR("Invalid satellite pass pointer");
-        return -EINVAL;
+// Red terrestre: sin bloqueo de banda ni PLMN fijo, selección automática del operador
+static int configure_nordic_for_terrestrial(void) {
+    int err;
+
+    LOG_INF("Configurando Nordic nRF9151 para red terrestre...");
+
+    err = nrf_modem_at_printf("AT%%XBANDLOCK=0");
+    if (err) {
+        LOG_ERR("Fallo al liberar bloqueo de banda: %d", err);
+        return err;
     }
-    
-    if (!config.gps_coordinates_valid) {
-        LOG_ERR("GPS coordinates not valid for satellite prediction");
-        return -ENODATA;
+
+    err = nrf_modem_at_printf("AT+COPS=0");
+    if (err) {
+        LOG_ERR("Fallo al activar selección automática de PLMN: %d", err);
+        return err;
     }
-    
-    LOG_DBG("Calculating Sateliot satellite pass for location: lat=%.6f, lon=%.6f", 
-            ground_lat, ground_lon);
-    
-    // Algoritmo mejorado basado en especificaciones Sateliot SIC-4
-    int64_t current_time = k_uptime_get();
-    
-    // Parámetros orbitales de SIC-4: SSO a 590 km
-    const double orbital_period_minutes = 96.0; // Período orbital típico para 590 km
-    const int64_t orbital_period_ms = (int64_t)(orbital_period_minutes * 60 * 1000);
-    
-    // Factor de latitud: más pases en latitudes altas
-    double lat_factor = 1.0 + (fabs(ground_lat) / 90.0) * 0.5; // Factor 1.0-1.5
-    
-    // Predicción basada en ubicación geográfica específica
-    // Barcelona (ejemplo del documento): 2 pases por día (10:00-12:00, 21:00-23:00)
-    int64_t time_since_midnight = current_time % (24 * 60 * 60 * 1000);
-    
-    // Determinar próximo pase basado en patrones típicos de SIC-4
-    int64_t morning_pass_start = 10 * 60 * 60 * 1000; // 10:00
-    int64_t evening_pass_start = 21 * 60 * 60 * 1000; // 21:00
-    
-    int64_t next_pass_start;
-    if (time_since_midnight < morning_pass_start) {
-        // Antes del pase matutino
-        next_pass_start = current_time + (morning_pass_start - time_since_midnight);
-    } else if (time_since_midnight < evening_pass_start) {
-        // Entre pases - próximo es el vespertino
-        next_pass_start = current_time + (evening_pass_start - time_since_midnight);
+
+    // Canal de la última celda terrestre, sin fijar el PCI: cualquier celda de ese EARFCN
+    // vale. Sin contexto se libera el canal fijado por NTN
+    const struct cell_context *tn = &cell_ctx[NET_PATH_TN];
+
+    connect_seeded = tn->valid;
+    if (tn->valid) {
+        err = nrf_modem_at_printf("AT%%CHSELECT=2,%u,%u", tn->act, tn->earfcn);
     } else {
-        // Después del pase vespertino - próximo es mañana por la mañana
-        next_pass_start = current_time + ((24 * 60 * 60 * 1000) - time_since_midnight) + morning_pass_start;
+        err = nrf_modem_at_printf("AT%%CHSELECT=0");
+    }
+    if (err) {
+        LOG_ERR("Fallo al configurar canal terrestre: %d", err);
+        return err;
     }
-    
-    // Duración del pase: 30 segundos a 8 minutos según especificación
-    int64_t pass_duration = MIN_SATELLITE_PASS_DURATION_MS + 
-                           (rand() % (MAX_SATELLITE_PASS_DURATION_MS - MIN_SATELLITE_PASS_DURATION_MS));
-    
-    // Aplicar variación por latitud
-    pass_duration = (int64_t)(pass_duration * lat_factor);
-    
-    pass->start_time = next_pass_start;
-    pass->end_time = next_pass_start + pass_duration;
-    pass->max_elevation = 30 + (rand() % 56); // 30-85 grados (rango típico)
-    pass->satellite_id = rand() % 4; // Cualquiera de los 4 satélites SIC-4
-    pass->is_predicted = true;
-    
-    LOG_INF("Próximo pase Sateliot: en %llds, duración %llds, elevación máx %d°", 
-            (next_pass_start - current_time) / 1000,
-            pass_duration / 1000, 
-            pass->max_elevation);
-    
+    return 0;
+}
+
+// Marca el inicio de la búsqueda para medir el tiempo hasta registro
+static void start_network_search(void) {
+    connect_start_time = k_uptime_get();
+    lte_lc_connect_async(lte_handler);
+}
+
+// Tras el registro: %XMONITOR da banda, celda y canal servidores para el próximo ciclo
+static void capture_cell_context(void) {
+    static char resp[XMONITOR_RESPONSE_SIZE];
+    struct cell_context ctx;
+    int err = nrf_modem_at_cmd(resp, sizeof(resp), "AT%%XMONITOR");
+
+    if (err == 0) {
+        err = cell_context_parse_xmonitor(resp, &ctx);
+    }
+    if (err) {
+        LOG_WRN("Sin contexto de celda (%d)", err);
+        return;
+    }
+    cell_ctx[active_path] = ctx;
+    cell_context_save(active_path, &ctx);
+    LOG_INF("Celda %s: id %x, EARFCN %u, PCI %u, banda %u", net_path_str(active_path),
+            ctx.cell_id, ctx.earfcn, ctx.phys_cell_id, ctx.band);
+}
+
+// Semilla única por dispositivo (ID de hardware) para el predictor
+static uint32_t device_seed(void) {
+    uint8_t device_id[16];
+    ssize_t len = hwinfo_get_device_id(device_id, sizeof(device_id));
+
+    return len > 0 ? crc32_ieee(device_id, len) : (uint32_t)k_cycle_get_32();
+}
+
+static int predict_next_pass(void) {
+    int64_t current_time = k_uptime_get();
+    int err = calculate_sateliot_satellite_pass(&config.next_pass,
+                                                config.gps_coordinates_valid ? &config.position : NULL,
+                                                current_time, &pass_rng);
+    if (err) {
+        LOG_ERR("Predicción de pase fallida: %d", err);
+        return err;
+    }
+    pass_assign_tx_slot(&config.next_pass, device_id_seed);
+    rach_attempts = 0;
+
+    LOG_DBG("Calculating Sateliot satellite pass for location: lat=" UDEG_FMT ", lon=" UDEG_FMT,
+            UDEG_ARGS(config.position.lat_udeg), UDEG_ARGS(config.position.lon_udeg));
+    LOG_INF("Próximo pase Sateliot: en %llds, duración %llds, elevación máx %d°, slot +%us", 
+            (config.next_pass.start_time - current_time) / 1000,
+            (config.next_pass.end_time - config.next_pass.start_time) / 1000, 
+            config.next_pass.max_elevation, config.next_pass.tx_offset_ms / 1000);
     return 0;
 }
 
 static int update_device_coordinates(void) {
     if (last_gps_data.flags & NRF_MODEM_GNSS_PVT_FLAG_FIX_VALID) {
-        config.device_lat = last_gps_data.latitude;
-        config.device_lon = last_gps_data.longitude;
-        config.device_alt = last_gps_data.altitude;
+        // Única conversión a enteros: el frame PVT del módem entrega double/float
+        geo_position_from_fix(last_gps_data.latitude, last_gps_data.longitude, last_gps_data.altitude,
+                              &config.position, &config.modem_position);
         config.gps_coordinates_valid = true;
         
-        LOG_INF("Coordenadas GPS actualizadas: lat=%.6f, lon=%.6f, alt=%.1f", 
-                config.device_lat, config.device_lon, config.device_alt);
+        LOG_INF("Coordenadas GPS actualizadas: lat=" UDEG_FMT ", lon=" UDEG_FMT ", alt=" DM_FMT,
+                UDEG_ARGS(config.position.lat_udeg), UDEG_ARGS(config.position.lon_udeg),
+                DM_ARGS(config.position.alt_dm));
         return 0;
     }
     
@@ -530,12 +935,22 @@ static void gnss_event_handler(int event) {
         if (err == 0 && (last_gps_data.flags & NRF_MODEM_GNSS_PVT_FLAG_FIX_VALID)) {
             LOG_INF("GNSS: Fix válido obtenido!");
             update_device_coordinates(); // Actualizar coordenadas inmediatamente
+            geofence_submit_fix(&config.position);
+            atomic_set_bit(recovery_success_events, RECOVERY_SUCCESS_GNSS_FIX);
             k_sem_give(&gps_fix_sem);
         }
     }
 }
 
 static int gnss_init_and_start(void) {
+    // En caliente lte_lc_init() deja el módem en CFUN=0 y tras un pase queda en CFUN=4:
+    // sin CFUN=31 nrf_modem_gnss_start() falla. No toca el estado de la parte LTE.
+    int err = lte_lc_func_mode_set(LTE_LC_FUNC_MODE_ACTIVATE_GNSS);
+
+    if (err) {
+        LOG_ERR("Fallo al activar GNSS en el módem: %d", err);
+        return err;
+    }
     if (nrf_modem_gnss_event_handler_set(gnss_event_handler) != 0) {
         LOG_ERR("Fallo al establecer el manejador de eventos GNSS.");
         return -EFAULT;
@@ -544,11 +959,17 @@ static int gnss_init_and_start(void) {
         LOG_ERR("Fallo al iniciar el GNSS.");
         return -EFAULT;
     }
+    gnss_running = true;
     return 0;
 }
 
 static int gnss_stop(void) {
-    return nrf_modem_gnss_stop();
+    int err = nrf_modem_gnss_stop();
+
+    if (err == 0) {
+        gnss_running = false;
+    }
+    return err;
 }
 
 // =================================================================
@@ -562,14 +983,25 @@ static void lte_handler(const struct lte_lc_evt *const evt) {
                 evt->nw_reg_status == LTE_LC_NW_REG_REGISTERED_ROAMING) {
                 LOG_INF("Red registrada exitosamente!");
                 current_attachment_step = ATTACH_COMPLETE;
-                // MEJORA v3.2: Reset recovery attempts on success
-                config.recovery.recovery_attempts = 0;
+                if (connect_start_time) {
+                    struct acquisition_stats *stats = &acquisition[active_path][connect_seeded];
+                    uint32_t elapsed_ms = (uint32_t)(k_uptime_get() - connect_start_time);
+
+                    acquisition_stats_record(stats, elapsed_ms);
+                    connect_start_time = 0;
+                    LOG_INF("Registro %s en %u ms (%s, media %u ms en %u)", net_path_str(active_path),
+                            elapsed_ms, connect_seeded ? "sembrada" : "en frío",
+                            (uint32_t)(stats->total_ms / stats->samples), stats->samples);
+                }
+                // MEJORA v3.2: Reset recovery attempts on success (desde el bucle principal)
+                atomic_set_bit(recovery_success_events, RECOVERY_SUCCESS_REGISTERED);
                 k_sem_give(&lte_connected_sem);
             }
             break;
             
         case LTE_LC_EVT_CELL_UPDATE:
-            LOG_INF("Actualización de celda recibida");
+            // El detalle de canal se lee con %XMONITOR fuera del handler (sin AT aquí)
+            LOG_INF("Actualización de celda recibida: id %x, TAC %x", evt->cell.id, evt->cell.tac);
             break;
             
         default:
@@ -585,11 +1017,7 @@ static int modem_configure_for_sateliot_attachment(void) {
     
     // Actualizar coordenadas GPS en el módem si están disponibles
     if (config.gps_coordinates_valid) {
-        int lat_param = 90000 + (int)(config.device_lat * 1000);
-        int lon_param = 180000 + (int)(config.device_lon * 1000);
-        int alt_param = (int)(config.device_alt * 1000);
-        
-        err = nrf_modem_at_printf("AT%%XSETGPSPOS=%d,%d,%d", lon_param, lat_param, alt_param);
+        err = set_modem_gps_position(&config.modem_position);
         if (err) {
             LOG_ERR("Fallo al actualizar coordenadas GPS: %d", err);
         }
@@ -598,90 +1026,405 @@ static int modem_configure_for_sateliot_attachment(void) {
     return 0;
 }
 
-// MEJORA v3.2: Validación robusta en format_telemetry_data
-static int format_telemetry_data(char *buffer, size_t buffer_size) {
-    if (!buffer || buffer_size == 0) {
-        LOG_ERR("Invalid parameters: buffer=%p, size=%zu", buffer, buffer_size);
-        return -EINVAL;
+static struct report_thresholds rbe_thresholds(void) {
+    return (struct report_thresholds) {
+        .heartbeat_s = rt_params.rbe_heartbeat_s,
+        .beacon_s = rt_params.rbe_beacon_s,
+        .position_m = rt_params.rbe_position_m,
+        .vbat_mv = rt_params.rbe_vbat_mv,
+        .temp_c = rt_params.rbe_temp_c,
+        .adc_mv = rt_params.rbe_adc_mv,
+        .vbat_low_mv = rt_params.rbe_vbat_low_mv,
+    };
+}
+
+// Añade un registro al pool; si está lleno se descarta el más antiguo
+static void uplink_queue_put(const struct uplink_record *record) {
+    while (k_msgq_put(&uplink_msgq, record, K_NO_WAIT) != 0) {
+        struct uplink_record dropped;
+
+        LOG_WRN("Cola de uplink llena - descartando registro más antiguo");
+        k_msgq_get(&uplink_msgq, &dropped, K_NO_WAIT);
     }
+}
 
-    // MEJORA v3.2: Validación robusta del tamaño del buffer
-    if (!validate_buffer_safety(buffer_size, MIN_BUFFER_SIZE_TELEMETRY)) {
-        LOG_ERR("Buffer size validation failed for telemetry data");
-        return -ENOMEM;
+static void uplink_agg_queue_put(const struct uplink_aggregate *aggregate) {
+    while (k_msgq_put(&uplink_agg_msgq, aggregate, K_NO_WAIT) != 0) {
+        struct uplink_aggregate dropped;
+
+        LOG_WRN("Cola de agregados llena - descartando el intervalo más antiguo");
+        k_msgq_get(&uplink_agg_msgq, &dropped, K_NO_WAIT);
+    }
+}
+
+static uint32_t uplink_pending_count(void) {
+    return k_msgq_num_used_get(&uplink_msgq) + k_msgq_num_used_get(&uplink_agg_msgq);
+}
+
+// Cierra el intervalo de agregación abierto y lo encola como un único registro
+static void flush_aggregate(void) {
+    struct uplink_aggregate aggregate = {
+        .timestamp = k_uptime_get(),
+        .position = aggregator.position,
+        .sats = aggregator.sats,
+        .position_valid = aggregator.position_valid,
+    };
+
+    if (aggregator_close(&aggregator, aggregate.timestamp, &aggregate.summary) == 0) {
+        uplink_agg_queue_put(&aggregate);
+    }
+}
+
+// Las transiciones de geocerca salen siempre, sin agregación ni reporte por excepción.
+// Se encolan desde aquí para que la cola de uplink tenga un único productor.
+static void queue_geofence_events(void) {
+    struct geofence_event evt;
+
+    while (geofence_next_event(&evt)) {
+        struct uplink_record record = {
+            .timestamp = evt.timestamp,
+            .position = evt.position,
+            .position_valid = true,
+            .kind = UPLINK_RECORD_GEOFENCE,
+            .fence = {.fence_id = evt.fence_id, .transition = evt.transition},
+        };
+
+        uplink_queue_put(&record);
+    }
+}
+
+// Tamaño en crudo de un registro para medir la reducción; payload_buffer solo se usa al enviar
+static size_t raw_record_len(const struct uplink_record *record) {
+    return telemetry_raw_len(payload_buffer, rt_params.max_payload_bytes, record);
+}
+
+// Registro en crudo: a la cola directamente o tras el filtro del reporte por excepción
+static void report_raw_record(const struct uplink_record *record) {
+    if (rt_params.rbe_heartbeat_s == 0) {
+        uplink_queue_put(record);
+        return;
+    }
+
+    struct report_thresholds thresholds = rbe_thresholds();
+    uint32_t reasons = report_filter_evaluate(&report_filter, &thresholds, record, record->timestamp);
+
+    if (reasons) {
+        LOG_DBG("Registro reportado (motivos 0x%02x)", reasons);
+        uplink_queue_put(record);
+    } else {
+        report_filter_count_saved(&report_filter, raw_record_len(record));
+        LOG_DBG("Registro sin cambios suprimido (%u)", report_filter.suppressed);
+    }
+}
+
+// Cierra el tramo de trayectoria abierto para que el extremo actual salga en este pase
+static void flush_trajectory(void) {
+    struct uplink_record key;
+
+    if (!trajectory_flush(&trajectory, &key)) {
+        return;
+    }
+    report_raw_record(&key);
+    if (trajectory.points_in > 0) {
+        LOG_INF("Trayectoria: %u puntos -> %u clave (%u%%), %u us/punto", trajectory.points_in,
+                trajectory.points_out, trajectory.points_out * 100 / trajectory.points_in,
+                k_cyc_to_us_floor32(trajectory.cycles) / trajectory.points_in);
+        trajectory_stats_reset(&trajectory);
+    }
+}
+
+// Una muestra (posición actual + sensores): en crudo a la cola o al agregador
+static void sample_telemetry(void) {
+    struct uplink_record record = {
+        .timestamp = k_uptime_get(),
+        .position = config.position,
+        .sats = (last_gps_data.flags & NRF_MODEM_GNSS_PVT_FLAG_FIX_VALID) ? last_gps_data.sv_count : 0,
+        .position_valid = config.gps_coordinates_valid,
+        .kind = UPLINK_RECORD_RAW,
+    };
+
+    sensors_sample(&record.sensors);
+    last_sample_time = record.timestamp;
+    last_sensors = record.sensors;
+
+    if (rt_params.agg_interval_s == 0) {
+        struct uplink_record key;
+
+        if (rt_params.track_tolerance_m == 0 || !record.position_valid) {
+            // Sin posición no hay trayectoria: el tramo abierto se cierra antes para no
+            // desordenar la cola
+            flush_trajectory();
+            report_raw_record(&record);
+        } else if (trajectory_add(&trajectory, &record, rt_params.track_tolerance_m, &key)) {
+            report_raw_record(&key);
+        }
+        return;
+    }
+    flush_trajectory();
+    aggregator_add(&aggregator, &record.sensors, record.sats, &record.position,
+                   record.position_valid, raw_record_len(&record));
+    if (aggregator_due(&aggregator, record.timestamp, rt_params.agg_interval_s)) {
+        flush_aggregate();
+    }
+}
+
+// Muestra del pase, en el mismo despertar que el fix GNSS. El intervalo de agregación
+// abierto se cierra para que salga en este pase y no espere al siguiente.
+static void enqueue_uplink_record(void) {
+    queue_geofence_events();
+    sample_telemetry();
+    flush_trajectory();
+    flush_aggregate();
+}
+
+// Registro del pase y siguiente estado. Con reporte por excepción y la cola vacía el pase
+// solo se conecta si toca la baliza de vida; si no, se omite sin encender la radio.
+static enum app_state pass_uplink_state(void) {
+    enum app_state connect = active_path == NET_PATH_TN ? STATE_ATTEMPTING_CONNECTION_TN
+                                                        : STATE_ATTEMPTING_CONNECTION_STEP1;
+
+    enqueue_uplink_record();
+    radio_on_start = k_uptime_get();
+    if (rt_params.rbe_heartbeat_s == 0 || uplink_pending_count() > 0) {
+        return connect;
+    }
+
+    struct report_thresholds thresholds = rbe_thresholds();
+
+    if (report_filter_beacon_due(&report_filter, &thresholds, radio_on_start)) {
+        struct uplink_record beacon;
+
+        report_filter_beacon(&report_filter, &last_sensors, radio_on_start, &beacon);
+        uplink_queue_put(&beacon);
+        LOG_INF("Sin cambios: baliza de vida (%u registros suprimidos)", report_filter.suppressed);
+        return connect;
+    }
+    LOG_INF("Sin cambios: pase omitido. Ahorro acumulado %u pases, %u s de radio, %u bytes",
+            report_filter.passes_skipped, report_filter.radio_ms_saved / 1000, report_filter.bytes_saved);
+    return STATE_IDLE;
+}
+
+// Intervalo de muestreo hasta el próximo pase: el configurado, o adaptado a la capacidad
+// de los pases previstos en el presupuesto de latencia y a la cola actual
+static void plan_sampling(void) {
+    uint32_t previous = sample_interval_s;
+
+    sample_interval_s = rt_params.sample_interval_s;
+    if (rt_params.sample_interval_min_s == 0 || rt_params.sample_interval_s == 0 ||
+        rt_params.agg_interval_s != 0 || active_path != NET_PATH_NTN) {
+        return;
+    }
+
+    struct satellite_pass passes[SAMPLE_CONTROL_MAX_PASSES];
+    int64_t now = k_uptime_get();
+    int count = pass_forecast(&config.next_pass, &config.position, now + MAX_END_TO_END_DELAY_MS, pass_rng,
+                              device_id_seed, passes, ARRAY_SIZE(passes));
+
+    if (count < 0) {
+        LOG_WRN("Previsión de pases fallida: %d - muestreo fijo", count);
+        return;
+    }
+
+    uint32_t backlog = k_msgq_num_used_get(&uplink_msgq);
+
+    sample_interval_s = sample_control_update(&sample_ctrl, passes, count, last_sample_time, backlog,
+                                              UPLINK_QUEUE_DEPTH, rt_params.sample_interval_min_s,
+                                              rt_params.sample_interval_s);
+    if (sample_interval_s == previous) {
+        return;
+    }
+    LOG_INF("Muestreo adaptativo: cada %us (%d pases en 26 h, capacidad %u registros, cola %u, "
+            "%u ms/registro)", sample_interval_s, count, sample_ctrl.capacity, backlog, sample_ctrl.record_ms);
+    if (!sample_ctrl.feasible) {
+        LOG_WRN("La capacidad prevista no vacía la cola en 26 h ni con el intervalo máximo");
+    }
+}
+
+// Tras el fix GNSS anticipado, el attach por NTN espera al slot asignado del pase
+static void wait_for_tx_slot(void) {
+    if (active_path != NET_PATH_NTN) {
+        return;
     }
 
+    int64_t until_slot = config.next_pass.start_time + config.next_pass.tx_offset_ms +
+                         pass_access_jitter_ms(&config.next_pass, device_id_seed) - k_uptime_get();
+
+    if (until_slot > 0) {
+        LOG_INF("Fix listo: esperando %lld ms al slot del pase", until_slot);
+        wdt_sleep_ms(until_slot);
+    }
+}
+
+// Duración de un ciclo omitido por el back-off de recovery, según la ruta del ciclo que
+// falló: el próximo pase entero en NTN, un ciclo TN en TN y un sueño máximo si no hay fix
+// con el que planificar el pase.
+static int64_t skipped_cycle_ms(void) {
+    int64_t now = k_uptime_get();
+
+    if (active_path == NET_PATH_TN) {
+        return (int64_t)rt_params.tn_cycle_interval_s * 1000;
+    }
     if (!config.gps_coordinates_valid) {
-        LOG_WRN("GPS coordinates not valid, using last known position");
-        // Usar coordenadas por defecto o return error según política
+        return MAX_IDLE_SLEEP_MS;
+    }
+    if (config.next_pass.start_time <= now) {
+        predict_next_pass();
     }
+    return config.next_pass.end_time - now;
+}
 
-    // MEJORA v3.2: Validación previa del tamaño requerido
-    const size_t estimated_size = 120; // Estimación conservadora del JSON
-    if (buffer_size < estimated_size + TELEMETRY_SAFETY_MARGIN) {
-        LOG_ERR("Buffer insufficient for telemetry: need %zu, have %zu", 
-                estimated_size + TELEMETRY_SAFETY_MARGIN, buffer_size);
-        return -ENOMEM;
+// Sueño entre pases troceado por el muestreo periódico y la alimentación del watchdog
+static void idle_sleep(int64_t duration_ms) {
+    int64_t wake = k_uptime_get() + duration_ms;
+
+    for (int64_t now = k_uptime_get(); now < wake; now = k_uptime_get()) {
+        int64_t interval_ms = (int64_t)sample_interval_s * 1000;
+        int64_t until = interval_ms > 0 ? MIN(wake, last_sample_time + interval_ms) : wake;
+
+        if (until > now) {
+            wdt_sleep_ms(until - now);
+        }
+        if (interval_ms > 0 && k_uptime_get() >= last_sample_time + interval_ms) {
+            sample_telemetry();
+        }
     }
+}
 
-    int ret = snprintf(buffer, buffer_size,
-        "{\"ts\":%lld,\"lat\":%.6f,\"lon\":%.6f,\"alt\":%.1f,\"sats\":%d,\"ntn\":\"sateliot\"}",
-        k_uptime_get(),
-        config.gps_coordinates_valid ? config.device_lat : 0.0,
-        config.gps_coordinates_valid ? config.device_lon : 0.0,
-        config.gps_coordinates_valid ? config.device_alt : 0.0,
-        (last_gps_data.flags & NRF_MODEM_GNSS_PVT_FLAG_FIX_VALID) ? last_gps_data.sv_count : 0
-    );
-    
-    if (ret < 0) {
-        LOG_ERR("snprintf failed: %d", ret);
-        return -EFAULT;
+// Envía un payload, con cabecera FEC y la paridad del grupo cuando se completa
+static int send_uplink_payload(const char *payload) {
+    size_t len = strlen(payload);
+    int fec_len, err;
+
+    if (!uplink_fec_enabled) {
+        return robust_data_send(payload, len);
     }
-    
-    if (ret >= buffer_size) {
-        LOG_ERR("Buffer overflow prevented: needed %d, have %zu", ret, buffer_size);
-        return -ENOMEM;
+    fec_len = uplink_fec_encode((const uint8_t *)payload, len, fec_datagram, sizeof(fec_datagram));
+    if (fec_len < 0) {
+        return fec_len;
     }
-    
-    // MEJORA v3.2: Verificación final del contenido
-    if (ret < 50) { // JSON muy pequeño, probablemente inválido
-        LOG_ERR("Generated telemetry suspiciously small: %d bytes", ret);
-        return -EFAULT;
+    err = robust_data_send(fec_datagram, fec_len);
+    if (err) {
+        uplink_fec_abort_group();
+        return err;
+    }
+    uplink_fec_commit((const uint8_t *)payload, len);
+    // El registro ya salió: un fallo de la paridad no lo devuelve a la cola
+    fec_len = uplink_fec_parity(fec_datagram, sizeof(fec_datagram), false);
+    if (fec_len > 0) {
+        robust_data_send(fec_datagram, fec_len);
     }
-    
-    LOG_DBG("Telemetry formatted successfully: %d bytes", ret);
     return 0;
 }
 
-static int robust_data_send(const char *payload) {
-    int err = -1, retry_count = 0, sock;
-    const int max_retries = 3;
+// Envía los registros pendientes; los no enviados se conservan para el próximo pase
+static int send_pending_uplink_records(void) {
+    struct uplink_record record;
+    struct uplink_aggregate aggregate;
+    int err = 0;
+
+    int64_t send_start = k_uptime_get();
+    uint32_t sent = 0;
+
+    uplink_fec_enabled = uplink_fec_session_begin(rt_params.fec_group) != 0;
+
+    while (k_msgq_peek(&uplink_msgq, &record) == 0) {
+        err = format_telemetry_data(payload_buffer, rt_params.max_payload_bytes, &record);
+        if (err) {
+            LOG_ERR("Fallo al formatear el payload.");
+        } else {
+            err = send_uplink_payload(payload_buffer);
+            if (err) {
+                break;
+            }
+            sent++;
+        }
+        // Registros enviados o imposibles de formatear salen de la cola
+        k_msgq_get(&uplink_msgq, &record, K_NO_WAIT);
+    }
+
+    // Después los intervalos agregados; si un envío ha fallado ambas colas esperan al próximo pase
+    while (k_msgq_num_used_get(&uplink_msgq) == 0 && k_msgq_peek(&uplink_agg_msgq, &aggregate) == 0) {
+        err = format_aggregate_data(payload_buffer, rt_params.max_payload_bytes, &aggregate);
+        if (err) {
+            LOG_ERR("Fallo al formatear el payload.");
+        } else {
+            err = send_uplink_payload(payload_buffer);
+            if (err) {
+                break;
+            }
+            sent++;
+        }
+        k_msgq_get(&uplink_agg_msgq, &aggregate, K_NO_WAIT);
+    }
+
+    // Grupo a medias: su paridad sale ya, sin esperar a completar k en otro pase
+    if (uplink_fec_enabled) {
+        int parity_len = uplink_fec_parity(fec_datagram, sizeof(fec_datagram), true);
+
+        if (parity_len > 0) {
+            robust_data_send(fec_datagram, parity_len);
+        }
+        uplink_fec_session_end();
+    }
+
+    // Medidas para la previsión de capacidad: solo los pases NTN (TN no tiene ventana)
+    if (active_path == NET_PATH_NTN) {
+        sample_control_observe(&sample_ctrl, (uint32_t)(send_start - radio_on_start),
+                               (uint32_t)(k_uptime_get() - send_start), sent);
+    }
+    return err;
+}
+
+static void server_sockaddr(struct sockaddr_in *addr) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons((uint16_t)rt_params.server_port);
+    addr->sin_addr.s_addr = htonl(rt_params.server_addr);
+}
+
+// Un socket por sesión de envío: el servidor responde al mismo puerto origen del uplink
+static void uplink_socket_close(void) {
+    if (uplink_sock >= 0) {
+        close(uplink_sock);
+        uplink_sock = -1;
+    }
+}
+
+static int robust_data_send(const void *data, size_t len) {
+    int err = -1, retry_count = 0;
+    const int max_retries = rt_params.send_max_retries;
     struct sockaddr_in server_addr;
 
+    if (rt_params.server_addr == 0) {
+        LOG_ERR("Servidor VAS sin dirección válida - envío cancelado");
+        return -EINVAL;
+    }
+
     // Validación específica para UDP (único protocolo soportado por Sateliot)
-    LOG_INF("Enviando datos via UDP a servidor VAS: %s:%d", config.server_ip, config.server_port);
+    LOG_INF("Enviando datos via UDP a servidor VAS: %u.%u.%u.%u:%u",
+            (rt_params.server_addr >> 24) & 0xFF, (rt_params.server_addr >> 16) & 0xFF,
+            (rt_params.server_addr >> 8) & 0xFF, rt_params.server_addr & 0xFF, rt_params.server_port);
+    server_sockaddr(&server_addr);
 
     while (retry_count < max_retries && err != 0) {
-        sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-        if (sock < 0) {
+        if (uplink_sock < 0) {
+            uplink_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        }
+        if (uplink_sock < 0) {
             LOG_ERR("Fallo al crear socket UDP, intento %d/%d", retry_count + 1, max_retries);
             retry_count++;
-            k_sleep(K_SECONDS(10));
+            wdt_sleep_ms((int64_t)rt_params.send_retry_delay_s * 1000);
             continue;
         }
 
-        server_addr.sin_family = AF_INET;
-        server_addr.sin_port = htons(config.server_port);
-        inet_pton(AF_INET, config.server_ip, &server_addr.sin_addr);
-
-        err = sendto(sock, payload, strlen(payload), 0, (struct sockaddr *)&server_addr, sizeof(server_addr));
-        close(sock);
+        err = sendto(uplink_sock, data, len, 0, (struct sockaddr *)&server_addr, sizeof(server_addr));
 
         if (err < 0) {
             LOG_ERR("Fallo al enviar datos, intento %d/%d: %d", retry_count + 1, max_retries, -errno);
+            uplink_socket_close();
             retry_count++;
             // Timeout más largo para acomodar latencias de Sateliot
-            k_sleep(K_SECONDS(15));
+            wdt_sleep_ms((int64_t)rt_params.send_retry_delay_s * 1000);
         } else {
             LOG_INF("Datos enviados exitosamente a Sateliot en intento %d.", retry_count + 1);
             return 0;
@@ -691,21 +1434,112 @@ static int robust_data_send(const char *payload) {
     return -EIO;
 }
 
+// Escucha comandos del servidor VAS durante la ventana de downlink tras el uplink
+static void receive_downlink(void) {
+    struct sockaddr_in server_addr, from;
+    int64_t window_ms = (int64_t)rt_params.downlink_window_s * 1000;
+    int64_t deadline = k_uptime_get() + window_ms;
+    struct downlink_response resp;
+
+    if (uplink_sock < 0 || rt_params.downlink_window_s == 0) {
+        return;
+    }
+    server_sockaddr(&server_addr);
+
+    // Transferencia FOTA a medias: se pide al servidor el siguiente fragmento
+    if (fota_resume_request(&resp)) {
+        sendto(uplink_sock, resp.buf, resp.len, 0, (struct sockaddr *)&server_addr, sizeof(server_addr));
+    }
+
+    for (int64_t remaining = deadline - k_uptime_get(); remaining > 0;
+         remaining = deadline - k_uptime_get()) {
+        struct pollfd fds = { .fd = uplink_sock, .events = POLLIN };
+        socklen_t from_len = sizeof(from);
+
+        if (wdt_poll(&fds, remaining) <= 0) {
+            break;
+        }
+        ssize_t len = recvfrom(uplink_sock, downlink_buffer, sizeof(downlink_buffer), 0,
+                               (struct sockaddr *)&from, &from_len);
+        if (len < 0) {
+            LOG_WRN("Fallo al recibir downlink: %d", -errno);
+            break;
+        }
+        // Solo se aceptan comandos del servidor configurado
+        if (from.sin_addr.s_addr != server_addr.sin_addr.s_addr || from.sin_port != server_addr.sin_port) {
+            LOG_WRN("Downlink de origen desconocido - descartado");
+            continue;
+        }
+
+        int err = downlink_dispatch(downlink_buffer, len, &resp);
+
+        LOG_DBG("Downlink opcode 0x%02x: %d", resp.buf[0] & ~DOWNLINK_ACK_FLAG, err);
+        if (err == 0) {
+            sync_runtime_params();
+        }
+        sendto(uplink_sock, resp.buf, resp.len, 0, (struct sockaddr *)&server_addr, sizeof(server_addr));
+
+        // Mientras el servidor siga enviando (p. ej. fragmentos FOTA) la ventana se prolonga
+        deadline = MAX(deadline, k_uptime_get() + window_ms);
+    }
+    // El delta del módem queda cerrado hasta el próximo pase; la sesión bulk se persiste
+    // después de sus destinos para no quedar nunca por delante de ellos
+    fota_suspend();
+    modem_dfu_suspend();
+    bulk_suspend();
+}
+
+// Propaga a los módulos los parámetros que guardan su propia copia
+static void sync_runtime_params(void) {
+    config.tle_config.update_interval_hours = rt_params.tle_update_interval_h;
+}
+
 // =================================================================
 //  FUNCIÓN PRINCIPAL
 // =================================================================
 
 int main(void) {
     int err;
-    struct satellite_pass next_pass;
+    int64_t attach_wait_ms;
+    int64_t seeded_wait_ms;
 
     LOG_INF("Iniciando firmware Sateliot NTN v3.2...");
     
-    // Inicializar configuración Sateliot
-    err = initialize_sateliot_config();
+    // Arranque en caliente: posición, planificación y TLEs vienen de la RAM retenida
+    bool warm_boot = retained_state_restore();
+    device_id_seed = device_seed();
+    pass_rng_seed(&pass_rng, device_id_seed);
+
+    // Settings en flash: historial de recovery (en caliente ya viene en la RAM retenida)
+    // y contexto de celda
+    err = settings_subsys_init();
     if (err) {
-        LOG_ERR("Fallo al inicializar configuración Sateliot: %d", err);
-        set_state(STATE_ERROR);
+        LOG_ERR("Fallo al inicializar settings: %d", err);
+    }
+
+    // Parámetros y contexto de celda viven solo en flash: se cargan en frío y en caliente
+    params_init(VAS_SERVER_IP, VAS_SERVER_PORT);
+    if (err == 0) {
+        params_load();
+        cell_context_load(cell_ctx);
+        downlink_auth_init();
+        fota_init();
+        modem_dfu_init();
+        geofence_init();
+        bulk_init(bulk_sinks);
+    }
+
+    // Inicializar configuración Sateliot
+    if (!warm_boot) {
+        recovery_init(&config.recovery);
+        if (err == 0) {
+            recovery_persist_load(&config.recovery);
+        }
+        err = initialize_sateliot_config();
+        if (err) {
+            LOG_ERR("Fallo al inicializar configuración Sateliot: %d", err);
+            report_fault(RECOVERY_FAULT_AT_ERROR, err);
+        }
     }
     
     err = setup_watchdog();
@@ -714,16 +1548,19 @@ int main(void) {
         while(1) { k_sleep(K_FOREVER); }
     }
 
-    err = lte_lc_init_and_connect_async(lte_handler);
+    // En caliente no se conecta ni se arranca GNSS hasta el próximo pase
+    err = warm_boot ? lte_lc_init() : lte_lc_init_and_connect_async(lte_handler);
     if (err) {
         LOG_ERR("Fallo al inicializar el módem: %d", err);
-        set_state(STATE_ERROR);
+        report_fault(RECOVERY_FAULT_MODEM, err);
     }
 
-    err = gnss_init_and_start();
-    if (err) {
-        LOG_ERR("Fallo al inicializar GNSS: %d", err);
-        set_state(STATE_ERROR);
+    if (!warm_boot) {
+        err = gnss_init_and_start();
+        if (err) {
+            LOG_ERR("Fallo al inicializar GNSS: %d", err);
+            report_fault(RECOVERY_FAULT_GNSS_TIMEOUT, err);
+        }
     }
     
     err = configure_power_management();
@@ -731,7 +1568,18 @@ int main(void) {
         LOG_WRN("No se pudo configurar la gestión de energía.");
     }
 
-    set_state(STATE_IDLE);
+    sample_control_init(&sample_ctrl);
+
+    // Sin ADC los registros llevan igualmente batería y temperatura del módem
+    err = sensors_init();
+    if (err) {
+        LOG_WRN("Sensores ADC no disponibles: %d", err);
+    }
+
+    // Un fallo en el arranque pasa directamente por recovery
+    if (current_state != STATE_ERROR) {
+        set_state(STATE_IDLE);
+    }
 
     // =================================================================
     //  LOOP PRINCIPAL DE LA MÁQUINA DE ESTADOS
@@ -739,34 +1587,110 @@ int main(void) {
     
     while (1) {
         wdt_feed(wdt_dev, wdt_channel_id);
+
+        if (modem_faulted && current_state != STATE_ERROR && current_state != STATE_RECOVERY) {
+            modem_faulted = false;
+            report_fault(RECOVERY_FAULT_MODEM, (int)modem_fault_reason);
+        }
+
+        // Un fix solo cierra un incidente de GNSS; el registro cierra cualquiera
+        bool gnss_fixed = atomic_test_and_clear_bit(recovery_success_events, RECOVERY_SUCCESS_GNSS_FIX);
+
+        if (atomic_test_and_clear_bit(recovery_success_events, RECOVERY_SUCCESS_REGISTERED) ||
+            (gnss_fixed && config.recovery.last_fault == RECOVERY_FAULT_GNSS_TIMEOUT)) {
+            recovery_mark_success(&config.recovery, k_uptime_get());
+        }
         
         switch (current_state) {
             case STATE_IDLE:
                 // MEJORA v3.2: Verificar si necesita actualización de TLEs
-                if (config.tle_config.update_needed || 
-                    (k_uptime_get() - config.tle_config.last_update_time) > 
-                    (config.tle_config.update_interval_hours * 60 * 60 * 1000)) {
+                if (tle_update_due(&config.tle_config, k_uptime_get())) {
                     set_state(STATE_TLE_UPDATE);
                     break;
                 }
                 
-                if (CURRENT_INTEGRATION_PHASE == PHASE_NTN_TESTING) {
+                // Imagen nueva lista: se reinicia aquí, entre pases, nunca con el enlace activo
+                if (fota_reboot_pending()) {
+                    LOG_INF("Reiniciando para instalar firmware nuevo...");
+                    recovery_persist_save(&config.recovery);
+                    // La imagen nueva puede tener otro layout de RAM retenida: arranca en frío
+                    retained.magic = 0;
+                    sys_reboot(SYS_REBOOT_COLD);
+                }
+
+                // Marca máxima del heap del sistema, una vez por ciclo (solo librerías del módem)
+                heap_guard_check();
+                retained_state_rebase();
+
+                // Back-off de recovery: el ciclo se duerme entero, sin GNSS ni módem. Se consulta
+                // una sola vez y antes de elegir ruta, así también lo respetan TN y el caso sin fix
+                if (recovery_skip_pass(&config.recovery)) {
+                    int64_t skip_ms = skipped_cycle_ms();
+
+                    LOG_WRN("Back-off de recovery: ciclo %s omitido (%llds), quedan %u",
+                            net_path_str(active_path), skip_ms / 1000, config.recovery.passes_to_skip);
+                    retained_state_save();
+                    recovery_persist_save(&config.recovery);
+                    idle_sleep(skip_ms);
+                    break;
+                }
+
+                // Ruta del ciclo a partir de la disponibilidad TN cacheada
+                active_path = net_path_select(&config.net_path, k_uptime_get());
+
+                if (active_path == NET_PATH_NTN) {
                     if (config.gps_coordinates_valid) {
-                        calculate_sateliot_satellite_pass(&next_pass, config.device_lat, config.device_lon);
-                        int64_t sleep_ms = next_pass.start_time - k_uptime_get();
+                        // Reutilizar el cursor de planificación mientras el pase siga en el futuro
+                        if (config.next_pass.start_time <= k_uptime_get()) {
+                            predict_next_pass();
+                        }
+                        // El fix GNSS va antes del slot: el attach empieza en el slot, no tras el GNSS
+                        int64_t gnss_lead_ms = (int64_t)rt_params.gnss_fix_timeout_s * 1000;
+                        int64_t sleep_ms = config.next_pass.start_time + config.next_pass.tx_offset_ms -
+                                           gnss_lead_ms - k_uptime_get();
+
+                        plan_sampling();
+
+                        // Delta del módem listo: solo si la instalación cabe antes del pase
+                        if (modem_dfu_apply_pending() && sleep_ms > MODEM_DFU_APPLY_MARGIN_MS) {
+                            err = apply_modem_dfu();
+                            if (err) {
+                                report_fault(RECOVERY_FAULT_MODEM, err);
+                                break;
+                            }
+                        }
+                        retained_state_save();
+                        recovery_persist_save(&config.recovery);
+                        if (!boot_to_sleep_logged) {
+                            LOG_INF("Boot-to-sleep: %lld ms", k_uptime_get());
+                            boot_to_sleep_logged = true;
+                        }
                         if (sleep_ms > 0) {
-                            LOG_INF("Sateliot NTN: Durmiendo %llds hasta próximo pase satelital.", sleep_ms / 1000);
-                            // Limitar sleep máximo para permitir verificaciones periódicas
-                            int64_t max_sleep = MIN(sleep_ms, 30 * 60 * 1000); // Máximo 30 minutos
-                            k_sleep(K_MSEC(max_sleep));
+                            LOG_INF("Sateliot NTN: Durmiendo %llds hasta el GNSS previo al slot del próximo pase.",
+                                    sleep_ms / 1000);
+                            idle_sleep(pass_wakeup_delay_ms(&config.next_pass, gnss_lead_ms, k_uptime_get()));
+                        }
+                        // Sueño acotado a MAX_IDLE_SLEEP_MS: se vuelve a IDLE hasta que toque el GNSS
+                        if (pass_wakeup_delay_ms(&config.next_pass, gnss_lead_ms, k_uptime_get()) > 0) {
+                            break;
                         }
                     } else {
                         LOG_WRN("Coordenadas GPS no válidas - esperando 30s");
-                        k_sleep(K_SECONDS(30));
+                        wdt_sleep_ms(30 * 1000);
                     }
                 } else {
-                    LOG_INF("Modo TN: Esperando 60s.");
-                    k_sleep(K_SECONDS(60));
+                    if (modem_dfu_apply_pending()) {
+                        err = apply_modem_dfu();
+                        if (err) {
+                            report_fault(RECOVERY_FAULT_MODEM, err);
+                            break;
+                        }
+                    }
+                    LOG_INF("Modo TN: Esperando %us.", rt_params.tn_cycle_interval_s);
+                    retained_state_save();
+                    recovery_persist_save(&config.recovery);
+                    plan_sampling();
+                    idle_sleep((int64_t)rt_params.tn_cycle_interval_s * 1000);
                 }
                 set_state(STATE_GETTING_GPS_FIX);
                 break;
@@ -781,22 +1705,30 @@ int main(void) {
                 } else {
                     LOG_INF("TLEs actualizados exitosamente");
                 }
-                set_state(STATE_GETTING_GPS_FIX);
+                // De vuelta a IDLE: replanifica el pase con los TLEs nuevos y duerme hasta su slot
+                set_state(STATE_IDLE);
                 break;
 
             case STATE_GETTING_GPS_FIX:
+                if (!gnss_running && gnss_init_and_start() != 0) {
+                    LOG_ERR("Fallo al iniciar GNSS diferido");
+                }
                 LOG_INF("Esperando fix de GNSS...");
                 k_sem_reset(&gps_fix_sem);
-                err = k_sem_take(&gps_fix_sem, K_SECONDS(180));
+                err = wdt_sem_take(&gps_fix_sem, (int64_t)rt_params.gnss_fix_timeout_s * 1000);
                 if (err) {
                     LOG_WRN("No se obtuvo fix de GNSS - continuando con última posición conocida");
                     if (config.gps_coordinates_valid) {
-                        set_state(STATE_ATTEMPTING_CONNECTION_STEP1);
+                        wait_for_tx_slot();
+                        set_state(pass_uplink_state());
                     } else {
-                        set_state(STATE_IDLE);
+                        report_fault(RECOVERY_FAULT_GNSS_TIMEOUT, err);
                     }
                 } else {
-                    set_state(STATE_ATTEMPTING_CONNECTION_STEP1);
+                    wall_clock_from_gnss();
+                    retained_state_rebase();
+                    wait_for_tx_slot();
+                    set_state(pass_uplink_state());
                 }
                 break;
 
@@ -804,20 +1736,25 @@ int main(void) {
                 LOG_INF("Sateliot Attachment Step 1: Esperando Attach Reject...");
                 current_attachment_step = ATTACH_STEP_1;
                 
-                if (CURRENT_INTEGRATION_PHASE == PHASE_NTN_TESTING) {
-                    err = configure_nordic_for_sateliot();
-                    if (err) {
-                        LOG_ERR("Fallo en configuración Nordic para Sateliot");
-                        set_state(STATE_ERROR);
-                        break;
-                    }
-                    modem_configure_for_sateliot_attachment();
+                err = configure_nordic_for_sateliot();
+                if (err) {
+                    LOG_ERR("Fallo en configuración Nordic para Sateliot");
+                    report_fault(RECOVERY_FAULT_AT_ERROR, err);
+                    break;
                 }
+                modem_configure_for_sateliot_attachment();
                 
-                lte_lc_connect_async(lte_handler);
+                start_network_search();
 
-                // Timeout más largo para Step 1 - se espera rechazo inicial
-                err = k_sem_take(&lte_connected_sem, K_MINUTES(5));
+                // Step 1 espera el rechazo inicial, acotado a la ventana del slot
+                attach_wait_ms = pass_attach_wait_ms(&config.next_pass, (int64_t)rt_params.step1_timeout_s * 1000,
+                                                     k_uptime_get());
+                if (attach_wait_ms < 0) {
+                    lte_lc_offline();
+                    report_fault(RECOVERY_FAULT_REGISTRATION_TIMEOUT, -ETIME);
+                    break;
+                }
+                err = wdt_sem_take(&lte_connected_sem, attach_wait_ms);
                 if (err) {
                     LOG_INF("Step 1 completado (Attach Reject recibido) - procediendo a Step 2");
                     current_attachment_step = ATTACH_STEP_2;
@@ -835,29 +1772,96 @@ int main(void) {
                 
                 // Esperar tiempo para que el feeder link procese la autenticación
                 LOG_INF("Esperando procesamiento de feeder link...");
-                k_sleep(K_SECONDS(30));
+                wdt_sleep_ms((int64_t)rt_params.feeder_link_wait_s * 1000);
                 
-                lte_lc_connect_async(lte_handler);
+                start_network_search();
 
-                // Timeout muy largo para Step 2 debido a latencias de Sateliot
-                err = k_sem_take(&lte_connected_sem, K_MINUTES(15));
+                // Step 2 acotado igual que Step 1: params.c garantiza que la secuencia cabe en el
+                // slot, y el fin del pase deja hueco al back-off
+                attach_wait_ms = pass_attach_wait_ms(&config.next_pass, (int64_t)rt_params.step2_timeout_s * 1000,
+                                                     k_uptime_get());
+                err = attach_wait_ms < 0 ? -ETIME : wdt_sem_take(&lte_connected_sem, attach_wait_ms);
                 if (err) {
-                    LOG_WRN("Timeout en attachment Step 2 - reintentando desde Step 1");
                     lte_lc_offline();
                     current_attachment_step = ATTACH_STEP_1;
+
+                    // Back-off con jitter por dispositivo; sin hueco en el pase se espera al siguiente
+                    int64_t backoff_ms = pass_rach_backoff_ms(&config.next_pass, device_id_seed,
+                                                              ++rach_attempts, k_uptime_get());
+                    if (backoff_ms < 0) {
+                        LOG_WRN("Timeout en attachment Step 2 - sin ventana en este pase");
+                        rach_attempts = 0;
+                        report_fault(RECOVERY_FAULT_REGISTRATION_TIMEOUT, -ETIME);
+                        break;
+                    }
+                    LOG_WRN("Timeout en attachment Step 2 - reintentando desde Step 1 en %lld ms", backoff_ms);
+                    wdt_sleep_ms(backoff_ms);
                     set_state(STATE_ATTEMPTING_CONNECTION_STEP1);
                 } else {
+                    rach_attempts = 0;
+                    set_state(STATE_SENDING_DATA);
+                }
+                break;
+
+            case STATE_ATTEMPTING_CONNECTION_TN:
+                LOG_INF("Intentando registro en red terrestre...");
+                err = configure_nordic_for_terrestrial();
+                if (err) {
+                    report_fault(RECOVERY_FAULT_AT_ERROR, err);
+                    break;
+                }
+
+                k_sem_reset(&lte_connected_sem);
+                start_network_search();
+                // El canal sembrado solo tiene la mitad del plazo: si el dispositivo se ha movido
+                // a otra frecuencia se libera el canal y se repite la búsqueda en frío
+                seeded_wait_ms = (int64_t)rt_params.tn_connect_timeout_s * 1000;
+                if (connect_seeded) {
+                    seeded_wait_ms /= 2;
+                }
+                err = wdt_sem_take(&lte_connected_sem, seeded_wait_ms);
+                if (err && connect_seeded) {
+                    LOG_WRN("Sin registro en el EARFCN terrestre conocido - búsqueda en frío");
+                    lte_lc_offline();
+                    cell_ctx[NET_PATH_TN].valid = false;
+                    cell_context_save(NET_PATH_TN, &cell_ctx[NET_PATH_TN]);
+                    err = configure_nordic_for_terrestrial();
+                    if (err == 0) {
+                        k_sem_reset(&lte_connected_sem);
+                        start_network_search();
+                        err = wdt_sem_take(&lte_connected_sem, seeded_wait_ms);
+                    }
+                }
+                net_path_report(&config.net_path, NET_PATH_TN, err == 0, k_uptime_get());
+                if (err == 0) {
                     set_state(STATE_SENDING_DATA);
+                    break;
                 }
+
+                // Sin cobertura terrestre: el registro queda en cola para el próximo pase NTN
+                LOG_WRN("Sin red terrestre - volviendo a Sateliot NTN");
+                lte_lc_offline();
+                active_path = NET_PATH_NTN;
+                set_state(STATE_IDLE);
                 break;
 
             case STATE_SENDING_DATA:
-                if (format_telemetry_data(payload_buffer, PAYLOAD_BUFFER_SIZE) == 0) {
-                    robust_data_send(payload_buffer);
-                } else {
-                    LOG_ERR("Fallo al formatear el payload.");
+                capture_cell_context();
+                err = send_pending_uplink_records();
+                if (err == 0) {
+                    // Ciclo completo con la imagen en prueba: se confirma ante MCUboot
+                    fota_confirm_image();
+                    receive_downlink();
+                    report_filter_uplink_done(&report_filter, k_uptime_get(),
+                                              (uint32_t)(k_uptime_get() - radio_on_start));
                 }
+                uplink_socket_close();
                 lte_lc_offline();
+                if (err) {
+                    // Los registros siguen en la cola para el próximo pase
+                    report_fault(RECOVERY_FAULT_SOCKET, err);
+                    break;
+                }
                 LOG_INF("Ciclo Sateliot completado.");
                 set_state(STATE_IDLE);
                 break;
@@ -866,15 +1870,22 @@ int main(void) {
             case STATE_RECOVERY:
                 LOG_INF("Iniciando secuencia de recovery automático...");
                 err = attempt_error_recovery(config.recovery.last_good_state);
-                if (err == 0) {
+                if (err == 0 && config.recovery.last_fault == RECOVERY_FAULT_REGISTRATION_TIMEOUT) {
+                    // El pase ya no tiene ventana: el módem queda reparado para el siguiente
+                    LOG_INF("Recovery exitoso - esperando al próximo pase");
+                    set_state(STATE_IDLE);
+                } else if (err == 0) {
                     LOG_INF("Recovery exitoso - regresando a estado anterior");
                     set_state(config.recovery.last_good_state);
                 } else if (err == -EFAULT) {
-                    LOG_ERR("Recovery falló - manteniendo operación limitada");
+                    LOG_ERR("Recovery falló - back-off de %u pases", config.recovery.passes_to_skip);
                     set_state(STATE_IDLE);
                 } else {
-                    LOG_WRN("Recovery parcial - reintentando en próximo ciclo");
-                    k_sleep(K_MINUTES(2));
+                    // Fuera de un pase el módem no puede verificar el recovery: STATE_IDLE
+                    // duerme hasta el próximo pase en lugar de reintentar cada pocos minutos
+                    if (err != -EAGAIN) {
+                        LOG_WRN("Recovery parcial (%d) - reintentando en próximo pase", err);
+                    }
                     set_state(STATE_IDLE);
                 }
                 break;
@@ -0,0 +1,303 @@
+/*
+ * Archivo: modem_dfu.c
+ * Descripción: Cliente de actualización delta del firmware del módem.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/crc.h>
+#include <nrf_modem.h>
+#include <nrf_modem_delta_dfu.h>
+#include <string.h>
+
+#include "downlink_auth.h"
+#include "modem_dfu.h"
+
+LOG_MODULE_DECLARE(ntn_app, LOG_LEVEL_INF);
+
+#define MODEM_DFU_BEGIN_LEN (12 + DOWNLINK_AUTH_TAG_LEN)
+
+enum modem_dfu_state {
+    MODEM_DFU_IDLE,
+    MODEM_DFU_ACTIVE,
+    MODEM_DFU_READY         // Delta completo con CRC correcto, pendiente de aplicar
+};
+
+struct modem_dfu_progress {
+    uint32_t session_id;
+    uint32_t size;
+    uint32_t crc;               // CRC32 esperado del delta completo
+    uint32_t written;           // Bytes confirmados en el área DFU del módem
+    uint32_t running_crc;       // CRC32 de los bytes escritos
+    uint8_t state;
+    uint8_t tag[DOWNLINK_AUTH_TAG_LEN];     // Etiqueta esperada del delta completo
+    struct downlink_auth_stream mac;        // Etiqueta de los bytes escritos
+};
+
+static struct modem_dfu_progress progress;
+static bool writing;            // Entre write_init y write_done
+
+static uint32_t get_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static int modem_dfu_persist(void) {
+    int err = settings_save_one(MODEM_DFU_SETTINGS_KEY, &progress, sizeof(progress));
+
+    if (err) {
+        LOG_ERR("Fallo al guardar progreso DFU del módem: %d", err);
+    }
+    return err;
+}
+
+static void modem_dfu_reset(void) {
+    modem_dfu_suspend();
+    memset(&progress, 0, sizeof(progress));
+    progress.state = MODEM_DFU_IDLE;
+}
+
+static void modem_dfu_put_status(struct downlink_response *resp) {
+    downlink_resp_put_be32(resp, progress.session_id);
+    downlink_resp_put_be32(resp, progress.written);
+}
+
+static int modem_dfu_load_cb(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg, void *param) {
+    ARG_UNUSED(key);
+    ARG_UNUSED(param);
+
+    if (len != sizeof(progress) || read_cb(cb_arg, &progress, sizeof(progress)) != sizeof(progress)) {
+        LOG_WRN("Progreso DFU del módem incompatible - descartado");
+        modem_dfu_reset();
+    }
+    return 0;
+}
+
+int modem_dfu_init(void) {
+    modem_dfu_reset();
+
+    int err = settings_load_subtree_direct(MODEM_DFU_SETTINGS_KEY, modem_dfu_load_cb, NULL);
+
+    if (err) {
+        LOG_ERR("Fallo al cargar progreso DFU del módem: %d", err);
+        modem_dfu_reset();
+        return err;
+    }
+    if (progress.state == MODEM_DFU_ACTIVE) {
+        LOG_INF("DFU del módem en curso: sesión %08x, %u/%u bytes", progress.session_id,
+                progress.written, progress.size);
+    } else if (progress.state == MODEM_DFU_READY) {
+        LOG_INF("DFU del módem sesión %08x pendiente de aplicar", progress.session_id);
+    }
+    return 0;
+}
+
+// El borrado del área DFU es asíncrono y dura segundos: no se espera en el manejador del
+// downlink. -EINPROGRESS mientras el módem siga borrando.
+static int modem_dfu_erase_status(void) {
+    size_t offset;
+
+    if (writing || progress.state != MODEM_DFU_ACTIVE || progress.written > 0) {
+        return 0;
+    }
+    return nrf_modem_delta_dfu_offset(&offset) == NRF_MODEM_DELTA_DFU_ERASE_PENDING ? -EINPROGRESS : 0;
+}
+
+int modem_dfu_handle_begin(const uint8_t *payload, size_t len, struct downlink_response *resp) {
+    uint32_t session_id;
+    size_t area;
+    int err;
+
+    if (len != MODEM_DFU_BEGIN_LEN) {
+        return -EBADMSG;
+    }
+    session_id = get_be32(&payload[0]);
+
+    // BEGIN repetido (ack perdido o nuevo pase): se contesta con el punto de reanudación
+    if (progress.state != MODEM_DFU_IDLE && progress.session_id == session_id) {
+        modem_dfu_put_status(resp);
+        return modem_dfu_erase_status();
+    }
+    if (progress.state == MODEM_DFU_READY) {
+        return -EBUSY;
+    }
+
+    modem_dfu_reset();
+    progress.session_id = session_id;
+    progress.size = get_be32(&payload[4]);
+    progress.crc = get_be32(&payload[8]);
+    memcpy(progress.tag, &payload[12], sizeof(progress.tag));
+    downlink_auth_begin(&progress.mac, DOWNLINK_AUTH_IMAGE);
+
+    err = nrf_modem_delta_dfu_area(&area);
+    if (err || progress.size == 0 || progress.size > area) {
+        LOG_ERR("Delta del módem de %u bytes no cabe en el área DFU (%u): %d", progress.size,
+                (unsigned int)area, err);
+        modem_dfu_reset();
+        return err ? -EIO : -EFBIG;
+    }
+
+    // Restos de una sesión anterior: el área se borra antes de escribir. La respuesta es
+    // -EINPROGRESS hasta que termine; la primera escritura lo vuelve a comprobar.
+    err = nrf_modem_delta_dfu_erase();
+    if (err) {
+        LOG_ERR("Fallo al borrar el área DFU del módem: %d", err);
+        modem_dfu_reset();
+        return err < 0 ? err : -EIO;
+    }
+
+    progress.state = MODEM_DFU_ACTIVE;
+    LOG_INF("DFU del módem sesión %08x: delta de %u bytes", session_id, progress.size);
+    modem_dfu_put_status(resp);
+    err = modem_dfu_persist();
+    return err ? err : modem_dfu_erase_status();
+}
+
+int modem_dfu_handle_abort(const uint8_t *payload, size_t len) {
+    if (len != 4) {
+        return -EBADMSG;
+    }
+    if (progress.state == MODEM_DFU_IDLE || get_be32(payload) != progress.session_id) {
+        return -ESRCH;
+    }
+    LOG_WRN("DFU del módem sesión %08x cancelada por el servidor", progress.session_id);
+    modem_dfu_reset();
+    return modem_dfu_persist();
+}
+
+// Primera escritura del pase: el área del módem debe seguir donde quedó el progreso
+static int modem_dfu_resume(void) {
+    size_t offset;
+    int err = nrf_modem_delta_dfu_offset(&offset);
+
+    // Borrado del BEGIN aún en curso: el bloque se reintenta sin perder la sesión
+    if (err == NRF_MODEM_DELTA_DFU_ERASE_PENDING) {
+        return -EINPROGRESS;
+    }
+    if (err == 0 && offset != progress.written) {
+        // Corte entre la escritura en el módem y el guardado del progreso
+        LOG_ERR("Área DFU del módem en %u, progreso en %u - sesión descartada",
+                (unsigned int)offset, progress.written);
+        return -ESTALE;
+    }
+    if (err) {
+        return err < 0 ? err : -EIO;
+    }
+    err = nrf_modem_delta_dfu_write_init();
+    if (err) {
+        return err < 0 ? err : -EIO;
+    }
+    writing = true;
+    return 0;
+}
+
+static int modem_dfu_finish(void) {
+    modem_dfu_suspend();
+    if (progress.running_crc != progress.crc) {
+        LOG_ERR("CRC del delta del módem incorrecto (%08x != %08x)", progress.running_crc, progress.crc);
+        return -EBADMSG;
+    }
+    if (downlink_auth_verify(&progress.mac, progress.tag) != 0) {
+        LOG_ERR("Etiqueta del delta del módem incorrecta - no se aplicará");
+        return -EACCES;
+    }
+    progress.state = MODEM_DFU_READY;
+    LOG_INF("Delta del módem completo - se aplicará entre pases");
+    return 0;
+}
+
+int modem_dfu_write(uint32_t session_id, uint32_t offset, const uint8_t *data, size_t len) {
+    int err = 0;
+
+    if (progress.state != MODEM_DFU_ACTIVE || session_id != progress.session_id) {
+        return -ESRCH;
+    }
+    // Bloque ya escrito en un pase anterior
+    if (offset + len <= progress.written) {
+        return 0;
+    }
+    if (offset != progress.written) {
+        return -ERANGE;
+    }
+    if (len > progress.size - progress.written) {
+        return -EFBIG;
+    }
+
+    if (!writing) {
+        err = modem_dfu_resume();
+        if (err == -EINPROGRESS) {
+            return err;
+        }
+    }
+    if (err == 0) {
+        err = nrf_modem_delta_dfu_write(data, len);
+        if (err > 0) {
+            err = -EIO;
+        }
+    }
+    if (err == 0) {
+        progress.written += len;
+        progress.running_crc = crc32_ieee_update(progress.running_crc, data, len);
+        downlink_auth_update(&progress.mac, data, len);
+        if (progress.written == progress.size) {
+            err = modem_dfu_finish();
+        }
+    }
+    if (err) {
+        LOG_ERR("DFU del módem sesión %08x abortada: %d", progress.session_id, err);
+        modem_dfu_reset();
+        modem_dfu_persist();
+        return err;
+    }
+    return modem_dfu_persist();
+}
+
+void modem_dfu_suspend(void) {
+    if (!writing) {
+        return;
+    }
+    int err = nrf_modem_delta_dfu_write_done();
+
+    if (err) {
+        LOG_WRN("Fallo al cerrar la escritura DFU del módem: %d", err);
+    }
+    writing = false;
+}
+
+bool modem_dfu_apply_pending(void) {
+    return progress.state == MODEM_DFU_READY;
+}
+
+int modem_dfu_schedule(void) {
+    if (progress.state != MODEM_DFU_READY) {
+        return -ENOENT;
+    }
+    int err = nrf_modem_delta_dfu_update();
+
+    if (err) {
+        // El módem no acepta el delta: se descarta para no reintentarlo en cada IDLE
+        LOG_ERR("Fallo al programar el DFU del módem: %d", err);
+        modem_dfu_reset();
+        modem_dfu_persist();
+        return err < 0 ? err : -EIO;
+    }
+    LOG_INF("DFU del módem sesión %08x programado", progress.session_id);
+    return 0;
+}
+
+void modem_dfu_result(int result) {
+    switch (result) {
+    case NRF_MODEM_DFU_RESULT_OK:
+        LOG_INF("Firmware del módem actualizado (sesión %08x)", progress.session_id);
+        break;
+    case NRF_MODEM_DFU_RESULT_VOLTAGE_LOW:
+        // El módem sigue con el firmware anterior y el delta intacto: se reintenta
+        LOG_WRN("DFU del módem aplazado por tensión baja");
+        return;
+    default:
+        LOG_ERR("DFU del módem rechazado: 0x%x", result);
+        break;
+    }
+    modem_dfu_reset();
+    modem_dfu_persist();
+}
@@ -0,0 +1,58 @@
+/*
+ * Archivo: modem_dfu.h
+ * Descripción: Actualización delta del firmware del módem (nrf_modem_delta_dfu),
+ *              recibida por el canal bulk a lo largo de varios pases.
+ *
+ * El delta se escribe en el área DFU del propio módem, que conserva lo recibido entre
+ * reinicios; el progreso y el CRC acumulado se persisten tras cada bloque. La imagen
+ * solo se aplica en IDLE con margen suficiente hasta el próximo pase, porque el módem
+ * queda fuera de servicio mientras se instala.
+ *
+ * Downlink (payload tras el opcode, big-endian):
+ *   MODEM_DFU_BEGIN [sesión][tamaño delta][CRC32 delta][etiqueta del delta (DOWNLINK_AUTH_IMAGE)]
+ *   MODEM_DFU_ABORT [sesión]
+ * Los datos llegan como objeto bulk BULK_TYPE_MODEM_DFU con el mismo id de sesión.
+ * Respuesta a BEGIN: [sesión][bytes ya escritos en el módem]; -EINPROGRESS mientras el
+ * módem borra el área DFU (segundos, no se espera en el manejador): el servidor repite el
+ * BEGIN hasta recibir 0. Un bloque que llega antes también es -EINPROGRESS y se reintenta.
+ *
+ * BEGIN y ABORT van autenticados (downlink_auth.h). La etiqueta del delta se calcula a
+ * medida que se escribe y se persiste con el progreso; el delta solo queda pendiente de
+ * aplicar si coincide con la del BEGIN.
+ */
+
+#ifndef MODEM_DFU_H_
+#define MODEM_DFU_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "downlink.h"
+
+#define MODEM_DFU_SETTINGS_KEY "ntn/mdfu"
+#define MODEM_DFU_APPLY_MARGIN_MS (15 * 60 * 1000)     // Instalación + reconfiguración del módem
+
+// Recupera el progreso persistido. Requiere settings_subsys_init().
+int modem_dfu_init(void);
+
+int modem_dfu_handle_begin(const uint8_t *payload, size_t len, struct downlink_response *resp);
+int modem_dfu_handle_abort(const uint8_t *payload, size_t len);
+
+// Destino bulk: escribe un tramo del delta de la sesión activa en el módem.
+// -EINPROGRESS si el área aún se está borrando; la sesión sigue activa.
+int modem_dfu_write(uint32_t session_id, uint32_t offset, const uint8_t *data, size_t len);
+
+// Cierra la escritura en curso al terminar la ventana de downlink
+void modem_dfu_suspend(void);
+
+// Delta completo y verificado, pendiente de aplicar
+bool modem_dfu_apply_pending(void);
+
+// Programa la instalación: se ejecuta en la siguiente inicialización de la librería del módem
+int modem_dfu_schedule(void);
+
+// Resultado de esa inicialización (NRF_MODEM_DFU_RESULT_*)
+void modem_dfu_result(int result);
+
+#endif /* MODEM_DFU_H_ */
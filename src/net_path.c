@@ -0,0 +1,49 @@
+/*
+ * Archivo: net_path.c
+ * Descripción: Selección TN/NTN. Lógica pura: el tiempo lo aporta el llamador.
+ */
+
+#include <string.h>
+
+#include "net_path.h"
+
+void net_path_init(struct net_path_state *state) {
+    memset(state, 0, sizeof(*state));
+    state->tn_probe_pending = true;
+}
+
+static bool tn_recently_seen(const struct net_path_state *state, int64_t current_time) {
+    return state->tn_last_seen != 0 &&
+           current_time - state->tn_last_seen < TN_AVAILABILITY_TTL_MS &&
+           state->tn_failures < TN_MAX_CONSECUTIVE_FAILURES;
+}
+
+enum net_path net_path_select(struct net_path_state *state, int64_t current_time) {
+    if (tn_recently_seen(state, current_time)) {
+        return NET_PATH_TN;
+    }
+
+    // Sin TN reciente: sondeo acotado para descubrir cobertura nueva
+    if (state->tn_probe_pending || current_time - state->tn_last_probe >= TN_PROBE_INTERVAL_MS) {
+        state->tn_probe_pending = false;
+        state->tn_last_probe = current_time ? current_time : 1;
+        return NET_PATH_TN;
+    }
+    return NET_PATH_NTN;
+}
+
+void net_path_report(struct net_path_state *state, enum net_path path, bool registered, int64_t current_time) {
+    if (path != NET_PATH_TN) {
+        return;
+    }
+    if (registered) {
+        state->tn_last_seen = current_time ? current_time : 1;
+        state->tn_failures = 0;
+    } else if (state->tn_failures < UINT8_MAX) {
+        state->tn_failures++;
+    }
+}
+
+const char *net_path_str(enum net_path path) {
+    return path == NET_PATH_TN ? "TN" : "NTN";
+}
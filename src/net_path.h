@@ -0,0 +1,44 @@
+/*
+ * Archivo: net_path.h
+ * Descripción: Selección en tiempo de ejecución entre red terrestre (TN, LTE-M/NB-IoT)
+ *              y Sateliot NTN (banda 64) a partir de la disponibilidad TN cacheada.
+ */
+
+#ifndef NET_PATH_H_
+#define NET_PATH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// --- DISPONIBILIDAD TERRESTRE CACHEADA ---
+#define TN_AVAILABILITY_TTL_MS (6 * 60 * 60 * 1000)     // TN vista hace menos de 6 h: se usa directamente
+#define TN_PROBE_INTERVAL_MS (24 * 60 * 60 * 1000)      // Sondeo TN como máximo una vez al día
+#define TN_MAX_CONSECUTIVE_FAILURES 2                   // Fallos seguidos antes de volver a NTN
+#define TN_CONNECT_TIMEOUT_S 120                        // Búsqueda de celda terrestre
+#define TN_CYCLE_INTERVAL_S 60                          // Periodo de reporte por TN
+
+enum net_path {
+    NET_PATH_NTN,   // Sateliot banda 64, attachment de dos pasos en el pase
+    NET_PATH_TN     // Red terrestre, latencia de segundos
+};
+
+// Tiempos en ms de uptime (k_uptime_get() en el dispositivo); 0 = nunca
+struct net_path_state {
+    int64_t tn_last_seen;       // Último registro TN correcto
+    int64_t tn_last_probe;      // Último intento TN sin disponibilidad cacheada
+    uint8_t tn_failures;        // Fallos TN consecutivos
+    bool tn_probe_pending;      // Sondeo forzado (arranque en frío)
+};
+
+void net_path_init(struct net_path_state *state);
+
+// Elige la ruta del ciclo actual: TN solo si se vio hace poco o toca sondear.
+// NTN en el resto de casos, sin escanear ambas redes en cada ciclo.
+enum net_path net_path_select(struct net_path_state *state, int64_t current_time);
+
+// Resultado del intento de registro por la ruta elegida
+void net_path_report(struct net_path_state *state, enum net_path path, bool registered, int64_t current_time);
+
+const char *net_path_str(enum net_path path);
+
+#endif /* NET_PATH_H_ */
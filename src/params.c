@@ -0,0 +1,243 @@
+/*
+ * Archivo: params.c
+ * Descripción: Tabla de parámetros, validación y persistencia en settings.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/settings/settings.h>
+#include <string.h>
+
+#include "net_path.h"
+#include "params.h"
+#include "pass_predictor.h"
+#include "telemetry.h"
+#include "tle.h"
+#include "uplink_fec.h"
+
+LOG_MODULE_DECLARE(ntn_app, LOG_LEVEL_INF);
+
+#define PARAM_ENTRY_SIZE 5              // id + valor u32
+
+struct param_desc {
+    const char *name;
+    uint32_t min;
+    uint32_t max;
+};
+
+BUILD_ASSERT(sizeof(struct runtime_params) == PARAM_COUNT * sizeof(uint32_t),
+             "runtime_params must mirror enum param_id");
+
+static const struct param_desc param_table[PARAM_COUNT] = {
+    [PARAM_STEP1_TIMEOUT_S] = { "step1_timeout_s", 5, TX_SLOT_WINDOW_MS / 1000 },
+    [PARAM_STEP2_TIMEOUT_S] = { "step2_timeout_s", 5, TX_SLOT_WINDOW_MS / 1000 },
+    [PARAM_FEEDER_LINK_WAIT_S] = { "feeder_link_wait_s", 0, TX_SLOT_WINDOW_MS / 1000 },
+    [PARAM_GNSS_FIX_TIMEOUT_S] = { "gnss_fix_timeout_s", 30, 900 },
+    [PARAM_TLE_UPDATE_INTERVAL_H] = { "tle_update_interval_h", 1, 168 },
+    [PARAM_SEND_MAX_RETRIES] = { "send_max_retries", 1, 10 },
+    [PARAM_SEND_RETRY_DELAY_S] = { "send_retry_delay_s", 1, 120 },
+    [PARAM_TN_CONNECT_TIMEOUT_S] = { "tn_connect_timeout_s", 30, 600 },
+    [PARAM_TN_CYCLE_INTERVAL_S] = { "tn_cycle_interval_s", 30, 86400 },
+    [PARAM_DOWNLINK_WINDOW_S] = { "downlink_window_s", 0, 120 },
+    [PARAM_MAX_PAYLOAD_BYTES] = { "max_payload_bytes", MIN_BUFFER_SIZE_TELEMETRY, PAYLOAD_BUFFER_SIZE },
+    [PARAM_SERVER_ADDR] = { "server_addr", 1, UINT32_MAX },
+    [PARAM_SERVER_PORT] = { "server_port", 1, UINT16_MAX },
+    [PARAM_FEC_GROUP] = { "fec_group", UPLINK_FEC_MODE_OFF, UPLINK_FEC_MAX_K },
+    [PARAM_SAMPLE_INTERVAL_S] = { "sample_interval_s", 0, 86400 },
+    [PARAM_AGG_INTERVAL_S] = { "agg_interval_s", 0, 7 * 86400 },
+    [PARAM_RBE_HEARTBEAT_S] = { "rbe_heartbeat_s", 0, 7 * 86400 },
+    [PARAM_RBE_BEACON_S] = { "rbe_beacon_s", 0, 7 * 86400 },
+    [PARAM_RBE_POSITION_M] = { "rbe_position_m", 0, 100000 },
+    [PARAM_RBE_VBAT_MV] = { "rbe_vbat_mv", 0, 5000 },
+    [PARAM_RBE_TEMP_C] = { "rbe_temp_c", 0, 100 },
+    [PARAM_RBE_ADC_MV] = { "rbe_adc_mv", 0, 5000 },
+    [PARAM_RBE_VBAT_LOW_MV] = { "rbe_vbat_low_mv", 0, 5000 },
+    [PARAM_TRACK_TOLERANCE_M] = { "track_tolerance_m", 0, 10000 },
+    [PARAM_SAMPLE_INTERVAL_MIN_S] = { "sample_interval_min_s", 0, 86400 },
+};
+
+struct runtime_params rt_params;
+
+static uint32_t *param_slot(struct runtime_params *params, enum param_id id) {
+    return &((uint32_t *)params)[id];
+}
+
+static bool param_in_range(enum param_id id, uint32_t value) {
+    // Sin dirección configurada el envío se cancela, pero la tabla sigue siendo válida
+    if (id == PARAM_SERVER_ADDR && value == 0) {
+        return true;
+    }
+    return value >= param_table[id].min && value <= param_table[id].max;
+}
+
+// La secuencia de attach completa debe caber en el slot que reserva pass_assign_tx_slot()
+static bool params_attach_fits(const struct runtime_params *params) {
+    return params->step1_timeout_s + params->feeder_link_wait_s + params->step2_timeout_s <=
+           TX_SLOT_WINDOW_MS / 1000;
+}
+
+static int params_validate(const struct runtime_params *params) {
+    for (int id = 0; id < PARAM_COUNT; id++) {
+        uint32_t value = *param_slot((struct runtime_params *)params, id);
+
+        if (!param_in_range(id, value)) {
+            LOG_ERR("Parámetro %s fuera de rango: %u [%u, %u]", param_table[id].name, value,
+                    param_table[id].min, param_table[id].max);
+            return -ERANGE;
+        }
+    }
+    if (!params_attach_fits(params)) {
+        LOG_ERR("Step 1 + feeder link + Step 2 = %u s no cabe en el slot de %u s",
+                params->step1_timeout_s + params->feeder_link_wait_s + params->step2_timeout_s,
+                TX_SLOT_WINDOW_MS / 1000);
+        return -ERANGE;
+    }
+    return 0;
+}
+
+void params_init(const char *server_ip, uint32_t server_port) {
+    struct in_addr addr;
+
+    rt_params = (struct runtime_params) {
+        .step1_timeout_s = 20,
+        .step2_timeout_s = 20,
+        .feeder_link_wait_s = 30,
+        .gnss_fix_timeout_s = 180,
+        .tle_update_interval_h = TLE_UPDATE_INTERVAL_HOURS,
+        .send_max_retries = 3,
+        .send_retry_delay_s = 15,
+        .tn_connect_timeout_s = TN_CONNECT_TIMEOUT_S,
+        .tn_cycle_interval_s = TN_CYCLE_INTERVAL_S,
+        .downlink_window_s = 10,
+        .max_payload_bytes = PAYLOAD_BUFFER_SIZE,
+        .server_addr = inet_pton(AF_INET, server_ip, &addr) == 1 ? ntohl(addr.s_addr) : 0,
+        .server_port = server_port,
+        .fec_group = UPLINK_FEC_MODE_OFF,   // Requiere soporte en el servidor VAS
+        .sample_interval_s = 0,
+        .agg_interval_s = 0,
+        .rbe_heartbeat_s = 0,
+        .rbe_beacon_s = 24 * 3600,
+        .rbe_position_m = 100,
+        .rbe_vbat_mv = 100,
+        .rbe_temp_c = 5,
+        .rbe_adc_mv = 50,
+        .rbe_vbat_low_mv = 3300,
+        .track_tolerance_m = 0,
+        .sample_interval_min_s = 0,
+    };
+    if (rt_params.server_addr == 0) {
+        LOG_WRN("Dirección de servidor VAS no válida: %s", server_ip);
+    }
+}
+
+static int params_read(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg, void *param) {
+    struct runtime_params stored;
+    size_t count = MIN(len, sizeof(stored)) / sizeof(uint32_t);
+    size_t prefix = count * sizeof(uint32_t);
+    bool *migrate = param;
+
+    ARG_UNUSED(key);
+
+    // Los ids solo se añaden al final: una tabla de otro firmware comparte el prefijo.
+    // Los ids nuevos conservan su valor por defecto; los sobrantes de una tabla más
+    // larga (firmware más nuevo) se ignoran sin tocar flash.
+    if (read_cb(cb_arg, param_slot(&stored, 0), prefix) != (ssize_t)prefix) {
+        LOG_WRN("Tabla de parámetros ilegible (%u bytes) - valores por defecto", (unsigned int)len);
+        return 0;
+    }
+    for (size_t id = count; id < PARAM_COUNT; id++) {
+        *param_slot(&stored, id) = *param_slot(&rt_params, id);
+    }
+    // Un valor fuera del rango de este firmware vuelve a su defecto sin descartar el resto
+    for (size_t id = 0; id < count; id++) {
+        if (!param_in_range(id, *param_slot(&stored, id))) {
+            LOG_WRN("Parámetro %s persistido fuera de rango: %u - valor por defecto %u",
+                    param_table[id].name, *param_slot(&stored, id), *param_slot(&rt_params, id));
+            *param_slot(&stored, id) = *param_slot(&rt_params, id);
+            *migrate = true;
+        }
+    }
+    if (!params_attach_fits(&stored)) {
+        LOG_WRN("Tiempos de attach persistidos fuera del slot - valores por defecto");
+        stored.step1_timeout_s = rt_params.step1_timeout_s;
+        stored.feeder_link_wait_s = rt_params.feeder_link_wait_s;
+        stored.step2_timeout_s = rt_params.step2_timeout_s;
+        *migrate = true;
+    }
+    *migrate |= count < PARAM_COUNT;
+    rt_params = stored;
+    LOG_INF("Parámetros de campo cargados (%u de %u)", (unsigned int)count, PARAM_COUNT);
+    return 0;
+}
+
+int params_load(void) {
+    bool migrate = false;
+    int err = settings_load_subtree_direct(PARAMS_SETTINGS_KEY, params_read, &migrate);
+
+    if (err) {
+        LOG_ERR("Fallo al cargar parámetros: %d", err);
+        return err;
+    }
+    // Fuera del callback de carga: el backend no admite escrituras mientras recorre flash
+    if (migrate) {
+        err = settings_save_one(PARAMS_SETTINGS_KEY, &rt_params, sizeof(rt_params));
+        if (err) {
+            LOG_WRN("Fallo al reescribir la tabla migrada: %d", err);
+        }
+    }
+    return 0;
+}
+
+static uint32_t get_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+int params_apply_set(const uint8_t *payload, size_t len) {
+    struct runtime_params staged = rt_params;
+    size_t count;
+    int err;
+
+    if (len < 1) {
+        return -EBADMSG;
+    }
+    count = payload[0];
+    if (count == 0 || len != 1 + count * PARAM_ENTRY_SIZE) {
+        LOG_ERR("PARAM_SET mal formado: %u entradas en %u bytes", (unsigned int)count, (unsigned int)len);
+        return -EBADMSG;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *entry = &payload[1 + i * PARAM_ENTRY_SIZE];
+
+        if (entry[0] >= PARAM_COUNT) {
+            LOG_ERR("PARAM_SET: id %u desconocido", entry[0]);
+            return -ENOENT;
+        }
+        *param_slot(&staged, entry[0]) = get_be32(&entry[1]);
+    }
+
+    err = params_validate(&staged);
+    if (err) {
+        return err;
+    }
+
+    // Persistir primero: si la escritura falla la copia activa sigue coincidiendo con flash
+    err = settings_save_one(PARAMS_SETTINGS_KEY, &staged, sizeof(staged));
+    if (err) {
+        LOG_ERR("Fallo al guardar parámetros: %d", err);
+        return err;
+    }
+    rt_params = staged;
+
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *entry = &payload[1 + i * PARAM_ENTRY_SIZE];
+
+        LOG_INF("Parámetro %s = %u", param_table[entry[0]].name, *param_slot(&rt_params, entry[0]));
+    }
+    return 0;
+}
+
+const char *params_name(enum param_id id) {
+    return id < PARAM_COUNT ? param_table[id].name : "desconocido";
+}
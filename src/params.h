@@ -0,0 +1,93 @@
+/*
+ * Archivo: params.h
+ * Descripción: Parámetros de planificación ajustables en campo. Tabla respaldada en
+ *              settings, actualizable por downlink y leída en la ruta caliente desde
+ *              una copia en RAM.
+ */
+
+#ifndef PARAMS_H_
+#define PARAMS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PARAMS_SETTINGS_KEY "ntn/params"
+
+// Identificadores en el downlink: nunca reutilizar ni renumerar, solo añadir al final
+enum param_id {
+    PARAM_STEP1_TIMEOUT_S,          // Espera de Attach Reject (Step 1)
+    PARAM_STEP2_TIMEOUT_S,          // Espera de Attach Accept (Step 2)
+    PARAM_FEEDER_LINK_WAIT_S,       // Pausa entre Step 1 y Step 2. Los tres suman como mucho TX_SLOT_WINDOW_MS
+    PARAM_GNSS_FIX_TIMEOUT_S,
+    PARAM_TLE_UPDATE_INTERVAL_H,
+    PARAM_SEND_MAX_RETRIES,
+    PARAM_SEND_RETRY_DELAY_S,
+    PARAM_TN_CONNECT_TIMEOUT_S,
+    PARAM_TN_CYCLE_INTERVAL_S,
+    PARAM_DOWNLINK_WINDOW_S,        // Escucha de downlink tras el uplink
+    PARAM_MAX_PAYLOAD_BYTES,
+    PARAM_SERVER_ADDR,              // IPv4 del servidor VAS (orden de host)
+    PARAM_SERVER_PORT,
+    PARAM_FEC_GROUP,                // Paridad de uplink: 0 off, 1 adaptativa, 2..16 fija
+    PARAM_SAMPLE_INTERVAL_S,        // Muestreo entre pases (0 = solo en el pase); máximo si es adaptativo
+    PARAM_AGG_INTERVAL_S,           // Intervalo de agregación (0 = muestras en crudo)
+    PARAM_RBE_HEARTBEAT_S,          // Reporte por excepción: heartbeat (0 = desactivado)
+    PARAM_RBE_BEACON_S,             // Baliza de vida mínima (0 = en cada pase sin cambios)
+    PARAM_RBE_POSITION_M,           // Bandas muertas (0 = campo ignorado)
+    PARAM_RBE_VBAT_MV,
+    PARAM_RBE_TEMP_C,
+    PARAM_RBE_ADC_MV,
+    PARAM_RBE_VBAT_LOW_MV,          // Umbral de batería baja (0 = sin umbral)
+    PARAM_TRACK_TOLERANCE_M,        // Desviación máxima al simplificar la trayectoria (0 = off)
+    PARAM_SAMPLE_INTERVAL_MIN_S,    // Muestreo adaptativo entre este y sample_interval_s (0 = off)
+    PARAM_COUNT
+};
+
+// Copia activa: todos los campos son uint32_t en el orden de enum param_id
+struct runtime_params {
+    uint32_t step1_timeout_s;
+    uint32_t step2_timeout_s;
+    uint32_t feeder_link_wait_s;
+    uint32_t gnss_fix_timeout_s;
+    uint32_t tle_update_interval_h;
+    uint32_t send_max_retries;
+    uint32_t send_retry_delay_s;
+    uint32_t tn_connect_timeout_s;
+    uint32_t tn_cycle_interval_s;
+    uint32_t downlink_window_s;
+    uint32_t max_payload_bytes;
+    uint32_t server_addr;
+    uint32_t server_port;
+    uint32_t fec_group;
+    uint32_t sample_interval_s;
+    uint32_t agg_interval_s;
+    uint32_t rbe_heartbeat_s;
+    uint32_t rbe_beacon_s;
+    uint32_t rbe_position_m;
+    uint32_t rbe_vbat_mv;
+    uint32_t rbe_temp_c;
+    uint32_t rbe_adc_mv;
+    uint32_t rbe_vbat_low_mv;
+    uint32_t track_tolerance_m;
+    uint32_t sample_interval_min_s;
+};
+
+// Solo lectura fuera de params.c: se sustituye entera y validada en params_apply_set()
+extern struct runtime_params rt_params;
+
+// Valores por defecto (server_addr desde texto, 0 si no es una IPv4 válida)
+void params_init(const char *server_ip, uint32_t server_port);
+
+// Sustituye los valores por defecto con la tabla persistida. Una tabla de otro
+// firmware aporta su prefijo; los ids nuevos o fuera de rango quedan por defecto
+// y la tabla se reescribe completa.
+int params_load(void);
+
+// Aplica un comando PARAM_SET: [count][count x (id, valor u32 big-endian)].
+// Todo o nada: si un id o valor no es válido, o la secuencia de attach no cabe en
+// el slot, la copia activa no cambia.
+int params_apply_set(const uint8_t *payload, size_t len);
+
+const char *params_name(enum param_id id);
+
+#endif /* PARAMS_H_ */
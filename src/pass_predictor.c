@@ -0,0 +1,182 @@
+/*
+ * Archivo: pass_predictor.c
+ * Descripción: Algoritmo de predicción satelital mejorado para Sateliot SIC-4.
+ *              Sin dependencias de Zephyr ni estado global: el reloj y el
+ *              generador aleatorio los aporta el llamador, de modo que el mismo
+ *              código compila en host (simulación de flota) y en el nRF9151.
+ */
+
+#include <errno.h>
+#include <stddef.h>
+
+#include "pass_predictor.h"
+
+void pass_rng_seed(struct pass_rng *rng, uint32_t seed) {
+    // xorshift32 no admite estado 0
+    rng->state = seed ? seed : 0x9E3779B9;
+}
+
+uint32_t pass_rng_next(struct pass_rng *rng) {
+    uint32_t x = rng->state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng->state = x;
+    return x;
+}
+
+// Mezcla de 32 bits (finalizador de MurmurHash3) para derivar slots y jitter
+static uint32_t mix32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x85EBCA6B;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35;
+    x ^= x >> 16;
+    return x;
+}
+
+static uint32_t pass_hash(const struct satellite_pass *pass, uint32_t device_seed, uint32_t salt) {
+    uint32_t pass_id = (uint32_t)(pass->start_time / 1000) ^ ((uint32_t)pass->satellite_id << 24);
+
+    return mix32(device_seed ^ mix32(pass_id ^ salt));
+}
+
+int calculate_sateliot_satellite_pass(struct satellite_pass *pass, const struct geo_position *ground,
+                                      int64_t current_time, struct pass_rng *rng) {
+    if (!pass || !rng) {
+        return -EINVAL;
+    }
+    
+    if (!ground) {
+        return -ENODATA;
+    }
+    
+    // Algoritmo mejorado basado en especificaciones Sateliot SIC-4
+    // Factor de latitud: más pases en latitudes altas (factor 1.0-1.5)
+    const int64_t abs_lat_udeg = ground->lat_udeg < 0 ? -(int64_t)ground->lat_udeg : ground->lat_udeg;
+    
+    // Predicción basada en ubicación geográfica específica
+    // Barcelona (ejemplo del documento): 2 pases por día (10:00-12:00, 21:00-23:00)
+    int64_t time_since_midnight = current_time % (24 * 60 * 60 * 1000);
+    
+    // Determinar próximo pase basado en patrones típicos de SIC-4
+    int64_t morning_pass_start = 10 * 60 * 60 * 1000; // 10:00
+    int64_t evening_pass_start = 21 * 60 * 60 * 1000; // 21:00
+    
+    int64_t next_pass_start;
+    if (time_since_midnight < morning_pass_start) {
+        // Antes del pase matutino
+        next_pass_start = current_time + (morning_pass_start - time_since_midnight);
+    } else if (time_since_midnight < evening_pass_start) {
+        // Entre pases - próximo es el vespertino
+        next_pass_start = current_time + (evening_pass_start - time_since_midnight);
+    } else {
+        // Después del pase vespertino - próximo es mañana por la mañana
+        next_pass_start = current_time + ((24 * 60 * 60 * 1000) - time_since_midnight) + morning_pass_start;
+    }
+    
+    // Duración del pase: 30 segundos a 8 minutos según especificación
+    int64_t pass_duration = MIN_SATELLITE_PASS_DURATION_MS + 
+                           (pass_rng_next(rng) % (MAX_SATELLITE_PASS_DURATION_MS - MIN_SATELLITE_PASS_DURATION_MS));
+    
+    // Aplicar variación por latitud: duración * (1 + |lat| / 90° * 0.5)
+    pass_duration += (pass_duration * abs_lat_udeg) / (180LL * UDEG_PER_DEG);
+    
+    pass->start_time = next_pass_start;
+    pass->end_time = next_pass_start + pass_duration;
+    pass->max_elevation = 30 + (pass_rng_next(rng) % 56); // 30-85 grados (rango típico)
+    pass->satellite_id = pass_rng_next(rng) % SATELIOT_CONSTELLATION_SIZE; // Cualquiera de los 4 satélites SIC-4
+    pass->is_predicted = true;
+    pass->tx_offset_ms = 0;
+    
+    return 0;
+}
+
+int64_t pass_usable_ms(const struct satellite_pass *pass, int64_t *start_ms) {
+    int64_t duration = pass->end_time - pass->start_time;
+
+    // Pases bajos: solo la parte central tiene enlace fiable (50% a 30°, 100% a 85°)
+    int64_t elevation = pass->max_elevation < 30 ? 30 : (pass->max_elevation > 85 ? 85 : pass->max_elevation);
+    int64_t usable = duration / 2 + (duration / 2) * (elevation - 30) / 55;
+
+    *start_ms = (duration - usable) / 2;
+    return usable;
+}
+
+void pass_assign_tx_slot(struct satellite_pass *pass, uint32_t device_seed) {
+    int64_t usable_start;
+    int64_t usable = pass_usable_ms(pass, &usable_start);
+    int64_t span = usable - TX_SLOT_WINDOW_MS;
+
+    if (span <= 0) {
+        // Pase demasiado corto para repartir: todos al inicio de la zona útil
+        pass->tx_offset_ms = (uint32_t)(usable_start > 0 ? usable_start : 0);
+        return;
+    }
+
+    uint32_t slot_count = (uint32_t)(span / TX_SLOT_SPACING_MS) + 1;
+    uint32_t slot = pass_hash(pass, device_seed, 0) % slot_count;
+
+    pass->tx_offset_ms = (uint32_t)(usable_start + (int64_t)slot * TX_SLOT_SPACING_MS);
+}
+
+uint32_t pass_access_jitter_ms(const struct satellite_pass *pass, uint32_t device_seed) {
+    // Sal fuera del rango de intentos del back-off (1..n) y del slot (0)
+    return pass_hash(pass, device_seed, UINT32_MAX) % TX_SLOT_SPACING_MS;
+}
+
+int64_t pass_wakeup_delay_ms(const struct satellite_pass *pass, int64_t lead_ms, int64_t current_time) {
+    int64_t sleep_ms = pass->start_time + pass->tx_offset_ms - lead_ms - current_time;
+
+    if (sleep_ms <= 0) {
+        return 0;
+    }
+    // Limitar sleep máximo para permitir verificaciones periódicas
+    return sleep_ms < MAX_IDLE_SLEEP_MS ? sleep_ms : MAX_IDLE_SLEEP_MS;
+}
+
+int64_t pass_attach_wait_ms(const struct satellite_pass *pass, int64_t timeout_ms, int64_t current_time) {
+    int64_t remaining = pass->end_time - current_time;
+    int64_t wait = timeout_ms < TX_SLOT_WINDOW_MS ? timeout_ms : TX_SLOT_WINDOW_MS;
+
+    if (remaining <= 0) {
+        return -ETIME;
+    }
+    return wait < remaining ? wait : remaining;
+}
+
+int64_t pass_rach_backoff_ms(const struct satellite_pass *pass, uint32_t device_seed, int attempt,
+                             int64_t current_time) {
+    int shift = attempt < 1 ? 0 : (attempt - 1 > RACH_BACKOFF_MAX_SHIFT ? RACH_BACKOFF_MAX_SHIFT : attempt - 1);
+    int64_t window = (int64_t)RACH_BACKOFF_BASE_MS << shift;
+
+    // Jitter completo en [window/2, window): desincroniza dispositivos que fallaron juntos
+    int64_t backoff = window / 2 + pass_hash(pass, device_seed, (uint32_t)attempt) % (uint32_t)(window / 2);
+
+    if (current_time + backoff + TX_SLOT_WINDOW_MS > pass->end_time) {
+        return -ETIME;
+    }
+    return backoff;
+}
+
+int pass_forecast(const struct satellite_pass *first, const struct geo_position *ground, int64_t horizon_end,
+                  struct pass_rng rng, uint32_t device_seed, struct satellite_pass *out, int max) {
+    int count = 0;
+
+    if (!first || !out || max <= 0) {
+        return -EINVAL;
+    }
+
+    for (struct satellite_pass pass = *first; count < max && pass.start_time < horizon_end; count++) {
+        out[count] = pass;
+
+        int err = calculate_sateliot_satellite_pass(&pass, ground, pass.end_time, &rng);
+
+        if (err) {
+            return err;
+        }
+        pass_assign_tx_slot(&pass, device_seed);
+    }
+    return count;
+}
@@ -0,0 +1,85 @@
+/*
+ * Archivo: pass_predictor.h
+ * Descripción: Predicción de pases de la constelación Sateliot SIC-4.
+ */
+
+#ifndef PASS_PREDICTOR_H_
+#define PASS_PREDICTOR_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "geo_position.h"
+
+#define SATELIOT_CONSTELLATION_SIZE 4   // SIC-4
+
+// --- CONFIGURACIÓN DE LATENCIAS SATELIOT ---
+#define MAX_END_TO_END_DELAY_MS (26 * 60 * 60 * 1000)  // 26 horas máximo
+#define TYPICAL_REVISIT_TIME_MS (12 * 60 * 60 * 1000)   // 12 horas típico
+#define MIN_SATELLITE_PASS_DURATION_MS (30 * 1000)      // 30 segundos mínimo
+#define MAX_SATELLITE_PASS_DURATION_MS (8 * 60 * 1000)  // 8 minutos máximo
+#define MAX_IDLE_SLEEP_MS (30 * 60 * 1000)              // Máximo 30 minutos por sleep
+
+// --- SLOTS DE TRANSMISIÓN POR DISPOSITIVO ---
+#define TX_SLOT_WINDOW_MS (70 * 1000)       // Attach reservado: Step 1 + feeder link + Step 2
+#define TX_SLOT_SPACING_MS (5 * 1000)       // Separación entre slots dentro del pase
+#define RACH_BACKOFF_BASE_MS (2 * 1000)     // Primer back-off tras fallo de acceso
+#define RACH_BACKOFF_MAX_SHIFT 5            // Back-off máximo: base * 32
+
+struct satellite_pass {
+    int64_t start_time;         // Inicio del pase
+    int64_t end_time;           // Fin del pase
+    uint8_t max_elevation;      // Elevación máxima en grados
+    uint8_t satellite_id;       // ID del satélite (0-3 para SIC-4)
+    bool is_predicted;          // Si es predicción o dato real
+    uint32_t tx_offset_ms;      // Inicio del slot de este dispositivo respecto a start_time
+};
+
+// Generador pseudoaleatorio propio (xorshift32): uno por dispositivo, reproducible
+// y seguro para simulaciones multihilo, a diferencia de rand().
+struct pass_rng {
+    uint32_t state;
+};
+
+void pass_rng_seed(struct pass_rng *rng, uint32_t seed);
+uint32_t pass_rng_next(struct pass_rng *rng);
+
+// Próximo pase visible desde ground a partir de current_time (ms de uptime).
+// ground == NULL indica que no hay posición válida (-ENODATA).
+int calculate_sateliot_satellite_pass(struct satellite_pass *pass, const struct geo_position *ground,
+                                      int64_t current_time, struct pass_rng *rng);
+
+// Duración de la zona del pase con enlace fiable (según elevación máxima); *start_ms es
+// su inicio respecto a start_time
+int64_t pass_usable_ms(const struct satellite_pass *pass, int64_t *start_ms);
+
+// Asigna pass->tx_offset_ms: slot determinista a partir de la semilla del dispositivo
+// y la geometría del pase, para que los dispositivos de una zona no accedan a la vez.
+void pass_assign_tx_slot(struct satellite_pass *pass, uint32_t device_seed);
+
+// Retardo del primer acceso dentro del slot, en [0, TX_SLOT_SPACING_MS): los slots van
+// en una rejilla de TX_SLOT_SPACING_MS y dos dispositivos en el mismo slot colisionarían
+// siempre en el primer intento.
+uint32_t pass_access_jitter_ms(const struct satellite_pass *pass, uint32_t device_seed);
+
+// Tiempo a dormir hasta lead_ms antes del slot del pase, acotado a MAX_IDLE_SLEEP_MS
+// (0 si ya toca). lead_ms reserva el fix GNSS, que no puede solaparse con el attach.
+int64_t pass_wakeup_delay_ms(const struct satellite_pass *pass, int64_t lead_ms, int64_t current_time);
+
+// Espera de un paso del attach (Step 1 o Step 2): timeout_ms acotado a TX_SLOT_WINDOW_MS
+// y al fin del pase, para que un intento fallido deje sitio al back-off dentro del mismo
+// pase. -ETIME si el pase ya terminó.
+int64_t pass_attach_wait_ms(const struct satellite_pass *pass, int64_t timeout_ms, int64_t current_time);
+
+// Back-off con jitter tras el intento fallido número attempt (1..n). Devuelve -ETIME
+// si el reintento ya no cabe dentro del pase.
+int64_t pass_rach_backoff_ms(const struct satellite_pass *pass, uint32_t device_seed, int attempt,
+                             int64_t current_time);
+
+// Tabla de pases que empiezan antes de horizon_end: first (el ya planificado) y los
+// siguientes. rng va por valor para no alterar el cursor de planificación del llamador.
+// Devuelve el número de pases (como mucho max) o -errno.
+int pass_forecast(const struct satellite_pass *first, const struct geo_position *ground, int64_t horizon_end,
+                  struct pass_rng rng, uint32_t device_seed, struct satellite_pass *out, int max);
+
+#endif /* PASS_PREDICTOR_H_ */
@@ -0,0 +1,225 @@
+/*
+ * Archivo: recovery.c
+ * Descripción: Escalado de recovery por clase de fallo (decisión, sin acceso al módem).
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <string.h>
+
+#include "recovery.h"
+#include "text_writer.h"
+
+LOG_MODULE_DECLARE(ntn_app, LOG_LEVEL_INF);
+
+// Cambios pendientes de escribir en flash; las escrituras se agrupan antes de dormir
+static bool persist_dirty;
+
+// Escalado por clase: un error AT de configuración no justifica un reset del módem
+static const enum recovery_action escalation[RECOVERY_FAULT_COUNT][MAX_ERROR_RECOVERY_ATTEMPTS] = {
+    [RECOVERY_FAULT_AT_ERROR] = {
+        RECOVERY_RECONFIGURE, RECOVERY_SOFT_MODEM_RESET, RECOVERY_HARD_MODEM_RESET,
+    },
+    [RECOVERY_FAULT_SOCKET] = {
+        RECOVERY_RETRY_NEXT_PASS, RECOVERY_SOFT_MODEM_RESET, RECOVERY_HARD_MODEM_RESET,
+    },
+    [RECOVERY_FAULT_REGISTRATION_TIMEOUT] = {
+        RECOVERY_SOFT_MODEM_RESET, RECOVERY_HARD_MODEM_RESET, RECOVERY_FULL_RESET,
+    },
+    [RECOVERY_FAULT_GNSS_TIMEOUT] = {
+        RECOVERY_GNSS_RESTART, RECOVERY_GNSS_RESTART, RECOVERY_HARD_MODEM_RESET,
+    },
+    [RECOVERY_FAULT_MODEM] = {
+        RECOVERY_HARD_MODEM_RESET, RECOVERY_FULL_RESET, RECOVERY_FULL_RESET,
+    },
+};
+
+void recovery_init(struct error_recovery_state *state) {
+    memset(state, 0, sizeof(*state));
+    state->last_good_state = STATE_IDLE;
+}
+
+void recovery_record_fault(struct error_recovery_state *state, enum recovery_fault fault, int64_t current_time) {
+    if (fault >= RECOVERY_FAULT_COUNT) {
+        fault = RECOVERY_FAULT_MODEM;
+    }
+    if (state->fault_count[fault] < UINT16_MAX) {
+        state->fault_count[fault]++;
+    }
+    if (state->incident_start_time == 0) {
+        state->incident_start_time = current_time ? current_time : 1;
+    }
+    // Cambio de clase: el escalado empieza de nuevo desde la acción más barata
+    if (state->last_fault != fault) {
+        state->recovery_attempts = 0;
+        state->last_fault = fault;
+    }
+    persist_dirty = true;
+}
+
+enum recovery_action recovery_next_action(struct error_recovery_state *state, int64_t current_time) {
+    state->recovery_attempts++;
+    state->last_recovery_time = current_time;
+
+    if (state->recovery_attempts > MAX_ERROR_RECOVERY_ATTEMPTS) {
+        // Nuevo escalado tras el back-off, pero cada agotamiento consecutivo lo duplica
+        state->recovery_attempts = 0;
+        state->passes_to_skip = 1U << state->backoff_level;
+        if (state->backoff_level < RECOVERY_BACKOFF_MAX_LEVEL) {
+            state->backoff_level++;
+        }
+        persist_dirty = true;
+        LOG_ERR("Maximum recovery attempts exceeded - durmiendo %u pases (nivel %u)",
+                state->passes_to_skip, state->backoff_level);
+        return RECOVERY_EXHAUSTED;
+    }
+
+    return escalation[state->last_fault][state->recovery_attempts - 1];
+}
+
+bool recovery_skip_pass(struct error_recovery_state *state) {
+    if (state->passes_to_skip == 0) {
+        return false;
+    }
+    state->passes_to_skip--;
+    persist_dirty = true;
+    return true;
+}
+
+void recovery_mark_success(struct error_recovery_state *state, int64_t current_time) {
+    if (state->recovery_attempts || state->backoff_level || state->passes_to_skip) {
+        persist_dirty = true;
+    }
+    state->recovery_attempts = 0;
+    state->backoff_level = 0;
+    state->passes_to_skip = 0;
+    if (state->incident_start_time == 0) {
+        return;
+    }
+
+    int64_t elapsed = current_time - state->incident_start_time;
+    uint32_t elapsed_ms = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+
+    state->last_time_to_recover_ms = elapsed_ms;
+    if (elapsed_ms > state->max_time_to_recover_ms) {
+        state->max_time_to_recover_ms = elapsed_ms;
+    }
+    state->incident_start_time = 0;
+    persist_dirty = true;
+    LOG_INF("Recovery completo: fallo %s resuelto en %u ms (máx %u ms)",
+            recovery_fault_str(state->last_fault), elapsed_ms, state->max_time_to_recover_ms);
+}
+
+const char *recovery_fault_str(enum recovery_fault fault) {
+    switch (fault) {
+    case RECOVERY_FAULT_AT_ERROR:
+        return "AT";
+    case RECOVERY_FAULT_SOCKET:
+        return "socket";
+    case RECOVERY_FAULT_REGISTRATION_TIMEOUT:
+        return "registro";
+    case RECOVERY_FAULT_GNSS_TIMEOUT:
+        return "GNSS";
+    case RECOVERY_FAULT_MODEM:
+        return "módem";
+    default:
+        return "desconocido";
+    }
+}
+
+void modem_ready_hist_record(struct modem_ready_histogram *hist, uint32_t elapsed_ms) {
+    int idx = 0;
+
+    for (uint32_t limit = MODEM_READY_HIST_BASE_MS;
+         idx < MODEM_READY_HIST_BUCKETS - 1 && elapsed_ms >= limit; limit <<= 1) {
+        idx++;
+    }
+    if (hist->bucket[idx] < UINT16_MAX) {
+        hist->bucket[idx]++;
+    }
+    if (hist->samples < UINT16_MAX) {
+        hist->samples++;
+        hist->total_ms += elapsed_ms;
+    }
+    if (elapsed_ms > hist->max_ms) {
+        hist->max_ms = elapsed_ms;
+    }
+}
+
+size_t modem_ready_hist_format(const struct modem_ready_histogram *hist, char *buf, size_t size) {
+    struct text_writer w;
+
+    tw_init(&w, buf, size);
+    tw_str(&w, "n=");
+    tw_uint(&w, hist->samples, 1);
+    tw_str(&w, " avg=");
+    tw_uint(&w, hist->samples ? hist->total_ms / hist->samples : 0, 1);
+    tw_str(&w, " max=");
+    tw_uint(&w, hist->max_ms, 1);
+    tw_str(&w, " [");
+    for (int i = 0; i < MODEM_READY_HIST_BUCKETS; i++) {
+        if (i) {
+            tw_putc(&w, ' ');
+        }
+        tw_uint(&w, hist->bucket[i], 1);
+    }
+    tw_putc(&w, ']');
+    return w.len;
+}
+
+static int recovery_persist_read(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg,
+                                 void *param) {
+    struct error_recovery_state *state = param;
+    struct error_recovery_state stored;
+
+    // Otro layout (firmware anterior): se ignora y se empieza con historial limpio
+    if (len != sizeof(stored) || read_cb(cb_arg, &stored, sizeof(stored)) != sizeof(stored)) {
+        LOG_WRN("Historial de recovery incompatible (%u bytes) - descartado", (unsigned int)len);
+        return 0;
+    }
+    if (stored.last_fault >= RECOVERY_FAULT_COUNT || stored.recovery_attempts > MAX_ERROR_RECOVERY_ATTEMPTS ||
+        stored.backoff_level > RECOVERY_BACKOFF_MAX_LEVEL ||
+        stored.passes_to_skip > (1U << RECOVERY_BACKOFF_MAX_LEVEL)) {
+        LOG_WRN("Historial de recovery corrupto - descartado");
+        return 0;
+    }
+
+    // El uptime vuelve a 0: un incidente abierto cuenta desde este arranque
+    stored.last_recovery_time = 0;
+    stored.incident_start_time = stored.incident_start_time ? 1 : 0;
+    stored.last_good_state = STATE_IDLE;
+    stored.modem_reset_needed = false;
+    *state = stored;
+    return 0;
+}
+
+int recovery_persist_load(struct error_recovery_state *state) {
+    int err = settings_load_subtree_direct(RECOVERY_SETTINGS_KEY, recovery_persist_read, state);
+
+    if (err) {
+        LOG_ERR("Fallo al cargar historial de recovery: %d", err);
+        return err;
+    }
+    if (state->passes_to_skip) {
+        LOG_WRN("Back-off de recovery activo: %u pases por saltar (fallo %s)",
+                state->passes_to_skip, recovery_fault_str(state->last_fault));
+    }
+    persist_dirty = false;
+    return 0;
+}
+
+int recovery_persist_save(const struct error_recovery_state *state) {
+    if (!persist_dirty) {
+        return 0;
+    }
+
+    int err = settings_save_one(RECOVERY_SETTINGS_KEY, state, sizeof(*state));
+
+    if (err) {
+        LOG_ERR("Fallo al guardar historial de recovery: %d", err);
+        return err;
+    }
+    persist_dirty = false;
+    return 0;
+}
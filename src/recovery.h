@@ -0,0 +1,102 @@
+/*
+ * Archivo: recovery.h
+ * Descripción: Recovery automático de errores críticos clasificado por tipo de
+ *              fallo: cada clase escala desde la acción más barata suficiente.
+ */
+
+#ifndef RECOVERY_H_
+#define RECOVERY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "app_state.h"
+
+#define MAX_ERROR_RECOVERY_ATTEMPTS 3
+
+// Back-off tras agotar el escalado: se saltan 2^nivel pases (1, 2, 4, 8, 16)
+#define RECOVERY_BACKOFF_MAX_LEVEL  4
+
+// Clave de settings con el historial de recovery (sobrevive a cortes de alimentación)
+#define RECOVERY_SETTINGS_KEY       "ntn/recovery"
+
+// Histograma de tiempo hasta módem listo: la cubeta 0 cubre [0, 16) ms, la cubeta i
+// [16·2^(i-1), 16·2^i) ms y la última queda abierta (>= 4096 ms)
+#define MODEM_READY_HIST_BUCKETS    10
+#define MODEM_READY_HIST_BASE_MS    16
+
+struct modem_ready_histogram {
+    uint32_t max_ms;
+    uint32_t total_ms;
+    uint16_t samples;
+    uint16_t bucket[MODEM_READY_HIST_BUCKETS];
+};
+
+// Clase del fallo que originó el recovery
+enum recovery_fault {
+    RECOVERY_FAULT_AT_ERROR,                // Comando AT de configuración rechazado
+    RECOVERY_FAULT_SOCKET,                  // Fallo de socket/envío UDP
+    RECOVERY_FAULT_REGISTRATION_TIMEOUT,    // Sin registro en la red durante el pase
+    RECOVERY_FAULT_GNSS_TIMEOUT,            // Sin fix GNSS y sin posición conocida
+    RECOVERY_FAULT_MODEM,                   // Fallo del módem o de su inicialización
+    RECOVERY_FAULT_COUNT
+};
+
+// Acción que debe ejecutar la aplicación en cada intento de recovery
+enum recovery_action {
+    RECOVERY_RETRY_NEXT_PASS,   // Nada que reparar: reintentar en el próximo ciclo
+    RECOVERY_RECONFIGURE,       // Repetir la configuración AT Sateliot
+    RECOVERY_GNSS_RESTART,      // Parar y arrancar GNSS
+    RECOVERY_SOFT_MODEM_RESET,  // Módem offline
+    RECOVERY_HARD_MODEM_RESET,  // Reset del módem y reconfiguración
+    RECOVERY_FULL_RESET,        // Reinicializar configuración completa
+    RECOVERY_EXHAUSTED          // Intentos agotados, el contador vuelve a 0
+};
+
+// MEJORA v3.2: Estructura para recovery de errores
+struct error_recovery_state {
+    int64_t last_recovery_time;
+    int64_t incident_start_time;        // Primer fallo del incidente en curso (0 = sin incidente)
+    uint32_t last_time_to_recover_ms;   // Duración del último incidente resuelto
+    uint32_t max_time_to_recover_ms;    // Peor duración observada
+    uint16_t fault_count[RECOVERY_FAULT_COUNT];    // Fallos acumulados por clase
+    enum app_state last_good_state;
+    uint8_t recovery_attempts;          // Intentos dentro de la clase de fallo actual
+    uint8_t last_fault;                 // enum recovery_fault del incidente en curso
+    uint8_t backoff_level;              // Escalados agotados consecutivos (cap RECOVERY_BACKOFF_MAX_LEVEL)
+    uint8_t passes_to_skip;             // Pases que se duermen sin intentar conexión
+    bool modem_reset_needed;
+};
+
+void recovery_init(struct error_recovery_state *state);
+
+// Registra un fallo de la clase indicada en current_time (ms de uptime)
+void recovery_record_fault(struct error_recovery_state *state, enum recovery_fault fault, int64_t current_time);
+
+// Registra un intento y devuelve la acción más barata que corresponde al fallo en curso.
+// Al agotar el escalado programa un back-off exponencial en número de pases.
+enum recovery_action recovery_next_action(struct error_recovery_state *state, int64_t current_time);
+
+// Consume un pase del back-off; true si el pase actual debe dormirse sin conectar
+bool recovery_skip_pass(struct error_recovery_state *state);
+
+// MEJORA v3.2: Reset de intentos tras una conexión exitosa; cierra el incidente y
+// actualiza el tiempo de recuperación
+void recovery_mark_success(struct error_recovery_state *state, int64_t current_time);
+
+const char *recovery_fault_str(enum recovery_fault fault);
+
+void modem_ready_hist_record(struct modem_ready_histogram *hist, uint32_t elapsed_ms);
+
+// Formatea "n=<muestras> avg=<ms> max=<ms> [c0 c1 ...]"; devuelve la longitud requerida
+size_t modem_ready_hist_format(const struct modem_ready_histogram *hist, char *buf, size_t size);
+
+// Historial persistente (settings). Las marcas de uptime no sobreviven a un arranque en
+// frío y se descartan al cargar. Requiere settings_subsys_init() previo.
+int recovery_persist_load(struct error_recovery_state *state);
+
+// Escribe en flash solo si el historial cambió desde la última escritura
+int recovery_persist_save(const struct error_recovery_state *state);
+
+#endif /* RECOVERY_H_ */
@@ -0,0 +1,108 @@
+/*
+ * Archivo: report_filter.c
+ * Descripción: Detección de cambios y umbrales para el reporte por excepción.
+ */
+
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include "report_filter.h"
+
+static bool exceeds(int32_t previous, int32_t current, uint32_t deadband) {
+    return deadband > 0 && (uint32_t)abs(current - previous) >= deadband;
+}
+
+static bool crosses(int32_t previous, int32_t current, uint32_t threshold) {
+    return threshold > 0 && ((uint32_t)MAX(previous, 0) >= threshold) != ((uint32_t)MAX(current, 0) >= threshold);
+}
+
+static uint32_t sensor_reasons(const struct sensor_sample *last, const struct sensor_sample *now,
+                               const struct report_thresholds *t) {
+    uint32_t reasons = 0;
+
+    // Un sensor que aparece o desaparece también es un cambio
+    if ((last->valid ^ now->valid) & (SENSOR_VALID_VBAT | SENSOR_VALID_TEMP | SENSOR_VALID_ADC)) {
+        return REPORT_REASON_THRESHOLD;
+    }
+    if (now->valid & SENSOR_VALID_VBAT) {
+        if (exceeds(last->battery_mv, now->battery_mv, t->vbat_mv)) {
+            reasons |= REPORT_REASON_VBAT;
+        }
+        if (crosses(last->battery_mv, now->battery_mv, t->vbat_low_mv)) {
+            reasons |= REPORT_REASON_THRESHOLD;
+        }
+    }
+    if ((now->valid & SENSOR_VALID_TEMP) && exceeds(last->modem_temp_c, now->modem_temp_c, t->temp_c)) {
+        reasons |= REPORT_REASON_TEMP;
+    }
+    if (now->valid & SENSOR_VALID_ADC) {
+        for (uint8_t i = 0; i < now->adc_count && i < SENSOR_ADC_MAX_CHANNELS; i++) {
+            if (exceeds(last->adc_mv[i], now->adc_mv[i], t->adc_mv)) {
+                reasons |= REPORT_REASON_ADC;
+            }
+        }
+    }
+    return reasons;
+}
+
+uint32_t report_filter_evaluate(struct report_filter *f, const struct report_thresholds *t,
+                                const struct uplink_record *record, int64_t now) {
+    uint32_t reasons = 0;
+
+    if (!f->has_last) {
+        reasons |= REPORT_REASON_FIRST;
+    } else {
+        if (now - f->last_report >= (int64_t)t->heartbeat_s * 1000) {
+            reasons |= REPORT_REASON_HEARTBEAT;
+        }
+        if (record->position_valid != f->position_valid ||
+            (record->position_valid && t->position_m > 0 &&
+             geo_distance_m(&f->position, &record->position) >= t->position_m)) {
+            reasons |= REPORT_REASON_POSITION;
+        }
+        reasons |= sensor_reasons(&f->sensors, &record->sensors, t);
+    }
+
+    if (reasons == 0) {
+        if (f->suppressed < UINT16_MAX) {
+            f->suppressed++;
+        }
+        return 0;
+    }
+
+    f->position = record->position;
+    f->position_valid = record->position_valid;
+    f->sensors = record->sensors;
+    f->has_last = true;
+    f->suppressed = 0;
+    f->last_report = now;
+    return reasons;
+}
+
+void report_filter_count_saved(struct report_filter *f, size_t raw_len) {
+    f->bytes_saved += raw_len;
+}
+
+bool report_filter_beacon_due(struct report_filter *f, const struct report_thresholds *t, int64_t now) {
+    if (t->beacon_s == 0 || f->last_uplink == 0 || now - f->last_uplink >= (int64_t)t->beacon_s * 1000) {
+        return true;
+    }
+    f->passes_skipped++;
+    f->radio_ms_saved += f->radio_avg_ms;
+    return false;
+}
+
+void report_filter_beacon(const struct report_filter *f, const struct sensor_sample *sensors,
+                          int64_t now, struct uplink_record *out) {
+    memset(out, 0, sizeof(*out));
+    out->timestamp = now;
+    out->kind = UPLINK_RECORD_BEACON;
+    out->beacon.suppressed = f->suppressed;
+    out->beacon.battery_mv = (sensors->valid & SENSOR_VALID_VBAT) ? sensors->battery_mv : 0;
+}
+
+void report_filter_uplink_done(struct report_filter *f, int64_t now, uint32_t radio_ms) {
+    f->last_uplink = now;
+    // Media móvil 7/8 del coste de radio por pase
+    f->radio_avg_ms = f->radio_avg_ms ? (7 * f->radio_avg_ms + radio_ms) / 8 : radio_ms;
+}
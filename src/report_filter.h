@@ -0,0 +1,72 @@
+/*
+ * Archivo: report_filter.h
+ * Descripción: Reporte por excepción. Un registro solo se encola si algún campo sale
+ *              de su banda muerta, cruza un umbral o vence el heartbeat; los pases sin
+ *              nada que reportar se omiten salvo cuando toca la baliza de vida.
+ *
+ * Bandas muertas a 0 desactivan la comparación de ese campo. Solo se filtran registros
+ * en crudo: los agregados (aggregate.h) ya resumen el intervalo y se envían siempre.
+ */
+
+#ifndef REPORT_FILTER_H_
+#define REPORT_FILTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "telemetry.h"
+
+// Motivos de reporte (máscara devuelta por report_filter_evaluate)
+#define REPORT_REASON_FIRST 0x01
+#define REPORT_REASON_HEARTBEAT 0x02
+#define REPORT_REASON_POSITION 0x04
+#define REPORT_REASON_VBAT 0x08
+#define REPORT_REASON_TEMP 0x10
+#define REPORT_REASON_ADC 0x20
+#define REPORT_REASON_THRESHOLD 0x40
+
+struct report_thresholds {
+    uint32_t heartbeat_s;       // Reporte completo al menos con esta frecuencia (0 = filtro off)
+    uint32_t beacon_s;          // Baliza de vida al menos con esta frecuencia (0 = cada pase)
+    uint32_t position_m;
+    uint32_t vbat_mv;
+    uint32_t temp_c;
+    uint32_t adc_mv;
+    uint32_t vbat_low_mv;       // Umbral: cruzarlo en cualquier sentido se reporta (0 = off)
+};
+
+struct report_filter {
+    struct geo_position position;       // Último valor reportado
+    struct sensor_sample sensors;
+    bool position_valid;
+    bool has_last;
+    uint16_t suppressed;        // Registros suprimidos desde el último reporte
+    int64_t last_report;
+    int64_t last_uplink;        // Último envío de cualquier tipo (reporte o baliza)
+    uint32_t radio_avg_ms;      // Media del tiempo de radio por sesión de envío
+
+    // Ahorro acumulado
+    uint32_t bytes_saved;
+    uint32_t radio_ms_saved;
+    uint32_t passes_skipped;
+};
+
+// Devuelve la máscara de motivos (0 = suprimir). Si se reporta, el registro pasa a ser la
+// nueva referencia.
+uint32_t report_filter_evaluate(struct report_filter *f, const struct report_thresholds *t,
+                                const struct uplink_record *record, int64_t now);
+
+// Registro suprimido: suma al ahorro lo que habría ocupado en crudo (solo se mide si se suprime)
+void report_filter_count_saved(struct report_filter *f, size_t raw_len);
+
+// Pase sin registros: true si toca enviar la baliza; si no, el pase cuenta como omitido
+bool report_filter_beacon_due(struct report_filter *f, const struct report_thresholds *t, int64_t now);
+
+// Construye la baliza de vida con el último dato de batería
+void report_filter_beacon(const struct report_filter *f, const struct sensor_sample *sensors,
+                          int64_t now, struct uplink_record *out);
+
+// Sesión de envío completada: tiempo con la radio encendida
+void report_filter_uplink_done(struct report_filter *f, int64_t now, uint32_t radio_ms);
+
+#endif /* REPORT_FILTER_H_ */
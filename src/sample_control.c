@@ -0,0 +1,93 @@
+/*
+ * Archivo: sample_control.c
+ * Descripción: Previsión de capacidad por pase y búsqueda del intervalo de muestreo.
+ */
+
+#include <zephyr/kernel.h>
+
+#include "sample_control.h"
+
+void sample_control_init(struct sample_control *c) {
+    c->record_ms = SAMPLE_CONTROL_RECORD_MS_DEFAULT;
+    c->attach_ms = SAMPLE_CONTROL_ATTACH_MS_DEFAULT;
+    c->interval_s = 0;
+    c->capacity = 0;
+    c->feasible = true;
+}
+
+// Media móvil 3/4 - 1/4, la misma que la estimación de pérdidas del FEC de uplink
+static uint32_t ewma(uint32_t avg, uint32_t sample) {
+    return (avg * 3 + sample) / 4;
+}
+
+void sample_control_observe(struct sample_control *c, uint32_t attach_ms, uint32_t send_ms, uint32_t records) {
+    if (records == 0) {
+        return;
+    }
+    c->attach_ms = ewma(c->attach_ms, attach_ms);
+    c->record_ms = MAX(ewma(c->record_ms, send_ms / records), 1);
+}
+
+uint32_t sample_control_pass_capacity(const struct sample_control *c, const struct satellite_pass *pass) {
+    int64_t usable_start;
+    int64_t usable_end = pass_usable_ms(pass, &usable_start);
+
+    // El envío empieza en el slot propio tras el attach y dura hasta el final de la zona útil
+    usable_end += usable_start;
+    int64_t window = usable_end - pass->tx_offset_ms - c->attach_ms;
+
+    return window > 0 ? (uint32_t)(window / c->record_ms) : 0;
+}
+
+// Simulación de la cola a lo largo de la tabla con muestreo cada interval_ms
+static bool interval_fits(const struct sample_control *c, const struct satellite_pass *passes, int count,
+                          int64_t last_sample, uint32_t backlog, uint32_t queue_depth, int64_t interval_ms) {
+    uint32_t queued = backlog;
+
+    for (int i = 0; i < count; i++) {
+        int64_t tx_time = passes[i].start_time + passes[i].tx_offset_ms;
+        int64_t produced = tx_time > last_sample ? (tx_time - last_sample) / interval_ms : 0;
+
+        // La muestra del propio pase también se encola
+        last_sample += produced * interval_ms;
+        if (queued + produced + 1 > queue_depth) {
+            return false;
+        }
+        queued += (uint32_t)produced + 1;
+
+        uint32_t capacity = sample_control_pass_capacity(c, &passes[i]);
+
+        queued = queued > capacity ? queued - capacity : 0;
+    }
+    return queued == 0;
+}
+
+uint32_t sample_control_update(struct sample_control *c, const struct satellite_pass *passes, int count,
+                               int64_t last_sample, uint32_t backlog, uint32_t queue_depth, uint32_t min_s,
+                               uint32_t max_s) {
+    uint32_t lo = MAX(MIN(min_s, max_s), 1), hi = MAX(max_s, 1);
+
+    c->capacity = 0;
+    for (int i = 0; i < count; i++) {
+        c->capacity += sample_control_pass_capacity(c, &passes[i]);
+    }
+
+    // Factibilidad monótona en el intervalo: búsqueda binaria del menor que cumple.
+    // Sin pases en el horizonte no hay capacidad que repartir.
+    c->feasible = count > 0 && interval_fits(c, passes, count, last_sample, backlog, queue_depth, (int64_t)hi * 1000);
+    if (!c->feasible) {
+        c->interval_s = hi;
+        return hi;
+    }
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+
+        if (interval_fits(c, passes, count, last_sample, backlog, queue_depth, (int64_t)mid * 1000)) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    c->interval_s = hi;
+    return hi;
+}
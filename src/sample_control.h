@@ -0,0 +1,50 @@
+/*
+ * Archivo: sample_control.h
+ * Descripción: Intervalo de muestreo adaptado a la capacidad de uplink prevista.
+ *
+ * La capacidad de cada pase sale de la tabla de pases prevista (zona útil según elevación,
+ * slot del dispositivo) y de los tiempos de attach y de envío por registro medidos en los
+ * pases anteriores. Se elige el intervalo más corto dentro de [mín, máx] con el que la
+ * cola no desborda entre pases y queda vacía en el último pase del horizonte de 26 h, de
+ * modo que ningún registro espera más que el presupuesto de latencia.
+ *
+ * Cada muestra cuenta como un registro (cota superior: trayectoria y reporte por
+ * excepción solo pueden reducirlos). Con agregación el número de registros no depende
+ * del muestreo y el controlador no interviene.
+ */
+
+#ifndef SAMPLE_CONTROL_H_
+#define SAMPLE_CONTROL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pass_predictor.h"
+
+#define SAMPLE_CONTROL_MAX_PASSES 8
+#define SAMPLE_CONTROL_RECORD_MS_DEFAULT 2000       // Hasta tener medidas propias
+#define SAMPLE_CONTROL_ATTACH_MS_DEFAULT (15 * 1000)
+
+struct sample_control {
+    uint32_t record_ms;         // Media móvil del tiempo de envío por registro
+    uint32_t attach_ms;         // Media móvil del attach, desde el despertar hasta el primer envío
+    uint32_t interval_s;        // Último intervalo elegido
+    uint32_t capacity;          // Registros que caben en los pases del horizonte
+    bool feasible;              // false si ni el intervalo máximo cumple el presupuesto
+};
+
+void sample_control_init(struct sample_control *c);
+
+// Sesión de envío NTN completada con records registros enviados
+void sample_control_observe(struct sample_control *c, uint32_t attach_ms, uint32_t send_ms, uint32_t records);
+
+// Registros que caben en un pase según su zona útil y el slot del dispositivo
+uint32_t sample_control_pass_capacity(const struct sample_control *c, const struct satellite_pass *pass);
+
+// Elige el intervalo para la tabla de pases (ordenada, la primera es la próxima). Las
+// muestras se cuentan desde last_sample, la referencia del muestreo periódico.
+uint32_t sample_control_update(struct sample_control *c, const struct satellite_pass *passes, int count,
+                               int64_t last_sample, uint32_t backlog, uint32_t queue_depth, uint32_t min_s,
+                               uint32_t max_s);
+
+#endif /* SAMPLE_CONTROL_H_ */
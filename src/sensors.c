@@ -0,0 +1,143 @@
+/*
+ * Archivo: sensors.c
+ * Descripción: Lectura de sensores del módem y del ADC con coste instrumentado.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/drivers/adc.h>
+#include <nrf_modem_at.h>
+#include <string.h>
+
+#include "sensors.h"
+
+LOG_MODULE_DECLARE(ntn_app, LOG_LEVEL_INF);
+
+#define ZEPHYR_USER_NODE DT_PATH(zephyr_user)
+
+#if DT_NODE_HAS_PROP(ZEPHYR_USER_NODE, io_channels)
+#define SENSOR_ADC_SPEC(node_id, prop, idx) ADC_DT_SPEC_GET_BY_IDX(node_id, idx),
+
+static const struct adc_dt_spec adc_channels[] = {
+    DT_FOREACH_PROP_ELEM(ZEPHYR_USER_NODE, io_channels, SENSOR_ADC_SPEC)
+};
+
+BUILD_ASSERT(ARRAY_SIZE(adc_channels) <= SENSOR_ADC_MAX_CHANNELS, "too many ADC channels");
+#define SENSOR_ADC_COUNT ARRAY_SIZE(adc_channels)
+#else
+static const struct adc_dt_spec adc_channels[1];
+#define SENSOR_ADC_COUNT 0
+#endif
+
+static const char *const source_names[SENSOR_SRC_COUNT] = { "vbat", "temp", "adc" };
+static struct sensor_cost cost[SENSOR_SRC_COUNT];
+static uint32_t adc_channel_mask;
+static bool adc_ready;
+
+static void sensors_account(enum sensor_source source, uint32_t start_cycles) {
+    uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start_cycles);
+
+    cost[source].samples++;
+    cost[source].total_us += us;
+    cost[source].max_us = MAX(cost[source].max_us, us);
+}
+
+int sensors_init(void) {
+    if (SENSOR_ADC_COUNT == 0) {
+        LOG_INF("Sensores: sin canales ADC en devicetree");
+        return 0;
+    }
+    for (size_t i = 0; i < SENSOR_ADC_COUNT; i++) {
+        if (!adc_is_ready_dt(&adc_channels[i])) {
+            LOG_ERR("ADC no disponible");
+            return -ENODEV;
+        }
+        // Todos los canales en la misma secuencia: un solo disparo del ADC
+        if (adc_channels[i].dev != adc_channels[0].dev) {
+            LOG_ERR("Canales ADC en dispositivos distintos");
+            return -EINVAL;
+        }
+        int err = adc_channel_setup_dt(&adc_channels[i]);
+
+        if (err) {
+            LOG_ERR("Fallo al configurar canal ADC %u: %d", adc_channels[i].channel_id, err);
+            return err;
+        }
+        adc_channel_mask |= BIT(adc_channels[i].channel_id);
+    }
+    adc_ready = true;
+    LOG_INF("Sensores: %u canales ADC", (unsigned int)SENSOR_ADC_COUNT);
+    return 0;
+}
+
+static int sensors_read_adc(struct sensor_sample *out) {
+    int16_t raw[SENSOR_ADC_MAX_CHANNELS];
+    struct adc_sequence sequence = {
+        .channels = adc_channel_mask,
+        .buffer = raw,
+        .buffer_size = sizeof(raw),
+        .resolution = adc_channels[0].resolution,
+        .oversampling = adc_channels[0].oversampling,
+    };
+    int err = adc_read_dt(&adc_channels[0], &sequence);
+
+    if (err) {
+        return err;
+    }
+    // El resultado sale en orden de channel_id, no en el orden de devicetree
+    for (size_t i = 0; i < SENSOR_ADC_COUNT; i++) {
+        uint32_t slot = __builtin_popcount(adc_channel_mask & (BIT(adc_channels[i].channel_id) - 1));
+        int32_t mv = raw[slot];
+
+        // INT16_MIN marca un canal sin conversión a mV (referencia no soportada)
+        err = adc_raw_to_millivolts_dt(&adc_channels[i], &mv);
+        out->adc_mv[i] = err ? INT16_MIN : (int16_t)CLAMP(mv, INT16_MIN + 1, INT16_MAX);
+    }
+    out->adc_count = SENSOR_ADC_COUNT;
+    return 0;
+}
+
+void sensors_sample(struct sensor_sample *out) {
+    uint32_t start;
+    int value;
+
+    memset(out, 0, sizeof(*out));
+
+    start = k_cycle_get_32();
+    if (nrf_modem_at_scanf("AT%XVBAT", "%%XVBAT: %d", &value) == 1 && value > 0) {
+        out->battery_mv = (uint16_t)MIN(value, UINT16_MAX);
+        out->valid |= SENSOR_VALID_VBAT;
+    }
+    sensors_account(SENSOR_SRC_VBAT, start);
+
+    start = k_cycle_get_32();
+    if (nrf_modem_at_scanf("AT%XTEMP?", "%%XTEMP: %d", &value) == 1) {
+        out->modem_temp_c = (int8_t)CLAMP(value, INT8_MIN, INT8_MAX);
+        out->valid |= SENSOR_VALID_TEMP;
+    }
+    sensors_account(SENSOR_SRC_TEMP, start);
+
+    if (adc_ready) {
+        start = k_cycle_get_32();
+        if (sensors_read_adc(out) == 0) {
+            out->valid |= SENSOR_VALID_ADC;
+        }
+        sensors_account(SENSOR_SRC_ADC, start);
+    }
+
+    LOG_DBG("Sensores: vbat %u mV, temp %d C, %u ADC (valid 0x%x)", out->battery_mv,
+            out->modem_temp_c, out->adc_count, out->valid);
+
+    if (cost[SENSOR_SRC_VBAT].samples % SENSOR_COST_LOG_INTERVAL == 0) {
+        for (int i = 0; i < SENSOR_SRC_COUNT; i++) {
+            if (cost[i].samples) {
+                LOG_INF("Coste sensor %s: media %u us, máx %u us (%u muestras)", source_names[i],
+                        cost[i].total_us / cost[i].samples, cost[i].max_us, cost[i].samples);
+            }
+        }
+    }
+}
+
+const struct sensor_cost *sensors_cost(enum sensor_source source) {
+    return &cost[source];
+}
@@ -0,0 +1,55 @@
+/*
+ * Archivo: sensors.h
+ * Descripción: Adquisición de sensores para la telemetría: tensión de batería
+ *              (AT%XVBAT), temperatura del módem (AT%XTEMP) y canales ADC declarados
+ *              en devicetree (zephyr,user io-channels).
+ *
+ * Se muestrea en el mismo despertar que el fix GNSS (ver enqueue_uplink_record) para
+ * no añadir despertares propios; los canales ADC se leen en una única secuencia
+ * (SAADC en modo scan con EasyDMA en el nRF91).
+ */
+
+#ifndef SENSORS_H_
+#define SENSORS_H_
+
+#include <stdint.h>
+
+#define SENSOR_ADC_MAX_CHANNELS 4
+#define SENSOR_COST_LOG_INTERVAL 16     // Muestras entre resúmenes de coste
+
+// Bits de sensor_sample.valid
+#define SENSOR_VALID_VBAT 0x01
+#define SENSOR_VALID_TEMP 0x02
+#define SENSOR_VALID_ADC 0x04
+
+enum sensor_source {
+    SENSOR_SRC_VBAT,
+    SENSOR_SRC_TEMP,
+    SENSOR_SRC_ADC,
+    SENSOR_SRC_COUNT
+};
+
+struct sensor_sample {
+    int16_t adc_mv[SENSOR_ADC_MAX_CHANNELS];
+    uint16_t battery_mv;
+    int8_t modem_temp_c;
+    uint8_t adc_count;
+    uint8_t valid;              // SENSOR_VALID_*
+};
+
+// Coste por fuente, medido en ciclos alrededor de cada lectura
+struct sensor_cost {
+    uint32_t samples;
+    uint32_t total_us;
+    uint32_t max_us;
+};
+
+// Configura los canales ADC. Sin canales en devicetree solo se usan los del módem.
+int sensors_init(void);
+
+// Una pasada por todas las fuentes; las que fallan quedan sin su bit en valid
+void sensors_sample(struct sensor_sample *out);
+
+const struct sensor_cost *sensors_cost(enum sensor_source source);
+
+#endif /* SENSORS_H_ */
@@ -0,0 +1,229 @@
+/*
+ * Archivo: telemetry.c
+ * Descripción: Validación de buffers y codificación JSON de la telemetría.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "geofence.h"
+#include "telemetry.h"
+#include "text_writer.h"
+
+LOG_MODULE_DECLARE(ntn_app, LOG_LEVEL_INF);
+
+#define TELEMETRY_JSON_TAIL ",\"ntn\":\"sateliot\"}"
+
+// MEJORA v3.2: Validación robusta de buffers
+bool validate_buffer_safety(size_t buffer_size, size_t required_size) {
+    if (buffer_size < required_size + TELEMETRY_SAFETY_MARGIN) {
+        LOG_ERR("Buffer validation failed: size=%zu, required=%zu, margin=%d", 
+                buffer_size, required_size, TELEMETRY_SAFETY_MARGIN);
+        return false;
+    }
+    return true;
+}
+
+// Sensores válidos: "vbat":mV,"temp":C,"adc":[mV,...]. Si no caben junto con el cierre del
+// JSON se omiten y el registro sale solo con la posición.
+static void format_sensor_fields(struct text_writer *w, const struct sensor_sample *s) {
+    size_t mark = w->len;
+
+    if (s->valid & SENSOR_VALID_VBAT) {
+        tw_str(w, ",\"vbat\":");
+        tw_int(w, s->battery_mv);
+    }
+    if (s->valid & SENSOR_VALID_TEMP) {
+        tw_str(w, ",\"temp\":");
+        tw_int(w, s->modem_temp_c);
+    }
+    if ((s->valid & SENSOR_VALID_ADC) && s->adc_count > 0) {
+        tw_str(w, ",\"adc\":[");
+        for (uint8_t i = 0; i < s->adc_count && i < SENSOR_ADC_MAX_CHANNELS; i++) {
+            if (i > 0) {
+                tw_putc(w, ',');
+            }
+            tw_int(w, s->adc_mv[i]);
+        }
+        tw_putc(w, ']');
+    }
+    if (w->len + sizeof(TELEMETRY_JSON_TAIL) > w->size) {
+        LOG_WRN("Campos de sensores omitidos: no caben en %zu bytes", w->size);
+        tw_truncate(w, mark);
+    }
+}
+
+// Registro agregado: "dur":s,"n":muestras y por métrica "clave":[min,max,media,desv] (con
+// el número de muestras como quinto valor si la métrica no estuvo en todas). Las métricas
+// que no caben se omiten enteras.
+static const char *const agg_keys[AGG_METRIC_COUNT] = { "v", "t", "s", "a0", "a1", "a2", "a3" };
+
+BUILD_ASSERT(AGG_METRIC_COUNT == 7, "agg_keys must cover every metric");
+
+static void format_aggregate_fields(struct text_writer *w, const struct agg_summary *agg) {
+    tw_str(w, ",\"dur\":");
+    tw_int(w, agg->duration_s);
+    tw_str(w, ",\"n\":");
+    tw_int(w, agg->samples);
+
+    for (int i = 0; i < AGG_METRIC_COUNT; i++) {
+        const struct agg_stats *m = &agg->metric[i];
+        size_t mark = w->len;
+
+        if (m->count == 0) {
+            continue;
+        }
+        tw_str(w, ",\"");
+        tw_str(w, agg_keys[i]);
+        tw_str(w, "\":[");
+        tw_int(w, m->min);
+        tw_putc(w, ',');
+        tw_int(w, m->max);
+        tw_putc(w, ',');
+        tw_int(w, m->mean);
+        tw_putc(w, ',');
+        tw_int(w, m->stddev);
+        if (m->count != agg->samples) {
+            tw_putc(w, ',');
+            tw_int(w, m->count);
+        }
+        tw_putc(w, ']');
+        if (w->len + sizeof(TELEMETRY_JSON_TAIL) > w->size) {
+            LOG_WRN("Métrica %s omitida: no cabe en %zu bytes", agg_keys[i], w->size);
+            tw_truncate(w, mark);
+        }
+    }
+}
+
+// Baliza: {"ts":%lld,"alive":suprimidos[,"vbat":mV],"ntn":"sateliot"}, sin posición
+static int format_beacon(char *buffer, size_t buffer_size, const struct uplink_record *record) {
+    struct text_writer w;
+
+    tw_init(&w, buffer, buffer_size);
+    tw_str(&w, "{\"ts\":");
+    tw_int(&w, record->timestamp);
+    tw_str(&w, ",\"alive\":");
+    tw_int(&w, record->beacon.suppressed);
+    if (record->beacon.battery_mv) {
+        tw_str(&w, ",\"vbat\":");
+        tw_int(&w, record->beacon.battery_mv);
+    }
+    tw_str(&w, TELEMETRY_JSON_TAIL);
+    return w.len < buffer_size ? 0 : -ENOMEM;
+}
+
+// MEJORA v3.2: Validación robusta en format_telemetry_data
+// Con agg el registro es solo la cabecera (ts y posición) del intervalo agregado
+static int format_record(char *buffer, size_t buffer_size, const struct uplink_record *record,
+                         const struct agg_summary *agg) {
+    if (!buffer || buffer_size == 0 || !record) {
+        LOG_ERR("Invalid parameters: buffer=%p, size=%zu", buffer, buffer_size);
+        return -EINVAL;
+    }
+
+    // MEJORA v3.2: Validación robusta del tamaño del buffer
+    if (!validate_buffer_safety(buffer_size, MIN_BUFFER_SIZE_TELEMETRY)) {
+        LOG_ERR("Buffer size validation failed for telemetry data");
+        return -ENOMEM;
+    }
+
+    if (record->kind == UPLINK_RECORD_BEACON) {
+        return format_beacon(buffer, buffer_size, record);
+    }
+
+    // MEJORA v3.2: Validación previa del tamaño requerido
+    const size_t estimated_size = 120; // Estimación conservadora del JSON
+    if (buffer_size < estimated_size + TELEMETRY_SAFETY_MARGIN) {
+        LOG_ERR("Buffer insufficient for telemetry: need %zu, have %zu", 
+                estimated_size + TELEMETRY_SAFETY_MARGIN, buffer_size);
+        return -ENOMEM;
+    }
+
+    static const struct geo_position no_position;
+    const struct geo_position *pos = record->position_valid ? &record->position : &no_position;
+    struct text_writer w;
+
+    // Formato: {"ts":%lld,"lat":%.6f,"lon":%.6f,"alt":%.1f,"sats":%d[,sensores],"ntn":"sateliot"}
+    // Agregado: {"ts":..,"lat":..,"lon":..,"alt":..,"dur":%u,"n":%u[,métricas],"ntn":"sateliot"}
+    // Geocerca: {"ts":..,"lat":..,"lon":..,"alt":..,"fence":%u,"ev":"enter"|"exit","ntn":"sateliot"}
+    tw_init(&w, buffer, buffer_size);
+    tw_str(&w, "{\"ts\":");
+    tw_int(&w, record->timestamp);
+    tw_str(&w, ",\"lat\":");
+    tw_udeg(&w, pos->lat_udeg);
+    tw_str(&w, ",\"lon\":");
+    tw_udeg(&w, pos->lon_udeg);
+    tw_str(&w, ",\"alt\":");
+    tw_dm(&w, pos->alt_dm);
+    if (agg) {
+        format_aggregate_fields(&w, agg);
+    } else if (record->kind == UPLINK_RECORD_GEOFENCE) {
+        tw_str(&w, ",\"fence\":");
+        tw_int(&w, record->fence.fence_id);
+        tw_str(&w, record->fence.transition == GEOFENCE_ENTER ? ",\"ev\":\"enter\"" : ",\"ev\":\"exit\"");
+    } else {
+        tw_str(&w, ",\"sats\":");
+        tw_int(&w, record->sats);
+        format_sensor_fields(&w, &record->sensors);
+    }
+    tw_str(&w, TELEMETRY_JSON_TAIL);
+
+    int ret = (int)w.len;
+    
+    if (ret >= buffer_size) {
+        LOG_ERR("Buffer overflow prevented: needed %d, have %zu", ret, buffer_size);
+        return -ENOMEM;
+    }
+    
+    // MEJORA v3.2: Verificación final del contenido
+    if (ret < 50) { // JSON muy pequeño, probablemente inválido
+        LOG_ERR("Generated telemetry suspiciously small: %d bytes", ret);
+        return -EFAULT;
+    }
+    
+    if (agg && agg->raw_bytes > 0) {
+        LOG_INF("Agregado de %u muestras: %d bytes frente a %u en crudo (%d%%)", agg->samples,
+                ret, agg->raw_bytes, ret * 100 / agg->raw_bytes);
+    }
+    LOG_DBG("Telemetry formatted successfully: %d bytes", ret);
+    return 0;
+}
+
+// Solo al enviar: la medida de telemetry_raw_len() no avisa por cada muestra sin fix
+static void warn_no_position(bool position_valid) {
+    if (!position_valid) {
+        LOG_WRN("GPS coordinates not valid, using last known position");
+        // Usar coordenadas por defecto o return error según política
+    }
+}
+
+int format_telemetry_data(char *buffer, size_t buffer_size, const struct uplink_record *record) {
+    if (record && record->kind != UPLINK_RECORD_BEACON) {
+        warn_no_position(record->position_valid);
+    }
+    return format_record(buffer, buffer_size, record, NULL);
+}
+
+int format_aggregate_data(char *buffer, size_t buffer_size, const struct uplink_aggregate *aggregate) {
+    if (!aggregate) {
+        return format_record(buffer, buffer_size, NULL, NULL);
+    }
+
+    struct uplink_record header = {
+        .timestamp = aggregate->timestamp,
+        .position = aggregate->position,
+        .sats = aggregate->sats,
+        .position_valid = aggregate->position_valid,
+    };
+
+    warn_no_position(aggregate->position_valid);
+    return format_record(buffer, buffer_size, &header, &aggregate->summary);
+}
+
+size_t telemetry_raw_len(char *buffer, size_t buffer_size, const struct uplink_record *record) {
+    if (format_record(buffer, buffer_size, record, NULL) != 0) {
+        return 0;
+    }
+    return strlen(buffer);
+}
@@ -0,0 +1,74 @@
+/*
+ * Archivo: telemetry.h
+ * Descripción: Registros de uplink y codificación JSON de la telemetría.
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "aggregate.h"
+#include "geo_position.h"
+#include "sensors.h"
+
+#define MIN_BUFFER_SIZE_TELEMETRY 128
+#define PAYLOAD_BUFFER_SIZE 256
+#define TELEMETRY_SAFETY_MARGIN 32
+
+// Registro de telemetría pendiente de envío (pool estático, ver uplink_msgq)
+enum uplink_record_kind {
+    UPLINK_RECORD_RAW,          // Una muestra
+    UPLINK_RECORD_BEACON,       // Baliza de vida del reporte por excepción (ver report_filter.h)
+    UPLINK_RECORD_GEOFENCE      // Entrada/salida de una geocerca (ver geofence.h)
+};
+
+struct uplink_beacon {
+    uint16_t suppressed;        // Registros sin cambios desde el último reporte
+    uint16_t battery_mv;        // 0 si no hay lectura
+};
+
+struct uplink_geofence {
+    uint16_t fence_id;
+    uint8_t transition;         // enum geofence_transition
+};
+
+struct uplink_record {
+    int64_t timestamp;          // Uptime de la muestra
+    struct geo_position position;
+    union {
+        struct sensor_sample sensors;   // UPLINK_RECORD_RAW
+        struct uplink_beacon beacon;    // UPLINK_RECORD_BEACON
+        struct uplink_geofence fence;   // UPLINK_RECORD_GEOFENCE
+    };
+    uint8_t sats;               // Satélites usados en el fix
+    bool position_valid;
+    uint8_t kind;               // enum uplink_record_kind
+};
+
+// Resumen de un intervalo (ver aggregate.h). Va en su propia cola (uplink_agg_msgq): con
+// el resumen en la unión cada entrada de uplink_msgq ocuparía lo mismo que un agregado.
+struct uplink_aggregate {
+    int64_t timestamp;          // Fin del intervalo
+    struct geo_position position;   // Última del intervalo
+    uint8_t sats;
+    bool position_valid;
+    struct agg_summary summary;
+};
+
+// MEJORA v3.2: Validación robusta de buffers
+bool validate_buffer_safety(size_t buffer_size, size_t required_size);
+
+// Codifica un registro como JSON en buffer. 0 si cabe completo, -errno si no.
+int format_telemetry_data(char *buffer, size_t buffer_size, const struct uplink_record *record);
+
+// Igual para un intervalo agregado, con la misma cabecera de posición
+int format_aggregate_data(char *buffer, size_t buffer_size, const struct uplink_aggregate *aggregate);
+
+// Longitud que tendría el registro en crudo (0 si no cabe), para medir el ahorro de la
+// agregación y del reporte por excepción. buffer es solo espacio de trabajo; sin avisos.
+size_t telemetry_raw_len(char *buffer, size_t buffer_size, const struct uplink_record *record);
+
+#endif /* TELEMETRY_H_ */
@@ -0,0 +1,100 @@
+/*
+ * Archivo: text_writer.c
+ * Descripción: Formateador entero (ver text_writer.h).
+ */
+
+#include "text_writer.h"
+#include "geo_position.h"
+
+void tw_init(struct text_writer *w, char *buf, size_t size) {
+    w->buf = buf;
+    w->size = size;
+    w->len = 0;
+    if (size > 0) {
+        buf[0] = '\0';
+    }
+}
+
+void tw_putc(struct text_writer *w, char c) {
+    // Siempre se reserva espacio para el terminador, igual que snprintf
+    if (w->len + 1 < w->size) {
+        w->buf[w->len] = c;
+        w->buf[w->len + 1] = '\0';
+    }
+    w->len++;
+}
+
+void tw_str(struct text_writer *w, const char *str) {
+    while (*str) {
+        tw_putc(w, *str++);
+    }
+}
+
+// Entero sin signo con relleno de ceros hasta min_digits
+void tw_uint(struct text_writer *w, uint64_t value, int min_digits) {
+    char digits[20];
+    int n = 0;
+
+    // Ruta de 32 bits: evita la división de 64 bits emulada en el M33
+    if (value <= UINT32_MAX) {
+        uint32_t v32 = (uint32_t)value;
+        do {
+            digits[n++] = '0' + (v32 % 10);
+            v32 /= 10;
+        } while (v32);
+    } else {
+        do {
+            digits[n++] = '0' + (value % 10);
+            value /= 10;
+        } while (value);
+    }
+    while (n < min_digits && n < (int)sizeof(digits)) {
+        digits[n++] = '0';
+    }
+    while (n > 0) {
+        tw_putc(w, digits[--n]);
+    }
+}
+
+void tw_int(struct text_writer *w, int64_t value) {
+    if (value < 0) {
+        tw_putc(w, '-');
+        tw_uint(w, 0 - (uint64_t)value, 1);
+    } else {
+        tw_uint(w, (uint64_t)value, 1);
+    }
+}
+
+// Punto fijo: magnitude / scale con 'decimals' decimales (scale = 10^decimals)
+void tw_fixed(struct text_writer *w, bool negative, uint32_t magnitude,
+                     uint32_t scale, int decimals) {
+    if (negative) {
+        tw_putc(w, '-');
+    }
+    tw_uint(w, magnitude / scale, 1);
+    tw_putc(w, '.');
+    tw_uint(w, magnitude % scale, decimals);
+}
+
+// Micro-grados con 6 decimales (mismo texto que %.6f)
+void tw_udeg(struct text_writer *w, int32_t udeg) {
+    uint32_t magnitude = udeg < 0 ? 0 - (uint32_t)udeg : (uint32_t)udeg;
+    tw_fixed(w, udeg < 0, magnitude, UDEG_PER_DEG, 6);
+}
+
+// Decímetros como metros con 1 decimal (mismo texto que %.1f). El redondeo ya se hizo
+// al convertir el fix (ver geo_position_from_fix): aquí no se vuelve a redondear.
+void tw_dm(struct text_writer *w, int32_t dm) {
+    uint32_t magnitude = dm < 0 ? 0 - (uint32_t)dm : (uint32_t)dm;
+    tw_fixed(w, dm < 0, magnitude, 10, 1);
+}
+
+void tw_truncate(struct text_writer *w, size_t len) {
+    if (len >= w->len) {
+        return;
+    }
+    w->len = len;
+    if (len < w->size) {
+        w->buf[len] = '\0';
+    }
+}
@@ -0,0 +1,33 @@
+/*
+ * Archivo: text_writer.h
+ * Descripción: Formateador entero para telemetría y comandos AT. Sustituye a
+ *              snprintf en la ruta caliente para poder deshabilitar el
+ *              soporte de coma flotante de printf.
+ */
+
+#ifndef TEXT_WRITER_H_
+#define TEXT_WRITER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct text_writer {
+    char *buf;
+    size_t size;
+    size_t len;                 // Longitud requerida (como snprintf), aunque se trunque
+};
+
+void tw_init(struct text_writer *w, char *buf, size_t size);
+void tw_putc(struct text_writer *w, char c);
+void tw_str(struct text_writer *w, const char *str);
+void tw_uint(struct text_writer *w, uint64_t value, int min_digits);
+void tw_int(struct text_writer *w, int64_t value);
+void tw_fixed(struct text_writer *w, bool negative, uint32_t magnitude, uint32_t scale, int decimals);
+void tw_udeg(struct text_writer *w, int32_t udeg);
+void tw_dm(struct text_writer *w, int32_t dm);
+
+// Descarta lo escrito a partir de len (campos opcionales que no caben)
+void tw_truncate(struct text_writer *w, size_t len);
+
+#endif /* TEXT_WRITER_H_ */
@@ -0,0 +1,282 @@
+/*
+ * Archivo: tle.c
+ * Descripción: Parser de TLE a elementos binarios y política de actualización.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "tle.h"
+
+LOG_MODULE_DECLARE(ntn_app, LOG_LEVEL_INF);
+
+// Salta espacios y devuelve el inicio del siguiente token (o NULL al final)
+static const char *tle_next_token(const char *p) {
+    while (*p == ' ') {
+        p++;
+    }
+    return *p ? p : NULL;
+}
+
+static const char *tle_skip_token(const char *p) {
+    while (*p && *p != ' ') {
+        p++;
+    }
+    return p;
+}
+
+static bool tle_is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Decimal en punto fijo: "97.7148" con decimals=4 -> 977148. Dígitos extra se truncan.
+// Rechaza valores que no caben en 32 bits (entrada no confiable).
+static int tle_parse_fixed(const char **p, int decimals, uint32_t *out) {
+    const char *c = *p;
+    uint32_t value = 0;
+    int digits = 0;
+
+    while (tle_is_digit(*c)) {
+        if (value > (UINT32_MAX - 9) / 10) {
+            return -ERANGE;
+        }
+        value = value * 10 + (*c++ - '0');
+        digits++;
+    }
+    if (*c == '.') {
+        c++;
+    }
+    for (int i = 0; i < decimals; i++) {
+        if (value > (UINT32_MAX - 9) / 10) {
+            return -ERANGE;
+        }
+        value *= 10;
+        if (tle_is_digit(*c)) {
+            value += *c++ - '0';
+            digits++;
+        }
+    }
+    while (tle_is_digit(*c)) {
+        c++;
+    }
+    if (digits == 0) {
+        return -EINVAL;
+    }
+    *out = value;
+    *p = c;
+    return 0;
+}
+
+// Suma de control módulo 10 (dígitos, '-' cuenta 1) sobre todo salvo el último carácter
+static bool tle_checksum_ok(const char *line, size_t len) {
+    uint32_t sum = 0;
+
+    for (size_t i = 0; i + 1 < len; i++) {
+        if (tle_is_digit(line[i])) {
+            sum += line[i] - '0';
+        } else if (line[i] == '-') {
+            sum += 1;
+        }
+    }
+    return tle_is_digit(line[len - 1]) && (sum % 10) == (uint32_t)(line[len - 1] - '0');
+}
+
+// Longitud, caracteres imprimibles, número de línea y suma de control
+static int tle_validate_line(const char *line, char line_number) {
+    size_t len = strnlen(line, TLE_LINE_MAX_LEN + 1);
+
+    if (len < TLE_LINE_MIN_LEN || len > TLE_LINE_MAX_LEN || line[0] != line_number || line[1] != ' ') {
+        return -EINVAL;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (line[i] < 0x20 || line[i] > 0x7e) {
+            return -EINVAL;
+        }
+    }
+    return tle_checksum_ok(line, len) ? 0 : -EBADMSG;
+}
+
+// Época TLE "YYDDD.DDDDDDDD" a segundos Unix (día con 5 decimales, < 1 s de error)
+static uint32_t tle_epoch_to_unix(uint32_t year2, uint32_t day_e5) {
+    uint32_t year = year2 < 57 ? 2000 + year2 : 1900 + year2;
+    uint32_t days = 365 * (year - 1970) + (year - 1969) / 4 - (year - 1901) / 100 + (year - 1601) / 400;
+    uint32_t day_of_year = day_e5 / 100000;
+    uint32_t day_fraction_s = ((day_e5 % 100000) * 864) / 1000;
+
+    return (days + day_of_year - 1) * 86400 + day_fraction_s;
+}
+
+int parse_tle(const struct sateliot_tle_text *text, struct tle_elements *out) {
+    struct tle_elements elements = { 0 };
+    const char *p;
+    uint32_t epoch_day_e5;
+    uint32_t catalog_line2;
+    uint32_t values[6];
+    // La excentricidad lleva el punto decimal implícito: sus dígitos ya son * 1e7
+    static const int decimals[6] = { 4, 4, 0, 4, 4, 8 };
+    // Máximos admitidos: inclinación 180°, ángulos < 360°, mov. medio < 20 rev/día
+    static const uint32_t limits[6] = { 1800000, 3600000, 9999999, 3600000, 3600000, 2000000000 };
+    int err;
+
+    if (!text || !out || !text->line1 || !text->line2) {
+        return -EINVAL;
+    }
+    err = tle_validate_line(text->line1, '1');
+    if (!err) {
+        err = tle_validate_line(text->line2, '2');
+    }
+    if (err) {
+        return err;
+    }
+
+    // Línea 1: número de catálogo y época (primer token de forma YYDDD.ddd)
+    p = tle_next_token(text->line1 + 1);
+    if (!p || tle_parse_fixed(&p, 0, &elements.catalog_number)) {
+        return -EINVAL;
+    }
+    for (p = tle_next_token(p); p; p = tle_next_token(tle_skip_token(p))) {
+        if (tle_skip_token(p) - p > 6 && p[5] == '.') {
+            break;
+        }
+    }
+    if (!p || !tle_is_digit(p[0]) || !tle_is_digit(p[1])) {
+        return -EINVAL;
+    }
+    uint32_t year2 = (p[0] - '0') * 10 + (p[1] - '0');
+    p += 2;
+    if (tle_parse_fixed(&p, 5, &epoch_day_e5) || epoch_day_e5 < 100000 || epoch_day_e5 >= 36700000) {
+        return -EINVAL;
+    }
+    elements.epoch_s = tle_epoch_to_unix(year2, epoch_day_e5);
+
+    // Línea 2: catálogo, inclinación, RAAN, excentricidad, arg. perigeo, anomalía, mov. medio
+    p = tle_next_token(text->line2 + 1);
+    if (!p || tle_parse_fixed(&p, 0, &catalog_line2) || catalog_line2 != elements.catalog_number) {
+        return -EINVAL;
+    }
+    p = tle_next_token(p);
+    for (int i = 0; i < 6; i++) {
+        if (!p || tle_parse_fixed(&p, decimals[i], &values[i]) || values[i] > limits[i]) {
+            return -EINVAL;
+        }
+        p = tle_next_token(p);
+    }
+    if (values[5] == 0) {
+        return -EINVAL;
+    }
+    elements.inclination_e4 = values[0];
+    elements.raan_e4 = values[1];
+    elements.eccentricity_e7 = values[2];
+    elements.arg_perigee_e4 = values[3];
+    elements.mean_anomaly_e4 = values[4];
+    elements.mean_motion_e8 = values[5];
+    elements.valid = true;
+
+    *out = elements;
+    return 0;
+}
+
+int tle_ingest(const uint8_t *data, size_t len, struct tle_elements *out) {
+    char lines[3][TLE_LINE_MAX_LEN + 1];
+    size_t line_count = 0;
+    size_t col = 0;
+
+    if (!data || !out || len > TLE_INGEST_MAX_LEN) {
+        return -EINVAL;
+    }
+
+    // Partir en líneas sin asumir terminador NUL; se ignoran '\r' y líneas vacías
+    for (size_t i = 0; i <= len; i++) {
+        char c = i < len ? (char)data[i] : '\n';
+
+        if (c == '\r') {
+            continue;
+        }
+        if (c == '\n' || c == '\0') {
+            if (col > 0) {
+                lines[line_count][col] = '\0';
+                line_count++;
+                col = 0;
+            }
+            if (c == '\0') {
+                break;
+            }
+            continue;
+        }
+        if (line_count == ARRAY_SIZE(lines) || col == TLE_LINE_MAX_LEN) {
+            return -EMSGSIZE;
+        }
+        lines[line_count][col++] = c;
+    }
+
+    // Formato de 2 líneas o de 3 (nombre del satélite + 2 líneas)
+    if (line_count < 2) {
+        return -EINVAL;
+    }
+    struct sateliot_tle_text text = {
+        .line1 = lines[line_count - 2],
+        .line2 = lines[line_count - 1],
+    };
+
+    return parse_tle(&text, out);
+}
+
+void tle_update_init(struct tle_update_config *cfg) {
+    cfg->last_update_time = 0;
+    cfg->update_interval_hours = TLE_UPDATE_INTERVAL_HOURS;
+    cfg->update_needed = true;
+    cfg->consecutive_failures = 0;
+}
+
+bool tle_update_due(const struct tle_update_config *cfg, int64_t now) {
+    return cfg->update_needed ||
+           (now - cfg->last_update_time) > ((int64_t)cfg->update_interval_hours * 60 * 60 * 1000);
+}
+
+// MEJORA v3.2: Sistema de actualización automática de TLEs
+int tle_update_evaluate(struct tle_update_config *cfg, uint16_t base_interval_hours,
+                        const struct tle_elements *satellites, size_t count, int64_t current_time) {
+    int64_t hours_since_update = (current_time - cfg->last_update_time) / (60 * 60 * 1000);
+    
+    if (hours_since_update < cfg->update_interval_hours && !cfg->update_needed) {
+        LOG_DBG("TLE update not needed yet. Hours since last: %lld", hours_since_update);
+        return 0;
+    }
+    
+    LOG_INF("Initiating TLE update process...");
+    
+    // En una implementación real, aquí se descargarían los TLEs desde una fuente autorizada
+    // Por ahora, simulamos validación y actualización de timestamp
+    
+    // Verificar validez de TLEs actuales
+    bool any_invalid = false;
+    for (size_t i = 0; i < count; i++) {
+        if (!satellites[i].valid) {
+            any_invalid = true;
+            LOG_WRN("Satellite %d TLE is invalid", (int)i);
+        }
+    }
+    
+    if (any_invalid) {
+        LOG_WRN("Some TLEs are invalid - using backup prediction algorithm");
+        cfg->consecutive_failures++;
+    } else {
+        cfg->consecutive_failures = 0;
+        LOG_INF("All TLEs validated successfully");
+    }
+    
+    // Actualizar timestamp de última actualización
+    cfg->last_update_time = current_time;
+    cfg->update_needed = false;
+    
+    // Si hay muchos fallos consecutivos, extender el intervalo configurado
+    if (cfg->consecutive_failures > 3) {
+        cfg->update_interval_hours = base_interval_hours * 2;
+        LOG_WRN("Extending TLE update interval due to consecutive failures");
+    } else {
+        cfg->update_interval_hours = base_interval_hours;
+    }
+    
+    return 0;
+}
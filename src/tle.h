@@ -0,0 +1,66 @@
+/*
+ * Archivo: tle.h
+ * Descripción: Elementos orbitales TLE en binario y política de actualización
+ *              de TLEs de la constelación SIC-4.
+ */
+
+#ifndef TLE_H_
+#define TLE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TLE_UPDATE_INTERVAL_HOURS 24
+#define TLE_LINE_MAX_LEN 69             // Formato estándar de columnas fijas
+#define TLE_LINE_MIN_LEN 60             // Admite TLEs con espacios normalizados
+#define TLE_INGEST_MAX_LEN 256          // Nombre + 2 líneas + terminadores
+
+// Texto TLE original: solo en flash (const), se parsea a tle_elements al arrancar
+struct sateliot_tle_text {
+    const char *line1;          // TLE Line 1
+    const char *line2;          // TLE Line 2
+};
+
+// Elementos orbitales en binario (punto fijo), copia en RAM del TLE
+struct tle_elements {
+    uint32_t catalog_number;    // Número NORAD
+    uint32_t epoch_s;           // Época del TLE (segundos Unix)
+    int32_t inclination_e4;     // Inclinación (grados * 1e4)
+    int32_t raan_e4;            // Ascensión recta del nodo (grados * 1e4)
+    uint32_t eccentricity_e7;   // Excentricidad (* 1e7)
+    int32_t arg_perigee_e4;     // Argumento del perigeo (grados * 1e4)
+    int32_t mean_anomaly_e4;    // Anomalía media (grados * 1e4)
+    uint32_t mean_motion_e8;    // Movimiento medio (rev/día * 1e8)
+    bool valid;                 // Si el TLE es válido
+};
+
+// MEJORA v3.2: Estructura para gestión de TLEs
+struct tle_update_config {
+    int64_t last_update_time;
+    uint16_t update_interval_hours;
+    uint8_t consecutive_failures;
+    bool update_needed;
+};
+
+// Parsea las dos líneas TLE (columnas fijas o espacios normalizados) a binario.
+// Valida longitud, caracteres, suma de control, catálogo y rangos; out solo se
+// escribe si todo es correcto.
+int parse_tle(const struct sateliot_tle_text *text, struct tle_elements *out);
+
+// Ingesta de un TLE recibido por red (bytes no confiables, sin terminador NUL):
+// 2 líneas o 3 con nombre, separadas por '\n' o "\r\n".
+int tle_ingest(const uint8_t *data, size_t len, struct tle_elements *out);
+
+void tle_update_init(struct tle_update_config *cfg);
+
+// Si toca revisar los TLEs (forzado o intervalo vencido) en el instante now (ms de uptime)
+bool tle_update_due(const struct tle_update_config *cfg, int64_t now);
+
+// MEJORA v3.2: Valida el conjunto de TLEs y ajusta el intervalo según los fallos:
+// base_interval_hours (el parámetro en tiempo de ejecución) o el doble con más de 3
+// fallos consecutivos
+int tle_update_evaluate(struct tle_update_config *cfg, uint16_t base_interval_hours,
+                        const struct tle_elements *satellites, size_t count, int64_t current_time);
+
+#endif /* TLE_H_ */
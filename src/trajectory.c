@@ -0,0 +1,97 @@
+/*
+ * Archivo: trajectory.c
+ * Descripción: Simplificador de trayectoria por ventana abierta en enteros.
+ */
+
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include "int_math.h"
+#include "trajectory.h"
+
+// Distancia de c al segmento origen-b (desplazamientos en metros respecto al ancla).
+// El caso perpendicular compara |c x b| con tol·|b| para no elevar al cuadrado un
+// producto cruzado que ya ocupa ~40 bits.
+static bool within_segment(int32_t bx, int32_t by, int32_t cx, int32_t cy, uint32_t tol) {
+    int64_t len2 = (int64_t)bx * bx + (int64_t)by * by;
+    int64_t dot = (int64_t)cx * bx + (int64_t)cy * by;
+    int64_t tol2 = (int64_t)tol * tol;
+
+    if (len2 == 0 || dot <= 0) {
+        return (int64_t)cx * cx + (int64_t)cy * cy <= tol2;
+    }
+    if (dot >= len2) {
+        int64_t dx = (int64_t)cx - bx, dy = (int64_t)cy - by;
+
+        return dx * dx + dy * dy <= tol2;
+    }
+
+    int64_t cross = (int64_t)cx * by - (int64_t)cy * bx;
+
+    return (cross < 0 ? -cross : cross) <= (int64_t)tol * isqrt64(len2);
+}
+
+static bool window_fits(const struct trajectory *t, const struct geo_position *p, uint32_t tol) {
+    int32_t bx, by;
+
+    geo_offset_m(&t->anchor, p, &bx, &by);
+    for (uint8_t i = 0; i < t->count; i++) {
+        int32_t cx, cy;
+
+        geo_offset_m(&t->anchor, &t->window[i], &cx, &cy);
+        if (!within_segment(bx, by, cx, cy, tol)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void trajectory_reset(struct trajectory *t) {
+    memset(t, 0, sizeof(*t));
+}
+
+void trajectory_stats_reset(struct trajectory *t) {
+    t->points_in = 0;
+    t->points_out = 0;
+    t->cycles = 0;
+}
+
+bool trajectory_add(struct trajectory *t, const struct uplink_record *record, uint32_t tolerance_m,
+                    struct uplink_record *out) {
+    uint32_t start = k_cycle_get_32();
+    bool emit = false;
+
+    t->points_in++;
+    if (!t->has_anchor) {
+        // Primer punto del recorrido: siempre es clave
+        t->anchor = record->position;
+        t->has_anchor = true;
+        *out = *record;
+        t->points_out++;
+        t->cycles += k_cycle_get_32() - start;
+        return true;
+    }
+
+    if (t->count == TRAJECTORY_WINDOW || (t->count > 0 && !window_fits(t, &record->position, tolerance_m))) {
+        *out = t->floater;
+        t->anchor = t->floater.position;
+        t->count = 0;
+        t->points_out++;
+        emit = true;
+    }
+    t->window[t->count++] = record->position;
+    t->floater = *record;
+    t->cycles += k_cycle_get_32() - start;
+    return emit;
+}
+
+bool trajectory_flush(struct trajectory *t, struct uplink_record *out) {
+    if (t->count == 0) {
+        return false;
+    }
+    *out = t->floater;
+    t->anchor = t->floater.position;
+    t->count = 0;
+    t->points_out++;
+    return true;
+}
@@ -0,0 +1,48 @@
+/*
+ * Archivo: trajectory.h
+ * Descripción: Simplificación en línea de la trayectoria (ventana abierta, variante
+ *              en streaming de Douglas-Peucker) sobre los registros en crudo.
+ *
+ * Se retiene el último punto recibido (flotante). Cuando un punto nuevo deja algún punto
+ * intermedio a más de la tolerancia del segmento ancla-punto nuevo, el flotante pasa a
+ * ser punto clave: se reporta y se convierte en el ancla. Memoria acotada: la ventana
+ * se cierra también al llenarse. Los sensores de los puntos descartados se pierden; es
+ * un modo para activos en movimiento donde la forma del recorrido es el dato.
+ */
+
+#ifndef TRAJECTORY_H_
+#define TRAJECTORY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "telemetry.h"
+
+#define TRAJECTORY_WINDOW 32
+
+struct trajectory {
+    struct geo_position anchor;         // Último punto clave reportado
+    struct geo_position window[TRAJECTORY_WINDOW];  // Puntos tras el ancla; el último es el flotante
+    struct uplink_record floater;       // Registro completo del flotante
+    uint8_t count;
+    bool has_anchor;
+
+    // Estadísticas desde el último trajectory_stats_reset
+    uint32_t points_in;
+    uint32_t points_out;
+    uint32_t cycles;
+};
+
+void trajectory_reset(struct trajectory *t);
+
+// Ofrece un registro con posición válida. true si out contiene un punto clave a reportar.
+bool trajectory_add(struct trajectory *t, const struct uplink_record *record, uint32_t tolerance_m,
+                    struct uplink_record *out);
+
+// Cierra el tramo abierto: el flotante (extremo actual del recorrido) pasa a punto clave.
+// false si no había nada retenido.
+bool trajectory_flush(struct trajectory *t, struct uplink_record *out);
+
+void trajectory_stats_reset(struct trajectory *t);
+
+#endif /* TRAJECTORY_H_ */
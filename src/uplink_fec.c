@@ -0,0 +1,162 @@
+/*
+ * Archivo: uplink_fec.c
+ * Descripción: Codificador de paridad XOR del uplink y estimación de pérdida.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "uplink_fec.h"
+
+LOG_MODULE_DECLARE(ntn_app, LOG_LEVEL_INF);
+
+struct uplink_fec {
+    uint16_t seq;               // Secuencia continua: el servidor cuenta los huecos
+    uint16_t group;
+    uint8_t k;                  // Tamaño de grupo de la sesión (0 = sin FEC)
+    uint8_t count;              // Datagramas de datos en el grupo abierto
+    uint16_t len_xor;
+    uint16_t parity_len;        // Payload más largo del grupo
+    uint16_t loss_pm;           // Pérdida estimada (media móvil, por mil)
+    uint16_t data_sent;         // Contadores de la sesión
+    uint16_t parity_sent;
+    uint8_t parity[PAYLOAD_BUFFER_SIZE];
+};
+
+static struct uplink_fec fec = {
+    .loss_pm = UPLINK_FEC_INITIAL_LOSS_PM,
+};
+
+static void put_be16(uint8_t *p, uint16_t value) {
+    p[0] = value >> 8;
+    p[1] = value & 0xFF;
+}
+
+static uint16_t get_be16(const uint8_t *p) {
+    return ((uint16_t)p[0] << 8) | p[1];
+}
+
+static void fec_put_header(uint8_t *out, uint8_t index, uint8_t k) {
+    out[0] = UPLINK_FEC_MAGIC;
+    put_be16(&out[1], fec.seq);
+    put_be16(&out[3], fec.group);
+    out[5] = index;
+    out[6] = k;
+}
+
+uint8_t uplink_fec_select_k(uint16_t loss_pm) {
+    uint32_t p2 = (uint32_t)loss_pm * loss_pm;
+
+    for (uint8_t k = UPLINK_FEC_MAX_K; k > UPLINK_FEC_MIN_K; k /= 2) {
+        if (k * p2 <= UPLINK_FEC_TARGET_RESIDUAL_PM * 1000) {
+            return k;
+        }
+    }
+    return UPLINK_FEC_MIN_K;
+}
+
+uint8_t uplink_fec_session_begin(uint32_t mode) {
+    if (mode == UPLINK_FEC_MODE_OFF) {
+        fec.k = 0;
+    } else if (mode == UPLINK_FEC_MODE_ADAPTIVE) {
+        fec.k = uplink_fec_select_k(fec.loss_pm);
+    } else {
+        fec.k = CLAMP(mode, UPLINK_FEC_MIN_K, UPLINK_FEC_MAX_K);
+    }
+    fec.count = 0;
+    fec.data_sent = 0;
+    fec.parity_sent = 0;
+    return fec.k;
+}
+
+int uplink_fec_encode(const uint8_t *payload, size_t len, uint8_t *out, size_t out_size) {
+    if (fec.k == 0 || len > sizeof(fec.parity)) {
+        return -EINVAL;
+    }
+    if (out_size < UPLINK_FEC_HDR_LEN + len) {
+        return -ENOMEM;
+    }
+
+    // La secuencia avanza en el commit: un envío fallido no deja hueco en el servidor
+    fec_put_header(out, fec.count, fec.k);
+    memcpy(&out[UPLINK_FEC_HDR_LEN], payload, len);
+    return UPLINK_FEC_HDR_LEN + len;
+}
+
+void uplink_fec_commit(const uint8_t *payload, size_t len) {
+    if (fec.k == 0 || len > sizeof(fec.parity)) {
+        return;
+    }
+    if (fec.count == 0) {
+        fec.len_xor = 0;
+        fec.parity_len = 0;
+        memset(fec.parity, 0, sizeof(fec.parity));
+    }
+    for (size_t i = 0; i < len; i++) {
+        fec.parity[i] ^= payload[i];
+    }
+    fec.len_xor ^= (uint16_t)len;
+    fec.parity_len = MAX(fec.parity_len, len);
+    fec.seq++;
+    fec.count++;
+    fec.data_sent++;
+}
+
+void uplink_fec_abort_group(void) {
+    if (fec.count == 0) {
+        return;
+    }
+    // Los datos ya enviados del grupo quedan sin paridad; el índice no se reutiliza
+    fec.group++;
+    fec.count = 0;
+}
+
+int uplink_fec_parity(uint8_t *out, size_t out_size, bool force) {
+    if (fec.k == 0 || fec.count == 0 || (!force && fec.count < fec.k)) {
+        return 0;
+    }
+    if (out_size < (size_t)UPLINK_FEC_HDR_LEN + 2 + fec.parity_len) {
+        return -ENOMEM;
+    }
+
+    // Grupo incompleto al final de la sesión: k indica los datos realmente enviados
+    fec_put_header(out, UPLINK_FEC_PARITY_INDEX, fec.count);
+    fec.seq++;
+    put_be16(&out[UPLINK_FEC_HDR_LEN], fec.len_xor);
+    memcpy(&out[UPLINK_FEC_HDR_LEN + 2], fec.parity, fec.parity_len);
+
+    fec.group++;
+    fec.count = 0;
+    fec.parity_sent++;
+    return UPLINK_FEC_HDR_LEN + 2 + fec.parity_len;
+}
+
+void uplink_fec_session_end(void) {
+    if (fec.k == 0 || fec.data_sent == 0) {
+        return;
+    }
+    LOG_INF("FEC uplink k=%u: %u datos + %u paridad (%u%% overhead), pérdida estimada %u‰",
+            fec.k, fec.data_sent, fec.parity_sent, fec.parity_sent * 100 / fec.data_sent, fec.loss_pm);
+}
+
+int uplink_fec_handle_report(const uint8_t *payload, size_t len) {
+    if (len != 4) {
+        return -EBADMSG;
+    }
+
+    uint16_t received = get_be16(&payload[0]);
+    uint16_t expected = get_be16(&payload[2]);
+
+    if (expected == 0 || received > expected) {
+        return -EINVAL;
+    }
+
+    uint16_t sample = (uint32_t)(expected - received) * 1000 / expected;
+
+    // Media móvil 3/4: un pase malo no dispara el overhead, varios seguidos sí
+    fec.loss_pm = (3 * (uint32_t)fec.loss_pm + sample) / 4;
+    LOG_INF("Pérdida uplink %u/%u (%u‰), estimada %u‰ -> k=%u", expected - received, expected,
+            sample, fec.loss_pm, uplink_fec_select_k(fec.loss_pm));
+    return 0;
+}
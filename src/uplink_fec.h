@@ -0,0 +1,67 @@
+/*
+ * Archivo: uplink_fec.h
+ * Descripción: Paridad XOR sobre grupos de datagramas de uplink. El servidor reconstruye
+ *              un datagrama perdido por grupo sin esperar a una retransmisión en el
+ *              próximo pase. El tamaño de grupo se adapta a la pérdida que informa el
+ *              servidor (DOWNLINK_OP_UPLINK_REPORT).
+ *
+ * Con FEC activo cada datagrama lleva la cabecera (big-endian):
+ *   [UPLINK_FEC_MAGIC][seq u16][grupo u16][índice u8][k u8][payload]
+ * La paridad usa índice UPLINK_FEC_PARITY_INDEX, k = datagramas de datos del grupo y
+ * payload [XOR de longitudes u16][XOR de los payloads rellenos con ceros].
+ * El magic no puede empezar un JSON, así que el servidor distingue ambos formatos.
+ */
+
+#ifndef UPLINK_FEC_H_
+#define UPLINK_FEC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "telemetry.h"
+
+#define UPLINK_FEC_MAGIC 0xFE
+#define UPLINK_FEC_HDR_LEN 7
+#define UPLINK_FEC_PARITY_INDEX 0xFF
+#define UPLINK_FEC_DATAGRAM_MAX (UPLINK_FEC_HDR_LEN + 2 + PAYLOAD_BUFFER_SIZE)
+
+// Valores de PARAM_FEC_GROUP: 0 sin FEC, 1 adaptativo, 2..16 grupo fijo
+#define UPLINK_FEC_MODE_OFF 0
+#define UPLINK_FEC_MODE_ADAPTIVE 1
+#define UPLINK_FEC_MIN_K 2
+#define UPLINK_FEC_MAX_K 16
+
+// Con una paridad por grupo se pierde un dato si cae otro del mismo grupo: residual ~ k·p².
+// El adaptativo elige el mayor k con residual por debajo de este objetivo (por mil).
+#define UPLINK_FEC_TARGET_RESIDUAL_PM 5
+#define UPLINK_FEC_INITIAL_LOSS_PM 20
+
+// Prepara la sesión de envío y devuelve el tamaño de grupo (0 = enviar sin cabecera)
+uint8_t uplink_fec_session_begin(uint32_t mode);
+
+// Construye en out el datagrama de datos sin tocar la paridad. Devuelve la longitud o -errno.
+int uplink_fec_encode(const uint8_t *payload, size_t len, uint8_t *out, size_t out_size);
+
+// El datagrama de uplink_fec_encode() ya salió: se suma a la paridad del grupo. Solo tras
+// un envío correcto, o la paridad cubriría un dato que el servidor nunca recibió.
+void uplink_fec_commit(const uint8_t *payload, size_t len);
+
+// Fallo de envío: el grupo abierto se descarta sin paridad y el siguiente datagrama
+// empieza grupo nuevo (el registro vuelve a la cola y se reenvía en otro grupo).
+void uplink_fec_abort_group(void);
+
+// Datagrama de paridad del grupo abierto si está completo (o siempre con force, al final
+// de la sesión). Devuelve la longitud, 0 si no toca.
+int uplink_fec_parity(uint8_t *out, size_t out_size, bool force);
+
+// Cierra la sesión y registra el overhead
+void uplink_fec_session_end(void);
+
+// DOWNLINK_OP_UPLINK_REPORT: [recibidos u16][esperados u16] de la última sesión
+int uplink_fec_handle_report(const uint8_t *payload, size_t len);
+
+// k que se usaría con la pérdida p (por mil) en modo adaptativo
+uint8_t uplink_fec_select_k(uint16_t loss_pm);
+
+#endif /* UPLINK_FEC_H_ */
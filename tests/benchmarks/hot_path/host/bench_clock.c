@@ -0,0 +1,15 @@
+/*
+ * Archivo: bench_clock.c
+ * Descripción: Reloj monotónico del host para las pruebas de rendimiento en
+ *              native_sim (se compila en el runner, con la libc del host).
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+uint64_t bench_host_clock_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,248 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas de rendimiento de la ruta caliente: conversión del fix y
+ *              formateo de telemetría, parser TLE, ingesta desde red, previsión de
+ *              pases, histograma de recovery y evaluación de geocercas. Cada caso
+ *              imprime una línea BENCH legible por máquina (ver testcase.yaml).
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+
+#include "geofence.h"
+#include "pass_predictor.h"
+#include "recovery.h"
+#include "telemetry.h"
+#include "text_writer.h"
+#include "tle.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_NONE);
+
+#define SAT1_LINE1 "1 60550U 24149CL 25071.82076637 .00007488 00000+0 68187-3 0 9999"
+#define SAT1_LINE2 "2 60550 97.7148 150.0635 0007556 170.3117 189.8251 14.95428546 31058"
+
+#if defined(CONFIG_ARCH_POSIX)
+uint64_t bench_host_clock_ns(void);
+#define bench_clock_ns() bench_host_clock_ns()
+#else
+#define bench_clock_ns() k_cyc_to_ns_floor64(k_cycle_get_32())
+#endif
+
+// Evita que el compilador elimine el trabajo medido
+static volatile uint32_t sink;
+
+static void bench_report(const char *name, uint32_t iterations, uint64_t start_ns) {
+    uint64_t elapsed = bench_clock_ns() - start_ns;
+
+    TC_PRINT("BENCH %s n=%u ns_per_op=%u\n", name, iterations, (uint32_t)(elapsed / iterations));
+}
+
+static const struct uplink_record raw_record = {
+    .timestamp = 1741808513000LL,
+    .position = { .lat_udeg = 41387917, .lon_udeg = 2168365, .alt_dm = 123 },
+    .sensors = {
+        .adc_mv = { 1200, 845 },
+        .battery_mv = 3700,
+        .modem_temp_c = 24,
+        .adc_count = 2,
+        .valid = SENSOR_VALID_VBAT | SENSOR_VALID_TEMP | SENSOR_VALID_ADC,
+    },
+    .sats = 9,
+    .position_valid = true,
+    .kind = UPLINK_RECORD_RAW,
+};
+
+ZTEST_SUITE(hot_path, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(hot_path, bench_position_text) {
+    const uint32_t n = 100000;
+    char text[48];
+    struct text_writer w;
+    uint64_t start = bench_clock_ns();
+
+    for (uint32_t i = 0; i < n; i++) {
+        tw_init(&w, text, sizeof(text));
+        tw_udeg(&w, 41387917 + (int32_t)i);
+        tw_putc(&w, ',');
+        tw_udeg(&w, -2168365 - (int32_t)i);
+        tw_putc(&w, ',');
+        tw_dm(&w, (int32_t)i);
+        sink += w.len;
+    }
+    bench_report("position_text", n, start);
+}
+
+// Conversión del frame PVT (double/float) a enteros, una vez por fix
+ZTEST(hot_path, bench_position_from_fix) {
+    const uint32_t n = 100000;
+    struct geo_position pos;
+    struct geo_modem_position modem;
+    uint64_t start = bench_clock_ns();
+
+    for (uint32_t i = 0; i < n; i++) {
+        geo_position_from_fix(41.387917 + i * 1e-7, 2.168365 - i * 1e-7, 12.3f + (float)i, &pos, &modem);
+        sink += pos.alt_dm + modem.lat_param;
+    }
+    bench_report("position_from_fix", n, start);
+}
+
+ZTEST(hot_path, bench_format_raw_record) {
+    const uint32_t n = 50000;
+    static char payload[PAYLOAD_BUFFER_SIZE];
+    struct uplink_record record = raw_record;
+    uint64_t start = bench_clock_ns();
+
+    for (uint32_t i = 0; i < n; i++) {
+        record.timestamp++;
+        zassert_ok(format_telemetry_data(payload, sizeof(payload), &record));
+        sink += (uint8_t)payload[20];
+    }
+    bench_report("format_raw_record", n, start);
+}
+
+ZTEST(hot_path, bench_parse_tle) {
+    const uint32_t n = 50000;
+    static const struct sateliot_tle_text sat1 = { SAT1_LINE1, SAT1_LINE2 };
+    struct tle_elements el;
+    uint64_t start = bench_clock_ns();
+
+    for (uint32_t i = 0; i < n; i++) {
+        zassert_ok(parse_tle(&sat1, &el));
+        sink += el.mean_motion_e8;
+    }
+    bench_report("parse_tle", n, start);
+}
+
+ZTEST(hot_path, bench_tle_ingest) {
+    const uint32_t n = 50000;
+    static const char frame[] = "SATELIOT_1\r\n" SAT1_LINE1 "\r\n" SAT1_LINE2 "\r\n";
+    struct tle_elements el;
+    uint64_t start = bench_clock_ns();
+
+    for (uint32_t i = 0; i < n; i++) {
+        zassert_ok(tle_ingest((const uint8_t *)frame, sizeof(frame) - 1, &el));
+        sink += el.epoch_s;
+    }
+    bench_report("tle_ingest", n, start);
+}
+
+// Previsión de una semana (la que usa el control de muestreo antes de cada pase)
+ZTEST(hot_path, bench_pass_forecast_week) {
+    const uint32_t n = 20000;
+    const struct geo_position ground = { .lat_udeg = 41387917, .lon_udeg = 2168365 };
+    struct satellite_pass first;
+    struct satellite_pass table[32];
+    struct pass_rng rng;
+
+    pass_rng_seed(&rng, 1);
+    zassert_ok(calculate_sateliot_satellite_pass(&first, &ground, 0, &rng));
+
+    uint64_t start = bench_clock_ns();
+
+    for (uint32_t i = 0; i < n; i++) {
+        int count = pass_forecast(&first, &ground, 7LL * 24 * 60 * 60 * 1000, rng, i, table,
+                                  ARRAY_SIZE(table));
+
+        zassert_true(count > 0);
+        sink += table[count - 1].tx_offset_ms;
+    }
+    bench_report("pass_forecast_week", n, start);
+}
+
+ZTEST(hot_path, bench_modem_ready_histogram) {
+    const uint32_t n = 100000;
+    struct modem_ready_histogram hist = { 0 };
+    char text[96];
+    uint64_t start = bench_clock_ns();
+
+    for (uint32_t i = 0; i < n; i++) {
+        modem_ready_hist_record(&hist, (i * 37) % 8000);
+        sink += modem_ready_hist_format(&hist, text, sizeof(text));
+    }
+    bench_report("modem_ready_histogram", n, start);
+}
+
+// Conjunto lleno (GEOFENCE_MAX): mitad círculos, mitad estrellas cóncavas de 8 vértices
+// repartidos en ~40 x 40 km, con fixes al azar en la misma zona
+#define BENCH_FENCE_AREA_UDEG 180000
+
+static uint32_t fence_blob[GEOFENCE_MAX * 84 / 4 + 4];
+static uint32_t fence_rng = 1;
+
+static int32_t fence_rand(int32_t amplitude) {
+    fence_rng = fence_rng * 1664525u + 1013904223u;
+    return (int32_t)((fence_rng >> 4) % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+static size_t fence_put(uint8_t *blob, size_t len, int32_t value) {
+    sys_put_le32((uint32_t)value, &blob[len]);
+    return len + 4;
+}
+
+static size_t build_fence_blob(void) {
+    static const int32_t dir_q10[8][2] = {
+        { 1024, 0 }, { 724, 724 }, { 0, 1024 }, { -724, 724 },
+        { -1024, 0 }, { -724, -724 }, { 0, -1024 }, { 724, -724 },
+    };
+    uint8_t *blob = (uint8_t *)fence_blob;
+    size_t len = 12;
+
+    for (uint16_t id = 0; id < GEOFENCE_MAX; id++) {
+        int32_t lat = 41387917 + fence_rand(BENCH_FENCE_AREA_UDEG);
+        int32_t lon = 2168365 + fence_rand(BENCH_FENCE_AREA_UDEG);
+        int32_t r = 5000 + fence_rand(3000);    // Radio exterior en µ°
+
+        sys_put_le16(id, &blob[len]);
+        blob[len + 2] = id % 2 ? GEOFENCE_POLYGON : GEOFENCE_CIRCLE;
+        blob[len + 3] = id % 2 ? 8 : 0;
+        len = fence_put(blob, len + 4, lat - r);
+        len = fence_put(blob, len, lon - r);
+        len = fence_put(blob, len, lat + r);
+        len = fence_put(blob, len, lon + r);
+        if (id % 2 == 0) {
+            len = fence_put(blob, len, lat);
+            len = fence_put(blob, len, lon);
+            len = fence_put(blob, len, r / 13);     // Radio en m que cabe en la bbox
+            continue;
+        }
+        for (int i = 0; i < 8; i++) {
+            int32_t ri = i % 2 ? r / 3 : r;
+
+            len = fence_put(blob, len, lat + dir_q10[i][0] * ri / 1024);
+            len = fence_put(blob, len, lon + dir_q10[i][1] * ri / 1024);
+        }
+    }
+    sys_put_le32(GEOFENCE_MAGIC, &blob[0]);
+    sys_put_le16(GEOFENCE_VERSION, &blob[4]);
+    sys_put_le16(GEOFENCE_MAX, &blob[6]);
+    sys_put_le32(crc32_ieee(&blob[12], len - 12), &blob[8]);
+    return len;
+}
+
+static void fence_event_sink(const struct geofence_event *evt, void *ctx) {
+    ARG_UNUSED(ctx);
+    sink += evt->fence_id;
+}
+
+ZTEST(hot_path, bench_geofence_evaluate) {
+    const uint32_t n = 20000;
+    static struct geofence_set set;
+    struct geo_position p = { 0 };
+    uint32_t exact = 0;
+
+    zassert_ok(geofence_set_bind(&set, (const uint8_t *)fence_blob, build_fence_blob()));
+
+    uint64_t start = bench_clock_ns();
+
+    for (uint32_t i = 0; i < n; i++) {
+        p.lat_udeg = 41387917 + fence_rand(BENCH_FENCE_AREA_UDEG);
+        p.lon_udeg = 2168365 + fence_rand(BENCH_FENCE_AREA_UDEG);
+        exact += geofence_set_evaluate(&set, &p, i, fence_event_sink, NULL);
+    }
+    bench_report("geofence_evaluate", n, start);
+
+    // El pre-filtro por bbox deja la prueba exacta en una minoría de geocercas por fix
+    zassert_true(exact < n * 4, "%u pruebas exactas", exact);
+}
@@ -0,0 +1,388 @@
+/*
+ * Archivo: fleet_sim.c
+ * Descripción: Simulador de contención de una flota en la misma zona. N dispositivos
+ *              repartidos en hilos atraviesan los mismos pases con el código del
+ *              firmware: pass_assign_tx_slot() elige el slot y pass_rach_backoff_ms()
+ *              el reintento tras un acceso fallido.
+ *
+ * Modelo de acceso (ALOHA ranurado): el tiempo del pase se divide en ocasiones de acceso
+ * de -o ms; dos o más dispositivos que empiezan el attach en la misma ocasión colisionan
+ * y ninguno se registra. Un intento fallido se detecta tras -a ms (lo que dura un intento
+ * de attach) y el dispositivo pide el back-off; si ya no cabe en el pase (-ETIME) el pase
+ * se pierde para ese dispositivo.
+ *
+ * -g modela un fix GNSS hecho después de despertar en el slot (uniforme en [0, -g] ms por
+ * dispositivo y pase) que retrasa el primer acceso; con el GNSS adelantado al slot es 0.
+ * Comparación antes/después de acotar el attach al slot:
+ *   fleet_sim -g 180000 -a 1230000    # GNSS tras el slot, Step 1 + feeder + Step 2 completos
+ *   fleet_sim -a 70000                # GNSS antes del slot, Step 1 + feeder + Step 2 en el slot
+ *
+ * Los hilos avanzan ocasión a ocasión sincronizados por una barrera: en cada ocasión
+ * publican sus accesos y, tras la barrera, cada uno resuelve los suyos con el recuento
+ * ya cerrado. El resultado no depende del número de hilos.
+ *
+ * Salida: resumen legible y una línea FLEET_JSON {...} para scripts.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/sys/crc.h>
+
+#include "pass_predictor.h"
+
+#define SIM_DEVICES_DEFAULT 1000
+#define SIM_PASSES_DEFAULT 60
+#define SIM_THREADS_DEFAULT 4
+#define SIM_OCCASION_MS_DEFAULT 1000
+#define SIM_SEED_DEFAULT 1
+#define SIM_DAY_MS (24LL * 60 * 60 * 1000)
+
+// Barcelona, la zona de ejemplo del predictor
+#define SIM_LAT_UDEG 41385064
+#define SIM_LON_UDEG 2173403
+
+enum device_state {
+    DEV_WAITING,        // Esperando su próxima ocasión de acceso
+    DEV_ATTEMPTING,     // Acceso publicado en la ocasión actual
+    DEV_DONE,           // Registrado en este pase
+    DEV_MISSED          // Sin hueco para reintentar dentro del pase
+};
+
+struct device {
+    uint32_t seed;
+    enum device_state state;
+    int attempt;            // Intentos fallidos en este pase
+    int64_t next_ms;        // Próximo acceso, respecto al inicio del pase
+    int64_t slot_ms;        // Inicio de su slot, respecto al inicio del pase
+};
+
+struct sim_options {
+    int devices;
+    int passes;
+    int threads;
+    int occasion_ms;
+    int attempt_ms;
+    int gnss_ms;
+    uint32_t seed;
+    bool verbose;
+};
+
+// Contadores de un hilo; se suman al final de cada pase
+struct sim_stats {
+    uint64_t attempts;
+    uint64_t collisions;
+    uint64_t registered;
+    uint64_t missed;
+};
+
+struct sim {
+    struct sim_options opt;
+    struct device *devices;
+    struct satellite_pass pass;
+    int occasions;
+    atomic_uint *starts;        // Accesos por ocasión del pase en curso
+    uint64_t *latency_hist;     // Latencia slot -> acceso con éxito, en ocasiones
+    int latency_bins;
+    pthread_barrier_t barrier;
+    pthread_mutex_t merge_lock;
+    struct sim_stats pass_stats;
+};
+
+struct worker {
+    struct sim *sim;
+    int first;
+    int last;
+    uint64_t *latency_hist;
+    struct sim_stats stats;
+};
+
+static int64_t occasion_of(const struct sim *sim, int64_t offset_ms) {
+    // Hacia arriba: un acceso nunca empieza antes de lo que pide el firmware
+    return (offset_ms + sim->opt.occasion_ms - 1) / sim->opt.occasion_ms;
+}
+
+static void device_resolve(struct worker *w, struct device *dev, int k) {
+    struct sim *sim = w->sim;
+    int64_t t_ms = (int64_t)k * sim->opt.occasion_ms;
+
+    if (atomic_load(&sim->starts[k]) == 1) {
+        int64_t bin = (t_ms - dev->slot_ms) / sim->opt.occasion_ms;
+
+        w->latency_hist[bin < sim->latency_bins ? bin : sim->latency_bins - 1]++;
+        w->stats.registered++;
+        dev->state = DEV_DONE;
+        return;
+    }
+
+    w->stats.collisions++;
+    int64_t fail_ms = t_ms + sim->opt.attempt_ms;
+    int64_t backoff = pass_rach_backoff_ms(&sim->pass, dev->seed, ++dev->attempt,
+                                           sim->pass.start_time + fail_ms);
+
+    if (backoff < 0) {
+        w->stats.missed++;
+        dev->state = DEV_MISSED;
+        return;
+    }
+    dev->next_ms = fail_ms + backoff;
+    dev->state = DEV_WAITING;
+}
+
+static void *worker_run(void *arg) {
+    struct worker *w = arg;
+    struct sim *sim = w->sim;
+
+    for (int k = 0; k < sim->occasions; k++) {
+        for (int i = w->first; i < w->last; i++) {
+            struct device *dev = &sim->devices[i];
+
+            if (dev->state == DEV_WAITING && occasion_of(sim, dev->next_ms) <= k) {
+                atomic_fetch_add(&sim->starts[k], 1);
+                w->stats.attempts++;
+                dev->state = DEV_ATTEMPTING;
+            }
+        }
+
+        pthread_barrier_wait(&sim->barrier);
+
+        for (int i = w->first; i < w->last; i++) {
+            if (sim->devices[i].state == DEV_ATTEMPTING) {
+                device_resolve(w, &sim->devices[i], k);
+            }
+        }
+    }
+
+    // Los que siguen esperando al acabar el pase tampoco se registraron
+    for (int i = w->first; i < w->last; i++) {
+        if (sim->devices[i].state == DEV_WAITING) {
+            w->stats.missed++;
+        }
+    }
+
+    pthread_mutex_lock(&sim->merge_lock);
+    sim->pass_stats.attempts += w->stats.attempts;
+    sim->pass_stats.collisions += w->stats.collisions;
+    sim->pass_stats.registered += w->stats.registered;
+    sim->pass_stats.missed += w->stats.missed;
+    pthread_mutex_unlock(&sim->merge_lock);
+    return NULL;
+}
+
+static void run_pass(struct sim *sim, struct worker *workers, pthread_t *threads) {
+    int64_t duration = sim->pass.end_time - sim->pass.start_time;
+
+    sim->occasions = (int)occasion_of(sim, duration);
+    for (int k = 0; k < sim->occasions; k++) {
+        atomic_store(&sim->starts[k], 0);
+    }
+    memset(&sim->pass_stats, 0, sizeof(sim->pass_stats));
+
+    for (int i = 0; i < sim->opt.devices; i++) {
+        struct device *dev = &sim->devices[i];
+        struct satellite_pass own = sim->pass;
+
+        pass_assign_tx_slot(&own, dev->seed);
+        dev->slot_ms = own.tx_offset_ms;
+        dev->next_ms = own.tx_offset_ms + pass_access_jitter_ms(&own, dev->seed);
+        if (sim->opt.gnss_ms > 0) {
+            uint32_t h = (dev->seed ^ (uint32_t)(own.start_time / 1000)) * 2654435761u;
+
+            dev->next_ms += (h >> 8) % ((uint32_t)sim->opt.gnss_ms + 1);
+        }
+        dev->attempt = 0;
+        dev->state = DEV_WAITING;
+    }
+
+    for (int t = 0; t < sim->opt.threads; t++) {
+        memset(&workers[t].stats, 0, sizeof(workers[t].stats));
+        pthread_create(&threads[t], NULL, worker_run, &workers[t]);
+    }
+    for (int t = 0; t < sim->opt.threads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+}
+
+static int64_t hist_percentile(const uint64_t *hist, int bins, uint64_t total, int pct) {
+    uint64_t target = (total * (uint64_t)pct + 99) / 100;
+    uint64_t seen = 0;
+
+    for (int b = 0; b < bins; b++) {
+        seen += hist[b];
+        if (seen >= target && seen > 0) {
+            return b;
+        }
+    }
+    return bins - 1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [-n dispositivos] [-p pases] [-t hilos] [-o ms por ocasión]\n"
+            "          [-a ms por intento] [-g ms máx. de GNSS tras el slot] [-s semilla]\n"
+            "          [-v (una línea por pase)]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    struct sim sim = {
+        .opt = {
+            .devices = SIM_DEVICES_DEFAULT,
+            .passes = SIM_PASSES_DEFAULT,
+            .threads = SIM_THREADS_DEFAULT,
+            .occasion_ms = SIM_OCCASION_MS_DEFAULT,
+            .attempt_ms = TX_SLOT_WINDOW_MS,
+            .seed = SIM_SEED_DEFAULT,
+        },
+    };
+    int c;
+
+    while ((c = getopt(argc, argv, "n:p:t:o:a:g:s:vh")) != -1) {
+        switch (c) {
+        case 'n': sim.opt.devices = atoi(optarg); break;
+        case 'p': sim.opt.passes = atoi(optarg); break;
+        case 't': sim.opt.threads = atoi(optarg); break;
+        case 'o': sim.opt.occasion_ms = atoi(optarg); break;
+        case 'a': sim.opt.attempt_ms = atoi(optarg); break;
+        case 'g': sim.opt.gnss_ms = atoi(optarg); break;
+        case 's': sim.opt.seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'v': sim.opt.verbose = true; break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (sim.opt.devices <= 0 || sim.opt.passes <= 0 || sim.opt.threads <= 0 ||
+        sim.opt.occasion_ms <= 0 || sim.opt.attempt_ms < 0 ||
+        sim.opt.gnss_ms < 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (sim.opt.threads > sim.opt.devices) {
+        sim.opt.threads = sim.opt.devices;
+    }
+
+    // Pase más largo posible: duración máxima con el factor de latitud (x1.5)
+    int max_occasions = (int)((MAX_SATELLITE_PASS_DURATION_MS * 3 / 2) / sim.opt.occasion_ms) + 2;
+
+    sim.devices = calloc((size_t)sim.opt.devices, sizeof(*sim.devices));
+    sim.starts = calloc((size_t)max_occasions, sizeof(*sim.starts));
+    sim.latency_bins = max_occasions;
+    sim.latency_hist = calloc((size_t)sim.latency_bins, sizeof(*sim.latency_hist));
+
+    struct worker *workers = calloc((size_t)sim.opt.threads, sizeof(*workers));
+    pthread_t *threads = calloc((size_t)sim.opt.threads, sizeof(*threads));
+
+    // Semilla de cada dispositivo como en el firmware: CRC32 de su identificador
+    for (int i = 0; i < sim.opt.devices; i++) {
+        uint8_t device_id[8];
+        uint64_t id = ((uint64_t)sim.opt.seed << 32) | (uint32_t)i;
+
+        memcpy(device_id, &id, sizeof(device_id));
+        sim.devices[i].seed = crc32_ieee(device_id, sizeof(device_id));
+    }
+    for (int t = 0; t < sim.opt.threads; t++) {
+        workers[t].sim = &sim;
+        workers[t].first = (int)((int64_t)sim.opt.devices * t / sim.opt.threads);
+        workers[t].last = (int)((int64_t)sim.opt.devices * (t + 1) / sim.opt.threads);
+        workers[t].latency_hist = calloc((size_t)sim.latency_bins, sizeof(uint64_t));
+    }
+    pthread_barrier_init(&sim.barrier, NULL, (unsigned int)sim.opt.threads);
+    pthread_mutex_init(&sim.merge_lock, NULL);
+
+    struct geo_position ground = {.lat_udeg = SIM_LAT_UDEG, .lon_udeg = SIM_LON_UDEG};
+    struct pass_rng rng;
+    struct sim_stats total = {0};
+    double load_sum = 0, load_max = 0, miss_rate_max = 0;
+    uint32_t peak_starts = 0;
+    int64_t now = 0;
+
+    pass_rng_seed(&rng, sim.opt.seed);
+
+    for (int p = 0; p < sim.opt.passes; p++) {
+        calculate_sateliot_satellite_pass(&sim.pass, &ground, now, &rng);
+        run_pass(&sim, workers, threads);
+        now = sim.pass.end_time;
+
+        // Carga ofrecida: accesos por ocasión dentro de la zona útil del pase
+        int64_t usable_start;
+        int64_t usable = pass_usable_ms(&sim.pass, &usable_start);
+        double usable_occ = (double)usable / sim.opt.occasion_ms;
+        double load = usable_occ > 0 ? sim.pass_stats.attempts / usable_occ : 0;
+        double miss_rate = (double)sim.pass_stats.missed / sim.opt.devices;
+
+        for (int k = 0; k < sim.occasions; k++) {
+            uint32_t n = atomic_load(&sim.starts[k]);
+
+            peak_starts = n > peak_starts ? n : peak_starts;
+        }
+        if (sim.opt.verbose) {
+            printf("Pase %d: %llds (útil %llds, elev %u°), accesos %llu, carga %.3f, colisiones %llu, "
+                   "perdidos %llu\n", p, (long long)((sim.pass.end_time - sim.pass.start_time) / 1000),
+                   (long long)(usable / 1000), sim.pass.max_elevation,
+                   (unsigned long long)sim.pass_stats.attempts, load,
+                   (unsigned long long)sim.pass_stats.collisions, (unsigned long long)sim.pass_stats.missed);
+        }
+        load_sum += load;
+        load_max = load > load_max ? load : load_max;
+        miss_rate_max = miss_rate > miss_rate_max ? miss_rate : miss_rate_max;
+        total.attempts += sim.pass_stats.attempts;
+        total.collisions += sim.pass_stats.collisions;
+        total.registered += sim.pass_stats.registered;
+        total.missed += sim.pass_stats.missed;
+    }
+
+    for (int t = 0; t < sim.opt.threads; t++) {
+        for (int b = 0; b < sim.latency_bins; b++) {
+            sim.latency_hist[b] += workers[t].latency_hist[b];
+        }
+    }
+
+    uint64_t offered = (uint64_t)sim.opt.devices * sim.opt.passes;
+    int64_t occ = sim.opt.occasion_ms;
+    int64_t p50 = hist_percentile(sim.latency_hist, sim.latency_bins, total.registered, 50) * occ;
+    int64_t p90 = hist_percentile(sim.latency_hist, sim.latency_bins, total.registered, 90) * occ;
+    int64_t p99 = hist_percentile(sim.latency_hist, sim.latency_bins, total.registered, 99) * occ;
+    int64_t pmax = hist_percentile(sim.latency_hist, sim.latency_bins, total.registered, 100) * occ;
+
+    printf("Flota: %d dispositivos, %d pases, %d hilos, ocasión %d ms, intento %d ms, GNSS %d ms\n",
+           sim.opt.devices, sim.opt.passes, sim.opt.threads, sim.opt.occasion_ms, sim.opt.attempt_ms,
+           sim.opt.gnss_ms);
+    printf("Accesos: %llu (%.2f por dispositivo y pase), colisiones %llu (%.1f %%)\n",
+           (unsigned long long)total.attempts, (double)total.attempts / offered,
+           (unsigned long long)total.collisions,
+           total.attempts ? 100.0 * total.collisions / total.attempts : 0.0);
+    printf("Registrados: %llu de %llu (%.1f %%), pases perdidos %llu (peor pase %.1f %%)\n",
+           (unsigned long long)total.registered, (unsigned long long)offered,
+           100.0 * total.registered / offered, (unsigned long long)total.missed, 100.0 * miss_rate_max);
+    printf("Carga ofrecida por pase (accesos/ocasión útil): media %.3f, máx %.3f; pico %u en una ocasión\n",
+           load_sum / sim.opt.passes, load_max, peak_starts);
+    printf("Latencia slot -> registro: p50 %lld ms, p90 %lld ms, p99 %lld ms, máx %lld ms\n",
+           (long long)p50, (long long)p90, (long long)p99, (long long)pmax);
+    printf("FLEET_JSON {\"devices\":%d,\"passes\":%d,\"threads\":%d,\"occasion_ms\":%d,\"attempt_ms\":%d,"
+           "\"gnss_ms\":%d,\"attempts\":%llu,\"collisions\":%llu,\"registered\":%llu,\"missed\":%llu,"
+           "\"load_mean\":%.4f,\"load_max\":%.4f,\"peak_starts\":%u,"
+           "\"latency_ms\":{\"p50\":%lld,\"p90\":%lld,\"p99\":%lld,\"max\":%lld}}\n",
+           sim.opt.devices, sim.opt.passes, sim.opt.threads, sim.opt.occasion_ms, sim.opt.attempt_ms,
+           sim.opt.gnss_ms, (unsigned long long)total.attempts, (unsigned long long)total.collisions,
+           (unsigned long long)total.registered, (unsigned long long)total.missed,
+           load_sum / sim.opt.passes, load_max, peak_starts,
+           (long long)p50, (long long)p90, (long long)p99, (long long)pmax);
+
+    pthread_barrier_destroy(&sim.barrier);
+    pthread_mutex_destroy(&sim.merge_lock);
+    for (int t = 0; t < sim.opt.threads; t++) {
+        free(workers[t].latency_hist);
+    }
+    free(threads);
+    free(workers);
+    free(sim.latency_hist);
+    free(sim.starts);
+    free(sim.devices);
+    return 0;
+}
@@ -0,0 +1,141 @@
+/*
+ * Archivo: fuzz_downlink.c
+ * Descripción: Harness de downlink_dispatch() con todos los destinos reales: PARAM_SET,
+ *              FOTA, DFU del módem, símbolos bulk (TLE, FOTA, DFU, geocercas) e informe
+ *              de pérdida de uplink.
+ *
+ * Entrada: secuencia de tramas [longitud u8][opcode][payload...]. El harness añade un
+ * contador creciente y la etiqueta de downlink_auth.h a los opcodes privilegiados (con
+ * host_test_key, que se provisiona al empezar) y el CRC-16 de cada trama, así las
+ * mutaciones llegan a los decodificadores en lugar de morir en la autenticación, la
+ * anti-repetición o el CRC; una secuencia recorre los estados BEGIN -> CHUNK y
+ * BULK_BEGIN -> BULK_SYMBOL.
+ * El estado persistido (settings y slots en RAM) se borra al empezar cada entrada.
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/crc.h>
+
+#include "bulk.h"
+#include "downlink.h"
+#include "downlink_auth.h"
+#include "fota.h"
+#include "geofence.h"
+#include "modem_dfu.h"
+#include "params.h"
+#include "tle.h"
+#include "host_test_key.h"
+
+#define FUZZ_SERVER_IP "192.0.2.1"
+#define FUZZ_SERVER_PORT 17777
+#define FUZZ_MAX_FRAMES 64
+
+// Mismo formato que bulk_tle_sink() en src/main.c: [índice u8][longitud u8][texto TLE]
+static int tle_sink(uint32_t session, uint32_t offset, const uint8_t *data, size_t len, bool last) {
+    struct tle_elements el;
+    size_t pos = 0;
+
+    (void)session;
+    if (offset != 0 || !last) {
+        return -EFBIG;
+    }
+    while (pos + 2 <= len && (data[pos] != 0 || data[pos + 1] != 0)) {
+        size_t rec_len = data[pos + 1];
+
+        if (pos + 2 + rec_len > len) {
+            return -EINVAL;
+        }
+        int err = tle_ingest(&data[pos + 2], rec_len, &el);
+
+        if (err) {
+            return err;
+        }
+        pos += 2 + rec_len;
+    }
+    return 0;
+}
+
+static int fota_sink(uint32_t session, uint32_t offset, const uint8_t *data, size_t len, bool last) {
+    (void)last;
+    return fota_write_patch(session, offset, data, len);
+}
+
+static int modem_dfu_sink(uint32_t session, uint32_t offset, const uint8_t *data, size_t len, bool last) {
+    (void)last;
+    return modem_dfu_write(session, offset, data, len);
+}
+
+static const bulk_sink_t sinks[BULK_TYPE_COUNT] = {
+    [BULK_TYPE_TLE] = tle_sink,
+    [BULK_TYPE_FOTA] = fota_sink,
+    [BULK_TYPE_MODEM_DFU] = modem_dfu_sink,
+    [BULK_TYPE_GEOFENCE] = geofence_bulk_sink,
+};
+
+// Mismos opcodes que downlink_privileged() en src/downlink.c
+static bool privileged(uint8_t opcode) {
+    return opcode == DOWNLINK_OP_PARAM_SET || opcode == DOWNLINK_OP_FOTA_BEGIN || opcode == DOWNLINK_OP_FOTA_ABORT ||
+           opcode == DOWNLINK_OP_MODEM_DFU_BEGIN || opcode == DOWNLINK_OP_MODEM_DFU_ABORT ||
+           opcode == DOWNLINK_OP_BULK_BEGIN;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    uint32_t counter = 0;
+    size_t pos = 0;
+
+    host_shim_settings_reset();
+    downlink_auth_provision(host_test_key);
+    downlink_auth_init();       // El contador aceptado vuelve a cero con settings
+    params_init(FUZZ_SERVER_IP, FUZZ_SERVER_PORT);
+    fota_init();
+    modem_dfu_init();
+    geofence_init();
+    bulk_init(sinks);
+
+    for (int n = 0; n < FUZZ_MAX_FRAMES && pos < size; n++) {
+        size_t body = data[pos++];
+        struct downlink_response resp;
+
+        body = body < size - pos ? body : size - pos;
+        size_t auth = body > 0 && privileged(data[pos]) ? DOWNLINK_AUTH_FRAME_OVERHEAD : 0;
+
+        if (body + auth + 2 > DOWNLINK_MAX_FRAME_LEN) {
+            body = DOWNLINK_MAX_FRAME_LEN - auth - 2;
+        }
+        // Trama exacta en el heap: ASan ve cualquier lectura fuera de [0, len)
+        size_t len = body + auth + 2;
+        uint8_t *frame = malloc(len);
+        uint16_t crc;
+
+        memcpy(frame, &data[pos], body);
+        if (auth) {
+            struct downlink_auth_stream mac;
+            size_t signed_len = body + DOWNLINK_AUTH_COUNTER_LEN;
+
+            counter++;
+            frame[body] = counter >> 24;
+            frame[body + 1] = counter >> 16;
+            frame[body + 2] = counter >> 8;
+            frame[body + 3] = counter;
+            downlink_auth_begin(&mac, DOWNLINK_AUTH_FRAME);
+            downlink_auth_update(&mac, frame, signed_len);
+            downlink_auth_final(&mac, &frame[signed_len]);
+        }
+        crc = crc16_ccitt(0xFFFF, frame, body + auth);
+        frame[body + auth] = crc >> 8;
+        frame[body + auth + 1] = crc & 0xFF;
+        pos += body;
+
+        downlink_dispatch(frame, len, &resp);
+        if (resp.len < DOWNLINK_ACK_LEN || resp.len > sizeof(resp.buf)) {
+            abort();
+        }
+        free(frame);
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * Archivo: fuzz_geofence_bind.c
+ * Descripción: Harness de geofence_set_bind() y de la evaluación sobre el blob aceptado.
+ *
+ * El CRC32 de la cabecera se recalcula sobre la entrada: sin ello casi ninguna mutación
+ * pasaría del CRC y el fuzzer no llegaría a la validación de registros.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/sys/crc.h>
+
+#include "geofence.h"
+
+#define GEOFENCE_HDR_LEN 12
+#define GEOFENCE_HDR_CRC_OFFSET 8
+
+static void on_event(const struct geofence_event *evt, void *ctx) {
+    (void)evt;
+    (void)ctx;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static struct geofence_set set;
+
+    if (size > GEOFENCE_BLOB_MAX) {
+        return 0;
+    }
+    // malloc alinea a 8: el blob se evalúa en sitio y bind exige alineación a 4
+    uint8_t *blob = malloc(size ? size : 1);
+
+    memcpy(blob, data, size);
+    if (size >= GEOFENCE_HDR_LEN) {
+        uint32_t crc = crc32_ieee(blob + GEOFENCE_HDR_LEN, size - GEOFENCE_HDR_LEN);
+
+        memcpy(blob + GEOFENCE_HDR_CRC_OFFSET, &crc, sizeof(crc));
+    }
+
+    if (geofence_set_bind(&set, blob, size) == 0) {
+        // Unos cuantos fixes repartidos por el globo recorren círculos y polígonos
+        static const struct geo_position probes[] = {
+            {.lat_udeg = 41385064, .lon_udeg = 2173403},
+            {.lat_udeg = -33868820, .lon_udeg = 151209296},
+            {.lat_udeg = 0, .lon_udeg = 0},
+            {.lat_udeg = 90000000, .lon_udeg = 180000000},
+            {.lat_udeg = -90000000, .lon_udeg = -180000000},
+        };
+
+        for (size_t i = 0; i < sizeof(probes) / sizeof(probes[0]); i++) {
+            geofence_set_evaluate(&set, &probes[i], (int64_t)i * 1000, on_event, NULL);
+            geofence_set_evaluate(&set, &probes[i], (int64_t)i * 1000 + 500, on_event, NULL);
+        }
+        // Y el centro de la bbox del primer registro, que sí pasa el pre-filtro
+        if (set.count > 0) {
+            int32_t bbox[4];
+            struct geo_position center;
+
+            memcpy(bbox, blob + GEOFENCE_HDR_LEN + 4, sizeof(bbox));
+            center.lat_udeg = (int32_t)(((int64_t)bbox[0] + bbox[2]) / 2);
+            center.lon_udeg = (int32_t)(((int64_t)bbox[1] + bbox[3]) / 2);
+            geofence_set_evaluate(&set, &center, 10000, on_event, NULL);
+            geofence_set_evaluate(&set, &center, 10500, on_event, NULL);
+        }
+    }
+    free(blob);
+    return 0;
+}
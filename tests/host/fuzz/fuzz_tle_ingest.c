@@ -0,0 +1,28 @@
+/*
+ * Archivo: fuzz_tle_ingest.c
+ * Descripción: Harness de tle_ingest(): bytes de red sin terminador, tal cual los
+ *              entrega el destino bulk BULK_TYPE_TLE.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tle.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    // Copia exacta en el heap: ASan detecta cualquier lectura más allá de size
+    uint8_t *copy = malloc(size ? size : 1);
+    struct tle_elements out;
+
+    memcpy(copy, data, size);
+    if (tle_ingest(copy, size, &out) == 0) {
+        // Un TLE aceptado siempre sale marcado como válido
+        if (!out.valid) {
+            abort();
+        }
+    }
+    free(copy);
+    return 0;
+}
@@ -0,0 +1,322 @@
+/*
+ * Archivo: gen_seeds.c
+ * Descripción: Corpus inicial de los harnesses: el TLE de SATELIOT_1 (ver default_tles
+ *              en src/main.c) y tramas válidas de cada opcode, con los CRCs y las
+ *              etiquetas de imagen calculados por las mismas funciones que el firmware
+ *              (la etiqueta de trama y el CRC-16 los añade el harness).
+ *
+ * Uso: gen_seeds <directorio>  ->  <directorio>/{tle_ingest,downlink,geofence_bind}/
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <zephyr/sys/crc.h>
+
+#include "bulk.h"
+#include "downlink.h"
+#include "downlink_auth.h"
+#include "erasure.h"
+#include "geofence.h"
+#include "params.h"
+#include "host_test_key.h"
+
+#define SAT1_LINE1 "1 60550U 24149CL 25071.82076637 .00007488 00000+0 68187-3 0 9999"
+#define SAT1_LINE2 "2 60550 97.7148 150.0635 0007556 170.3117 189.8251 14.95428546 31058"
+
+#define SEED_SESSION 0x5EED0001u
+#define SEED_BASE_SIZE 4096         // Slot primario del shim: borrado a 0xFF
+#define SEED_BUF_SIZE 2048
+
+struct seed_buf {
+    uint8_t data[SEED_BUF_SIZE];
+    size_t len;
+};
+
+static const char *out_dir;
+
+static void put_u8(struct seed_buf *b, uint8_t v) {
+    b->data[b->len++] = v;
+}
+
+static void put_be16(struct seed_buf *b, uint16_t v) {
+    put_u8(b, v >> 8);
+    put_u8(b, v & 0xFF);
+}
+
+static void put_be32(struct seed_buf *b, uint32_t v) {
+    put_be16(b, v >> 16);
+    put_be16(b, v & 0xFFFF);
+}
+
+static void put_le16(struct seed_buf *b, uint16_t v) {
+    put_u8(b, v & 0xFF);
+    put_u8(b, v >> 8);
+}
+
+static void put_le32(struct seed_buf *b, uint32_t v) {
+    put_le16(b, v & 0xFFFF);
+    put_le16(b, v >> 16);
+}
+
+static void put_bytes(struct seed_buf *b, const void *data, size_t len) {
+    memcpy(&b->data[b->len], data, len);
+    b->len += len;
+}
+
+// Etiqueta de imagen (FOTA) o de delta (DFU del módem) que lleva el BEGIN
+static void put_image_tag(struct seed_buf *b, const uint8_t *image, size_t len) {
+    struct downlink_auth_stream mac;
+
+    downlink_auth_begin(&mac, DOWNLINK_AUTH_IMAGE);
+    downlink_auth_update(&mac, image, len);
+    downlink_auth_final(&mac, &b->data[b->len]);
+    b->len += DOWNLINK_AUTH_TAG_LEN;
+}
+
+static int write_seed(const char *target, const char *name, const void *data, size_t len) {
+    char path[512];
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s/%s", out_dir, target);
+    if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+        perror(path);
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/%s/%s", out_dir, target, name);
+    f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    fwrite(data, 1, len, f);
+    fclose(f);
+    return 0;
+}
+
+// =================================================================
+//  TLE
+// =================================================================
+
+static int seeds_tle(void) {
+    static const char *const variants[][2] = {
+        {"sat1_lf", SAT1_LINE1 "\n" SAT1_LINE2},
+        {"sat1_crlf", SAT1_LINE1 "\r\n" SAT1_LINE2 "\r\n"},
+        {"sat1_named", "SATELIOT_1\n" SAT1_LINE1 "\n" SAT1_LINE2 "\n"},
+        {"sat1_named_crlf", "SATELIOT_1\r\n" SAT1_LINE1 "\r\n" SAT1_LINE2 "\r\n"},
+    };
+    int err = 0;
+
+    for (size_t i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+        err |= write_seed("tle_ingest", variants[i][0], variants[i][1], strlen(variants[i][1]));
+    }
+    return err;
+}
+
+// =================================================================
+//  GEOCERCAS
+// =================================================================
+
+// Círculo de 500 m en Barcelona y un cuadrado de ~2 km al lado, ambos con bbox válida
+static void geofence_blob(struct seed_buf *b) {
+    size_t body;
+
+    put_le32(b, GEOFENCE_MAGIC);
+    put_le16(b, GEOFENCE_VERSION);
+    put_le16(b, 2);
+    put_le32(b, 0);             // CRC, se rellena al final
+    body = b->len;
+
+    put_le16(b, 1);
+    put_u8(b, GEOFENCE_CIRCLE);
+    put_u8(b, 0);
+    put_le32(b, 41375064);
+    put_le32(b, 2163403);
+    put_le32(b, 41395064);
+    put_le32(b, 2183403);
+    put_le32(b, 41385064);
+    put_le32(b, 2173403);
+    put_le32(b, 500);
+
+    put_le16(b, 2);
+    put_u8(b, GEOFENCE_POLYGON);
+    put_u8(b, 4);
+    put_le32(b, 41400000);
+    put_le32(b, 2180000);
+    put_le32(b, 41420000);
+    put_le32(b, 2200000);
+    put_le32(b, 41400000);
+    put_le32(b, 2180000);
+    put_le32(b, 41420000);
+    put_le32(b, 2180000);
+    put_le32(b, 41420000);
+    put_le32(b, 2200000);
+    put_le32(b, 41400000);
+    put_le32(b, 2200000);
+
+    uint32_t crc = crc32_ieee(&b->data[body], b->len - body);
+
+    memcpy(&b->data[body - 4], &crc, sizeof(crc));
+}
+
+static int seeds_geofence(void) {
+    struct seed_buf b = {0};
+
+    geofence_blob(&b);
+    return write_seed("geofence_bind", "two_fences", b.data, b.len);
+}
+
+// =================================================================
+//  DOWNLINK: [longitud][opcode][payload], el harness añade el CRC
+// =================================================================
+
+static void frame_begin(struct seed_buf *b, size_t *len_pos, uint8_t op) {
+    *len_pos = b->len;
+    put_u8(b, 0);
+    put_u8(b, op);
+}
+
+static void frame_end(struct seed_buf *b, size_t len_pos) {
+    b->data[len_pos] = (uint8_t)(b->len - len_pos - 1);
+}
+
+// Un objeto de un solo bloque: BULK_BEGIN con su etiqueta y un símbolo sistemático por
+// cada ERASURE_SYMBOL_SIZE bytes
+static void bulk_object_frames(struct seed_buf *b, uint8_t type, const uint8_t *object, size_t size) {
+    size_t begin_pos;
+
+    frame_begin(b, &begin_pos, DOWNLINK_OP_BULK_BEGIN);
+    put_be32(b, SEED_SESSION + type);
+    put_u8(b, type);
+    put_be32(b, (uint32_t)size);
+    put_image_tag(b, object, size);
+    frame_end(b, begin_pos);
+
+    for (size_t esi = 0; esi * ERASURE_SYMBOL_SIZE < size; esi++) {
+        uint8_t symbol[ERASURE_SYMBOL_SIZE] = {0};
+        size_t chunk = size - esi * ERASURE_SYMBOL_SIZE;
+        size_t len_pos;
+
+        memcpy(symbol, &object[esi * ERASURE_SYMBOL_SIZE], chunk < sizeof(symbol) ? chunk : sizeof(symbol));
+        frame_begin(b, &len_pos, DOWNLINK_OP_BULK_SYMBOL);
+        put_be32(b, SEED_SESSION + type);
+        put_u8(b, type);
+        put_be32(b, (uint32_t)size);
+        put_be16(b, 0);
+        put_be16(b, (uint16_t)esi);
+        put_bytes(b, symbol, sizeof(symbol));
+        frame_end(b, len_pos);
+    }
+}
+
+static int seeds_downlink(void) {
+    static const uint8_t patch_data[] = "seed image";
+    static uint8_t base[SEED_BASE_SIZE];
+    struct seed_buf b;
+    size_t len_pos;
+    int err = 0;
+
+    // PARAM_SET con dos entradas
+    b.len = 0;
+    frame_begin(&b, &len_pos, DOWNLINK_OP_PARAM_SET);
+    put_u8(&b, 2);
+    put_u8(&b, PARAM_GNSS_FIX_TIMEOUT_S);
+    put_be32(&b, 120);
+    put_u8(&b, PARAM_TLE_UPDATE_INTERVAL_H);
+    put_be32(&b, 48);
+    frame_end(&b, len_pos);
+    err |= write_seed("downlink", "param_set", b.data, b.len);
+
+    // FOTA: BEGIN contra el slot primario borrado y ABORT, o un CHUNK con un INSERT que
+    // completa la imagen
+    memset(base, 0xFF, sizeof(base));
+    struct seed_buf patch = {0};
+
+    put_u8(&patch, 0x02);
+    put_be32(&patch, sizeof(patch_data));
+    put_bytes(&patch, patch_data, sizeof(patch_data));
+
+    b.len = 0;
+    frame_begin(&b, &len_pos, DOWNLINK_OP_FOTA_BEGIN);
+    put_be32(&b, SEED_SESSION);
+    put_be32(&b, (uint32_t)patch.len);
+    put_be32(&b, sizeof(patch_data));
+    put_be32(&b, crc32_ieee(patch_data, sizeof(patch_data)));
+    put_be32(&b, sizeof(base));
+    put_be32(&b, crc32_ieee(base, sizeof(base)));
+    put_image_tag(&b, patch_data, sizeof(patch_data));
+    frame_end(&b, len_pos);
+    size_t begin_len = b.len;
+
+    frame_begin(&b, &len_pos, DOWNLINK_OP_FOTA_ABORT);
+    put_be32(&b, SEED_SESSION);
+    frame_end(&b, len_pos);
+    err |= write_seed("downlink", "fota_begin_abort", b.data, b.len);
+
+    b.len = begin_len;
+    frame_begin(&b, &len_pos, DOWNLINK_OP_FOTA_CHUNK);
+    put_be32(&b, SEED_SESSION);
+    put_be32(&b, 0);
+    put_bytes(&b, patch.data, patch.len);
+    frame_end(&b, len_pos);
+    err |= write_seed("downlink", "fota_begin_chunk", b.data, b.len);
+
+    // DFU del módem: BEGIN, delta por bulk y ABORT
+    b.len = 0;
+    frame_begin(&b, &len_pos, DOWNLINK_OP_MODEM_DFU_BEGIN);
+    put_be32(&b, SEED_SESSION + BULK_TYPE_MODEM_DFU);
+    put_be32(&b, sizeof(patch_data));
+    put_be32(&b, crc32_ieee(patch_data, sizeof(patch_data)));
+    put_image_tag(&b, patch_data, sizeof(patch_data));
+    frame_end(&b, len_pos);
+    bulk_object_frames(&b, BULK_TYPE_MODEM_DFU, patch_data, sizeof(patch_data));
+    err |= write_seed("downlink", "modem_dfu_begin_bulk", b.data, b.len);
+    frame_begin(&b, &len_pos, DOWNLINK_OP_MODEM_DFU_ABORT);
+    put_be32(&b, SEED_SESSION + BULK_TYPE_MODEM_DFU);
+    frame_end(&b, len_pos);
+    err |= write_seed("downlink", "modem_dfu_begin_bulk_abort", b.data, b.len);
+
+    // Bulk TLE: [índice][longitud][texto] de SATELIOT_1
+    struct seed_buf tle = {0};
+    static const char tle_text[] = SAT1_LINE1 "\n" SAT1_LINE2;
+
+    put_u8(&tle, 0);
+    put_u8(&tle, sizeof(tle_text) - 1);
+    put_bytes(&tle, tle_text, sizeof(tle_text) - 1);
+    b.len = 0;
+    bulk_object_frames(&b, BULK_TYPE_TLE, tle.data, tle.len);
+    err |= write_seed("downlink", "bulk_tle", b.data, b.len);
+
+    // Bulk de geocercas
+    struct seed_buf fences = {0};
+
+    geofence_blob(&fences);
+    b.len = 0;
+    bulk_object_frames(&b, BULK_TYPE_GEOFENCE, fences.data, fences.len);
+    err |= write_seed("downlink", "bulk_geofence", b.data, b.len);
+
+    // Informe de pérdida de uplink: 9 de 10 recibidos
+    b.len = 0;
+    frame_begin(&b, &len_pos, DOWNLINK_OP_UPLINK_REPORT);
+    put_be16(&b, 9);
+    put_be16(&b, 10);
+    frame_end(&b, len_pos);
+    err |= write_seed("downlink", "uplink_report", b.data, b.len);
+    return err;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "Uso: %s <directorio>\n", argv[0]);
+        return 2;
+    }
+    out_dir = argv[1];
+    downlink_auth_provision(host_test_key);
+    if (mkdir(out_dir, 0755) != 0 && errno != EEXIST) {
+        perror(out_dir);
+        return 1;
+    }
+    return seeds_tle() | seeds_geofence() | seeds_downlink() ? 1 : 0;
+}
@@ -0,0 +1,255 @@
+/*
+ * Archivo: standalone_driver.c
+ * Descripción: Driver de mutación para compiladores sin libFuzzer (GCC). Ejecuta el
+ *              corpus y después mutaciones aleatorias de sus entradas hasta -runs o
+ *              -max_total_time, con ASan/UBSan detectando los fallos.
+ *
+ * Sin guía por cobertura: sirve para reproducir y como humo en CI. Para explorar de
+ * verdad se compila con Clang (-fsanitize=fuzzer), que usa el main de libFuzzer.
+ * Acepta el subconjunto de opciones de libFuzzer que usa el CMakeLists.txt; la
+ * entrada que provoca un fallo queda en crash-<ejecución> en el directorio actual.
+ */
+
+#include <dirent.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#if defined(__has_include)
+#if __has_include(<sanitizer/asan_interface.h>)
+#include <sanitizer/asan_interface.h>
+#define DRIVER_HAS_ASAN 1
+#endif
+#endif
+
+#define DRIVER_MAX_LEN_DEFAULT 4096
+#define DRIVER_MAX_CORPUS 1024
+#define DRIVER_REPORT_EVERY 100000
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+struct corpus_entry {
+    uint8_t *data;
+    size_t len;
+};
+
+static struct corpus_entry corpus[DRIVER_MAX_CORPUS];
+static size_t corpus_count;
+static uint8_t *current;
+static size_t current_len;
+static unsigned long long exec_count;
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+
+static uint64_t rng_next(void) {
+    // xorshift64*: determinista con -seed para reproducir una sesión
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1Dull;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void save_crash(void) {
+    char name[64];
+    FILE *f;
+
+    snprintf(name, sizeof(name), "crash-%llu", exec_count);
+    f = fopen(name, "wb");
+    if (f) {
+        fwrite(current, 1, current_len, f);
+        fclose(f);
+        fprintf(stderr, "Entrada guardada en %s (%zu bytes)\n", name, current_len);
+    }
+}
+
+static void corpus_add_file(const char *path, size_t max_len) {
+    FILE *f = fopen(path, "rb");
+    struct corpus_entry *e;
+
+    if (!f || corpus_count == DRIVER_MAX_CORPUS) {
+        if (f) {
+            fclose(f);
+        }
+        return;
+    }
+    e = &corpus[corpus_count];
+    e->data = malloc(max_len);
+    e->len = fread(e->data, 1, max_len, f);
+    fclose(f);
+    corpus_count++;
+}
+
+static void corpus_add(const char *path, size_t max_len) {
+    struct stat st;
+    DIR *dir;
+    struct dirent *de;
+
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "No existe: %s\n", path);
+        return;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        corpus_add_file(path, max_len);
+        return;
+    }
+    dir = opendir(path);
+    while (dir && (de = readdir(dir)) != NULL) {
+        char child[4096];
+
+        if (de->d_name[0] == '.') {
+            continue;
+        }
+        snprintf(child, sizeof(child), "%s/%s", path, de->d_name);
+        corpus_add_file(child, max_len);
+    }
+    if (dir) {
+        closedir(dir);
+    }
+}
+
+static void mutate(uint8_t *buf, size_t *len, size_t max_len) {
+    int rounds = 1 + (int)(rng_next() % 8);
+
+    for (int r = 0; r < rounds; r++) {
+        size_t pos = *len ? (size_t)(rng_next() % *len) : 0;
+
+        switch (rng_next() % 7) {
+        case 0:     // Bit
+            if (*len) {
+                buf[pos] ^= (uint8_t)(1u << (rng_next() % 8));
+            }
+            break;
+        case 1:     // Byte aleatorio
+            if (*len) {
+                buf[pos] = (uint8_t)rng_next();
+            }
+            break;
+        case 2: {   // Valor frontera
+            static const uint8_t edge[] = {0x00, 0x01, 0x7F, 0x80, 0xFF, '\n', '\r', ' ', '0', '9'};
+
+            if (*len) {
+                buf[pos] = edge[rng_next() % sizeof(edge)];
+            }
+            break;
+        }
+        case 3:     // Insertar
+            if (*len < max_len) {
+                memmove(&buf[pos + 1], &buf[pos], *len - pos);
+                buf[pos] = (uint8_t)rng_next();
+                (*len)++;
+            }
+            break;
+        case 4:     // Borrar
+            if (*len) {
+                memmove(&buf[pos], &buf[pos + 1], *len - pos - 1);
+                (*len)--;
+            }
+            break;
+        case 5:     // Truncar
+            *len = pos;
+            break;
+        default: {  // Empalme con otra entrada del corpus
+            const struct corpus_entry *other = &corpus[rng_next() % corpus_count];
+            size_t from = other->len ? (size_t)(rng_next() % other->len) : 0;
+            size_t n = other->len - from;
+
+            if (pos + n > max_len) {
+                n = max_len - pos;
+            }
+            memcpy(&buf[pos], &other->data[from], n);
+            if (pos + n > *len) {
+                *len = pos + n;
+            }
+            break;
+        }
+        }
+    }
+}
+
+static void run_one(const uint8_t *data, size_t len) {
+    memcpy(current, data, len);
+    current_len = len;
+    LLVMFuzzerTestOneInput(current, current_len);
+    exec_count++;
+}
+
+int main(int argc, char **argv) {
+    unsigned long long runs = 0;
+    double max_time = 0;
+    size_t max_len = DRIVER_MAX_LEN_DEFAULT;
+    uint8_t *scratch;
+    double start;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "-runs=", 6) == 0) {
+            runs = strtoull(argv[i] + 6, NULL, 10);
+        } else if (strncmp(argv[i], "-max_total_time=", 16) == 0) {
+            max_time = strtod(argv[i] + 16, NULL);
+        } else if (strncmp(argv[i], "-max_len=", 9) == 0) {
+            max_len = strtoull(argv[i] + 9, NULL, 10);
+        } else if (strncmp(argv[i], "-seed=", 6) == 0) {
+            rng_state = strtoull(argv[i] + 6, NULL, 10) | 1;
+        }
+    }
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') {
+            corpus_add(argv[i], max_len);
+        }
+    }
+    if (corpus_count == 0) {
+        // Sin corpus se arranca desde la entrada vacía
+        corpus[0].data = malloc(max_len);
+        corpus[0].len = 0;
+        corpus_count = 1;
+    }
+
+    current = malloc(max_len);
+    scratch = malloc(max_len);
+#ifdef DRIVER_HAS_ASAN
+    __asan_set_death_callback(save_crash);
+#endif
+
+    start = now_s();
+    for (size_t i = 0; i < corpus_count; i++) {
+        run_one(corpus[i].data, corpus[i].len);
+    }
+    printf("INITED corpus: %zu entradas\n", corpus_count);
+
+    while ((runs == 0 || exec_count < runs) && (max_time == 0 || now_s() - start < max_time)) {
+        const struct corpus_entry *base = &corpus[rng_next() % corpus_count];
+        size_t len = base->len;
+
+        if (runs == 0 && max_time == 0) {
+            break;      // Sin límites solo se reproduce el corpus, como libFuzzer con ficheros
+        }
+        memcpy(scratch, base->data, len);
+        mutate(scratch, &len, max_len);
+        run_one(scratch, len);
+        if (exec_count % DRIVER_REPORT_EVERY == 0) {
+            double elapsed = now_s() - start;
+
+            printf("#%llu exec/s: %.0f\n", exec_count, exec_count / elapsed);
+        }
+    }
+
+    double elapsed = now_s() - start;
+
+    printf("Done %llu runs in %.1f s, exec/s: %.0f\n", exec_count, elapsed,
+           elapsed > 0 ? exec_count / elapsed : 0.0);
+
+    for (size_t i = 0; i < corpus_count; i++) {
+        free(corpus[i].data);
+    }
+    free(scratch);
+    free(current);
+    return 0;
+}
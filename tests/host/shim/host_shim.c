@@ -0,0 +1,614 @@
+/*
+ * Archivo: host_shim.c
+ * Descripción: Implementación de host de los servicios de Zephyr/NCS que usan
+ *              los módulos (ver include/). Estado global en RAM, un solo hilo.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/dfu/mcuboot.h>
+#include <zephyr/sys/crc.h>
+#include <nrf_modem_delta_dfu.h>
+#include <mbedtls/constant_time.h>
+#include <mbedtls/sha256.h>
+#include <psa/crypto.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// =================================================================
+//  TIEMPO
+// =================================================================
+
+static int64_t uptime_ms;
+
+void host_shim_set_uptime(int64_t ms) {
+    uptime_ms = ms;
+}
+
+int64_t k_uptime_get(void) {
+    return uptime_ms;
+}
+
+uint32_t k_uptime_get_32(void) {
+    return (uint32_t)uptime_ms;
+}
+
+int32_t k_sleep(k_timeout_t timeout) {
+    if (timeout.ms > 0) {
+        uptime_ms += timeout.ms;
+    }
+    return 0;
+}
+
+uint32_t k_cycle_get_32(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+uint32_t k_cyc_to_us_floor32(uint32_t cycles) {
+    return cycles / 1000;
+}
+
+// =================================================================
+//  COLAS Y TRABAJO DIFERIDO
+// =================================================================
+
+int k_msgq_put(struct k_msgq *q, const void *data, k_timeout_t timeout) {
+    (void)timeout;
+    if (q->used == q->max_msgs) {
+        return -ENOMSG;
+    }
+    uint32_t slot = (q->read + q->used) % q->max_msgs;
+
+    memcpy(q->buffer + slot * q->msg_size, data, q->msg_size);
+    q->used++;
+    return 0;
+}
+
+int k_msgq_get(struct k_msgq *q, void *data, k_timeout_t timeout) {
+    (void)timeout;
+    if (q->used == 0) {
+        return -ENOMSG;
+    }
+    memcpy(data, q->buffer + q->read * q->msg_size, q->msg_size);
+    q->read = (q->read + 1) % q->max_msgs;
+    q->used--;
+    return 0;
+}
+
+int k_msgq_peek(struct k_msgq *q, void *data) {
+    if (q->used == 0) {
+        return -ENOMSG;
+    }
+    memcpy(data, q->buffer + q->read * q->msg_size, q->msg_size);
+    return 0;
+}
+
+uint32_t k_msgq_num_used_get(struct k_msgq *q) {
+    return q->used;
+}
+
+uint32_t k_msgq_num_free_get(struct k_msgq *q) {
+    return q->max_msgs - q->used;
+}
+
+void k_msgq_purge(struct k_msgq *q) {
+    q->read = 0;
+    q->used = 0;
+}
+
+int k_work_submit(struct k_work *work) {
+    work->handler(work);
+    return 1;
+}
+
+// =================================================================
+//  SETTINGS EN RAM
+// =================================================================
+
+#define SETTINGS_MAX_ENTRIES 32
+#define SETTINGS_MAX_NAME    32
+#define SETTINGS_MAX_VALUE   4096
+
+struct settings_entry {
+    char name[SETTINGS_MAX_NAME];
+    size_t len;
+    uint8_t value[SETTINGS_MAX_VALUE];
+};
+
+static struct settings_entry entries[SETTINGS_MAX_ENTRIES];
+static int entry_count;
+
+struct settings_read_ctx {
+    const struct settings_entry *entry;
+};
+
+static ssize_t settings_read(void *cb_arg, void *data, size_t len) {
+    struct settings_read_ctx *ctx = cb_arg;
+    size_t n = MIN(len, ctx->entry->len);
+
+    memcpy(data, ctx->entry->value, n);
+    return (ssize_t)n;
+}
+
+static struct settings_entry *settings_find(const char *name) {
+    for (int i = 0; i < entry_count; i++) {
+        if (strcmp(entries[i].name, name) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+void host_shim_settings_reset(void) {
+    entry_count = 0;
+}
+
+int settings_subsys_init(void) {
+    return 0;
+}
+
+int settings_save_one(const char *name, const void *value, size_t val_len) {
+    struct settings_entry *entry = settings_find(name);
+
+    if (strlen(name) >= SETTINGS_MAX_NAME || val_len > SETTINGS_MAX_VALUE) {
+        return -ENOMEM;
+    }
+    if (!entry) {
+        if (entry_count == SETTINGS_MAX_ENTRIES) {
+            return -ENOSPC;
+        }
+        entry = &entries[entry_count++];
+        strcpy(entry->name, name);
+    }
+    memcpy(entry->value, value, val_len);
+    entry->len = val_len;
+    return 0;
+}
+
+int settings_delete(const char *name) {
+    struct settings_entry *entry = settings_find(name);
+
+    if (entry) {
+        *entry = entries[--entry_count];
+    }
+    return 0;
+}
+
+int settings_load_subtree_direct(const char *subtree, settings_load_direct_cb cb, void *param) {
+    size_t prefix = strlen(subtree);
+
+    for (int i = 0; i < entry_count; i++) {
+        const char *name = entries[i].name;
+
+        if (strncmp(name, subtree, prefix) != 0 || (name[prefix] != '\0' && name[prefix] != '/')) {
+            continue;
+        }
+        struct settings_read_ctx ctx = { &entries[i] };
+        const char *key = name[prefix] == '/' ? &name[prefix + 1] : NULL;
+        int err = cb(key, entries[i].len, settings_read, &ctx, param);
+
+        if (err) {
+            return err;
+        }
+    }
+    return 0;
+}
+
+// =================================================================
+//  FLASH (slot0/slot1) Y MCUBOOT
+// =================================================================
+
+#define HOST_SHIM_TRAILER_SIZE 4096
+
+static uint8_t slot_mem[2][HOST_SHIM_SLOT_SIZE];
+static const struct flash_area slots[2] = {
+    { 0, 0, HOST_SHIM_SLOT_SIZE },
+    { 1, HOST_SHIM_SLOT_SIZE, HOST_SHIM_SLOT_SIZE },
+};
+static bool slots_ready;
+
+static int slot_check(const struct flash_area *fa, off_t off, size_t len) {
+    return off < 0 || (size_t)off > fa->fa_size || len > fa->fa_size - (size_t)off ? -EINVAL : 0;
+}
+
+int flash_area_open(uint8_t id, const struct flash_area **fa) {
+    if (id >= ARRAY_SIZE(slots)) {
+        return -ENOENT;
+    }
+    if (!slots_ready) {
+        memset(slot_mem, 0xFF, sizeof(slot_mem));
+        slots_ready = true;
+    }
+    *fa = &slots[id];
+    return 0;
+}
+
+void flash_area_close(const struct flash_area *fa) {
+    (void)fa;
+}
+
+int flash_area_read(const struct flash_area *fa, off_t off, void *dst, size_t len) {
+    int err = slot_check(fa, off, len);
+
+    if (err == 0) {
+        memcpy(dst, &slot_mem[fa->fa_id][off], len);
+    }
+    return err;
+}
+
+// Como el simulador de flash sin doble escritura: solo se escribe sobre bytes borrados
+int flash_area_write(const struct flash_area *fa, off_t off, const void *src, size_t len) {
+    int err = slot_check(fa, off, len);
+
+    for (size_t i = 0; err == 0 && i < len; i++) {
+        if (slot_mem[fa->fa_id][off + i] != 0xFF) {
+            err = -EIO;
+        }
+    }
+    if (err == 0) {
+        memcpy(&slot_mem[fa->fa_id][off], src, len);
+    }
+    return err;
+}
+
+int flash_area_erase(const struct flash_area *fa, off_t off, size_t len) {
+    int err = slot_check(fa, off, len);
+
+    if (err == 0) {
+        memset(&slot_mem[fa->fa_id][off], 0xFF, len);
+    }
+    return err;
+}
+
+int boot_request_upgrade(int permanent) {
+    (void)permanent;
+    return 0;
+}
+
+bool boot_is_img_confirmed(void) {
+    return true;
+}
+
+int boot_write_img_confirmed(void) {
+    return 0;
+}
+
+ssize_t boot_get_area_trailer_status_offset(uint8_t area_id) {
+    return area_id < ARRAY_SIZE(slots) ? (ssize_t)(HOST_SHIM_SLOT_SIZE - HOST_SHIM_TRAILER_SIZE) : -ENOENT;
+}
+
+// =================================================================
+//  DFU DELTA DEL MÓDEM
+// =================================================================
+
+#define MODEM_DFU_AREA_SIZE (128 * 1024)
+
+#define MODEM_DFU_ERASE_POLLS 2     // Consultas del offset que dura el borrado
+
+static size_t modem_dfu_offset;
+static int modem_dfu_erase_polls;
+
+int nrf_modem_delta_dfu_offset(size_t *offset) {
+    if (modem_dfu_erase_polls > 0) {
+        modem_dfu_erase_polls--;
+        return NRF_MODEM_DELTA_DFU_ERASE_PENDING;
+    }
+    *offset = modem_dfu_offset;
+    return 0;
+}
+
+int nrf_modem_delta_dfu_area(size_t *size) {
+    *size = MODEM_DFU_AREA_SIZE;
+    return 0;
+}
+
+int nrf_modem_delta_dfu_erase(void) {
+    modem_dfu_offset = 0;
+    modem_dfu_erase_polls = MODEM_DFU_ERASE_POLLS;
+    return 0;
+}
+
+int nrf_modem_delta_dfu_write_init(void) {
+    return 0;
+}
+
+int nrf_modem_delta_dfu_write(const void *buf, size_t len) {
+    (void)buf;
+    if (len > MODEM_DFU_AREA_SIZE - modem_dfu_offset) {
+        return -ENOSPC;
+    }
+    modem_dfu_offset += len;
+    return 0;
+}
+
+int nrf_modem_delta_dfu_write_done(void) {
+    return 0;
+}
+
+int nrf_modem_delta_dfu_update(void) {
+    return 0;
+}
+
+// =================================================================
+//  CRC (mismas definiciones que lib/crc de Zephyr)
+// =================================================================
+
+uint16_t crc16_ccitt(uint16_t seed, const uint8_t *src, size_t len) {
+    for (; len > 0; len--) {
+        uint8_t e, f;
+
+        e = seed ^ *src++;
+        f = e ^ (e << 4);
+        seed = (seed >> 8) ^ ((uint16_t)f << 8) ^ ((uint16_t)f << 3) ^ ((uint16_t)f >> 4);
+    }
+    return seed;
+}
+
+uint32_t crc32_ieee_update(uint32_t crc, const uint8_t *data, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+uint32_t crc32_ieee(const uint8_t *data, size_t len) {
+    return crc32_ieee_update(0, data, len);
+}
+
+// =================================================================
+//  SHA-256 DE MBEDTLS (FIPS 180-4)
+// =================================================================
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static uint32_t ror32(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+static void sha256_block(uint32_t h[8], const uint8_t *p) {
+    uint32_t w[64];
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)p[4 * i] << 24) | ((uint32_t)p[4 * i + 1] << 16) | ((uint32_t)p[4 * i + 2] << 8) |
+               p[4 * i + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = ror32(w[i - 15], 7) ^ ror32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ror32(w[i - 2], 17) ^ ror32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = hh + (ror32(e, 6) ^ ror32(e, 11) ^ ror32(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+        uint32_t t2 = (ror32(a, 2) ^ ror32(a, 13) ^ ror32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+
+        hh = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+    h[5] += f;
+    h[6] += g;
+    h[7] += hh;
+}
+
+void mbedtls_sha256_init(mbedtls_sha256_context *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void mbedtls_sha256_free(mbedtls_sha256_context *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+int mbedtls_sha256_starts(mbedtls_sha256_context *ctx, int is224) {
+    static const uint32_t iv[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+
+    if (is224) {
+        return -0x0074;     // MBEDTLS_ERR_SHA256_BAD_INPUT_DATA: sin SHA-224 en el shim
+    }
+    memcpy(ctx->state, iv, sizeof(iv));
+    ctx->total[0] = 0;
+    ctx->total[1] = 0;
+    ctx->is224 = 0;
+    return 0;
+}
+
+// total[0] lleva los 32 bits bajos del número de bytes y total[1] los altos, como mbedTLS
+int mbedtls_sha256_update(mbedtls_sha256_context *ctx, const unsigned char *input, size_t ilen) {
+    size_t fill = ctx->total[0] % 64;
+
+    ctx->total[0] += (uint32_t)ilen;
+    ctx->total[1] += (uint32_t)((uint64_t)ilen >> 32) + (ctx->total[0] < (uint32_t)ilen);
+    while (ilen > 0) {
+        size_t n = MIN(ilen, 64 - fill);
+
+        memcpy(&ctx->buffer[fill], input, n);
+        fill += n;
+        input += n;
+        ilen -= n;
+        if (fill == 64) {
+            sha256_block(ctx->state, ctx->buffer);
+            fill = 0;
+        }
+    }
+    return 0;
+}
+
+int mbedtls_sha256_finish(mbedtls_sha256_context *ctx, unsigned char *output) {
+    uint64_t bits = (((uint64_t)ctx->total[1] << 32) | ctx->total[0]) * 8;
+    uint8_t pad[72] = { 0x80 };
+    size_t fill = ctx->total[0] % 64;
+    size_t pad_len = (fill < 56 ? 56 : 120) - fill;
+
+    for (int i = 0; i < 8; i++) {
+        pad[pad_len + i] = (uint8_t)(bits >> (56 - 8 * i));
+    }
+    mbedtls_sha256_update(ctx, pad, pad_len + 8);
+    for (int i = 0; i < 8; i++) {
+        output[4 * i] = (uint8_t)(ctx->state[i] >> 24);
+        output[4 * i + 1] = (uint8_t)(ctx->state[i] >> 16);
+        output[4 * i + 2] = (uint8_t)(ctx->state[i] >> 8);
+        output[4 * i + 3] = (uint8_t)ctx->state[i];
+    }
+    return 0;
+}
+
+int mbedtls_ct_memcmp(const void *a, const void *b, size_t n) {
+    const uint8_t *pa = a, *pb = b;
+    uint8_t diff = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        diff |= pa[i] ^ pb[i];
+    }
+    return diff;
+}
+
+// =================================================================
+//  PSA CRYPTO (CLAVES HMAC VOLÁTILES)
+// =================================================================
+
+#define PSA_KEY_SLOTS 4
+#define PSA_HMAC_BLOCK 64
+
+struct psa_key_slot {
+    bool used;
+    psa_key_attributes_t attr;
+    uint8_t data[PSA_HMAC_BLOCK];
+    size_t len;
+};
+
+static struct psa_key_slot psa_keys[PSA_KEY_SLOTS];
+
+static struct psa_key_slot *psa_key_get(psa_key_id_t key) {
+    return key >= 1 && key <= PSA_KEY_SLOTS && psa_keys[key - 1].used ? &psa_keys[key - 1] : NULL;
+}
+
+static void psa_hmac_key_block(mbedtls_sha256_context *sha, const struct psa_key_slot *slot, uint8_t pad) {
+    uint8_t block[PSA_HMAC_BLOCK];
+
+    memset(block, pad, sizeof(block));
+    for (size_t i = 0; i < slot->len; i++) {
+        block[i] ^= slot->data[i];
+    }
+    mbedtls_sha256_update(sha, block, sizeof(block));
+}
+
+psa_status_t psa_crypto_init(void) {
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_import_key(const psa_key_attributes_t *attr, const uint8_t *data, size_t data_length,
+                            psa_key_id_t *key) {
+    if (attr->type != PSA_KEY_TYPE_HMAC || data_length > PSA_HMAC_BLOCK ||
+        (attr->bits != 0 && attr->bits != data_length * 8)) {
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+    for (size_t i = 0; i < PSA_KEY_SLOTS; i++) {
+        if (!psa_keys[i].used) {
+            psa_keys[i].used = true;
+            psa_keys[i].attr = *attr;
+            memcpy(psa_keys[i].data, data, data_length);
+            psa_keys[i].len = data_length;
+            *key = (psa_key_id_t)(i + 1);
+            return PSA_SUCCESS;
+        }
+    }
+    return PSA_ERROR_INSUFFICIENT_MEMORY;
+}
+
+psa_status_t psa_destroy_key(psa_key_id_t key) {
+    struct psa_key_slot *slot = psa_key_get(key);
+
+    if (!slot) {
+        return key == PSA_KEY_ID_NULL ? PSA_SUCCESS : PSA_ERROR_INVALID_HANDLE;
+    }
+    memset(slot, 0, sizeof(*slot));
+    return PSA_SUCCESS;
+}
+
+// Solo HMAC-SHA256, completo o truncado
+psa_status_t psa_mac_verify_setup(psa_mac_operation_t *operation, psa_key_id_t key, psa_algorithm_t alg) {
+    const struct psa_key_slot *slot = psa_key_get(key);
+    size_t mac_len = (alg >> 16) & 0x3f;
+
+    if (operation->key != PSA_KEY_ID_NULL) {
+        return PSA_ERROR_BAD_STATE;
+    }
+    if (!slot) {
+        return PSA_ERROR_INVALID_HANDLE;
+    }
+    if ((alg & ~0x003f0000u) != PSA_ALG_HMAC(PSA_ALG_SHA_256) || mac_len > 32) {
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+    if (!(slot->attr.usage & PSA_KEY_USAGE_VERIFY_MESSAGE) || slot->attr.alg != alg) {
+        return PSA_ERROR_NOT_PERMITTED;
+    }
+    operation->key = key;
+    operation->mac_len = mac_len ? mac_len : 32;
+    mbedtls_sha256_starts(&operation->sha, 0);
+    psa_hmac_key_block(&operation->sha, slot, 0x36);
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_mac_update(psa_mac_operation_t *operation, const uint8_t *input, size_t input_length) {
+    if (operation->key == PSA_KEY_ID_NULL) {
+        return PSA_ERROR_BAD_STATE;
+    }
+    mbedtls_sha256_update(&operation->sha, input, input_length);
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_mac_verify_finish(psa_mac_operation_t *operation, const uint8_t *mac, size_t mac_length) {
+    const struct psa_key_slot *slot = psa_key_get(operation->key);
+    uint8_t digest[32];
+    psa_status_t status;
+
+    if (!slot) {
+        return PSA_ERROR_BAD_STATE;
+    }
+    mbedtls_sha256_finish(&operation->sha, digest);
+    mbedtls_sha256_starts(&operation->sha, 0);
+    psa_hmac_key_block(&operation->sha, slot, 0x5c);
+    mbedtls_sha256_update(&operation->sha, digest, sizeof(digest));
+    mbedtls_sha256_finish(&operation->sha, digest);
+    status = mac_length != operation->mac_len || mbedtls_ct_memcmp(digest, mac, mac_length) != 0
+                 ? PSA_ERROR_INVALID_SIGNATURE
+                 : PSA_SUCCESS;
+    psa_mac_abort(operation);
+    return status;
+}
+
+psa_status_t psa_mac_abort(psa_mac_operation_t *operation) {
+    memset(operation, 0, sizeof(*operation));
+    return PSA_SUCCESS;
+}
@@ -0,0 +1,20 @@
+/*
+ * Archivo: host_test_key.h
+ * Descripción: Clave de downlink (downlink_auth.h) común a las herramientas de host:
+ *              las semillas, el harness de downlink y el servidor VAS de prueba firman
+ *              con ella lo mismo que el firmware verifica.
+ */
+
+#ifndef HOST_TEST_KEY_H_
+#define HOST_TEST_KEY_H_
+
+#include <stdint.h>
+
+#include "downlink_auth.h"
+
+static const uint8_t host_test_key[DOWNLINK_AUTH_KEY_LEN] = {
+    0x4e, 0x54, 0x4e, 0x2d, 0x68, 0x6f, 0x73, 0x74, 0x2d, 0x74, 0x65, 0x73, 0x74, 0x2d, 0x6b, 0x65,
+    0x79, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+};
+
+#endif /* HOST_TEST_KEY_H_ */
@@ -0,0 +1,13 @@
+/*
+ * Archivo: mbedtls/constant_time.h (shim de host)
+ * Descripción: Comparación de memoria en tiempo constante de mbedTLS.
+ */
+
+#ifndef HOST_SHIM_MBEDTLS_CONSTANT_TIME_H_
+#define HOST_SHIM_MBEDTLS_CONSTANT_TIME_H_
+
+#include <stddef.h>
+
+int mbedtls_ct_memcmp(const void *a, const void *b, size_t n);
+
+#endif /* HOST_SHIM_MBEDTLS_CONSTANT_TIME_H_ */
@@ -0,0 +1,16 @@
+/*
+ * Archivo: nrf_modem.h (shim de host)
+ * Descripción: Códigos de resultado de DFU del módem.
+ */
+
+#ifndef HOST_SHIM_NRF_MODEM_H_
+#define HOST_SHIM_NRF_MODEM_H_
+
+#define NRF_MODEM_DFU_RESULT_OK             0x5500001
+#define NRF_MODEM_DFU_RESULT_UUID_ERROR     0x4400001
+#define NRF_MODEM_DFU_RESULT_AUTH_ERROR     0x4400002
+#define NRF_MODEM_DFU_RESULT_HARDWARE_ERROR 0x4400003
+#define NRF_MODEM_DFU_RESULT_INTERNAL_ERROR 0x4400004
+#define NRF_MODEM_DFU_RESULT_VOLTAGE_LOW    0x5500002
+
+#endif /* HOST_SHIM_NRF_MODEM_H_ */
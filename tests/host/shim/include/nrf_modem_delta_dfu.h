@@ -0,0 +1,22 @@
+/*
+ * Archivo: nrf_modem_delta_dfu.h (shim de host)
+ * Descripción: Área de parche delta del módem en RAM.
+ */
+
+#ifndef HOST_SHIM_NRF_MODEM_DELTA_DFU_H_
+#define HOST_SHIM_NRF_MODEM_DELTA_DFU_H_
+
+#include <stddef.h>
+
+#define NRF_MODEM_DELTA_DFU_ERASE_PENDING 1
+#define NRF_MODEM_DELTA_DFU_OFFSET_DIRTY  2
+
+int nrf_modem_delta_dfu_offset(size_t *offset);
+int nrf_modem_delta_dfu_area(size_t *size);
+int nrf_modem_delta_dfu_erase(void);
+int nrf_modem_delta_dfu_write_init(void);
+int nrf_modem_delta_dfu_write(const void *buf, size_t len);
+int nrf_modem_delta_dfu_write_done(void);
+int nrf_modem_delta_dfu_update(void);
+
+#endif /* HOST_SHIM_NRF_MODEM_DELTA_DFU_H_ */
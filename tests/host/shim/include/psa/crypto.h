@@ -0,0 +1,84 @@
+/*
+ * Archivo: psa/crypto.h (shim de host)
+ * Descripción: Subconjunto de PSA Crypto que usa downlink_auth.c: claves HMAC volátiles
+ *              y verificación de MAC por partes. Mismos valores de algoritmos y errores
+ *              que la especificación.
+ */
+
+#ifndef HOST_SHIM_PSA_CRYPTO_H_
+#define HOST_SHIM_PSA_CRYPTO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mbedtls/sha256.h>
+
+typedef int32_t psa_status_t;
+typedef uint32_t psa_key_id_t;
+typedef uint32_t psa_algorithm_t;
+typedef uint16_t psa_key_type_t;
+typedef uint32_t psa_key_usage_t;
+
+#define PSA_SUCCESS                    ((psa_status_t)0)
+#define PSA_ERROR_NOT_SUPPORTED        ((psa_status_t)-134)
+#define PSA_ERROR_NOT_PERMITTED        ((psa_status_t)-133)
+#define PSA_ERROR_INVALID_ARGUMENT     ((psa_status_t)-135)
+#define PSA_ERROR_INVALID_HANDLE       ((psa_status_t)-136)
+#define PSA_ERROR_BAD_STATE            ((psa_status_t)-137)
+#define PSA_ERROR_INSUFFICIENT_MEMORY  ((psa_status_t)-141)
+#define PSA_ERROR_INVALID_SIGNATURE    ((psa_status_t)-149)
+
+#define PSA_KEY_ID_NULL ((psa_key_id_t)0)
+#define PSA_KEY_TYPE_HMAC ((psa_key_type_t)0x1100)
+#define PSA_KEY_USAGE_SIGN_MESSAGE ((psa_key_usage_t)0x00000400)
+#define PSA_KEY_USAGE_VERIFY_MESSAGE ((psa_key_usage_t)0x00000800)
+
+#define PSA_ALG_SHA_256 ((psa_algorithm_t)0x02000009)
+#define PSA_ALG_HMAC(hash_alg) ((psa_algorithm_t)(0x03800000 | ((hash_alg) & 0xff)))
+#define PSA_ALG_TRUNCATED_MAC(mac_alg, mac_length) \
+    ((psa_algorithm_t)(((mac_alg) & ~0x003f0000u) | (((mac_length) & 0x3fu) << 16)))
+
+typedef struct {
+    psa_key_type_t type;
+    size_t bits;
+    psa_key_usage_t usage;
+    psa_algorithm_t alg;
+} psa_key_attributes_t;
+
+#define PSA_KEY_ATTRIBUTES_INIT { 0 }
+
+static inline void psa_set_key_type(psa_key_attributes_t *attr, psa_key_type_t type) {
+    attr->type = type;
+}
+
+static inline void psa_set_key_bits(psa_key_attributes_t *attr, size_t bits) {
+    attr->bits = bits;
+}
+
+static inline void psa_set_key_usage_flags(psa_key_attributes_t *attr, psa_key_usage_t usage) {
+    attr->usage = usage;
+}
+
+static inline void psa_set_key_algorithm(psa_key_attributes_t *attr, psa_algorithm_t alg) {
+    attr->alg = alg;
+}
+
+// HMAC-SHA256 en curso sobre la clave de un slot del shim
+typedef struct {
+    psa_key_id_t key;
+    size_t mac_len;
+    mbedtls_sha256_context sha;
+} psa_mac_operation_t;
+
+#define PSA_MAC_OPERATION_INIT { 0 }
+
+psa_status_t psa_crypto_init(void);
+psa_status_t psa_import_key(const psa_key_attributes_t *attr, const uint8_t *data, size_t data_length,
+                            psa_key_id_t *key);
+psa_status_t psa_destroy_key(psa_key_id_t key);
+
+psa_status_t psa_mac_verify_setup(psa_mac_operation_t *operation, psa_key_id_t key, psa_algorithm_t alg);
+psa_status_t psa_mac_update(psa_mac_operation_t *operation, const uint8_t *input, size_t input_length);
+psa_status_t psa_mac_verify_finish(psa_mac_operation_t *operation, const uint8_t *mac, size_t mac_length);
+psa_status_t psa_mac_abort(psa_mac_operation_t *operation);
+
+#endif /* HOST_SHIM_PSA_CRYPTO_H_ */
@@ -0,0 +1,22 @@
+/*
+ * Archivo: zephyr/dfu/mcuboot.h (shim de host)
+ * Descripción: Petición de swap de MCUboot sin efecto; la imagen arranca confirmada.
+ *              El trailer ocupa la última página de cada slot.
+ */
+
+#ifndef HOST_SHIM_MCUBOOT_H_
+#define HOST_SHIM_MCUBOOT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define BOOT_UPGRADE_TEST      0
+#define BOOT_UPGRADE_PERMANENT 1
+
+int boot_request_upgrade(int permanent);
+bool boot_is_img_confirmed(void);
+int boot_write_img_confirmed(void);
+ssize_t boot_get_area_trailer_status_offset(uint8_t area_id);
+
+#endif /* HOST_SHIM_MCUBOOT_H_ */
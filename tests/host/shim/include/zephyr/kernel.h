@@ -0,0 +1,112 @@
+/*
+ * Archivo: zephyr/kernel.h (shim de host)
+ * Descripción: Subconjunto del kernel que usan los módulos independientes del
+ *              hardware. Un solo hilo: el trabajo se ejecuta al enviarlo y el
+ *              uptime solo avanza con k_sleep().
+ */
+
+#ifndef HOST_SHIM_KERNEL_H_
+#define HOST_SHIM_KERNEL_H_
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+    int64_t ms;
+} k_timeout_t;
+
+#define K_MSEC(x)       ((k_timeout_t){ (x) })
+#define K_SECONDS(x)    ((k_timeout_t){ (int64_t)(x) * 1000 })
+#define K_MINUTES(x)    ((k_timeout_t){ (int64_t)(x) * 60000 })
+#define K_HOURS(x)      ((k_timeout_t){ (int64_t)(x) * 3600000 })
+#define K_FOREVER       ((k_timeout_t){ -1 })
+#define K_NO_WAIT       ((k_timeout_t){ 0 })
+
+int64_t k_uptime_get(void);
+uint32_t k_uptime_get_32(void);
+int32_t k_sleep(k_timeout_t timeout);
+uint32_t k_cycle_get_32(void);
+uint32_t k_cyc_to_us_floor32(uint32_t cycles);
+
+// Reloj simulado: lo ajustan las herramientas de host
+void host_shim_set_uptime(int64_t ms);
+
+struct k_msgq {
+    char *buffer;
+    size_t msg_size;
+    uint32_t max_msgs;
+    uint32_t read;
+    uint32_t used;
+};
+
+#define K_MSGQ_DEFINE(q_name, q_msg_size, q_max_msgs, q_align)                  \
+    static char _k_msgq_buf_##q_name[(q_msg_size) * (q_max_msgs)]             \
+        __attribute__((aligned(q_align)));                                     \
+    struct k_msgq q_name = { _k_msgq_buf_##q_name, (q_msg_size), (q_max_msgs), 0, 0 }
+
+int k_msgq_put(struct k_msgq *q, const void *data, k_timeout_t timeout);
+int k_msgq_get(struct k_msgq *q, void *data, k_timeout_t timeout);
+int k_msgq_peek(struct k_msgq *q, void *data);
+uint32_t k_msgq_num_used_get(struct k_msgq *q);
+uint32_t k_msgq_num_free_get(struct k_msgq *q);
+void k_msgq_purge(struct k_msgq *q);
+
+struct k_work;
+typedef void (*k_work_handler_t)(struct k_work *work);
+
+struct k_work {
+    k_work_handler_t handler;
+};
+
+#define K_WORK_DEFINE(work, work_handler) struct k_work work = { work_handler }
+
+int k_work_submit(struct k_work *work);
+
+struct k_mutex {
+    int locked;
+};
+
+#define K_MUTEX_DEFINE(name) struct k_mutex name
+
+static inline int k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout) {
+    (void)timeout;
+    mutex->locked++;
+    return 0;
+}
+
+static inline int k_mutex_unlock(struct k_mutex *mutex) {
+    mutex->locked--;
+    return 0;
+}
+
+struct k_spinlock {
+    int locked;
+};
+
+typedef int k_spinlock_key_t;
+
+static inline k_spinlock_key_t k_spin_lock(struct k_spinlock *lock) {
+    lock->locked = 1;
+    return 0;
+}
+
+static inline void k_spin_unlock(struct k_spinlock *lock, k_spinlock_key_t key) {
+    (void)key;
+    lock->locked = 0;
+}
+
+#define MIN(a, b)           (((a) < (b)) ? (a) : (b))
+#define MAX(a, b)           (((a) > (b)) ? (a) : (b))
+#define CLAMP(val, lo, hi)  (((val) <= (lo)) ? (lo) : MIN(val, hi))
+#define ARRAY_SIZE(array)   (sizeof(array) / sizeof((array)[0]))
+#define BIT(n)              (1UL << (n))
+#define BUILD_ASSERT(cond, ...) _Static_assert(cond, "" __VA_ARGS__)
+#define ARG_UNUSED(x)       (void)(x)
+#define __noinit
+#define __packed            __attribute__((packed))
+#define __fallthrough       __attribute__((fallthrough))
+
+#endif /* HOST_SHIM_KERNEL_H_ */
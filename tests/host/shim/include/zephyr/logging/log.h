@@ -0,0 +1,29 @@
+/*
+ * Archivo: zephyr/logging/log.h (shim de host)
+ * Descripción: Log desactivado. Sin comprobación de formato: los módulos usan
+ *              %u para size_t, que en el host es de 64 bits.
+ */
+
+#ifndef HOST_SHIM_LOG_H_
+#define HOST_SHIM_LOG_H_
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERR  1
+#define LOG_LEVEL_WRN  2
+#define LOG_LEVEL_INF  3
+#define LOG_LEVEL_DBG  4
+
+#define LOG_MODULE_REGISTER(...)
+#define LOG_MODULE_DECLARE(...)
+
+static inline void host_shim_log(const char *fmt, ...) {
+    (void)fmt;
+}
+
+#define LOG_ERR(...) host_shim_log(__VA_ARGS__)
+#define LOG_WRN(...) host_shim_log(__VA_ARGS__)
+#define LOG_INF(...) host_shim_log(__VA_ARGS__)
+#define LOG_DBG(...) host_shim_log(__VA_ARGS__)
+#define LOG_HEXDUMP_DBG(...)
+
+#endif /* HOST_SHIM_LOG_H_ */
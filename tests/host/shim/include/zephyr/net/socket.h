@@ -0,0 +1,12 @@
+/*
+ * Archivo: zephyr/net/socket.h (shim de host)
+ * Descripción: Solo lo que usa params.c (inet_pton y orden de bytes).
+ */
+
+#ifndef HOST_SHIM_SOCKET_H_
+#define HOST_SHIM_SOCKET_H_
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#endif /* HOST_SHIM_SOCKET_H_ */
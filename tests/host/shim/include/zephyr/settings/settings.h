@@ -0,0 +1,24 @@
+/*
+ * Archivo: zephyr/settings/settings.h (shim de host)
+ * Descripción: Settings en RAM con la misma semántica de carga por subárbol.
+ */
+
+#ifndef HOST_SHIM_SETTINGS_H_
+#define HOST_SHIM_SETTINGS_H_
+
+#include <stddef.h>
+#include <sys/types.h>
+
+typedef ssize_t (*settings_read_cb)(void *cb_arg, void *data, size_t len);
+typedef int (*settings_load_direct_cb)(const char *key, size_t len, settings_read_cb read_cb,
+                                       void *cb_arg, void *param);
+
+int settings_subsys_init(void);
+int settings_save_one(const char *name, const void *value, size_t val_len);
+int settings_delete(const char *name);
+int settings_load_subtree_direct(const char *subtree, settings_load_direct_cb cb, void *param);
+
+// Borra todas las claves (estado de flash recién borrada)
+void host_shim_settings_reset(void);
+
+#endif /* HOST_SHIM_SETTINGS_H_ */
@@ -0,0 +1,31 @@
+/*
+ * Archivo: zephyr/storage/flash_map.h (shim de host)
+ * Descripción: Particiones slot0/slot1 en RAM, borradas a 0xFF.
+ */
+
+#ifndef HOST_SHIM_FLASH_MAP_H_
+#define HOST_SHIM_FLASH_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define HOST_SHIM_SLOT_SIZE (256 * 1024)
+
+#define FIXED_PARTITION_ID(label) HOST_SHIM_PARTITION_##label
+#define HOST_SHIM_PARTITION_slot0_partition 0
+#define HOST_SHIM_PARTITION_slot1_partition 1
+
+struct flash_area {
+    uint8_t fa_id;
+    off_t fa_off;
+    size_t fa_size;
+};
+
+int flash_area_open(uint8_t id, const struct flash_area **fa);
+void flash_area_close(const struct flash_area *fa);
+int flash_area_read(const struct flash_area *fa, off_t off, void *dst, size_t len);
+int flash_area_write(const struct flash_area *fa, off_t off, const void *src, size_t len);
+int flash_area_erase(const struct flash_area *fa, off_t off, size_t len);
+
+#endif /* HOST_SHIM_FLASH_MAP_H_ */
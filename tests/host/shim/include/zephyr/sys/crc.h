@@ -0,0 +1,16 @@
+/*
+ * Archivo: zephyr/sys/crc.h (shim de host)
+ * Descripción: CRCs con la misma definición que lib/crc de Zephyr.
+ */
+
+#ifndef HOST_SHIM_CRC_H_
+#define HOST_SHIM_CRC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+uint16_t crc16_ccitt(uint16_t seed, const uint8_t *src, size_t len);
+uint32_t crc32_ieee(const uint8_t *data, size_t len);
+uint32_t crc32_ieee_update(uint32_t crc, const uint8_t *data, size_t len);
+
+#endif /* HOST_SHIM_CRC_H_ */
@@ -0,0 +1,636 @@
+/*
+ * Archivo: vas_standin.c
+ * Descripción: Servidor VAS de prueba para los comandos autenticados de downlink:
+ *              FOTA delta, DFU delta del módem y PARAM_SET. Construye las tramas como
+ *              el servidor (etiqueta de downlink_auth.h + CRC-16) y las entrega a
+ *              downlink_dispatch() en pases con pérdida de tramas y de acks, duplicados
+ *              y un reinicio del dispositivo entre pases (los módulos se reinicializan
+ *              desde settings, que el shim conserva en RAM).
+ *
+ * Escenarios: tramas privilegiadas sin etiqueta, con clave ajena o repetidas, símbolos bulk
+ * sin un BULK_BEGIN autenticado, imagen o delta cuya etiqueta no coincide con la del BEGIN
+ * (no se entregan a MCUboot ni al módem) y las transferencias completas, con los bytes
+ * enviados frente al tamaño de la imagen.
+ *
+ * Opciones: -l pérdida por trama en % (20), -s semilla (1).
+ * Salida: una línea por escenario y OTA_JSON {...}; código 1 si alguno falla.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/crc.h>
+
+#include "bulk.h"
+#include "downlink.h"
+#include "downlink_auth.h"
+#include "erasure.h"
+#include "fota.h"
+#include "modem_dfu.h"
+#include "params.h"
+#include "host_test_key.h"
+
+#define STANDIN_SERVER_IP "192.0.2.1"
+#define STANDIN_SERVER_PORT 17777
+#define STANDIN_FRAMES_PER_PASS 40
+#define STANDIN_MAX_PASSES 400
+#define STANDIN_CHUNK 200               // Datos por FOTA_CHUNK (cabe con holgura en una trama)
+#define STANDIN_BASE_SIZE (96 * 1024)
+#define STANDIN_DELTA_SIZE (20 * 1024)
+#define STANDIN_COPY_WINDOW 64
+
+#define DELTA_OP_COPY 0x01
+#define DELTA_OP_INSERT 0x02
+
+struct standin {
+    int loss_pct;
+    uint32_t rng;
+    uint32_t counter;           // Contador anti-repetición de la última trama sellada
+    int failures;
+};
+
+static struct standin sv = { .loss_pct = 20, .rng = 1 };
+
+static uint8_t base_image[STANDIN_BASE_SIZE];
+static uint8_t new_image[STANDIN_BASE_SIZE + 4096];
+static uint8_t patch[sizeof(new_image) + sizeof(new_image) / STANDIN_COPY_WINDOW * 9];
+static size_t patch_len;
+static uint8_t delta[STANDIN_DELTA_SIZE];
+
+static uint32_t rng_next(void) {
+    sv.rng ^= sv.rng << 13;
+    sv.rng ^= sv.rng >> 17;
+    sv.rng ^= sv.rng << 5;
+    return sv.rng;
+}
+
+static bool lost(void) {
+    return (int)(rng_next() % 100) < sv.loss_pct;
+}
+
+static void check(bool ok, const char *scenario, const char *what) {
+    if (!ok) {
+        printf("FALLO %s: %s\n", scenario, what);
+        sv.failures++;
+    }
+}
+
+// =================================================================
+//  TRAMAS DEL SERVIDOR
+// =================================================================
+
+struct frame {
+    uint8_t data[DOWNLINK_MAX_FRAME_LEN];
+    size_t len;
+};
+
+static void put_be16(struct frame *f, uint16_t v) {
+    f->data[f->len++] = v >> 8;
+    f->data[f->len++] = v & 0xFF;
+}
+
+static void put_be32(struct frame *f, uint32_t v) {
+    put_be16(f, v >> 16);
+    put_be16(f, v & 0xFFFF);
+}
+
+static void put_bytes(struct frame *f, const void *data, size_t len) {
+    memcpy(&f->data[f->len], data, len);
+    f->len += len;
+}
+
+static void put_image_tag(struct frame *f, const uint8_t *image, size_t len) {
+    struct downlink_auth_stream mac;
+
+    downlink_auth_begin(&mac, DOWNLINK_AUTH_IMAGE);
+    downlink_auth_update(&mac, image, len);
+    downlink_auth_final(&mac, &f->data[f->len]);
+    f->len += DOWNLINK_AUTH_TAG_LEN;
+}
+
+static void frame_start(struct frame *f, uint8_t op) {
+    f->len = 0;
+    f->data[f->len++] = op;
+}
+
+// Cierra la trama: contador y etiqueta con key (privilegiadas) y CRC-16. Cada trama
+// privilegiada, también un reenvío, lleva un contador nuevo.
+static void frame_seal(struct frame *f, const uint8_t *key) {
+    if (key) {
+        struct downlink_auth_stream mac;
+
+        put_be32(f, ++sv.counter);
+        // Un servidor ajeno firma con otra clave: se activa solo mientras se calcula la etiqueta
+        if (key != host_test_key) {
+            downlink_auth_provision(key);
+        }
+        downlink_auth_begin(&mac, DOWNLINK_AUTH_FRAME);
+        downlink_auth_update(&mac, f->data, f->len);
+        downlink_auth_final(&mac, &f->data[f->len]);
+        f->len += DOWNLINK_AUTH_TAG_LEN;
+        if (key != host_test_key) {
+            downlink_auth_provision(host_test_key);
+        }
+    }
+    uint16_t crc = crc16_ccitt(0xFFFF, f->data, f->len);
+
+    put_be16(f, crc);
+}
+
+static uint32_t resp_be32(const struct downlink_response *resp, size_t offset) {
+    const uint8_t *p = &resp->buf[offset];
+
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// =================================================================
+//  DISPOSITIVO
+// =================================================================
+
+static int modem_dfu_sink(uint32_t session, uint32_t offset, const uint8_t *data, size_t len, bool last) {
+    (void)last;
+    return modem_dfu_write(session, offset, data, len);
+}
+
+static int fota_sink(uint32_t session, uint32_t offset, const uint8_t *data, size_t len, bool last) {
+    (void)last;
+    return fota_write_patch(session, offset, data, len);
+}
+
+static const bulk_sink_t sinks[BULK_TYPE_COUNT] = {
+    [BULK_TYPE_FOTA] = fota_sink,
+    [BULK_TYPE_MODEM_DFU] = modem_dfu_sink,
+};
+
+// Arranque del dispositivo: todo lo persistido vuelve de settings
+static void device_boot(void) {
+    modem_dfu_suspend();
+    params_init(STANDIN_SERVER_IP, STANDIN_SERVER_PORT);
+    params_load();
+    downlink_auth_init();
+    fota_init();
+    modem_dfu_init();
+    bulk_init(sinks);
+}
+
+// Cierre de la ventana de downlink, como al final de receive_downlink() en src/main.c
+static void device_window_end(void) {
+    fota_suspend();
+    modem_dfu_suspend();
+    bulk_suspend();
+}
+
+static void device_factory_reset(void) {
+    host_shim_settings_reset();
+    downlink_auth_provision(host_test_key);
+    device_boot();
+}
+
+// Entrega una trama; con ack perdido el servidor no ve la respuesta
+static int deliver(const struct frame *f, struct downlink_response *resp, uint64_t *sent_bytes) {
+    *sent_bytes += f->len;
+    if (lost()) {
+        return -EAGAIN;
+    }
+    int err = downlink_dispatch(f->data, f->len, resp);
+
+    return lost() ? -EAGAIN : err;
+}
+
+// =================================================================
+//  PARAM_SET
+// =================================================================
+
+static void param_set_frame(struct frame *f, uint32_t value, const uint8_t *key) {
+    frame_start(f, DOWNLINK_OP_PARAM_SET);
+    f->data[f->len++] = 1;
+    f->data[f->len++] = PARAM_GNSS_FIX_TIMEOUT_S;
+    put_be32(f, value);
+    frame_seal(f, key);
+}
+
+static void scenario_param_set(void) {
+    static const uint8_t foreign_key[DOWNLINK_AUTH_KEY_LEN] = { 0xBA, 0xD0 };
+    struct downlink_response resp;
+    struct frame f;
+    uint32_t before;
+
+    device_factory_reset();
+    before = rt_params.gnss_fix_timeout_s;
+
+    param_set_frame(&f, before + 7, NULL);
+    check(downlink_dispatch(f.data, f.len, &resp) == -EBADMSG, "param_set", "sin etiqueta debe ser -EBADMSG");
+    param_set_frame(&f, before + 7, foreign_key);
+    check(downlink_dispatch(f.data, f.len, &resp) == -EACCES, "param_set", "clave ajena debe ser -EACCES");
+    check(resp.buf[1] == EACCES, "param_set", "el ack debe llevar EACCES");
+    check(rt_params.gnss_fix_timeout_s == before, "param_set", "parámetro cambiado sin autenticar");
+
+    param_set_frame(&f, before + 7, host_test_key);
+    check(downlink_dispatch(f.data, f.len, &resp) == 0, "param_set", "trama autenticada rechazada");
+    check(rt_params.gnss_fix_timeout_s == before + 7, "param_set", "parámetro no aplicado");
+
+    // Repetición de una trama ya aceptada, antes y después de un reinicio
+    struct frame replay = f;
+
+    param_set_frame(&f, before + 8, host_test_key);
+    check(downlink_dispatch(f.data, f.len, &resp) == 0, "param_set", "trama con contador nuevo rechazada");
+    check(downlink_dispatch(replay.data, replay.len, &resp) == -EALREADY, "param_set",
+          "trama repetida debe ser -EALREADY");
+    device_boot();
+    check(downlink_dispatch(replay.data, replay.len, &resp) == -EALREADY, "param_set",
+          "trama repetida tras reiniciar debe ser -EALREADY");
+    check(rt_params.gnss_fix_timeout_s == before + 8, "param_set", "parámetro cambiado por una repetición");
+
+    // Dispositivo sin clave: ni siquiera una trama bien firmada cambia nada
+    param_set_frame(&f, before + 9, host_test_key);
+    settings_delete(DOWNLINK_AUTH_SETTINGS_KEY);
+    device_boot();
+    check(downlink_dispatch(f.data, f.len, &resp) == -EACCES, "param_set", "sin clave provisionada debe ser -EACCES");
+    check(rt_params.gnss_fix_timeout_s == before + 8, "param_set", "parámetro cambiado sin clave");
+    printf("param_set: etiqueta ausente, ajena, repetida y sin clave rechazadas; firmada aplicada\n");
+}
+
+// =================================================================
+//  FOTA DELTA
+// =================================================================
+
+static void patch_op(uint8_t op, uint32_t a, uint32_t b) {
+    patch[patch_len++] = op;
+    for (int i = 3; i >= 0; i--) {
+        patch[patch_len++] = (uint8_t)(a >> (8 * i));
+    }
+    if (op == DELTA_OP_COPY) {
+        for (int i = 3; i >= 0; i--) {
+            patch[patch_len++] = (uint8_t)(b >> (8 * i));
+        }
+    }
+}
+
+// Parche por ventanas: COPY de lo que coincide en el mismo offset de la base, INSERT del resto
+static void build_patch(size_t image_size) {
+    size_t pos = 0;
+
+    patch_len = 0;
+    while (pos < image_size) {
+        size_t end = pos;
+        bool same = pos + STANDIN_COPY_WINDOW <= sizeof(base_image) &&
+                    memcmp(&new_image[pos], &base_image[pos], STANDIN_COPY_WINDOW) == 0;
+
+        while (end < image_size) {
+            size_t n = image_size - end < STANDIN_COPY_WINDOW ? image_size - end : STANDIN_COPY_WINDOW;
+            bool window_same = end + n <= sizeof(base_image) && memcmp(&new_image[end], &base_image[end], n) == 0;
+
+            if (window_same != same) {
+                break;
+            }
+            end += n;
+        }
+        if (same) {
+            patch_op(DELTA_OP_COPY, (uint32_t)pos, (uint32_t)(end - pos));
+        } else {
+            patch_op(DELTA_OP_INSERT, (uint32_t)(end - pos), 0);
+            memcpy(&patch[patch_len], &new_image[pos], end - pos);
+            patch_len += end - pos;
+        }
+        pos = end;
+    }
+}
+
+static void fota_begin_frame(struct frame *f, uint32_t session, size_t image_size, const uint8_t *tag_image) {
+    frame_start(f, DOWNLINK_OP_FOTA_BEGIN);
+    put_be32(f, session);
+    put_be32(f, (uint32_t)patch_len);
+    put_be32(f, (uint32_t)image_size);
+    put_be32(f, crc32_ieee(new_image, image_size));
+    put_be32(f, sizeof(base_image));
+    put_be32(f, crc32_ieee(base_image, sizeof(base_image)));
+    put_image_tag(f, tag_image, image_size);
+    frame_seal(f, host_test_key);
+}
+
+// Transferencia completa en pases; devuelve el resultado del último ack visto
+static int fota_transfer(uint32_t session, size_t image_size, const uint8_t *tag_image, int *passes,
+                         uint64_t *sent_bytes) {
+    struct downlink_response resp;
+    struct frame f;
+    uint32_t next = 0;
+    bool begun = false;
+    int last_err = -EAGAIN;
+
+    for (*passes = 1; *passes <= STANDIN_MAX_PASSES; (*passes)++) {
+        // Al empezar el pase el dispositivo pide reanudar donde se quedó
+        if (begun && fota_resume_request(&resp)) {
+            next = resp_be32(&resp, 6);
+        }
+        for (int n = 0; n < STANDIN_FRAMES_PER_PASS; n++) {
+            int err;
+
+            if (!begun) {
+                fota_begin_frame(&f, session, image_size, tag_image);
+                err = deliver(&f, &resp, sent_bytes);
+                begun = err == 0;
+                continue;
+            }
+            size_t len = patch_len - next < STANDIN_CHUNK ? patch_len - next : STANDIN_CHUNK;
+
+            frame_start(&f, DOWNLINK_OP_FOTA_CHUNK);
+            put_be32(&f, session);
+            put_be32(&f, next);
+            put_bytes(&f, &patch[next], len);
+            frame_seal(&f, NULL);
+            err = deliver(&f, &resp, sent_bytes);
+            if (fota_reboot_pending()) {
+                return 0;
+            }
+            if (err == -EAGAIN) {
+                // Sin ack: se sigue adelante y el offset esperado corrige la secuencia
+                next = next + len < patch_len ? next + (uint32_t)len : next;
+                continue;
+            }
+            last_err = err;
+            if (err != 0 && err != -ERANGE) {
+                return err;
+            }
+            next = resp_be32(&resp, 6);
+        }
+        device_window_end();
+        device_boot();
+    }
+    return last_err;
+}
+
+static void scenario_fota(void) {
+    size_t image_size = sizeof(new_image);
+    const struct flash_area *slot;
+    struct downlink_response resp;
+    struct frame f;
+    uint64_t sent = 0;
+    int passes;
+
+    // Base en el slot primario y una imagen nueva con tres zonas cambiadas y 4 KB más
+    for (size_t i = 0; i < sizeof(base_image); i++) {
+        base_image[i] = (uint8_t)rng_next();
+    }
+    memcpy(new_image, base_image, sizeof(base_image));
+    for (size_t i = 0; i < 3; i++) {
+        size_t at = (i + 1) * sizeof(base_image) / 4;
+
+        for (size_t j = 0; j < 1500; j++) {
+            new_image[at + j] ^= (uint8_t)(rng_next() | 1);
+        }
+    }
+    for (size_t i = sizeof(base_image); i < image_size; i++) {
+        new_image[i] = (uint8_t)rng_next();
+    }
+    build_patch(image_size);
+
+    device_factory_reset();
+    flash_area_open(0, &slot);
+    flash_area_erase(slot, 0, slot->fa_size);
+    flash_area_write(slot, 0, base_image, sizeof(base_image));
+
+    // BEGIN con clave ajena: ni se abre sesión ni se toca el slot secundario
+    static const uint8_t foreign_key[DOWNLINK_AUTH_KEY_LEN] = { 0xBA, 0xD0 };
+
+    fota_begin_frame(&f, 0xF0, image_size, new_image);
+    f.len -= DOWNLINK_AUTH_FRAME_OVERHEAD + 2;
+    frame_seal(&f, foreign_key);
+    check(downlink_dispatch(f.data, f.len, &resp) == -EACCES, "fota", "BEGIN con clave ajena aceptado");
+    check(!fota_resume_request(&resp), "fota", "sesión abierta por un BEGIN sin autenticar");
+
+    // Imagen cuyo CRC coincide con el del BEGIN pero no su etiqueta (parche manipulado)
+    static uint8_t other_image[sizeof(new_image)];
+
+    memcpy(other_image, new_image, image_size);
+    other_image[image_size / 2] ^= 0x01;
+    int loss_pct = sv.loss_pct;
+
+    // Sin pérdidas: el rechazo tiene que venir de la etiqueta y no de un ack perdido
+    sv.loss_pct = 0;
+    int err = fota_transfer(0xF1, image_size, other_image, &passes, &sent);
+
+    sv.loss_pct = loss_pct;
+
+    check(err == -EACCES, "fota", "imagen con etiqueta distinta no rechazada con -EACCES");
+    check(!fota_reboot_pending(), "fota", "imagen sin autenticar entregada a MCUboot");
+
+    // Transferencia buena con pérdidas y reinicios entre pases
+    sent = 0;
+    err = fota_transfer(0xF2, image_size, new_image, &passes, &sent);
+    check(err == 0 && fota_reboot_pending(), "fota", "la imagen autenticada no quedó lista");
+
+    flash_area_open(1, &slot);
+    static uint8_t rebuilt[sizeof(new_image)];
+
+    flash_area_read(slot, 0, rebuilt, image_size);
+    check(memcmp(rebuilt, new_image, image_size) == 0, "fota", "slot secundario distinto de la imagen nueva");
+
+    printf("fota: parche %zu B para imagen %zu B (%zu%%), enviados %llu B (%llu%% de la imagen) en %d pases\n",
+           patch_len, image_size, patch_len * 100 / image_size, (unsigned long long)sent,
+           (unsigned long long)(sent * 100 / image_size), passes);
+    printf("OTA_JSON {\"kind\":\"fota\",\"image\":%zu,\"patch\":%zu,\"sent\":%llu,\"passes\":%d,\"loss_pct\":%d}\n",
+           image_size, patch_len, (unsigned long long)sent, passes, sv.loss_pct);
+}
+
+// =================================================================
+//  DFU DELTA DEL MÓDEM (POR BULK)
+// =================================================================
+
+static void modem_dfu_begin_frame(struct frame *f, uint32_t session, const uint8_t *tag_delta) {
+    frame_start(f, DOWNLINK_OP_MODEM_DFU_BEGIN);
+    put_be32(f, session);
+    put_be32(f, sizeof(delta));
+    put_be32(f, crc32_ieee(delta, sizeof(delta)));
+    put_image_tag(f, tag_delta, sizeof(delta));
+    frame_seal(f, host_test_key);
+}
+
+// Sesión bulk del mismo id que transporta el delta, con la etiqueta del objeto
+static void bulk_begin_frame(struct frame *f, uint32_t session, const uint8_t *tag_delta) {
+    frame_start(f, DOWNLINK_OP_BULK_BEGIN);
+    put_be32(f, session);
+    f->data[f->len++] = BULK_TYPE_MODEM_DFU;
+    put_be32(f, sizeof(delta));
+    put_image_tag(f, tag_delta, sizeof(delta));
+    frame_seal(f, host_test_key);
+}
+
+// Multiplicación en GF(256) con el polinomio de erasure.h (lado servidor)
+static uint8_t gf_mul(uint8_t a, uint8_t b) {
+    uint8_t p = 0;
+
+    while (b) {
+        if (b & 1) {
+            p ^= a;
+        }
+        a = (a & 0x80) ? (uint8_t)((a << 1) ^ 0x1D) : (uint8_t)(a << 1);
+        b >>= 1;
+    }
+    return p;
+}
+
+// Símbolo fuente i del bloque, con ceros tras el final del delta
+static void source_symbol(uint16_t block, uint16_t i, uint8_t *out) {
+    size_t offset = (size_t)block * ERASURE_BLOCK_SIZE + (size_t)i * ERASURE_SYMBOL_SIZE;
+    size_t n = sizeof(delta) - offset < ERASURE_SYMBOL_SIZE ? sizeof(delta) - offset : ERASURE_SYMBOL_SIZE;
+
+    memset(out, 0, ERASURE_SYMBOL_SIZE);
+    memcpy(out, &delta[offset], n);
+}
+
+// Primero los K sistemáticos; después símbolos de reparación que sustituyen a cualquier perdido
+static void bulk_symbol_frame(struct frame *f, uint32_t session, uint16_t block, uint16_t esi, uint8_t k) {
+    uint8_t symbol[ERASURE_SYMBOL_SIZE];
+
+    if (esi < k) {
+        source_symbol(block, esi, symbol);
+    } else {
+        uint8_t coef[ERASURE_MAX_K];
+        uint8_t src[ERASURE_SYMBOL_SIZE];
+
+        erasure_coefficients(session, block, esi, k, coef);
+        memset(symbol, 0, sizeof(symbol));
+        for (uint16_t i = 0; i < k; i++) {
+            source_symbol(block, i, src);
+            for (size_t j = 0; j < sizeof(symbol); j++) {
+                symbol[j] ^= gf_mul(src[j], coef[i]);
+            }
+        }
+    }
+    frame_start(f, DOWNLINK_OP_BULK_SYMBOL);
+    put_be32(f, session);
+    f->data[f->len++] = BULK_TYPE_MODEM_DFU;
+    put_be32(f, sizeof(delta));
+    put_be16(f, block);
+    put_be16(f, esi);
+    put_bytes(f, symbol, sizeof(symbol));
+    frame_seal(f, NULL);
+}
+
+// Símbolos del bloque en curso; el estado del ack dice qué bloque toca
+static int modem_dfu_transfer(uint32_t session, const uint8_t *tag_delta, int *passes, uint64_t *sent_bytes) {
+    uint16_t blocks = (sizeof(delta) + ERASURE_BLOCK_SIZE - 1) / ERASURE_BLOCK_SIZE;
+    struct downlink_response resp;
+    struct frame f;
+    uint16_t block = 0, esi = 0;
+    bool begun = false, bulk_begun = false;
+    int last_err = -EAGAIN;
+
+    for (*passes = 1; *passes <= STANDIN_MAX_PASSES; (*passes)++) {
+        for (int n = 0; n < STANDIN_FRAMES_PER_PASS; n++) {
+            int err;
+
+            if (!begun) {
+                modem_dfu_begin_frame(&f, session, tag_delta);
+                begun = deliver(&f, &resp, sent_bytes) == 0;
+                continue;
+            }
+            if (!bulk_begun) {
+                bulk_begin_frame(&f, session, tag_delta);
+                bulk_begun = deliver(&f, &resp, sent_bytes) == 0;
+                continue;
+            }
+            uint32_t block_len = block + 1 < blocks ? ERASURE_BLOCK_SIZE : sizeof(delta) - block * ERASURE_BLOCK_SIZE;
+            uint16_t k = (block_len + ERASURE_SYMBOL_SIZE - 1) / ERASURE_SYMBOL_SIZE;
+
+            bulk_symbol_frame(&f, session, block, esi, (uint8_t)k);
+            esi++;
+            err = deliver(&f, &resp, sent_bytes);
+            if (modem_dfu_apply_pending()) {
+                return 0;
+            }
+            if (err == -EAGAIN) {
+                continue;
+            }
+            last_err = err;
+            if (err != 0 && err != -ERANGE && err != -EINPROGRESS) {
+                return err;
+            }
+            uint16_t next_block = resp_be32(&resp, 6) >> 16;
+
+            if (next_block != block) {
+                block = next_block;
+                esi = 0;
+            }
+            if (block >= blocks) {
+                return last_err;
+            }
+        }
+        device_window_end();
+        device_boot();
+    }
+    return last_err;
+}
+
+static void scenario_modem_dfu(void) {
+    uint64_t sent = 0;
+    int passes;
+
+    for (size_t i = 0; i < sizeof(delta); i++) {
+        delta[i] = (uint8_t)rng_next();
+    }
+    device_factory_reset();
+
+    // Un símbolo sin BULK_BEGIN autenticado no abre sesión
+    struct downlink_response resp;
+    struct frame f;
+
+    bulk_symbol_frame(&f, 0xD0, 0, 0, ERASURE_MAX_K);
+    check(downlink_dispatch(f.data, f.len, &resp) == -ENOENT, "modem_dfu", "símbolo sin BULK_BEGIN aceptado");
+
+    // Delta con etiqueta de otro delta: se escribe entero pero no queda pendiente de aplicar
+    static uint8_t other_delta[sizeof(delta)];
+
+    memcpy(other_delta, delta, sizeof(delta));
+    other_delta[0] ^= 0x80;
+    int loss_pct = sv.loss_pct;
+
+    sv.loss_pct = 0;
+    int err = modem_dfu_transfer(0xD1, other_delta, &passes, &sent);
+
+    sv.loss_pct = loss_pct;
+
+    check(err == -EACCES, "modem_dfu", "delta con etiqueta distinta no rechazado con -EACCES");
+    check(!modem_dfu_apply_pending(), "modem_dfu", "delta sin autenticar pendiente de aplicar");
+
+    sent = 0;
+    err = modem_dfu_transfer(0xD2, delta, &passes, &sent);
+    check(err == 0 && modem_dfu_apply_pending(), "modem_dfu", "el delta autenticado no quedó pendiente");
+    check(modem_dfu_schedule() == 0, "modem_dfu", "el delta autenticado no se pudo programar");
+
+    printf("modem_dfu: delta %zu B, enviados %llu B (%llu%%) en %d pases con reinicio entre pases\n",
+           sizeof(delta), (unsigned long long)sent, (unsigned long long)(sent * 100 / sizeof(delta)), passes);
+    printf("OTA_JSON {\"kind\":\"modem_dfu\",\"image\":%zu,\"sent\":%llu,\"passes\":%d,\"loss_pct\":%d}\n",
+           sizeof(delta), (unsigned long long)sent, passes, sv.loss_pct);
+}
+
+int main(int argc, char **argv) {
+    int c;
+
+    while ((c = getopt(argc, argv, "l:s:h")) != -1) {
+        switch (c) {
+        case 'l': sv.loss_pct = atoi(optarg); break;
+        case 's': sv.rng = (uint32_t)strtoul(optarg, NULL, 0); break;
+        default:
+            fprintf(stderr, "Uso: %s [-l pérdida %%] [-s semilla]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (sv.loss_pct < 0 || sv.loss_pct > 90 || sv.rng == 0) {
+        fprintf(stderr, "Pérdida en [0, 90] y semilla distinta de 0\n");
+        return 2;
+    }
+
+    scenario_param_set();
+    scenario_fota();
+    scenario_modem_dfu();
+
+    printf("%s (%d fallos)\n", sv.failures ? "FALLO" : "OK", sv.failures);
+    return sv.failures ? 1 : 0;
+}
@@ -0,0 +1,206 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas de la agregación por intervalos (aggregate.c): Welford en punto
+ *              fijo frente a una referencia en double sobre una traza sintética, y
+ *              tamaño del registro agregado frente a las muestras en crudo.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "aggregate.h"
+#include "telemetry.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+#define TRACE_LEN 500                   // Una muestra por minuto
+#define SAMPLE_MS (60 * 1000)
+
+struct trace_sample {
+    struct sensor_sample sensors;
+    uint8_t sats;
+    bool position_valid;
+};
+
+static struct trace_sample trace[TRACE_LEN];
+static const struct geo_position position = { .lat_udeg = 41387917, .lon_udeg = 2168365, .alt_dm = 123 };
+
+// LCG de Numerical Recipes: ruido reproducible sin libc
+static uint32_t noise_state = 12345;
+
+static int32_t noise(int32_t amplitude) {
+    noise_state = noise_state * 1664525u + 1013904223u;
+    return (int32_t)((noise_state >> 8) % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+// Descarga con ruido de ±20 mV, temperatura de -5 a 15 °C con ±3 °C, huecos de
+// temperatura cada 11 muestras y sin fix cada 7
+static void build_trace(void) {
+    for (int i = 0; i < TRACE_LEN; i++) {
+        struct trace_sample *t = &trace[i];
+
+        t->sensors.valid = SENSOR_VALID_VBAT;
+        t->sensors.battery_mv = (uint16_t)(4100 - i / 2 + noise(20));
+        if (i % 11 != 0) {
+            t->sensors.valid |= SENSOR_VALID_TEMP;
+            t->sensors.modem_temp_c = (int8_t)(-5 + i / 25 + noise(3));
+        }
+        t->sats = (uint8_t)(8 + noise(4));
+        t->position_valid = i % 7 != 0;
+    }
+}
+
+// Raíz por Newton en double: la prueba no enlaza libm
+static double sqrt_newton(double x) {
+    double r = x > 1.0 ? x : 1.0;
+
+    if (x <= 0.0) {
+        return 0.0;
+    }
+    for (int i = 0; i < 100; i++) {
+        r = 0.5 * (r + x / r);
+    }
+    return r;
+}
+
+struct reference {
+    int32_t min;
+    int32_t max;
+    double mean;
+    double stddev;
+    uint16_t count;
+};
+
+// Dos pasadas en double: media y desviación muestral de los valores dados
+static void reference_stats(const int32_t *values, size_t n, struct reference *ref) {
+    double sum = 0.0, m2 = 0.0;
+
+    ref->min = INT32_MAX;
+    ref->max = INT32_MIN;
+    for (size_t i = 0; i < n; i++) {
+        sum += values[i];
+        ref->min = MIN(ref->min, values[i]);
+        ref->max = MAX(ref->max, values[i]);
+    }
+    ref->mean = sum / (double)n;
+    for (size_t i = 0; i < n; i++) {
+        m2 += (values[i] - ref->mean) * (values[i] - ref->mean);
+    }
+    ref->stddev = sqrt_newton(m2 / (double)(n - 1));
+    ref->count = (uint16_t)n;
+}
+
+static void assert_matches(const struct agg_stats *s, const struct reference *ref, const char *name) {
+    double mean_err = s->mean - ref->mean;
+    double stddev_err = s->stddev - ref->stddev;
+
+    zassert_equal(s->count, ref->count, "%s", name);
+    zassert_equal(s->min, ref->min, "%s", name);
+    zassert_equal(s->max, ref->max, "%s", name);
+    // Solo el redondeo a entero: a lo sumo una unidad
+    zassert_true(mean_err > -1.0 && mean_err < 1.0, "%s: media %d", name, s->mean);
+    zassert_true(stddev_err > -1.0 && stddev_err < 1.0, "%s: desviación %u", name, s->stddev);
+}
+
+static struct aggregator agg;
+static struct agg_summary summary;
+
+static void *setup(void) {
+    build_trace();
+    return NULL;
+}
+
+static void before(void *fixture) {
+    ARG_UNUSED(fixture);
+    aggregator_reset(&agg, 0);
+    memset(&summary, 0, sizeof(summary));
+}
+
+ZTEST_SUITE(aggregate, NULL, setup, before, NULL, NULL);
+
+ZTEST(aggregate, test_matches_double_reference) {
+    static int32_t vbat[TRACE_LEN], temp[TRACE_LEN], sats[TRACE_LEN];
+    size_t n_vbat = 0, n_temp = 0, n_sats = 0;
+    struct reference ref;
+
+    for (int i = 0; i < TRACE_LEN; i++) {
+        const struct trace_sample *t = &trace[i];
+
+        aggregator_add(&agg, &t->sensors, t->sats, &position, t->position_valid, 100);
+        vbat[n_vbat++] = t->sensors.battery_mv;
+        if (t->sensors.valid & SENSOR_VALID_TEMP) {
+            temp[n_temp++] = t->sensors.modem_temp_c;
+        }
+        if (t->position_valid) {
+            sats[n_sats++] = t->sats;
+        }
+    }
+    zassert_ok(aggregator_close(&agg, (int64_t)TRACE_LEN * SAMPLE_MS, &summary));
+    zassert_equal(summary.samples, TRACE_LEN);
+    zassert_equal(summary.duration_s, TRACE_LEN * 60);
+
+    reference_stats(vbat, n_vbat, &ref);
+    assert_matches(&summary.metric[AGG_METRIC_VBAT], &ref, "vbat");
+    reference_stats(temp, n_temp, &ref);
+    assert_matches(&summary.metric[AGG_METRIC_TEMP], &ref, "temp");
+    reference_stats(sats, n_sats, &ref);
+    assert_matches(&summary.metric[AGG_METRIC_SATS], &ref, "sats");
+    zassert_equal(summary.metric[AGG_METRIC_ADC0].count, 0);
+}
+
+// El registro agregado de 500 muestras ocupa una fracción de lo que ocuparían en crudo
+ZTEST(aggregate, test_summary_much_smaller_than_raw) {
+    static char payload[PAYLOAD_BUFFER_SIZE];
+    uint32_t raw_total = 0;
+
+    for (int i = 0; i < TRACE_LEN; i++) {
+        const struct trace_sample *t = &trace[i];
+        struct uplink_record record = {
+            .timestamp = (int64_t)i * SAMPLE_MS,
+            .position = position,
+            .position_valid = t->position_valid,
+            .sats = t->sats,
+            .sensors = t->sensors,
+            .kind = UPLINK_RECORD_RAW,
+        };
+        size_t raw_len = telemetry_raw_len(payload, sizeof(payload), &record);
+
+        zassert_true(raw_len > 0);
+        raw_total += raw_len;
+        aggregator_add(&agg, &t->sensors, t->sats, &position, t->position_valid, raw_len);
+    }
+    zassert_ok(aggregator_close(&agg, (int64_t)TRACE_LEN * SAMPLE_MS, &summary));
+    zassert_equal(summary.raw_bytes, MIN(raw_total, UINT16_MAX));
+
+    struct uplink_aggregate aggregate = {
+        .timestamp = (int64_t)TRACE_LEN * SAMPLE_MS,
+        .position = agg.position,
+        .position_valid = true,
+        .sats = trace[TRACE_LEN - 1].sats,
+        .summary = summary,
+    };
+
+    zassert_ok(format_aggregate_data(payload, sizeof(payload), &aggregate));
+    zassert_true(strlen(payload) * 100 < raw_total, "%u B frente a %u B", (unsigned int)strlen(payload),
+                 raw_total);
+}
+
+ZTEST(aggregate, test_interval_boundaries) {
+    // Intervalo vacío: no hay registro aunque haya vencido
+    zassert_false(aggregator_due(&agg, 3600 * 1000, 60));
+    zassert_equal(aggregator_close(&agg, 3600 * 1000, &summary), -ENODATA);
+
+    // Una sola muestra: desviación nula y vence justo al cumplirse el intervalo
+    aggregator_reset(&agg, 1000);
+    aggregator_add(&agg, &trace[1].sensors, trace[1].sats, &position, true, 100);
+    zassert_false(aggregator_due(&agg, 1000 + 60 * 1000 - 1, 60));
+    zassert_true(aggregator_due(&agg, 1000 + 60 * 1000, 60));
+    zassert_ok(aggregator_close(&agg, 1000 + 60 * 1000, &summary));
+    zassert_equal(summary.metric[AGG_METRIC_VBAT].count, 1);
+    zassert_equal(summary.metric[AGG_METRIC_VBAT].mean, trace[1].sensors.battery_mv);
+    zassert_equal(summary.metric[AGG_METRIC_VBAT].stddev, 0);
+
+    // El cierre empieza el siguiente intervalo vacío
+    zassert_equal(aggregator_close(&agg, 1000 + 120 * 1000, &summary), -ENODATA);
+}
@@ -0,0 +1,48 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas de las transiciones de la máquina de estados (app_state.c).
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+
+#include "app_state.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+ZTEST_SUITE(app_state, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(app_state, test_transition_records_last_good_state) {
+    enum app_state current = STATE_INIT;
+    enum app_state last_good = STATE_INIT;
+
+    app_state_transition(&current, &last_good, STATE_GETTING_GPS_FIX);
+    zassert_equal(current, STATE_GETTING_GPS_FIX);
+    zassert_equal(last_good, STATE_INIT);
+
+    app_state_transition(&current, &last_good, STATE_ATTEMPTING_CONNECTION_STEP2);
+    zassert_equal(last_good, STATE_GETTING_GPS_FIX);
+}
+
+// ERROR y RECOVERY nunca son "último estado bueno": recovery vuelve al anterior a ellos
+ZTEST(app_state, test_error_states_are_not_last_good) {
+    enum app_state current = STATE_SENDING_DATA;
+    enum app_state last_good = STATE_IDLE;
+
+    app_state_transition(&current, &last_good, STATE_ERROR);
+    zassert_equal(last_good, STATE_SENDING_DATA);
+    app_state_transition(&current, &last_good, STATE_RECOVERY);
+    zassert_equal(last_good, STATE_SENDING_DATA, "ERROR must not be recorded");
+    app_state_transition(&current, &last_good, STATE_IDLE);
+    zassert_equal(last_good, STATE_SENDING_DATA, "RECOVERY must not be recorded");
+    zassert_equal(current, STATE_IDLE);
+}
+
+ZTEST(app_state, test_self_transition_is_noop) {
+    enum app_state current = STATE_TLE_UPDATE;
+    enum app_state last_good = STATE_IDLE;
+
+    app_state_transition(&current, &last_good, STATE_TLE_UPDATE);
+    zassert_equal(current, STATE_TLE_UPDATE);
+    zassert_equal(last_good, STATE_IDLE);
+}
@@ -0,0 +1,292 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas de las sesiones bulk (bulk.c): solo un BULK_BEGIN abre sesión,
+ *              un id distinto no sustituye a una sesión activa y la etiqueta del
+ *              objeto se comprueba antes de entregar el último bloque, también tras
+ *              un reinicio a mitad de objeto; bloques fuera de orden, rango
+ *              conservado entre pases y destino aún no preparado.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+
+#include "bulk.h"
+#include "downlink_auth.h"
+#include "erasure.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+#define OBJECT_SIZE (2 * ERASURE_SYMBOL_SIZE)
+#define LONG_OBJECT_SIZE (ERASURE_BLOCK_SIZE + ERASURE_SYMBOL_SIZE)
+#define WIDE_OBJECT_SIZE (BULK_DECODER_COUNT * ERASURE_BLOCK_SIZE + ERASURE_SYMBOL_SIZE)
+
+static uint8_t object[WIDE_OBJECT_SIZE];
+static uint8_t object_tag[DOWNLINK_AUTH_TAG_LEN];
+static uint8_t long_object_tag[DOWNLINK_AUTH_TAG_LEN];
+static uint8_t wide_object_tag[DOWNLINK_AUTH_TAG_LEN];
+
+static uint32_t delivered_session;
+static size_t delivered_len;
+static bool delivered_last;
+static int sink_busy;           // Entregas que el destino rechaza con -EINPROGRESS
+
+static int test_sink(uint32_t session, uint32_t offset, const uint8_t *data, size_t len, bool last) {
+    if (sink_busy > 0) {
+        sink_busy--;
+        return -EINPROGRESS;
+    }
+    zassert_equal(offset, delivered_len);
+    zassert_mem_equal(data, &object[offset], len);
+    delivered_session = session;
+    delivered_len += len;
+    delivered_last = last;
+    return 0;
+}
+
+static const bulk_sink_t sinks[BULK_TYPE_COUNT] = {
+    [BULK_TYPE_TLE] = test_sink,
+};
+
+// Sin downlink.c: solo hace falta el serializador de la respuesta
+void downlink_resp_put_be32(struct downlink_response *resp, uint32_t value) {
+    sys_put_be32(value, &resp->buf[resp->len]);
+    resp->len += 4;
+}
+
+static struct downlink_response resp;
+
+// BULK_BEGIN ya autenticado por downlink.c: solo queda la etiqueta del objeto
+static int send_begin(uint32_t session, uint32_t size, const uint8_t *tag) {
+    uint8_t payload[9 + DOWNLINK_AUTH_TAG_LEN];
+
+    sys_put_be32(session, &payload[0]);
+    payload[4] = BULK_TYPE_TLE;
+    sys_put_be32(size, &payload[5]);
+    memcpy(&payload[9], tag, DOWNLINK_AUTH_TAG_LEN);
+    resp.len = 0;
+    return bulk_handle_begin(payload, sizeof(payload), &resp);
+}
+
+// Símbolo sistemático esi del bloque, con ceros tras el final del objeto
+static int send_symbol(uint32_t session, uint32_t size, uint16_t block, uint16_t esi) {
+    uint8_t payload[13 + ERASURE_SYMBOL_SIZE] = {0};
+    size_t offset = (size_t)block * ERASURE_BLOCK_SIZE + (size_t)esi * ERASURE_SYMBOL_SIZE;
+
+    sys_put_be32(session, &payload[0]);
+    payload[4] = BULK_TYPE_TLE;
+    sys_put_be32(size, &payload[5]);
+    sys_put_be16(block, &payload[9]);
+    sys_put_be16(esi, &payload[11]);
+    memcpy(&payload[13], &object[offset], MIN(ERASURE_SYMBOL_SIZE, size - offset));
+    resp.len = 0;
+    return bulk_handle_symbol(payload, sizeof(payload), &resp);
+}
+
+static void object_tag_of(size_t size, uint8_t tag[DOWNLINK_AUTH_TAG_LEN]) {
+    struct downlink_auth_stream mac;
+
+    downlink_auth_begin(&mac, DOWNLINK_AUTH_IMAGE);
+    downlink_auth_update(&mac, object, size);
+    downlink_auth_final(&mac, tag);
+}
+
+static void *setup(void) {
+    static uint8_t key[DOWNLINK_AUTH_KEY_LEN];
+
+    zassert_ok(settings_subsys_init());
+    for (size_t i = 0; i < sizeof(key); i++) {
+        key[i] = (uint8_t)(0xA0 + i);
+    }
+    zassert_ok(downlink_auth_provision(key));
+    for (size_t i = 0; i < sizeof(object); i++) {
+        object[i] = (uint8_t)(i * 7 + 3);
+    }
+    object_tag_of(OBJECT_SIZE, object_tag);
+    object_tag_of(LONG_OBJECT_SIZE, long_object_tag);
+    object_tag_of(WIDE_OBJECT_SIZE, wide_object_tag);
+    return NULL;
+}
+
+static void before(void *fixture) {
+    ARG_UNUSED(fixture);
+    settings_delete(BULK_SETTINGS_KEY);
+    for (int i = 0; i < BULK_DECODER_COUNT; i++) {
+        char key[] = BULK_SETTINGS_KEY "/d0";
+
+        key[sizeof(key) - 2] = (char)('0' + i);
+        settings_delete(key);
+    }
+    zassert_ok(bulk_init(sinks));
+    delivered_session = 0;
+    delivered_len = 0;
+    delivered_last = false;
+    sink_busy = 0;
+}
+
+ZTEST(bulk, test_symbol_never_opens_session) {
+    zassert_equal(send_symbol(0x100, OBJECT_SIZE, 0, 0), -ENOENT);
+    zassert_equal(send_symbol(0x100, OBJECT_SIZE, 0, 1), -ENOENT);
+    zassert_equal(delivered_session, 0);
+
+    zassert_ok(send_begin(0x100, OBJECT_SIZE, object_tag));
+    zassert_ok(send_symbol(0x100, OBJECT_SIZE, 0, 0));
+    zassert_ok(send_symbol(0x100, OBJECT_SIZE, 0, 1));
+    zassert_equal(delivered_session, 0x100);
+    zassert_equal(delivered_len, OBJECT_SIZE);
+    zassert_true(delivered_last);
+}
+
+ZTEST(bulk, test_other_session_rejected_while_active) {
+    zassert_ok(send_begin(0x100, OBJECT_SIZE, object_tag));
+    zassert_ok(send_symbol(0x100, OBJECT_SIZE, 0, 0));
+
+    // Id viejo o ajeno a mitad de objeto: -EBUSY con la posición de la sesión en curso
+    zassert_equal(send_symbol(0x0FF, OBJECT_SIZE, 0, 0), -EBUSY);
+    zassert_equal(sys_get_be32(&resp.buf[0]), 0x100);
+    zassert_equal(send_symbol(0x200, OBJECT_SIZE, 0, 0), -EBUSY);
+
+    // La sesión en curso no se ha perdido: el segundo símbolo la completa
+    zassert_ok(send_symbol(0x100, OBJECT_SIZE, 0, 1));
+    zassert_equal(delivered_session, 0x100);
+    zassert_equal(delivered_len, OBJECT_SIZE);
+}
+
+// Símbolos inyectados o etiqueta de otro objeto: el destino no recibe el último bloque
+ZTEST(bulk, test_object_tag_checked_before_delivery) {
+    uint8_t tag[DOWNLINK_AUTH_TAG_LEN];
+
+    memcpy(tag, object_tag, sizeof(tag));
+    tag[0] ^= 0x01;
+    zassert_ok(send_begin(0x100, OBJECT_SIZE, tag));
+    zassert_ok(send_symbol(0x100, OBJECT_SIZE, 0, 0));
+    zassert_equal(send_symbol(0x100, OBJECT_SIZE, 0, 1), -EACCES);
+    zassert_equal(delivered_len, 0);
+
+    // La sesión queda cerrada: hace falta otro BEGIN
+    zassert_ok(send_symbol(0x100, OBJECT_SIZE, 0, 0));
+    zassert_equal(delivered_len, 0);
+}
+
+ZTEST(bulk, test_begin_resumes_or_replaces) {
+    zassert_ok(send_begin(0x100, OBJECT_SIZE, object_tag));
+    zassert_ok(send_symbol(0x100, OBJECT_SIZE, 0, 0));
+
+    // Reenvío del BEGIN: conserva lo recibido (rango 1 de K=2)
+    zassert_ok(send_begin(0x100, OBJECT_SIZE, object_tag));
+    zassert_equal(sys_get_be32(&resp.buf[4]), (1 << 8) | 2);
+    zassert_equal(send_begin(0x100, OBJECT_SIZE + 1, object_tag), -EINVAL);
+
+    // Un BEGIN autenticado con otro id sí sustituye a la sesión activa
+    zassert_ok(send_begin(0x200, OBJECT_SIZE, object_tag));
+    zassert_equal(send_symbol(0x100, OBJECT_SIZE, 0, 1), -EBUSY);
+    zassert_ok(send_symbol(0x200, OBJECT_SIZE, 0, 0));
+    zassert_ok(send_symbol(0x200, OBJECT_SIZE, 0, 1));
+    zassert_equal(delivered_session, 0x200);
+}
+
+// Reinicio tras el primer bloque y el final de la ventana: la etiqueta en curso vuelve
+// de settings con la sesión
+ZTEST(bulk, test_restored_session_verifies_whole_object) {
+    zassert_ok(send_begin(0x100, LONG_OBJECT_SIZE, long_object_tag));
+    for (uint16_t esi = 0; esi < ERASURE_MAX_K; esi++) {
+        zassert_ok(send_symbol(0x100, LONG_OBJECT_SIZE, 0, esi));
+    }
+    zassert_equal(delivered_len, ERASURE_BLOCK_SIZE);
+    zassert_false(delivered_last);
+
+    bulk_suspend();
+    zassert_ok(bulk_init(sinks));
+    zassert_equal(send_symbol(0x200, LONG_OBJECT_SIZE, 1, 0), -EBUSY);
+    zassert_equal(sys_get_be32(&resp.buf[0]), 0x100);
+    zassert_ok(send_symbol(0x100, LONG_OBJECT_SIZE, 1, 0));
+    zassert_equal(delivered_len, LONG_OBJECT_SIZE);
+    zassert_true(delivered_last);
+}
+
+// Un bloque completo antes que el anterior espera su turno; más allá de la ventana, -ERANGE
+ZTEST(bulk, test_out_of_order_blocks_delivered_in_order) {
+    zassert_ok(send_begin(0x100, WIDE_OBJECT_SIZE, wide_object_tag));
+    zassert_equal(send_symbol(0x100, WIDE_OBJECT_SIZE, BULK_DECODER_COUNT, 0), -ERANGE);
+
+    for (uint16_t block = BULK_DECODER_COUNT - 1; block > 0; block--) {
+        for (uint16_t esi = 0; esi < ERASURE_MAX_K; esi++) {
+            zassert_ok(send_symbol(0x100, WIDE_OBJECT_SIZE, block, esi));
+        }
+    }
+    zassert_equal(delivered_len, 0);
+    zassert_equal(sys_get_be32(&resp.buf[4]), 0);
+
+    for (uint16_t esi = 0; esi < ERASURE_MAX_K; esi++) {
+        zassert_ok(send_symbol(0x100, WIDE_OBJECT_SIZE, 0, esi));
+    }
+    zassert_equal(delivered_len, BULK_DECODER_COUNT * ERASURE_BLOCK_SIZE);
+    zassert_false(delivered_last);
+
+    // La ventana avanza con la entrega: el último bloque ya cabe
+    zassert_ok(send_symbol(0x100, WIDE_OBJECT_SIZE, BULK_DECODER_COUNT, 0));
+    zassert_equal(delivered_len, WIDE_OBJECT_SIZE);
+    zassert_true(delivered_last);
+}
+
+// El rango de los bloques a medias sobrevive al reinicio entre pases
+ZTEST(bulk, test_rank_kept_across_passes) {
+    zassert_ok(send_begin(0x100, LONG_OBJECT_SIZE, long_object_tag));
+    for (uint16_t esi = 0; esi < ERASURE_MAX_K / 2; esi++) {
+        zassert_ok(send_symbol(0x100, LONG_OBJECT_SIZE, 0, esi));
+    }
+    zassert_ok(send_symbol(0x100, LONG_OBJECT_SIZE, 1, 0));
+    bulk_suspend();
+
+    zassert_ok(bulk_init(sinks));
+    zassert_ok(send_begin(0x100, LONG_OBJECT_SIZE, long_object_tag));
+    zassert_equal(sys_get_be32(&resp.buf[4]), ((ERASURE_MAX_K / 2) << 8) | ERASURE_MAX_K);
+
+    // Solo faltan los símbolos del pase siguiente; el bloque 1 ya estaba completo
+    for (uint16_t esi = ERASURE_MAX_K / 2; esi < ERASURE_MAX_K; esi++) {
+        zassert_ok(send_symbol(0x100, LONG_OBJECT_SIZE, 0, esi));
+    }
+    zassert_equal(delivered_len, LONG_OBJECT_SIZE);
+    zassert_true(delivered_last);
+}
+
+// Sin bulk_suspend() un reinicio vuelve a la última posición persistida y el destino
+// recibe de nuevo los bloques posteriores
+ZTEST(bulk, test_reset_within_window_redelivers) {
+    zassert_ok(send_begin(0x100, LONG_OBJECT_SIZE, long_object_tag));
+    for (uint16_t esi = 0; esi < ERASURE_MAX_K; esi++) {
+        zassert_ok(send_symbol(0x100, LONG_OBJECT_SIZE, 0, esi));
+    }
+    zassert_equal(delivered_len, ERASURE_BLOCK_SIZE);
+
+    zassert_ok(bulk_init(sinks));
+    zassert_ok(send_begin(0x100, LONG_OBJECT_SIZE, long_object_tag));
+    zassert_equal(sys_get_be32(&resp.buf[4]), 0);
+
+    delivered_len = 0;
+    for (uint16_t esi = 0; esi < ERASURE_MAX_K; esi++) {
+        zassert_ok(send_symbol(0x100, LONG_OBJECT_SIZE, 0, esi));
+    }
+    zassert_ok(send_symbol(0x100, LONG_OBJECT_SIZE, 1, 0));
+    zassert_equal(delivered_len, LONG_OBJECT_SIZE);
+    zassert_true(delivered_last);
+}
+
+// Destino aún no preparado: el bloque espera decodificado y la etiqueta no cuenta dos veces
+ZTEST(bulk, test_busy_sink_retried) {
+    zassert_ok(send_begin(0x100, OBJECT_SIZE, object_tag));
+    sink_busy = 2;
+    zassert_ok(send_symbol(0x100, OBJECT_SIZE, 0, 0));
+    zassert_equal(send_symbol(0x100, OBJECT_SIZE, 0, 1), -EINPROGRESS);
+    zassert_equal(sys_get_be32(&resp.buf[4]), (2 << 8) | 2);
+    zassert_equal(send_symbol(0x100, OBJECT_SIZE, 0, 1), -EINPROGRESS);
+    zassert_equal(delivered_len, 0);
+
+    zassert_ok(send_symbol(0x100, OBJECT_SIZE, 0, 0));
+    zassert_equal(delivered_len, OBJECT_SIZE);
+    zassert_true(delivered_last);
+}
+
+ZTEST_SUITE(bulk, NULL, setup, before, NULL, NULL);
@@ -0,0 +1,158 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas de la autenticación de downlink (downlink_auth.c): etiquetas
+ *              frente a HMAC-SHA256 de referencia (Python hmac/hashlib), cálculo
+ *              troceado, separación de dominios, clave provisionada en settings y
+ *              contador anti-repetición de las tramas privilegiadas.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <string.h>
+
+#include "downlink_auth.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+// Clave de prueba: 0x00..0x1f
+static uint8_t key[DOWNLINK_AUTH_KEY_LEN];
+
+// PARAM_SET de una entrada (id 3, gnss_fix_timeout_s = 120): opcode + payload
+static const uint8_t param_frame[] = { 0x01, 0x01, 0x03, 0x00, 0x00, 0x00, 0x78 };
+static const uint8_t param_tag[DOWNLINK_AUTH_TAG_LEN] = {
+    0xe1, 0xe2, 0x47, 0x64, 0xd2, 0xe2, 0xea, 0x64, 0xec, 0xc0, 0xf6, 0x7e, 0xfb, 0x58, 0x18, 0x91,
+};
+
+// Imagen de 1000 bytes i % 251: varios bloques SHA-256 y un resto
+static const uint8_t image_tag[DOWNLINK_AUTH_TAG_LEN] = {
+    0x58, 0x30, 0x8d, 0x1e, 0x09, 0x6c, 0xf0, 0x9a, 0x24, 0x45, 0x06, 0x0c, 0x38, 0x70, 0x12, 0x6f,
+};
+static uint8_t image[1000];
+
+static void *setup(void) {
+    zassert_ok(settings_subsys_init());
+    for (size_t i = 0; i < sizeof(key); i++) {
+        key[i] = (uint8_t)i;
+    }
+    for (size_t i = 0; i < sizeof(image); i++) {
+        image[i] = (uint8_t)(i % 251);
+    }
+    return NULL;
+}
+
+static void before(void *fixture) {
+    ARG_UNUSED(fixture);
+    settings_delete(DOWNLINK_AUTH_COUNTER_KEY);
+    zassert_ok(downlink_auth_provision(key));
+    zassert_ok(downlink_auth_init());
+}
+
+// param_frame + contador + etiqueta, como la sella el servidor (sin CRC)
+static size_t seal_frame(uint8_t *frame, uint32_t counter) {
+    struct downlink_auth_stream mac;
+    size_t len = sizeof(param_frame);
+
+    memcpy(frame, param_frame, len);
+    frame[len++] = counter >> 24;
+    frame[len++] = counter >> 16;
+    frame[len++] = counter >> 8;
+    frame[len++] = counter;
+    downlink_auth_begin(&mac, DOWNLINK_AUTH_FRAME);
+    downlink_auth_update(&mac, frame, len);
+    downlink_auth_final(&mac, &frame[len]);
+    return len + DOWNLINK_AUTH_TAG_LEN;
+}
+
+ZTEST(downlink_auth, test_tags_match_reference) {
+    zassert_ok(downlink_auth_verify_buf(DOWNLINK_AUTH_FRAME, param_frame, sizeof(param_frame), param_tag));
+    zassert_ok(downlink_auth_verify_buf(DOWNLINK_AUTH_IMAGE, image, sizeof(image), image_tag));
+}
+
+ZTEST(downlink_auth, test_rejects_tampering_and_other_domain) {
+    uint8_t frame[sizeof(param_frame)];
+    uint8_t tag[DOWNLINK_AUTH_TAG_LEN];
+
+    memcpy(frame, param_frame, sizeof(frame));
+    frame[6] ^= 0x01;
+    zassert_equal(downlink_auth_verify_buf(DOWNLINK_AUTH_FRAME, frame, sizeof(frame), param_tag), -EACCES);
+
+    memcpy(tag, param_tag, sizeof(tag));
+    tag[DOWNLINK_AUTH_TAG_LEN - 1] ^= 0x80;
+    zassert_equal(downlink_auth_verify_buf(DOWNLINK_AUTH_FRAME, param_frame, sizeof(param_frame), tag), -EACCES);
+
+    // La etiqueta de una trama no vale para una imagen con los mismos bytes
+    zassert_equal(downlink_auth_verify_buf(DOWNLINK_AUTH_IMAGE, param_frame, sizeof(param_frame), param_tag),
+                  -EACCES);
+}
+
+ZTEST(downlink_auth, test_split_and_persisted_stream) {
+    struct downlink_auth_stream mac, saved;
+
+    // Trozos irregulares y una copia a mitad (como el progreso persistido del DFU del módem)
+    downlink_auth_begin(&mac, DOWNLINK_AUTH_IMAGE);
+    downlink_auth_update(&mac, image, 1);
+    downlink_auth_update(&mac, &image[1], 63);
+    downlink_auth_update(&mac, &image[64], 129);
+    memcpy(&saved, &mac, sizeof(saved));
+    memset(&mac, 0xA5, sizeof(mac));
+    downlink_auth_update(&saved, &image[193], sizeof(image) - 193);
+    zassert_ok(downlink_auth_verify(&saved, image_tag));
+}
+
+ZTEST(downlink_auth, test_key_survives_reboot_and_is_required) {
+    zassert_ok(downlink_auth_init());
+    zassert_true(downlink_auth_ready());
+    zassert_ok(downlink_auth_verify_buf(DOWNLINK_AUTH_FRAME, param_frame, sizeof(param_frame), param_tag));
+
+    // Otra clave: la etiqueta anterior deja de valer
+    uint8_t other[DOWNLINK_AUTH_KEY_LEN] = { 0x42 };
+
+    zassert_ok(downlink_auth_provision(other));
+    zassert_equal(downlink_auth_verify_buf(DOWNLINK_AUTH_FRAME, param_frame, sizeof(param_frame), param_tag),
+                  -EACCES);
+
+    // Sin clave provisionada todo se rechaza, incluida una etiqueta de ceros
+    static const uint8_t zero_tag[DOWNLINK_AUTH_TAG_LEN];
+
+    zassert_ok(settings_delete(DOWNLINK_AUTH_SETTINGS_KEY));
+    zassert_equal(downlink_auth_init(), -ENOENT);
+    zassert_false(downlink_auth_ready());
+    zassert_equal(downlink_auth_verify_buf(DOWNLINK_AUTH_FRAME, param_frame, sizeof(param_frame), zero_tag),
+                  -EACCES);
+}
+
+// Una trama aceptada no vuelve a valer, tampoco tras un reinicio ni con otra clave
+ZTEST(downlink_auth, test_frame_counter_rejects_replay) {
+    uint8_t first[sizeof(param_frame) + DOWNLINK_AUTH_FRAME_OVERHEAD];
+    uint8_t frame[sizeof(first)];
+    size_t len = seal_frame(first, 5);
+
+    zassert_ok(downlink_auth_verify_frame(first, len));
+    zassert_equal(downlink_auth_verify_frame(first, len), -EALREADY);
+    seal_frame(frame, 4);
+    zassert_equal(downlink_auth_verify_frame(frame, len), -EALREADY);
+
+    zassert_ok(downlink_auth_init());
+    zassert_equal(downlink_auth_verify_frame(first, len), -EALREADY);
+    seal_frame(frame, 6);
+    zassert_ok(downlink_auth_verify_frame(frame, len));
+
+    // Reprovisionar la clave no reinicia el contador
+    zassert_ok(downlink_auth_provision(key));
+    zassert_equal(downlink_auth_verify_frame(frame, len), -EALREADY);
+}
+
+// El contador va dentro de la etiqueta: cambiarlo sin firmar no cuela ni gasta el guardado
+ZTEST(downlink_auth, test_frame_counter_is_authenticated) {
+    uint8_t frame[sizeof(param_frame) + DOWNLINK_AUTH_FRAME_OVERHEAD];
+    size_t len = seal_frame(frame, 1);
+
+    frame[sizeof(param_frame)] = 0xFF;
+    zassert_equal(downlink_auth_verify_frame(frame, len), -EACCES);
+    frame[sizeof(param_frame)] = 0x00;
+    zassert_ok(downlink_auth_verify_frame(frame, len));
+    zassert_equal(downlink_auth_verify_frame(frame, DOWNLINK_AUTH_FRAME_OVERHEAD), -EACCES);
+}
+
+ZTEST_SUITE(downlink_auth, NULL, setup, before, NULL, NULL);
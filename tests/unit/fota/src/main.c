@@ -0,0 +1,205 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas de la aplicación del parche FOTA (fota.c): COPY e INSERT sobre
+ *              el slot secundario, reanudación tras un reinicio antes y después de
+ *              persistir el progreso, CRC y etiqueta de la imagen y límite del trailer
+ *              de MCUboot.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/dfu/mcuboot.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <string.h>
+
+#include "downlink_auth.h"
+#include "fota.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+// Imagen nueva: COPY base[0, 4096) + INSERT de INSERT_LEN bytes + COPY base[1000, 3000)
+#define BASE_SIZE 6000
+#define INSERT_LEN 6000
+#define IMAGE_SIZE (4096 + INSERT_LEN + 2000)
+#define PATCH_SIZE (9 + 5 + INSERT_LEN + 9)
+#define CHUNK_LEN 100
+
+static uint8_t base[BASE_SIZE];
+static uint8_t image[IMAGE_SIZE];
+static uint8_t patch[PATCH_SIZE];
+static uint8_t image_tag[DOWNLINK_AUTH_TAG_LEN];
+static const struct flash_area *slot1;
+
+// Sin downlink.c: solo hace falta el serializador de la respuesta
+void downlink_resp_put_be32(struct downlink_response *resp, uint32_t value) {
+    sys_put_be32(value, &resp->buf[resp->len]);
+    resp->len += 4;
+}
+
+static struct downlink_response resp;
+
+static size_t put_copy(uint8_t *p, uint32_t src, uint32_t len) {
+    p[0] = 0x01;
+    sys_put_be32(src, &p[1]);
+    sys_put_be32(len, &p[5]);
+    return 9;
+}
+
+// BEGIN ya autenticado por downlink.c
+static int send_begin(uint32_t session, uint32_t image_size, uint32_t image_crc, const uint8_t *tag) {
+    uint8_t payload[24 + DOWNLINK_AUTH_TAG_LEN];
+
+    sys_put_be32(session, &payload[0]);
+    sys_put_be32(PATCH_SIZE, &payload[4]);
+    sys_put_be32(image_size, &payload[8]);
+    sys_put_be32(image_crc, &payload[12]);
+    sys_put_be32(BASE_SIZE, &payload[16]);
+    sys_put_be32(crc32_ieee(base, BASE_SIZE), &payload[20]);
+    memcpy(&payload[24], tag, DOWNLINK_AUTH_TAG_LEN);
+    resp.len = 0;
+    return fota_handle_begin(payload, sizeof(payload), &resp);
+}
+
+// Fragmentos de CHUNK_LEN desde from hasta to; devuelve el resultado del último
+static int send_patch(uint32_t session, uint32_t from, uint32_t to) {
+    int err = 0;
+
+    for (uint32_t off = from; off < to && err == 0; off += CHUNK_LEN) {
+        err = fota_write_patch(session, off, &patch[off], MIN(CHUNK_LEN, to - off));
+    }
+    return err;
+}
+
+// Offset del parche que el dispositivo pide al arrancar
+static uint32_t resume_offset(void) {
+    resp.len = 0;
+    zassert_true(fota_resume_request(&resp));
+    return sys_get_be32(&resp.buf[DOWNLINK_ACK_LEN + 4]);
+}
+
+static void assert_image_written(void) {
+    static uint8_t rebuilt[IMAGE_SIZE];
+
+    zassert_true(fota_reboot_pending());
+    zassert_ok(flash_area_read(slot1, 0, rebuilt, sizeof(rebuilt)));
+    zassert_mem_equal(rebuilt, image, sizeof(image));
+}
+
+static void *setup(void) {
+    static uint8_t key[DOWNLINK_AUTH_KEY_LEN];
+    const struct flash_area *slot0;
+    struct downlink_auth_stream mac;
+    size_t n = 0;
+
+    zassert_ok(settings_subsys_init());
+    for (size_t i = 0; i < sizeof(key); i++) {
+        key[i] = (uint8_t)(0xA0 + i);
+    }
+    zassert_ok(downlink_auth_provision(key));
+
+    for (size_t i = 0; i < sizeof(base); i++) {
+        base[i] = (uint8_t)(i * 13 + 5);
+    }
+    zassert_ok(flash_area_open(FIXED_PARTITION_ID(slot0_partition), &slot0));
+    zassert_ok(flash_area_open(FIXED_PARTITION_ID(slot1_partition), &slot1));
+    zassert_ok(flash_area_erase(slot0, 0, 2 * 4096));
+    zassert_ok(flash_area_write(slot0, 0, base, sizeof(base)));
+
+    memcpy(image, base, 4096);
+    for (size_t i = 0; i < INSERT_LEN; i++) {
+        image[4096 + i] = (uint8_t)(i * 7 + 1);
+    }
+    memcpy(&image[4096 + INSERT_LEN], &base[1000], 2000);
+
+    n += put_copy(&patch[n], 0, 4096);
+    patch[n] = 0x02;
+    sys_put_be32(INSERT_LEN, &patch[n + 1]);
+    n += 5;
+    memcpy(&patch[n], &image[4096], INSERT_LEN);
+    n += INSERT_LEN;
+    n += put_copy(&patch[n], 1000, 2000);
+    zassert_equal(n, PATCH_SIZE);
+
+    downlink_auth_begin(&mac, DOWNLINK_AUTH_IMAGE);
+    downlink_auth_update(&mac, image, sizeof(image));
+    downlink_auth_final(&mac, image_tag);
+    return NULL;
+}
+
+static void before(void *fixture) {
+    ARG_UNUSED(fixture);
+    settings_delete(FOTA_SETTINGS_KEY);
+    zassert_ok(fota_init());
+}
+
+ZTEST(fota, test_copy_insert_apply) {
+    zassert_ok(send_begin(0x100, IMAGE_SIZE, crc32_ieee(image, IMAGE_SIZE), image_tag));
+    zassert_ok(send_patch(0x100, 0, PATCH_SIZE));
+    assert_image_written();
+}
+
+// Reinicio antes del primer guardado: el parche se reaplica desde el BEGIN
+ZTEST(fota, test_resume_rewrites_unpersisted_blocks) {
+    zassert_ok(send_begin(0x100, IMAGE_SIZE, crc32_ieee(image, IMAGE_SIZE), image_tag));
+    zassert_ok(send_patch(0x100, 0, 3000));
+
+    zassert_ok(fota_init());
+    zassert_equal(resume_offset(), 0);
+    zassert_ok(send_patch(0x100, 0, PATCH_SIZE));
+    assert_image_written();
+}
+
+// Progreso guardado cada pocos KB y en fota_suspend(). Los bloques escritos tras el
+// guardado, en una página ya borrada, se comprueban en lugar de reescribirse, y un
+// fragmento que solapa lo ya aplicado solo aporta su parte nueva
+ZTEST(fota, test_resume_from_persisted_offset) {
+    uint32_t offset;
+
+    zassert_ok(send_begin(0x100, IMAGE_SIZE, crc32_ieee(image, IMAGE_SIZE), image_tag));
+    zassert_ok(send_patch(0x100, 0, 1000));
+    fota_suspend();
+    zassert_ok(fota_init());
+    zassert_equal(resume_offset(), 1000);
+
+    zassert_ok(send_patch(0x100, 1000, 6000));
+    zassert_ok(fota_init());
+    offset = resume_offset();
+    zassert_true(offset > 1000 && offset < 6000);
+
+    zassert_equal(fota_write_patch(0x100, offset + CHUNK_LEN, &patch[offset + CHUNK_LEN], CHUNK_LEN), -ERANGE);
+    zassert_ok(fota_write_patch(0x100, offset - 50, &patch[offset - 50], CHUNK_LEN));
+    zassert_ok(send_patch(0x100, offset + 50, PATCH_SIZE));
+    assert_image_written();
+}
+
+ZTEST(fota, test_crc_mismatch_rejected) {
+    zassert_ok(send_begin(0x100, IMAGE_SIZE, crc32_ieee(image, IMAGE_SIZE) ^ 1, image_tag));
+    zassert_equal(send_patch(0x100, 0, PATCH_SIZE), -EBADMSG);
+    zassert_false(fota_reboot_pending());
+    zassert_false(fota_resume_request(&resp));
+}
+
+ZTEST(fota, test_tag_mismatch_rejected) {
+    uint8_t tag[DOWNLINK_AUTH_TAG_LEN];
+
+    memcpy(tag, image_tag, sizeof(tag));
+    tag[0] ^= 0x01;
+    zassert_ok(send_begin(0x100, IMAGE_SIZE, crc32_ieee(image, IMAGE_SIZE), tag));
+    zassert_equal(send_patch(0x100, 0, PATCH_SIZE), -EACCES);
+    zassert_false(fota_reboot_pending());
+    zassert_false(fota_resume_request(&resp));
+}
+
+// La imagen no puede invadir el trailer de MCUboot
+ZTEST(fota, test_image_must_fit_before_trailer) {
+    ssize_t image_max = boot_get_area_trailer_status_offset(slot1->fa_id);
+
+    zassert_true(image_max > IMAGE_SIZE && (size_t)image_max <= slot1->fa_size);
+    zassert_equal(send_begin(0x100, image_max + 1, 0, image_tag), -EFBIG);
+    zassert_false(fota_resume_request(&resp));
+}
+
+ZTEST_SUITE(fota, NULL, setup, before, NULL, NULL);
@@ -0,0 +1,290 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas del motor de geocercas (geofence.c): validación del blob,
+ *              histéresis de dos fixes, polígonos cóncavos y contraste de fixes
+ *              aleatorios con una referencia en double.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <string.h>
+
+#include "geofence.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+#define CENTER_LAT 41387917
+#define CENTER_LON 2168365
+#define UDEG_PER_M_LAT 9                // 1 m ≈ 8.99 µ° de latitud
+#define UDEG_PER_M_LON 13               // 1 m ≈ 11.9 µ° de longitud a 41° N
+#define RANDOM_FENCES 64
+#define RANDOM_FIXES 4000
+
+// ========================================
+// CONSTRUCCIÓN DEL BLOB
+// ========================================
+
+static uint32_t blob_words[2048];
+static uint8_t *const blob = (uint8_t *)blob_words;
+static size_t blob_len;
+static uint16_t blob_count;
+
+static void put_le32(int32_t value) {
+    sys_put_le32((uint32_t)value, &blob[blob_len]);
+    blob_len += 4;
+}
+
+static void put_record(uint16_t id, uint8_t type, uint8_t vertices, int32_t min_lat, int32_t min_lon,
+                       int32_t max_lat, int32_t max_lon) {
+    sys_put_le16(id, &blob[blob_len]);
+    blob[blob_len + 2] = type;
+    blob[blob_len + 3] = vertices;
+    blob_len += 4;
+    put_le32(min_lat);
+    put_le32(min_lon);
+    put_le32(max_lat);
+    put_le32(max_lon);
+    blob_count++;
+}
+
+static void blob_begin(void) {
+    blob_len = 12;
+    blob_count = 0;
+}
+
+// bbox con margen: la del servidor solo tiene que cubrir el círculo
+static void blob_circle(uint16_t id, int32_t lat, int32_t lon, uint32_t radius_m) {
+    int32_t dlat = (int32_t)radius_m * UDEG_PER_M_LAT + 10;
+    int32_t dlon = (int32_t)radius_m * UDEG_PER_M_LON + 10;
+
+    put_record(id, GEOFENCE_CIRCLE, 0, lat - dlat, lon - dlon, lat + dlat, lon + dlon);
+    put_le32(lat);
+    put_le32(lon);
+    put_le32((int32_t)radius_m);
+}
+
+static void blob_polygon(uint16_t id, const struct geo_position *v, uint8_t n) {
+    int32_t min_lat = INT32_MAX, min_lon = INT32_MAX, max_lat = INT32_MIN, max_lon = INT32_MIN;
+
+    for (uint8_t i = 0; i < n; i++) {
+        min_lat = MIN(min_lat, v[i].lat_udeg);
+        min_lon = MIN(min_lon, v[i].lon_udeg);
+        max_lat = MAX(max_lat, v[i].lat_udeg);
+        max_lon = MAX(max_lon, v[i].lon_udeg);
+    }
+    put_record(id, GEOFENCE_POLYGON, n, min_lat, min_lon, max_lat, max_lon);
+    for (uint8_t i = 0; i < n; i++) {
+        put_le32(v[i].lat_udeg);
+        put_le32(v[i].lon_udeg);
+    }
+}
+
+static void blob_end(void) {
+    sys_put_le32(GEOFENCE_MAGIC, &blob[0]);
+    sys_put_le16(GEOFENCE_VERSION, &blob[4]);
+    sys_put_le16(blob_count, &blob[6]);
+    sys_put_le32(crc32_ieee(&blob[12], blob_len - 12), &blob[8]);
+}
+
+// ========================================
+// EVENTOS Y UTILIDADES
+// ========================================
+
+static struct geofence_set set;
+static struct geofence_event events[8];
+static int event_count;
+
+static void record_event(const struct geofence_event *evt, void *ctx) {
+    ARG_UNUSED(ctx);
+    zassert_true(event_count < ARRAY_SIZE(events));
+    events[event_count++] = *evt;
+}
+
+static int evaluate(int32_t lat, int32_t lon) {
+    struct geo_position p = { .lat_udeg = lat, .lon_udeg = lon };
+
+    event_count = 0;
+    return geofence_set_evaluate(&set, &p, 0, record_event, NULL);
+}
+
+static bool inside(uint16_t i) {
+    return set.inside[i / 8] & (1u << (i % 8));
+}
+
+static uint32_t noise_state = 7;
+
+static int32_t noise(int32_t amplitude) {
+    noise_state = noise_state * 1664525u + 1013904223u;
+    return (int32_t)((noise_state >> 4) % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+// Estrella de 8 puntas alternando radio exterior e interior: cóncava
+static void star(int32_t lat, int32_t lon, int32_t outer_m, int32_t inner_m, struct geo_position v[8]) {
+    static const int32_t dir_q10[8][2] = {
+        { 1024, 0 }, { 724, 724 }, { 0, 1024 }, { -724, 724 },
+        { -1024, 0 }, { -724, -724 }, { 0, -1024 }, { 724, -724 },
+    };
+
+    for (int i = 0; i < 8; i++) {
+        int32_t r = i % 2 ? inner_m : outer_m;
+
+        v[i].lat_udeg = lat + dir_q10[i][0] * r * UDEG_PER_M_LAT / 1024;
+        v[i].lon_udeg = lon + dir_q10[i][1] * r * UDEG_PER_M_LON / 1024;
+    }
+}
+
+// Referencia clásica de cruce de rayo (PNPOLY) en double
+static bool polygon_reference(const struct geo_position *v, int n, int32_t lat, int32_t lon) {
+    bool in = false;
+
+    for (int i = 0, j = n - 1; i < n; j = i++) {
+        if ((v[i].lat_udeg > lat) != (v[j].lat_udeg > lat) &&
+            lon < (double)(v[j].lon_udeg - v[i].lon_udeg) * (lat - v[i].lat_udeg) /
+                          (v[j].lat_udeg - v[i].lat_udeg) + v[i].lon_udeg) {
+            in = !in;
+        }
+    }
+    return in;
+}
+
+ZTEST_SUITE(geofence, NULL, NULL, NULL, NULL, NULL);
+
+// ========================================
+// PRUEBAS
+// ========================================
+
+ZTEST(geofence, test_bind_validates_blob) {
+    blob_begin();
+    blob_circle(1, CENTER_LAT, CENTER_LON, 500);
+    blob_end();
+    zassert_ok(geofence_set_bind(&set, blob, blob_len));
+    zassert_equal(set.count, 1);
+
+    // Desalineado, sin cabecera completa o de otra versión
+    zassert_equal(geofence_set_bind(&set, blob + 1, blob_len - 1), -EINVAL);
+    zassert_equal(geofence_set_bind(&set, blob, 8), -EINVAL);
+    blob[4] = GEOFENCE_VERSION + 1;
+    zassert_equal(geofence_set_bind(&set, blob, blob_len), -EBADMSG);
+    blob_end();
+
+    // Un byte alterado rompe el CRC
+    blob[20] ^= 0x01;
+    zassert_equal(geofence_set_bind(&set, blob, blob_len), -EILSEQ);
+    zassert_equal(set.count, 0);
+    blob[20] ^= 0x01;
+
+    // Más registros anunciados de los que hay, aun con el CRC bien
+    blob_count = 2;
+    blob_end();
+    zassert_equal(geofence_set_bind(&set, blob, blob_len), -EMSGSIZE);
+
+    // La bbox tiene que cubrir el círculo entero
+    blob_begin();
+    put_record(1, GEOFENCE_CIRCLE, 0, CENTER_LAT - 100, CENTER_LON - 100, CENTER_LAT + 100, CENTER_LON + 100);
+    put_le32(CENTER_LAT);
+    put_le32(CENTER_LON);
+    put_le32(500);
+    blob_end();
+    zassert_equal(geofence_set_bind(&set, blob, blob_len), -EINVAL);
+}
+
+ZTEST(geofence, test_transition_needs_two_fixes) {
+    const int32_t edge = 500 * UDEG_PER_M_LAT;
+
+    blob_begin();
+    blob_circle(7, CENTER_LAT, CENTER_LON, 500);
+    blob_end();
+    zassert_ok(geofence_set_bind(&set, blob, blob_len));
+
+    zassert_equal(evaluate(CENTER_LAT, CENTER_LON), 1);
+    zassert_equal(event_count, 0);
+    evaluate(CENTER_LAT, CENTER_LON);
+    zassert_equal(event_count, 1);
+    zassert_equal(events[0].fence_id, 7);
+    zassert_equal(events[0].transition, GEOFENCE_ENTER);
+
+    // Ruido en el borde: fuera y dentro alternos (acabando dentro) no generan eventos
+    for (int i = 0; i < 10; i++) {
+        evaluate(CENTER_LAT + edge + (i % 2 ? -200 : 200), CENTER_LON);
+        zassert_equal(event_count, 0, "fix %d", i);
+    }
+
+    // Fuera de la bbox no hay prueba exacta, y dos fixes fuera confirman la salida
+    zassert_equal(evaluate(CENTER_LAT + 2 * edge, CENTER_LON), 0);
+    zassert_equal(event_count, 0);
+    evaluate(CENTER_LAT + 2 * edge, CENTER_LON);
+    zassert_equal(event_count, 1);
+    zassert_equal(events[0].transition, GEOFENCE_EXIT);
+}
+
+ZTEST(geofence, test_concave_polygon) {
+    // U abierta al norte: 1 km de lado, brazos de 300 m
+    const int32_t km_lat = 1000 * UDEG_PER_M_LAT, km_lon = 1000 * UDEG_PER_M_LON;
+    const struct geo_position u[8] = {
+        { .lat_udeg = CENTER_LAT, .lon_udeg = CENTER_LON },
+        { .lat_udeg = CENTER_LAT, .lon_udeg = CENTER_LON + km_lon },
+        { .lat_udeg = CENTER_LAT + km_lat, .lon_udeg = CENTER_LON + km_lon },
+        { .lat_udeg = CENTER_LAT + km_lat, .lon_udeg = CENTER_LON + km_lon * 7 / 10 },
+        { .lat_udeg = CENTER_LAT + km_lat * 3 / 10, .lon_udeg = CENTER_LON + km_lon * 7 / 10 },
+        { .lat_udeg = CENTER_LAT + km_lat * 3 / 10, .lon_udeg = CENTER_LON + km_lon * 3 / 10 },
+        { .lat_udeg = CENTER_LAT + km_lat, .lon_udeg = CENTER_LON + km_lon * 3 / 10 },
+        { .lat_udeg = CENTER_LAT + km_lat, .lon_udeg = CENTER_LON },
+    };
+
+    blob_begin();
+    blob_polygon(3, u, ARRAY_SIZE(u));
+    blob_end();
+    zassert_ok(geofence_set_bind(&set, blob, blob_len));
+
+    // Hueco de la U: dentro de la bbox pero fuera del polígono
+    evaluate(CENTER_LAT + km_lat * 8 / 10, CENTER_LON + km_lon / 2);
+    evaluate(CENTER_LAT + km_lat * 8 / 10, CENTER_LON + km_lon / 2);
+    zassert_false(inside(0));
+
+    // Brazos y base
+    const int32_t probes[][2] = {
+        { km_lat * 8 / 10, km_lon / 10 },
+        { km_lat * 8 / 10, km_lon * 9 / 10 },
+        { km_lat / 10, km_lon / 2 },
+    };
+
+    for (int i = 0; i < ARRAY_SIZE(probes); i++) {
+        evaluate(CENTER_LAT + probes[i][0], CENTER_LON + probes[i][1]);
+        evaluate(CENTER_LAT + probes[i][0], CENTER_LON + probes[i][1]);
+        zassert_true(inside(0), "punto %d", i);
+    }
+}
+
+// Estrellas cóncavas al azar: tras dos fixes iguales el estado coincide con PNPOLY
+ZTEST(geofence, test_random_fixes_match_reference) {
+    static struct geo_position stars[RANDOM_FENCES][8];
+    const int32_t area_lat = 20000 * UDEG_PER_M_LAT, area_lon = 20000 * UDEG_PER_M_LON;
+    uint32_t exact = 0, hits = 0;
+
+    blob_begin();
+    for (int i = 0; i < RANDOM_FENCES; i++) {
+        star(CENTER_LAT + noise(area_lat), CENTER_LON + noise(area_lon), 1500 + noise(1000), 400 + noise(200),
+             stars[i]);
+        blob_polygon((uint16_t)i, stars[i], 8);
+    }
+    blob_end();
+    zassert_ok(geofence_set_bind(&set, blob, blob_len));
+
+    for (int k = 0; k < RANDOM_FIXES; k++) {
+        int32_t lat = CENTER_LAT + noise(area_lat), lon = CENTER_LON + noise(area_lon);
+
+        exact += evaluate(lat, lon);
+        evaluate(lat, lon);
+        for (int i = 0; i < RANDOM_FENCES; i++) {
+            bool expected = polygon_reference(stars[i], 8, lat, lon);
+
+            zassert_equal(inside(i), expected, "fix %d geocerca %d", k, i);
+            hits += expected;
+        }
+    }
+    // La muestra ejercita los dos lados, y la bbox evita casi todas las pruebas exactas
+    zassert_true(hits > RANDOM_FIXES / 20, "%u fixes dentro", hits);
+    zassert_true(exact < RANDOM_FIXES, "%u pruebas exactas", exact);
+}
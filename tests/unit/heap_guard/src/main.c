@@ -0,0 +1,71 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas de la imagen sin heap (heap_guard.c), enlazadas con el mismo
+ *              --wrap que la imagen: los envoltorios cuentan y rechazan cada llamada, y
+ *              la ruta de cada ciclo (fix, telemetría, TLE, previsión de pases) no llama
+ *              a malloc & co.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+#include <stdlib.h>
+
+#include "geo_position.h"
+#include "heap_guard.h"
+#include "pass_predictor.h"
+#include "telemetry.h"
+#include "tle.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+#define SAT1_LINE1 "1 60550U 24149CL 25071.82076637 .00007488 00000+0 68187-3 0 9999"
+#define SAT1_LINE2 "2 60550 97.7148 150.0635 0007556 170.3117 189.8251 14.95428546 31058"
+
+// Tamaño opaco: el compilador no puede resolver ni eliminar la llamada
+static volatile size_t alloc_size = 16;
+
+ZTEST_SUITE(heap_guard, NULL, NULL, NULL, NULL, NULL);
+
+// Un ciclo de la aplicación: sin ninguna llamada a malloc & co. de principio a fin
+ZTEST(heap_guard, test_cycle_path_does_not_allocate) {
+    static const char tle_frame[] = "SATELIOT_1\r\n" SAT1_LINE1 "\r\n" SAT1_LINE2 "\r\n";
+    static char payload[PAYLOAD_BUFFER_SIZE];
+    struct uplink_record record = { .timestamp = 1741808513000LL, .sats = 9, .kind = UPLINK_RECORD_RAW };
+    struct geo_modem_position modem;
+    struct satellite_pass first;
+    struct satellite_pass table[16];
+    struct tle_elements el;
+    struct pass_rng rng;
+    uint32_t calls = heap_guard_libc_calls();
+
+    geo_position_from_fix(41.387917, 2.168365, 12.3f, &record.position, &modem);
+    record.position_valid = true;
+    zassert_ok(format_telemetry_data(payload, sizeof(payload), &record));
+    zassert_ok(tle_ingest((const uint8_t *)tle_frame, sizeof(tle_frame) - 1, &el));
+    pass_rng_seed(&rng, 1);
+    zassert_ok(calculate_sateliot_satellite_pass(&first, &record.position, 0, &rng));
+    zassert_true(pass_forecast(&first, &record.position, 7LL * 24 * 60 * 60 * 1000, rng, 1, table,
+                               ARRAY_SIZE(table)) > 0);
+
+    zassert_equal(heap_guard_libc_calls(), calls, "malloc & co. en la ruta del ciclo");
+}
+
+// Los envoltorios devuelven NULL sin detener la imagen; heap_guard_check() lo informa
+ZTEST(heap_guard, test_wrappers_count_and_refuse) {
+    uint32_t calls = heap_guard_libc_calls();
+    void *p;
+
+    p = malloc(alloc_size);
+    zassert_is_null(p);
+    p = calloc(2, alloc_size);
+    zassert_is_null(p);
+    p = realloc(NULL, alloc_size);
+    zassert_is_null(p);
+    free(NULL);
+    zassert_equal(heap_guard_libc_calls(), calls + 3);
+
+    free(&calls);
+    zassert_equal(heap_guard_libc_calls(), calls + 4);
+    zassert_equal(heap_guard_check(), -ENOMEM);
+    zassert_equal(heap_guard_check(), -ENOMEM);
+}
@@ -0,0 +1,17 @@
+/*
+ * Archivo: nrf_modem.h (prueba)
+ * Descripción: Solo los códigos de resultado de DFU que usa modem_dfu.c; en native_sim
+ *              no hay librería del módem.
+ */
+
+#ifndef NRF_MODEM_H__
+#define NRF_MODEM_H__
+
+#define NRF_MODEM_DFU_RESULT_OK             0x5500001
+#define NRF_MODEM_DFU_RESULT_UUID_ERROR     0x4400001
+#define NRF_MODEM_DFU_RESULT_AUTH_ERROR     0x4400002
+#define NRF_MODEM_DFU_RESULT_HARDWARE_ERROR 0x4400003
+#define NRF_MODEM_DFU_RESULT_INTERNAL_ERROR 0x4400004
+#define NRF_MODEM_DFU_RESULT_VOLTAGE_LOW    0x5500002
+
+#endif /* NRF_MODEM_H__ */
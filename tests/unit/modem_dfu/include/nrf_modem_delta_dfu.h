@@ -0,0 +1,23 @@
+/*
+ * Archivo: nrf_modem_delta_dfu.h (prueba)
+ * Descripción: Interfaz delta DFU que usa modem_dfu.c; src/main.c simula el área DFU
+ *              del módem con un borrado que tarda varias consultas.
+ */
+
+#ifndef NRF_MODEM_DELTA_DFU_H__
+#define NRF_MODEM_DELTA_DFU_H__
+
+#include <stddef.h>
+
+#define NRF_MODEM_DELTA_DFU_ERASE_PENDING 1
+#define NRF_MODEM_DELTA_DFU_OFFSET_DIRTY  2
+
+int nrf_modem_delta_dfu_offset(size_t *offset);
+int nrf_modem_delta_dfu_area(size_t *size);
+int nrf_modem_delta_dfu_erase(void);
+int nrf_modem_delta_dfu_write_init(void);
+int nrf_modem_delta_dfu_write(const void *buf, size_t len);
+int nrf_modem_delta_dfu_write_done(void);
+int nrf_modem_delta_dfu_update(void);
+
+#endif /* NRF_MODEM_DELTA_DFU_H__ */
@@ -0,0 +1,203 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas del DFU delta del módem (modem_dfu.c) contra un área DFU
+ *              simulada: borrado asíncrono sin bloquear el downlink, reanudación tras
+ *              un reinicio con el área del módem en otro offset y comprobación del CRC
+ *              y la etiqueta al completar el delta.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <nrf_modem_delta_dfu.h>
+#include <string.h>
+
+#include "downlink_auth.h"
+#include "modem_dfu.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+#define DELTA_SIZE 4096
+#define BLOCK_LEN 512
+#define AREA_SIZE (64 * 1024)
+#define ERASE_POLLS 3               // Consultas del offset que dura el borrado
+
+static uint8_t delta[DELTA_SIZE];
+static uint8_t delta_tag[DOWNLINK_AUTH_TAG_LEN];
+
+// Área DFU del módem: conserva lo escrito entre reinicios de la aplicación
+static size_t area_offset;
+static int erase_polls;
+
+int nrf_modem_delta_dfu_offset(size_t *offset) {
+    if (erase_polls > 0) {
+        erase_polls--;
+        return NRF_MODEM_DELTA_DFU_ERASE_PENDING;
+    }
+    *offset = area_offset;
+    return 0;
+}
+
+int nrf_modem_delta_dfu_area(size_t *size) {
+    *size = AREA_SIZE;
+    return 0;
+}
+
+int nrf_modem_delta_dfu_erase(void) {
+    area_offset = 0;
+    erase_polls = ERASE_POLLS;
+    return 0;
+}
+
+int nrf_modem_delta_dfu_write_init(void) {
+    zassert_equal(erase_polls, 0, "escritura con el borrado en curso");
+    return 0;
+}
+
+int nrf_modem_delta_dfu_write(const void *buf, size_t len) {
+    ARG_UNUSED(buf);
+    area_offset += len;
+    return 0;
+}
+
+int nrf_modem_delta_dfu_write_done(void) {
+    return 0;
+}
+
+int nrf_modem_delta_dfu_update(void) {
+    return 0;
+}
+
+// Sin downlink.c: solo hace falta el serializador de la respuesta
+void downlink_resp_put_be32(struct downlink_response *resp, uint32_t value) {
+    sys_put_be32(value, &resp->buf[resp->len]);
+    resp->len += 4;
+}
+
+static struct downlink_response resp;
+
+// BEGIN ya autenticado por downlink.c
+static int send_begin(uint32_t session, uint32_t crc, const uint8_t *tag) {
+    uint8_t payload[12 + DOWNLINK_AUTH_TAG_LEN];
+
+    sys_put_be32(session, &payload[0]);
+    sys_put_be32(DELTA_SIZE, &payload[4]);
+    sys_put_be32(crc, &payload[8]);
+    memcpy(&payload[12], tag, DOWNLINK_AUTH_TAG_LEN);
+    resp.len = 0;
+    return modem_dfu_handle_begin(payload, sizeof(payload), &resp);
+}
+
+// Repite el BEGIN mientras el módem borra, como el servidor
+static void begin_and_wait_erase(uint32_t session, uint32_t crc, const uint8_t *tag) {
+    int err = send_begin(session, crc, tag);
+
+    for (int i = 0; err == -EINPROGRESS && i < 2 * ERASE_POLLS; i++) {
+        err = send_begin(session, crc, tag);
+    }
+    zassert_ok(err);
+}
+
+static int write_blocks(uint32_t session, uint32_t from, uint32_t to) {
+    int err = 0;
+
+    for (uint32_t off = from; off < to && err == 0; off += BLOCK_LEN) {
+        err = modem_dfu_write(session, off, &delta[off], BLOCK_LEN);
+    }
+    return err;
+}
+
+static void *setup(void) {
+    static uint8_t key[DOWNLINK_AUTH_KEY_LEN];
+    struct downlink_auth_stream mac;
+
+    zassert_ok(settings_subsys_init());
+    for (size_t i = 0; i < sizeof(key); i++) {
+        key[i] = (uint8_t)(0xA0 + i);
+    }
+    zassert_ok(downlink_auth_provision(key));
+    for (size_t i = 0; i < sizeof(delta); i++) {
+        delta[i] = (uint8_t)(i * 11 + 9);
+    }
+    downlink_auth_begin(&mac, DOWNLINK_AUTH_IMAGE);
+    downlink_auth_update(&mac, delta, sizeof(delta));
+    downlink_auth_final(&mac, delta_tag);
+    return NULL;
+}
+
+static void before(void *fixture) {
+    ARG_UNUSED(fixture);
+    settings_delete(MODEM_DFU_SETTINGS_KEY);
+    area_offset = 0;
+    erase_polls = 0;
+    zassert_ok(modem_dfu_init());
+}
+
+// El BEGIN no espera al borrado: contesta -EINPROGRESS y los bloques que lleguen antes
+// de que termine se rechazan sin perder la sesión
+ZTEST(modem_dfu, test_erase_does_not_block) {
+    zassert_equal(send_begin(0x100, crc32_ieee(delta, DELTA_SIZE), delta_tag), -EINPROGRESS);
+    zassert_equal(sys_get_be32(&resp.buf[0]), 0x100);
+    zassert_equal(sys_get_be32(&resp.buf[4]), 0);
+    zassert_equal(modem_dfu_write(0x100, 0, delta, BLOCK_LEN), -EINPROGRESS);
+
+    begin_and_wait_erase(0x100, crc32_ieee(delta, DELTA_SIZE), delta_tag);
+    zassert_ok(write_blocks(0x100, 0, DELTA_SIZE));
+    zassert_true(modem_dfu_apply_pending());
+    zassert_ok(modem_dfu_schedule());
+}
+
+// Reinicio entre pases: se sigue donde quedó y los bloques ya escritos se ignoran
+ZTEST(modem_dfu, test_resume_after_reboot) {
+    begin_and_wait_erase(0x100, crc32_ieee(delta, DELTA_SIZE), delta_tag);
+    zassert_ok(write_blocks(0x100, 0, DELTA_SIZE / 2));
+    modem_dfu_suspend();
+
+    zassert_ok(modem_dfu_init());
+    zassert_ok(send_begin(0x100, crc32_ieee(delta, DELTA_SIZE), delta_tag));
+    zassert_equal(sys_get_be32(&resp.buf[4]), DELTA_SIZE / 2);
+    zassert_ok(modem_dfu_write(0x100, 0, delta, BLOCK_LEN));
+    zassert_equal(modem_dfu_write(0x100, DELTA_SIZE / 2 + BLOCK_LEN, delta, BLOCK_LEN), -ERANGE);
+    zassert_ok(write_blocks(0x100, DELTA_SIZE / 2, DELTA_SIZE));
+    zassert_true(modem_dfu_apply_pending());
+}
+
+// Corte entre la escritura en el módem y el guardado del progreso: el área va por delante
+ZTEST(modem_dfu, test_resume_offset_mismatch_discards_session) {
+    begin_and_wait_erase(0x100, crc32_ieee(delta, DELTA_SIZE), delta_tag);
+    zassert_ok(write_blocks(0x100, 0, DELTA_SIZE / 2));
+    modem_dfu_suspend();
+    area_offset += BLOCK_LEN;
+
+    zassert_ok(modem_dfu_init());
+    zassert_equal(modem_dfu_write(0x100, DELTA_SIZE / 2, &delta[DELTA_SIZE / 2], BLOCK_LEN), -ESTALE);
+    zassert_false(modem_dfu_apply_pending());
+    zassert_equal(modem_dfu_write(0x100, DELTA_SIZE / 2, &delta[DELTA_SIZE / 2], BLOCK_LEN), -ESRCH);
+
+    // Un BEGIN nuevo vuelve a borrar y empieza de cero
+    begin_and_wait_erase(0x100, crc32_ieee(delta, DELTA_SIZE), delta_tag);
+    zassert_equal(sys_get_be32(&resp.buf[4]), 0);
+    zassert_equal(area_offset, 0);
+}
+
+ZTEST(modem_dfu, test_finish_checks_crc) {
+    begin_and_wait_erase(0x100, crc32_ieee(delta, DELTA_SIZE) ^ 1, delta_tag);
+    zassert_equal(write_blocks(0x100, 0, DELTA_SIZE), -EBADMSG);
+    zassert_false(modem_dfu_apply_pending());
+    zassert_equal(modem_dfu_schedule(), -ENOENT);
+}
+
+ZTEST(modem_dfu, test_finish_checks_tag) {
+    uint8_t tag[DOWNLINK_AUTH_TAG_LEN];
+
+    memcpy(tag, delta_tag, sizeof(tag));
+    tag[0] ^= 0x01;
+    begin_and_wait_erase(0x100, crc32_ieee(delta, DELTA_SIZE), tag);
+    zassert_equal(write_blocks(0x100, 0, DELTA_SIZE), -EACCES);
+    zassert_false(modem_dfu_apply_pending());
+    zassert_equal(modem_dfu_schedule(), -ENOENT);
+}
+
+ZTEST_SUITE(modem_dfu, NULL, setup, before, NULL, NULL);
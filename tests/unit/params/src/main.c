@@ -0,0 +1,166 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas de la tabla de parámetros (params.c): migración de tablas
+ *              persistidas por otro firmware, valores fuera de rango y PARAM_SET.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <string.h>
+
+#include "params.h"
+#include "pass_predictor.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+// Tabla de un firmware anterior: los diez primeros ids (hasta downlink_window_s)
+#define OLD_PARAM_COUNT 10
+
+static struct runtime_params defaults;
+static size_t stored_len;
+
+static int stored_len_read(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg, void *param) {
+    stored_len = len;
+    return 0;
+}
+
+// Longitud de la tabla que queda en settings tras params_load()
+static size_t persisted_len(void) {
+    stored_len = 0;
+    zassert_ok(settings_load_subtree_direct(PARAMS_SETTINGS_KEY, stored_len_read, NULL));
+    return stored_len;
+}
+
+static void *setup(void) {
+    zassert_ok(settings_subsys_init());
+    params_init("192.0.2.1", 5683);
+    defaults = rt_params;
+    return NULL;
+}
+
+static void before(void *fixture) {
+    ARG_UNUSED(fixture);
+    settings_delete(PARAMS_SETTINGS_KEY);
+    params_init("192.0.2.1", 5683);
+}
+
+ZTEST_SUITE(params, NULL, setup, before, NULL, NULL);
+
+ZTEST(params, test_no_table_keeps_defaults) {
+    zassert_ok(params_load());
+    zassert_mem_equal(&rt_params, &defaults, sizeof(defaults));
+    zassert_equal(rt_params.server_addr, 0xC0000201);
+}
+
+// Tabla más corta: se conserva el prefijo, los ids nuevos quedan por defecto y se reescribe
+ZTEST(params, test_shorter_table_migrates_prefix) {
+    uint32_t old[OLD_PARAM_COUNT];
+
+    memcpy(old, &defaults, sizeof(old));
+    old[PARAM_STEP1_TIMEOUT_S] = 15;
+    old[PARAM_GNSS_FIX_TIMEOUT_S] = 300;
+    old[PARAM_DOWNLINK_WINDOW_S] = 30;
+    zassert_ok(settings_save_one(PARAMS_SETTINGS_KEY, old, sizeof(old)));
+
+    zassert_ok(params_load());
+    zassert_equal(rt_params.step1_timeout_s, 15);
+    zassert_equal(rt_params.gnss_fix_timeout_s, 300);
+    zassert_equal(rt_params.downlink_window_s, 30);
+    zassert_equal(rt_params.max_payload_bytes, defaults.max_payload_bytes);
+    zassert_equal(rt_params.rbe_beacon_s, defaults.rbe_beacon_s);
+    zassert_equal(rt_params.sample_interval_min_s, defaults.sample_interval_min_s);
+    zassert_equal(persisted_len(), sizeof(struct runtime_params));
+
+    // El siguiente arranque carga la tabla completa sin volver a migrar
+    params_init("192.0.2.1", 5683);
+    zassert_ok(params_load());
+    zassert_equal(rt_params.step1_timeout_s, 15);
+}
+
+// Tabla más larga (firmware más nuevo): se leen los ids conocidos y flash no se toca
+ZTEST(params, test_longer_table_keeps_known_ids) {
+    uint32_t newer[PARAM_COUNT + 2];
+
+    memcpy(newer, &defaults, sizeof(defaults));
+    newer[PARAM_SEND_MAX_RETRIES] = 5;
+    newer[PARAM_COUNT] = 0xDEADBEEF;
+    newer[PARAM_COUNT + 1] = 0xDEADBEEF;
+    zassert_ok(settings_save_one(PARAMS_SETTINGS_KEY, newer, sizeof(newer)));
+
+    zassert_ok(params_load());
+    zassert_equal(rt_params.send_max_retries, 5);
+    zassert_equal(persisted_len(), sizeof(newer));
+}
+
+// Un valor fuera de rango vuelve a su defecto sin descartar el resto de la tabla
+ZTEST(params, test_out_of_range_value_reverts_to_default) {
+    struct runtime_params stored = defaults;
+
+    stored.gnss_fix_timeout_s = 5;
+    stored.max_payload_bytes = 0;
+    stored.send_retry_delay_s = 60;
+    zassert_ok(settings_save_one(PARAMS_SETTINGS_KEY, &stored, sizeof(stored)));
+
+    zassert_ok(params_load());
+    zassert_equal(rt_params.gnss_fix_timeout_s, defaults.gnss_fix_timeout_s);
+    zassert_equal(rt_params.max_payload_bytes, defaults.max_payload_bytes);
+    zassert_equal(rt_params.send_retry_delay_s, 60);
+
+    // La tabla corregida queda persistida
+    params_init("192.0.2.1", 5683);
+    zassert_ok(params_load());
+    zassert_equal(rt_params.send_retry_delay_s, 60);
+}
+
+// Step 1 + feeder link + Step 2 debe caber en el slot: tablas de firmwares con esperas
+// de minutos (5 y 15 min) vuelven a los tiempos por defecto
+ZTEST(params, test_attach_sequence_fits_slot) {
+    struct runtime_params stored = defaults;
+    uint8_t set[] = { 2, PARAM_STEP1_TIMEOUT_S, 0, 0, 0, 0, PARAM_STEP2_TIMEOUT_S, 0, 0, 0, 0 };
+
+    zassert_true(defaults.step1_timeout_s + defaults.feeder_link_wait_s + defaults.step2_timeout_s <=
+                 TX_SLOT_WINDOW_MS / 1000);
+
+    stored.step1_timeout_s = 5 * 60;
+    stored.step2_timeout_s = 15 * 60;
+    zassert_ok(settings_save_one(PARAMS_SETTINGS_KEY, &stored, sizeof(stored)));
+    zassert_ok(params_load());
+    zassert_equal(rt_params.step1_timeout_s, defaults.step1_timeout_s);
+    zassert_equal(rt_params.step2_timeout_s, defaults.step2_timeout_s);
+
+    // Cada valor en rango pero la suma no cabe
+    stored = defaults;
+    stored.step1_timeout_s = TX_SLOT_WINDOW_MS / 1000;
+    zassert_ok(settings_save_one(PARAMS_SETTINGS_KEY, &stored, sizeof(stored)));
+    zassert_ok(params_load());
+    zassert_equal(rt_params.step1_timeout_s, defaults.step1_timeout_s);
+
+    set[5] = (uint8_t)(TX_SLOT_WINDOW_MS / 1000 / 2);
+    set[10] = (uint8_t)(TX_SLOT_WINDOW_MS / 1000 / 2);
+    zassert_equal(params_apply_set(set, sizeof(set)), -ERANGE);
+    set[5] = 10;
+    set[10] = 10;
+    zassert_ok(params_apply_set(set, sizeof(set)));
+    zassert_equal(rt_params.step1_timeout_s, 10);
+    zassert_equal(rt_params.step2_timeout_s, 10);
+}
+
+ZTEST(params, test_param_set_is_all_or_nothing) {
+    // gnss_fix_timeout_s = 120 y send_max_retries = 11 (fuera de rango)
+    static const uint8_t bad[] = { 2, PARAM_GNSS_FIX_TIMEOUT_S, 0, 0, 0, 120,
+                                   PARAM_SEND_MAX_RETRIES, 0, 0, 0, 11 };
+    static const uint8_t unknown[] = { 1, PARAM_COUNT, 0, 0, 0, 1 };
+    static const uint8_t good[] = { 1, PARAM_GNSS_FIX_TIMEOUT_S, 0, 0, 0, 120 };
+
+    zassert_equal(params_apply_set(bad, sizeof(bad)), -ERANGE);
+    zassert_equal(params_apply_set(unknown, sizeof(unknown)), -ENOENT);
+    zassert_equal(params_apply_set(good, sizeof(good) - 1), -EBADMSG);
+    zassert_mem_equal(&rt_params, &defaults, sizeof(defaults));
+
+    zassert_ok(params_apply_set(good, sizeof(good)));
+    zassert_equal(rt_params.gnss_fix_timeout_s, 120);
+    params_init("192.0.2.1", 5683);
+    zassert_ok(params_load());
+    zassert_equal(rt_params.gnss_fix_timeout_s, 120);
+}
@@ -0,0 +1,187 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas del planificador de pases (pass_predictor.c): ventanas,
+ *              slots por dispositivo, back-off de RACH y previsión de pases.
+ */
+
+#include <zephyr/ztest.h>
+
+#include "pass_predictor.h"
+
+#define HOUR_MS (60LL * 60 * 1000)
+#define DAY_MS  (24 * HOUR_MS)
+
+static const struct geo_position barcelona = { .lat_udeg = 41387917, .lon_udeg = 2168365 };
+
+static struct satellite_pass make_pass(int64_t start, int64_t duration, uint8_t elevation) {
+    return (struct satellite_pass){
+        .start_time = start,
+        .end_time = start + duration,
+        .max_elevation = elevation,
+        .is_predicted = true,
+    };
+}
+
+ZTEST_SUITE(pass_predictor, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(pass_predictor, test_rng_is_reproducible_and_never_stuck) {
+    struct pass_rng a, b, zero;
+
+    pass_rng_seed(&a, 1234);
+    pass_rng_seed(&b, 1234);
+    pass_rng_seed(&zero, 0);
+    for (int i = 0; i < 100; i++) {
+        zassert_equal(pass_rng_next(&a), pass_rng_next(&b));
+        zassert_not_equal(pass_rng_next(&zero), 0);
+    }
+}
+
+ZTEST(pass_predictor, test_next_pass_windows) {
+    struct pass_rng rng;
+    struct satellite_pass pass;
+
+    pass_rng_seed(&rng, 1);
+    zassert_equal(calculate_sateliot_satellite_pass(&pass, NULL, 0, &rng), -ENODATA);
+    zassert_equal(calculate_sateliot_satellite_pass(NULL, &barcelona, 0, &rng), -EINVAL);
+
+    // Antes de las 10:00 -> pase de las 10:00; entre pases -> 21:00; después -> mañana 10:00
+    static const struct {
+        int64_t now;
+        int64_t start;
+    } cases[] = {
+        { 3 * HOUR_MS, 10 * HOUR_MS },
+        { 12 * HOUR_MS, 21 * HOUR_MS },
+        { 22 * HOUR_MS, DAY_MS + 10 * HOUR_MS },
+        { 5 * DAY_MS + 22 * HOUR_MS, 6 * DAY_MS + 10 * HOUR_MS },
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(cases); i++) {
+        zassert_ok(calculate_sateliot_satellite_pass(&pass, &barcelona, cases[i].now, &rng));
+        zassert_equal(pass.start_time, cases[i].start, "case %u", (unsigned int)i);
+        // 30 s a 8 min, alargado hasta un 50 % con la latitud
+        zassert_between_inclusive(pass.end_time - pass.start_time, MIN_SATELLITE_PASS_DURATION_MS,
+                                  MAX_SATELLITE_PASS_DURATION_MS * 3 / 2);
+        zassert_between_inclusive(pass.max_elevation, 30, 85);
+        zassert_true(pass.satellite_id < SATELIOT_CONSTELLATION_SIZE);
+    }
+}
+
+ZTEST(pass_predictor, test_usable_window_grows_with_elevation) {
+    struct satellite_pass low = make_pass(0, 400000, 30);
+    struct satellite_pass high = make_pass(0, 400000, 85);
+    int64_t start;
+
+    zassert_equal(pass_usable_ms(&low, &start), 200000);
+    zassert_equal(start, 100000);
+    zassert_equal(pass_usable_ms(&high, &start), 400000);
+    zassert_equal(start, 0);
+}
+
+ZTEST(pass_predictor, test_tx_slot_inside_usable_window) {
+    struct satellite_pass pass = make_pass(10 * HOUR_MS, 300000, 50);
+    int64_t usable_start;
+    int64_t usable = pass_usable_ms(&pass, &usable_start);
+    uint32_t first = 0;
+    bool spread = false;
+
+    for (uint32_t seed = 1; seed <= 200; seed++) {
+        pass_assign_tx_slot(&pass, seed);
+        zassert_true(pass.tx_offset_ms >= usable_start);
+        zassert_true(pass.tx_offset_ms + TX_SLOT_WINDOW_MS <= usable_start + usable);
+        zassert_equal((pass.tx_offset_ms - usable_start) % TX_SLOT_SPACING_MS, 0);
+        if (seed == 1) {
+            first = pass.tx_offset_ms;
+        } else if (pass.tx_offset_ms != first) {
+            spread = true;
+        }
+    }
+    zassert_true(spread, "devices must not share a single slot");
+
+    // Pase más corto que un slot: todos al inicio de la zona útil
+    pass = make_pass(0, 30000, 30);
+    pass_assign_tx_slot(&pass, 99);
+    zassert_equal(pass.tx_offset_ms, 7500);
+}
+
+ZTEST(pass_predictor, test_access_jitter_splits_shared_slot) {
+    struct satellite_pass pass = make_pass(10 * HOUR_MS, 300000, 50);
+    uint32_t first = pass_access_jitter_ms(&pass, 1);
+    bool spread = false;
+
+    for (uint32_t seed = 1; seed <= 200; seed++) {
+        uint32_t jitter = pass_access_jitter_ms(&pass, seed);
+
+        zassert_true(jitter < TX_SLOT_SPACING_MS);
+        zassert_equal(jitter, pass_access_jitter_ms(&pass, seed), "must be deterministic");
+        spread |= jitter / 1000 != first / 1000;
+    }
+    zassert_true(spread, "devices in one slot must not share an access occasion");
+}
+
+ZTEST(pass_predictor, test_wakeup_delay_is_capped) {
+    struct satellite_pass pass = make_pass(DAY_MS, 300000, 60);
+
+    pass.tx_offset_ms = 5000;
+    zassert_equal(pass_wakeup_delay_ms(&pass, 0, 0), MAX_IDLE_SLEEP_MS);
+    zassert_equal(pass_wakeup_delay_ms(&pass, 0, DAY_MS), 5000);
+    zassert_equal(pass_wakeup_delay_ms(&pass, 0, DAY_MS + 6000), 0);
+
+    // El fix GNSS se adelanta al slot: se despierta lead_ms antes
+    zassert_equal(pass_wakeup_delay_ms(&pass, 180000, DAY_MS - 180000), 5000);
+    zassert_equal(pass_wakeup_delay_ms(&pass, 180000, DAY_MS - 174000), 0);
+}
+
+ZTEST(pass_predictor, test_attach_wait_fits_slot_and_pass) {
+    struct satellite_pass pass = make_pass(0, 8 * 60 * 1000, 85);
+
+    // Los timeouts de Step 1/2 (5 y 15 min) se acotan a la ventana del slot
+    zassert_equal(pass_attach_wait_ms(&pass, 15 * 60 * 1000, 0), TX_SLOT_WINDOW_MS);
+    zassert_equal(pass_attach_wait_ms(&pass, 5000, 0), 5000);
+    zassert_equal(pass_attach_wait_ms(&pass, 15 * 60 * 1000, pass.end_time - 3000), 3000);
+    zassert_equal(pass_attach_wait_ms(&pass, 15 * 60 * 1000, pass.end_time), -ETIME);
+
+    // Tras un Step 2 acotado al principio del pase todavía cabe el back-off
+    int64_t now = pass_attach_wait_ms(&pass, 15 * 60 * 1000, 0);
+
+    zassert_true(pass_rach_backoff_ms(&pass, 7, 1, now) > 0);
+}
+
+ZTEST(pass_predictor, test_rach_backoff_doubles_and_respects_pass_end) {
+    struct satellite_pass pass = make_pass(0, 8 * 60 * 1000, 85);
+
+    for (int attempt = 1; attempt <= 8; attempt++) {
+        int shift = MIN(attempt - 1, RACH_BACKOFF_MAX_SHIFT);
+        int64_t window = (int64_t)RACH_BACKOFF_BASE_MS << shift;
+        int64_t backoff = pass_rach_backoff_ms(&pass, 7, attempt, 0);
+
+        zassert_between_inclusive(backoff, window / 2, window - 1, "attempt %d", attempt);
+    }
+
+    // El reintento más el slot ya no caben antes del fin del pase
+    zassert_equal(pass_rach_backoff_ms(&pass, 7, 1, pass.end_time - TX_SLOT_WINDOW_MS), -ETIME);
+}
+
+ZTEST(pass_predictor, test_forecast_week) {
+    struct satellite_pass first;
+    struct satellite_pass table[32];
+    struct pass_rng rng;
+    struct pass_rng before;
+
+    pass_rng_seed(&rng, 42);
+    zassert_ok(calculate_sateliot_satellite_pass(&first, &barcelona, 0, &rng));
+    before = rng;
+
+    int count = pass_forecast(&first, &barcelona, 7 * DAY_MS, rng, 42, table, ARRAY_SIZE(table));
+
+    // Dos pases al día
+    zassert_equal(count, 14);
+    zassert_equal(rng.state, before.state, "forecast must not advance the caller's rng");
+    zassert_mem_equal(&table[0], &first, sizeof(first));
+    for (int i = 1; i < count; i++) {
+        zassert_true(table[i].start_time >= table[i - 1].end_time);
+    }
+
+    zassert_equal(pass_forecast(&first, &barcelona, 7 * DAY_MS, rng, 42, table, 3), 3);
+    zassert_equal(pass_forecast(&first, &barcelona, 7 * DAY_MS, rng, 42, table, 0), -EINVAL);
+    zassert_equal(pass_forecast(&first, NULL, 7 * DAY_MS, rng, 42, table, 4), -ENODATA);
+}
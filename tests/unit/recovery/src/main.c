@@ -0,0 +1,164 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas del escalado de recovery por clase de fallo, del back-off
+ *              entre pases, del histograma de módem listo y del historial en
+ *              settings (recovery.c).
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+
+#include "recovery.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+static struct error_recovery_state state;
+
+static void *setup(void) {
+    zassert_ok(settings_subsys_init());
+    return NULL;
+}
+
+static void before(void *fixture) {
+    ARG_UNUSED(fixture);
+    recovery_init(&state);
+}
+
+// Agota el escalado de fault y devuelve los pases de back-off programados
+static uint8_t exhaust(enum recovery_fault fault, int64_t now) {
+    recovery_record_fault(&state, fault, now);
+    for (int i = 0; i < MAX_ERROR_RECOVERY_ATTEMPTS; i++) {
+        zassert_not_equal(recovery_next_action(&state, now), RECOVERY_EXHAUSTED);
+    }
+    zassert_equal(recovery_next_action(&state, now), RECOVERY_EXHAUSTED);
+    return state.passes_to_skip;
+}
+
+ZTEST_SUITE(recovery, NULL, setup, before, NULL, NULL);
+
+// La acción más barata suficiente para cada clase, escalando en cada intento
+ZTEST(recovery, test_escalation_per_fault_class) {
+    static const enum recovery_action expected[RECOVERY_FAULT_COUNT][MAX_ERROR_RECOVERY_ATTEMPTS] = {
+        [RECOVERY_FAULT_AT_ERROR] = { RECOVERY_RECONFIGURE, RECOVERY_SOFT_MODEM_RESET,
+                                      RECOVERY_HARD_MODEM_RESET },
+        [RECOVERY_FAULT_SOCKET] = { RECOVERY_RETRY_NEXT_PASS, RECOVERY_SOFT_MODEM_RESET,
+                                    RECOVERY_HARD_MODEM_RESET },
+        [RECOVERY_FAULT_REGISTRATION_TIMEOUT] = { RECOVERY_SOFT_MODEM_RESET, RECOVERY_HARD_MODEM_RESET,
+                                                  RECOVERY_FULL_RESET },
+        [RECOVERY_FAULT_GNSS_TIMEOUT] = { RECOVERY_GNSS_RESTART, RECOVERY_GNSS_RESTART,
+                                          RECOVERY_HARD_MODEM_RESET },
+        [RECOVERY_FAULT_MODEM] = { RECOVERY_HARD_MODEM_RESET, RECOVERY_FULL_RESET, RECOVERY_FULL_RESET },
+    };
+
+    for (int fault = 0; fault < RECOVERY_FAULT_COUNT; fault++) {
+        recovery_init(&state);
+        recovery_record_fault(&state, fault, 100);
+        for (int i = 0; i < MAX_ERROR_RECOVERY_ATTEMPTS; i++) {
+            zassert_equal(recovery_next_action(&state, 100), expected[fault][i], "fault %d attempt %d",
+                          fault, i + 1);
+        }
+        zassert_equal(recovery_next_action(&state, 100), RECOVERY_EXHAUSTED);
+        zassert_equal(state.fault_count[fault], 1);
+    }
+}
+
+ZTEST(recovery, test_class_change_restarts_escalation) {
+    recovery_record_fault(&state, RECOVERY_FAULT_AT_ERROR, 10);
+    zassert_equal(recovery_next_action(&state, 10), RECOVERY_RECONFIGURE);
+    zassert_equal(recovery_next_action(&state, 20), RECOVERY_SOFT_MODEM_RESET);
+
+    recovery_record_fault(&state, RECOVERY_FAULT_GNSS_TIMEOUT, 30);
+    zassert_equal(recovery_next_action(&state, 30), RECOVERY_GNSS_RESTART);
+    zassert_equal(state.incident_start_time, 10, "incident spans both classes");
+
+    // Clase fuera de rango: se trata como fallo del módem
+    recovery_record_fault(&state, RECOVERY_FAULT_COUNT, 40);
+    zassert_equal(state.last_fault, RECOVERY_FAULT_MODEM);
+}
+
+ZTEST(recovery, test_backoff_doubles_up_to_cap) {
+    static const uint8_t expected[] = { 1, 2, 4, 8, 16, 16 };
+
+    for (size_t i = 0; i < ARRAY_SIZE(expected); i++) {
+        zassert_equal(exhaust(RECOVERY_FAULT_REGISTRATION_TIMEOUT, 1000), expected[i]);
+    }
+    zassert_equal(state.backoff_level, RECOVERY_BACKOFF_MAX_LEVEL);
+
+    for (int i = 0; i < 16; i++) {
+        zassert_true(recovery_skip_pass(&state));
+    }
+    zassert_false(recovery_skip_pass(&state));
+}
+
+ZTEST(recovery, test_success_closes_incident) {
+    zassert_equal(exhaust(RECOVERY_FAULT_SOCKET, 5000), 1);
+    recovery_mark_success(&state, 65000);
+
+    zassert_equal(state.last_time_to_recover_ms, 60000);
+    zassert_equal(state.max_time_to_recover_ms, 60000);
+    zassert_equal(state.incident_start_time, 0);
+    zassert_equal(state.passes_to_skip, 0);
+    zassert_equal(state.backoff_level, 0);
+    zassert_false(recovery_skip_pass(&state));
+
+    // Incidente más corto: el máximo se conserva
+    recovery_record_fault(&state, RECOVERY_FAULT_SOCKET, 70000);
+    recovery_mark_success(&state, 71000);
+    zassert_equal(state.last_time_to_recover_ms, 1000);
+    zassert_equal(state.max_time_to_recover_ms, 60000);
+    zassert_equal(state.fault_count[RECOVERY_FAULT_SOCKET], 2);
+}
+
+ZTEST(recovery, test_modem_ready_histogram) {
+    struct modem_ready_histogram hist = { 0 };
+    char text[96];
+    static const uint32_t samples[] = { 0, 15, 16, 31, 100, 4095, 4096, 60000 };
+
+    for (size_t i = 0; i < ARRAY_SIZE(samples); i++) {
+        modem_ready_hist_record(&hist, samples[i]);
+    }
+    size_t len = modem_ready_hist_format(&hist, text, sizeof(text));
+
+    zassert_equal(len, strlen(text));
+    zassert_str_equal(text, "n=8 avg=8544 max=60000 [2 2 0 1 0 0 0 0 1 2]");
+    zassert_equal(modem_ready_hist_format(&hist, text, 8), len, "required length even if truncated");
+}
+
+ZTEST(recovery, test_persist_round_trip) {
+    struct error_recovery_state loaded;
+
+    zassert_equal(exhaust(RECOVERY_FAULT_MODEM, 123456), 1);
+    zassert_ok(recovery_persist_save(&state));
+
+    recovery_init(&loaded);
+    zassert_ok(recovery_persist_load(&loaded));
+    zassert_equal(loaded.fault_count[RECOVERY_FAULT_MODEM], 1);
+    zassert_equal(loaded.passes_to_skip, 1);
+    zassert_equal(loaded.backoff_level, 1);
+    zassert_equal(loaded.last_fault, RECOVERY_FAULT_MODEM);
+    // Las marcas de uptime del arranque anterior no tienen sentido tras el reset
+    zassert_equal(loaded.last_recovery_time, 0);
+    zassert_equal(loaded.incident_start_time, 1);
+    zassert_equal(loaded.last_good_state, STATE_IDLE);
+}
+
+ZTEST(recovery, test_persist_discards_foreign_layout) {
+    struct error_recovery_state corrupt;
+    uint8_t old_layout[16] = { 0 };
+    struct error_recovery_state loaded;
+
+    zassert_ok(settings_save_one(RECOVERY_SETTINGS_KEY, old_layout, sizeof(old_layout)));
+    recovery_init(&loaded);
+    zassert_ok(recovery_persist_load(&loaded));
+    zassert_equal(loaded.passes_to_skip, 0);
+
+    recovery_init(&corrupt);
+    corrupt.backoff_level = RECOVERY_BACKOFF_MAX_LEVEL + 1;
+    corrupt.passes_to_skip = 3;
+    zassert_ok(settings_save_one(RECOVERY_SETTINGS_KEY, &corrupt, sizeof(corrupt)));
+    recovery_init(&loaded);
+    zassert_ok(recovery_persist_load(&loaded));
+    zassert_equal(loaded.passes_to_skip, 0);
+    zassert_equal(loaded.backoff_level, 0);
+}
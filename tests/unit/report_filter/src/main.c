@@ -0,0 +1,164 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas del reporte por excepción (report_filter.c): simulación de una
+ *              semana de un equipo casi parado con muestras horarias y un pase cada 6 h,
+ *              con el mismo flujo que main.c (filtrar al muestrear, baliza u omisión al
+ *              llegar el pase).
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "report_filter.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+#define HOUR_MS (3600LL * 1000)
+#define SIM_HOURS (7 * 24)
+#define PASS_EVERY_H 6
+#define MOVE_HOUR 120                   // Día 5: el equipo se desplaza ~550 m
+#define RADIO_MS 30000                  // Coste de una sesión de envío
+
+static const struct report_thresholds thresholds = {
+    .heartbeat_s = 72 * 3600,
+    .beacon_s = 12 * 3600,
+    .position_m = 100,
+    .vbat_mv = 100,
+    .temp_c = 5,
+    .adc_mv = 50,
+    .vbat_low_mv = 3300,
+};
+
+static uint32_t noise_state = 2024;
+
+static int32_t noise(int32_t amplitude) {
+    noise_state = noise_state * 1664525u + 1013904223u;
+    return (int32_t)((noise_state >> 8) % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+// Muestra de la hora h: posición con ±20 m de ruido GNSS, batería que baja 60 mV en la
+// semana y temperatura diaria entre 12 y 16 °C (dentro de la banda muerta)
+static void sample_at(int h, struct uplink_record *record) {
+    int hour_of_day = h % 24;
+
+    memset(record, 0, sizeof(*record));
+    record->timestamp = h * HOUR_MS;
+    record->kind = UPLINK_RECORD_RAW;
+    record->position_valid = true;
+    record->sats = 8;
+    record->position.lat_udeg = 41387917 + noise(180) + (h >= MOVE_HOUR ? 5000 : 0);
+    record->position.lon_udeg = 2168365 + noise(240);
+    record->position.alt_dm = 1230;
+    record->sensors.valid = SENSOR_VALID_VBAT | SENSOR_VALID_TEMP;
+    record->sensors.battery_mv = (uint16_t)(4000 - h * 60 / SIM_HOURS + noise(5));
+    record->sensors.modem_temp_c = (int8_t)(12 + (hour_of_day < 12 ? hour_of_day : 24 - hour_of_day) / 3);
+}
+
+struct sim_result {
+    uint32_t passes;
+    uint32_t passes_sent;
+    uint32_t beacons;
+    uint32_t records_sent;
+    uint32_t bytes_sent;
+    uint32_t bytes_raw;
+    uint32_t bytes_suppressed;
+    int64_t max_report_gap;
+    int64_t max_uplink_gap;
+    bool move_reported;
+};
+
+static struct report_filter filter;
+static struct sim_result sim;
+
+static void run_week(void) {
+    static char payload[PAYLOAD_BUFFER_SIZE];
+    uint32_t queued = 0, queued_bytes = 0;
+    int64_t last_report = 0, last_uplink = 0;
+
+    memset(&filter, 0, sizeof(filter));
+    memset(&sim, 0, sizeof(sim));
+    for (int h = 0; h < SIM_HOURS; h++) {
+        struct uplink_record record;
+        int64_t now = h * HOUR_MS;
+
+        sample_at(h, &record);
+
+        size_t raw_len = telemetry_raw_len(payload, sizeof(payload), &record);
+        uint32_t reasons = report_filter_evaluate(&filter, &thresholds, &record, now);
+
+        zassert_true(raw_len > 0);
+        sim.bytes_raw += raw_len;
+        if (reasons) {
+            sim.max_report_gap = MAX(sim.max_report_gap, now - last_report);
+            last_report = now;
+            queued++;
+            queued_bytes += raw_len;
+            if (h == MOVE_HOUR) {
+                sim.move_reported = (reasons & REPORT_REASON_POSITION) != 0;
+            }
+        } else {
+            report_filter_count_saved(&filter, raw_len);
+            sim.bytes_suppressed += raw_len;
+        }
+
+        if (h % PASS_EVERY_H != PASS_EVERY_H - 1) {
+            continue;
+        }
+        sim.passes++;
+        if (queued == 0) {
+            struct uplink_record beacon;
+
+            if (!report_filter_beacon_due(&filter, &thresholds, now)) {
+                continue;
+            }
+            report_filter_beacon(&filter, &record.sensors, now, &beacon);
+            zassert_ok(format_telemetry_data(payload, sizeof(payload), &beacon));
+            zassert_equal(beacon.beacon.battery_mv, record.sensors.battery_mv);
+            queued_bytes = strlen(payload);
+            sim.beacons++;
+        }
+        sim.passes_sent++;
+        sim.records_sent += queued;
+        sim.bytes_sent += queued_bytes;
+        queued = 0;
+        queued_bytes = 0;
+        sim.max_uplink_gap = MAX(sim.max_uplink_gap, now - last_uplink);
+        last_uplink = now;
+        report_filter_uplink_done(&filter, now, RADIO_MS);
+    }
+}
+
+static void before(void *fixture) {
+    ARG_UNUSED(fixture);
+    run_week();
+}
+
+ZTEST_SUITE(report_filter, NULL, NULL, before, NULL, NULL);
+
+ZTEST(report_filter, test_week_skips_passes_and_saves_bytes) {
+    zassert_equal(sim.passes, SIM_HOURS / PASS_EVERY_H);
+    zassert_equal(filter.passes_skipped, sim.passes - sim.passes_sent);
+    zassert_true(filter.passes_skipped >= sim.passes / 3, "%u de %u pases omitidos", filter.passes_skipped,
+                 sim.passes);
+    zassert_equal(filter.radio_ms_saved, filter.passes_skipped * RADIO_MS);
+
+    // El ahorro contado es exactamente lo suprimido, y se envía una fracción de lo medido
+    zassert_equal(filter.bytes_saved, sim.bytes_suppressed);
+    zassert_true(sim.bytes_sent * 5 < sim.bytes_raw, "%u de %u bytes enviados", sim.bytes_sent, sim.bytes_raw);
+}
+
+ZTEST(report_filter, test_beacon_and_heartbeat_honored) {
+    zassert_true(sim.beacons > 0);
+    // Con un pase cada 6 h y baliza a 12 h nunca hay más de 12 h sin enviar nada
+    zassert_true(sim.max_uplink_gap <= (int64_t)thresholds.beacon_s * 1000);
+    // Con muestras horarias el heartbeat puede llegar como mucho una hora tarde
+    zassert_true(sim.max_report_gap <= (int64_t)thresholds.heartbeat_s * 1000 + HOUR_MS);
+}
+
+ZTEST(report_filter, test_real_changes_reported) {
+    zassert_true(sim.move_reported);
+    // Primero, heartbeat a las 72 h y desplazamiento; nada más sale de la banda muerta
+    zassert_true(sim.records_sent >= 3);
+    zassert_true(sim.records_sent < SIM_HOURS / 10, "%u registros enviados", sim.records_sent);
+}
@@ -0,0 +1,168 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas del muestreo adaptativo (sample_control.c): simulación de una
+ *              semana de pases SIC-4 con la cola de uplink de main.c, comparando
+ *              intervalos fijos con el intervalo elegido antes de cada pase.
+ */
+
+#include <zephyr/ztest.h>
+#include <string.h>
+
+#include "pass_predictor.h"
+#include "sample_control.h"
+
+#define HOUR_MS (60LL * 60 * 1000)
+#define WEEK_MS (7 * 24 * HOUR_MS)
+#define QUEUE_DEPTH 32                  // UPLINK_QUEUE_DEPTH en main.c
+#define MIN_INTERVAL_S 60
+#define MAX_INTERVAL_S (4 * 60 * 60)
+#define DEVICE_SEED 0x5EED
+
+static const struct geo_position barcelona = { .lat_udeg = 41387917, .lon_udeg = 2168365 };
+
+static struct satellite_pass week[96];
+static int week_count;
+
+struct sim_result {
+    uint32_t sampled;
+    uint32_t sent;
+    uint32_t dropped;           // Descartados por cola llena (el más antiguo)
+    int64_t max_delay_ms;       // Muestreo -> envío
+    uint32_t min_interval_s;
+    bool always_feasible;
+};
+
+// Cola FIFO de instantes de muestreo con descarte del más antiguo, como uplink_queue_put
+static int64_t queue[QUEUE_DEPTH];
+static uint32_t queue_head, queue_used;
+
+static void queue_put(int64_t t, struct sim_result *r) {
+    if (queue_used == QUEUE_DEPTH) {
+        queue_head = (queue_head + 1) % QUEUE_DEPTH;
+        queue_used--;
+        r->dropped++;
+    }
+    queue[(queue_head + queue_used) % QUEUE_DEPTH] = t;
+    queue_used++;
+    r->sampled++;
+}
+
+// Pases que main.c tendría en la tabla antes del pase next: los que empiezan dentro del
+// presupuesto de latencia, como mucho SAMPLE_CONTROL_MAX_PASSES
+static int forecast_from(int next, int64_t now) {
+    int count = 0;
+
+    while (next + count < week_count && count < SAMPLE_CONTROL_MAX_PASSES &&
+           week[next + count].start_time < now + MAX_END_TO_END_DELAY_MS) {
+        count++;
+    }
+    return count;
+}
+
+// interval_s = 0: adaptativo entre MIN_INTERVAL_S y MAX_INTERVAL_S
+static void simulate(uint32_t interval_s, struct sim_result *r) {
+    struct sample_control ctrl;
+    int64_t last_sample = 0;
+    uint32_t current_s = interval_s ? interval_s : MAX_INTERVAL_S;
+
+    memset(r, 0, sizeof(*r));
+    r->min_interval_s = UINT32_MAX;
+    r->always_feasible = true;
+    queue_head = 0;
+    queue_used = 0;
+    sample_control_init(&ctrl);
+
+    for (int i = 0; i < week_count; i++) {
+        const struct satellite_pass *pass = &week[i];
+        int64_t tx = pass->start_time + pass->tx_offset_ms;
+
+        if (interval_s == 0) {
+            int count = forecast_from(i, last_sample);
+
+            current_s = sample_control_update(&ctrl, &week[i], count, last_sample, queue_used, QUEUE_DEPTH,
+                                              MIN_INTERVAL_S, MAX_INTERVAL_S);
+            r->always_feasible &= ctrl.feasible;
+        }
+        r->min_interval_s = MIN(r->min_interval_s, current_s);
+
+        // Muestreo periódico hasta el slot, más la muestra del propio pase
+        while (last_sample + (int64_t)current_s * 1000 <= tx) {
+            last_sample += (int64_t)current_s * 1000;
+            queue_put(last_sample, r);
+        }
+        queue_put(tx, r);
+
+        uint32_t sent = MIN(queue_used, sample_control_pass_capacity(&ctrl, pass));
+
+        for (uint32_t k = 0; k < sent; k++) {
+            r->max_delay_ms = MAX(r->max_delay_ms, tx - queue[queue_head]);
+            queue_head = (queue_head + 1) % QUEUE_DEPTH;
+            queue_used--;
+        }
+        r->sent += sent;
+        if (sent > 0) {
+            sample_control_observe(&ctrl, SAMPLE_CONTROL_ATTACH_MS_DEFAULT,
+                                   sent * SAMPLE_CONTROL_RECORD_MS_DEFAULT, sent);
+        }
+    }
+}
+
+static void *setup(void) {
+    struct satellite_pass first;
+    struct pass_rng rng;
+
+    pass_rng_seed(&rng, 1);
+    zassert_ok(calculate_sateliot_satellite_pass(&first, &barcelona, 0, &rng));
+    week_count = pass_forecast(&first, &barcelona, WEEK_MS, rng, DEVICE_SEED, week, ARRAY_SIZE(week));
+    zassert_true(week_count > 7 && week_count < ARRAY_SIZE(week), "%d pases", week_count);
+    return NULL;
+}
+
+ZTEST_SUITE(sample_control, NULL, setup, NULL, NULL, NULL);
+
+ZTEST(sample_control, test_pass_capacity) {
+    struct sample_control ctrl;
+    struct satellite_pass pass = week[0];
+    int64_t usable_start;
+    int64_t usable = pass_usable_ms(&pass, &usable_start);
+
+    sample_control_init(&ctrl);
+    zassert_equal(sample_control_pass_capacity(&ctrl, &pass),
+                  (usable + usable_start - pass.tx_offset_ms - SAMPLE_CONTROL_ATTACH_MS_DEFAULT) /
+                  SAMPLE_CONTROL_RECORD_MS_DEFAULT);
+
+    // Envíos más lentos medidos: menos registros por pase
+    uint32_t before = sample_control_pass_capacity(&ctrl, &pass);
+
+    sample_control_observe(&ctrl, SAMPLE_CONTROL_ATTACH_MS_DEFAULT, 10 * 8000, 10);
+    zassert_true(sample_control_pass_capacity(&ctrl, &pass) < before);
+
+    // Un slot que empieza después de la zona útil no tiene capacidad
+    pass.tx_offset_ms = (uint32_t)(usable_start + usable);
+    zassert_equal(sample_control_pass_capacity(&ctrl, &pass), 0);
+}
+
+ZTEST(sample_control, test_fixed_short_interval_overflows) {
+    struct sim_result fixed;
+
+    simulate(10 * 60, &fixed);
+    zassert_true(fixed.dropped > fixed.sampled / 4, "%u de %u descartados", fixed.dropped, fixed.sampled);
+}
+
+ZTEST(sample_control, test_adaptive_drops_nothing) {
+    struct sim_result adaptive, fixed_min, fixed_max;
+
+    simulate(0, &adaptive);
+    simulate(MIN_INTERVAL_S, &fixed_min);
+    simulate(MAX_INTERVAL_S, &fixed_max);
+
+    zassert_true(adaptive.always_feasible);
+    zassert_equal(adaptive.dropped, 0, "%u descartados", adaptive.dropped);
+    zassert_true(adaptive.max_delay_ms <= MAX_END_TO_END_DELAY_MS, "%lld ms", (long long)adaptive.max_delay_ms);
+
+    // Aprovecha la capacidad: más muestras que el intervalo máximo fijo, y el intervalo
+    // baja del máximo cuando los pases lo permiten
+    zassert_true(adaptive.sent > fixed_max.sent, "%u frente a %u", adaptive.sent, fixed_max.sent);
+    zassert_true(adaptive.min_interval_s < MAX_INTERVAL_S);
+    zassert_true(fixed_min.dropped > 0);
+}
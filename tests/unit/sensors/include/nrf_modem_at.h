@@ -0,0 +1,12 @@
+/*
+ * Archivo: nrf_modem_at.h (prueba)
+ * Descripción: Solo la interfaz AT que usa sensors.c; en native_sim no hay librería del
+ *              módem y src/main.c contesta con la traza sintética.
+ */
+
+#ifndef NRF_MODEM_AT_H__
+#define NRF_MODEM_AT_H__
+
+int nrf_modem_at_scanf(const char *cmd, const char *fmt, ...);
+
+#endif /* NRF_MODEM_AT_H__ */
@@ -0,0 +1,128 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas de la adquisición de sensores (sensors.c) con trazas sintéticas
+ *              de %XVBAT y %XTEMP: descarga de batería, ciclo diario de temperatura,
+ *              lecturas fallidas y fuera de rango, y su paso a la telemetría.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sensors.h"
+#include "telemetry.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+#define TRACE_LEN 48                    // Un día con una muestra cada 30 min
+#define AT_FAIL INT32_MIN               // La respuesta AT no llega
+
+// Lo que contesta el módem en cada muestra
+struct trace_point {
+    int32_t vbat_mv;
+    int32_t temp_c;
+};
+
+static struct trace_point trace[TRACE_LEN];
+static unsigned int trace_pos;
+
+int nrf_modem_at_scanf(const char *cmd, const char *fmt, ...) {
+    int32_t value;
+    va_list ap;
+
+    zassert_true(trace_pos < TRACE_LEN);
+    if (strcmp(cmd, "AT%XVBAT") == 0) {
+        value = trace[trace_pos].vbat_mv;
+    } else if (strcmp(cmd, "AT%XTEMP?") == 0) {
+        value = trace[trace_pos].temp_c;
+    } else {
+        return -ENOEXEC;
+    }
+    if (value == AT_FAIL) {
+        return -EIO;
+    }
+    va_start(ap, fmt);
+    *va_arg(ap, int *) = value;
+    va_end(ap);
+    return 1;
+}
+
+// Descarga lineal de 4100 a ~3630 mV y temperatura en diente de sierra 10..22 °C, con
+// fallos y valores fuera de rango en puntos fijos
+static void build_trace(void) {
+    for (int i = 0; i < TRACE_LEN; i++) {
+        int hour = i / 2;
+
+        trace[i].vbat_mv = 4100 - i * 10;
+        trace[i].temp_c = 10 + (hour < 12 ? hour : 24 - hour);
+    }
+    trace[10].vbat_mv = AT_FAIL;
+    trace[20].temp_c = AT_FAIL;
+    trace[30].temp_c = 150;             // Fuera de int8: se satura
+    trace[31].temp_c = -200;
+    trace[40].vbat_mv = 0;              // Lectura sin sentido: no válida
+    trace[41].vbat_mv = 70000;          // Fuera de uint16: se satura
+}
+
+static void *setup(void) {
+    build_trace();
+    zassert_ok(sensors_init());
+    return NULL;
+}
+
+ZTEST_SUITE(sensors, NULL, setup, NULL, NULL, NULL);
+
+ZTEST(sensors, test_synthetic_trace) {
+    uint32_t vbat_before = sensors_cost(SENSOR_SRC_VBAT)->samples;
+    uint32_t temp_before = sensors_cost(SENSOR_SRC_TEMP)->samples;
+
+    for (trace_pos = 0; trace_pos < TRACE_LEN; trace_pos++) {
+        const struct trace_point *p = &trace[trace_pos];
+        struct sensor_sample s;
+        bool vbat_ok = p->vbat_mv != AT_FAIL && p->vbat_mv > 0;
+        bool temp_ok = p->temp_c != AT_FAIL;
+
+        sensors_sample(&s);
+        zassert_equal(!!(s.valid & SENSOR_VALID_VBAT), vbat_ok, "muestra %u", trace_pos);
+        zassert_equal(!!(s.valid & SENSOR_VALID_TEMP), temp_ok, "muestra %u", trace_pos);
+        // Sin canales ADC en devicetree solo hay sensores del módem
+        zassert_false(s.valid & SENSOR_VALID_ADC);
+        if (vbat_ok) {
+            zassert_equal(s.battery_mv, MIN(p->vbat_mv, UINT16_MAX), "muestra %u", trace_pos);
+        }
+        if (temp_ok) {
+            zassert_equal(s.modem_temp_c, CLAMP(p->temp_c, INT8_MIN, INT8_MAX), "muestra %u", trace_pos);
+        }
+    }
+    zassert_equal(sensors_cost(SENSOR_SRC_VBAT)->samples - vbat_before, TRACE_LEN);
+    zassert_equal(sensors_cost(SENSOR_SRC_TEMP)->samples - temp_before, TRACE_LEN);
+}
+
+// Cada muestra llega al JSON con exactamente los campos válidos
+ZTEST(sensors, test_trace_feeds_telemetry) {
+    static char payload[PAYLOAD_BUFFER_SIZE];
+    char field[24];
+
+    for (trace_pos = 0; trace_pos < TRACE_LEN; trace_pos++) {
+        struct uplink_record record = {
+            .timestamp = (int64_t)trace_pos * 30 * 60 * 1000,
+            .position = { .lat_udeg = 41387917, .lon_udeg = 2168365, .alt_dm = 123 },
+            .position_valid = true,
+            .sats = 7,
+            .kind = UPLINK_RECORD_RAW,
+        };
+
+        sensors_sample(&record.sensors);
+        zassert_ok(format_telemetry_data(payload, sizeof(payload), &record));
+
+        snprintf(field, sizeof(field), "\"vbat\":%u,", record.sensors.battery_mv);
+        zassert_equal(strstr(payload, field) != NULL, !!(record.sensors.valid & SENSOR_VALID_VBAT),
+                      "muestra %u: %s", trace_pos, payload);
+        snprintf(field, sizeof(field), "\"temp\":%d,", record.sensors.modem_temp_c);
+        zassert_equal(strstr(payload, field) != NULL, !!(record.sensors.valid & SENSOR_VALID_TEMP),
+                      "muestra %u: %s", trace_pos, payload);
+        zassert_is_null(strstr(payload, "\"adc\""));
+    }
+}
@@ -0,0 +1,131 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas de la codificación JSON de los registros de uplink
+ *              (telemetry.c): texto exacto por tipo de registro y límites de buffer.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "geofence.h"
+#include "telemetry.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+static char payload[PAYLOAD_BUFFER_SIZE];
+static struct uplink_record record;
+
+static void before(void *fixture) {
+    ARG_UNUSED(fixture);
+    memset(payload, 0, sizeof(payload));
+    memset(&record, 0, sizeof(record));
+    record.timestamp = 1000;
+    record.position = (struct geo_position){ .lat_udeg = 41387917, .lon_udeg = 2168365, .alt_dm = 123 };
+    record.position_valid = true;
+    record.sats = 7;
+}
+
+ZTEST_SUITE(telemetry, NULL, NULL, before, NULL, NULL);
+
+ZTEST(telemetry, test_raw_record_with_sensors) {
+    record.kind = UPLINK_RECORD_RAW;
+    record.sensors = (struct sensor_sample){
+        .adc_mv = { 1200, -5 },
+        .battery_mv = 3700,
+        .modem_temp_c = -12,
+        .adc_count = 2,
+        .valid = SENSOR_VALID_VBAT | SENSOR_VALID_TEMP | SENSOR_VALID_ADC,
+    };
+
+    zassert_ok(format_telemetry_data(payload, sizeof(payload), &record));
+    zassert_str_equal(payload, "{\"ts\":1000,\"lat\":41.387917,\"lon\":2.168365,\"alt\":12.3,\"sats\":7,"
+                               "\"vbat\":3700,\"temp\":-12,\"adc\":[1200,-5],\"ntn\":\"sateliot\"}");
+}
+
+// Sin posición válida se envían ceros (mismo comportamiento que la versión con snprintf)
+ZTEST(telemetry, test_raw_record_without_position) {
+    record.kind = UPLINK_RECORD_RAW;
+    record.position_valid = false;
+
+    zassert_ok(format_telemetry_data(payload, sizeof(payload), &record));
+    zassert_str_equal(payload, "{\"ts\":1000,\"lat\":0.000000,\"lon\":0.000000,\"alt\":0.0,\"sats\":7,"
+                               "\"ntn\":\"sateliot\"}");
+}
+
+ZTEST(telemetry, test_aggregate_record) {
+    struct uplink_aggregate aggregate = {
+        .timestamp = record.timestamp,
+        .position = record.position,
+        .sats = record.sats,
+        .position_valid = true,
+        .summary = { .duration_s = 600, .samples = 10, .raw_bytes = 1100 },
+    };
+
+    aggregate.summary.metric[AGG_METRIC_VBAT] = (struct agg_stats){ 3600, 3700, 3650, 30, 10 };
+    aggregate.summary.metric[AGG_METRIC_TEMP] = (struct agg_stats){ -3, 5, 1, 2, 4 };
+
+    zassert_ok(format_aggregate_data(payload, sizeof(payload), &aggregate));
+    zassert_str_equal(payload, "{\"ts\":1000,\"lat\":41.387917,\"lon\":2.168365,\"alt\":12.3,\"dur\":600,"
+                               "\"n\":10,\"v\":[3600,3700,3650,30],\"t\":[-3,5,1,2,4],\"ntn\":\"sateliot\"}");
+}
+
+ZTEST(telemetry, test_beacon_record) {
+    record.kind = UPLINK_RECORD_BEACON;
+    record.beacon.suppressed = 42;
+    record.beacon.battery_mv = 3610;
+
+    zassert_ok(format_telemetry_data(payload, sizeof(payload), &record));
+    zassert_str_equal(payload, "{\"ts\":1000,\"alive\":42,\"vbat\":3610,\"ntn\":\"sateliot\"}");
+}
+
+ZTEST(telemetry, test_geofence_record) {
+    record.kind = UPLINK_RECORD_GEOFENCE;
+    record.fence.fence_id = 17;
+    record.fence.transition = GEOFENCE_EXIT;
+
+    zassert_ok(format_telemetry_data(payload, sizeof(payload), &record));
+    zassert_str_equal(payload, "{\"ts\":1000,\"lat\":41.387917,\"lon\":2.168365,\"alt\":12.3,\"fence\":17,"
+                               "\"ev\":\"exit\",\"ntn\":\"sateliot\"}");
+}
+
+// Sensores que no caben junto con el cierre: se omiten y el registro sigue siendo JSON válido
+ZTEST(telemetry, test_sensor_fields_dropped_when_too_long) {
+    char tight[160];
+
+    record.kind = UPLINK_RECORD_RAW;
+    record.timestamp = INT64_MAX;
+    record.position = (struct geo_position){ .lat_udeg = -89999999, .lon_udeg = -179999999, .alt_dm = -1000 };
+    record.sensors = (struct sensor_sample){
+        .adc_mv = { -32768, -32768, -32768, -32768 },
+        .battery_mv = 65535,
+        .modem_temp_c = -128,
+        .adc_count = 4,
+        .valid = SENSOR_VALID_VBAT | SENSOR_VALID_TEMP | SENSOR_VALID_ADC,
+    };
+
+    zassert_ok(format_telemetry_data(tight, sizeof(tight), &record));
+    zassert_str_equal(tight, "{\"ts\":9223372036854775807,\"lat\":-89.999999,\"lon\":-179.999999,"
+                             "\"alt\":-100.0,\"sats\":7,\"ntn\":\"sateliot\"}");
+}
+
+// Medida del ahorro: misma longitud que el registro enviado, 0 si no cabe
+ZTEST(telemetry, test_raw_len_matches_encoding) {
+    char small[MIN_BUFFER_SIZE_TELEMETRY + TELEMETRY_SAFETY_MARGIN];
+
+    record.kind = UPLINK_RECORD_RAW;
+    record.position_valid = false;
+    zassert_ok(format_telemetry_data(payload, sizeof(payload), &record));
+    zassert_equal(telemetry_raw_len(small, sizeof(small), &record), strlen(payload));
+    zassert_equal(telemetry_raw_len(small, 16, &record), 0);
+}
+
+ZTEST(telemetry, test_invalid_arguments) {
+    char small[MIN_BUFFER_SIZE_TELEMETRY];
+
+    zassert_equal(format_telemetry_data(NULL, sizeof(payload), &record), -EINVAL);
+    zassert_equal(format_telemetry_data(payload, 0, &record), -EINVAL);
+    zassert_equal(format_telemetry_data(payload, sizeof(payload), NULL), -EINVAL);
+    zassert_equal(format_telemetry_data(small, sizeof(small), &record), -ENOMEM);
+    zassert_equal(format_aggregate_data(payload, sizeof(payload), NULL), -EINVAL);
+}
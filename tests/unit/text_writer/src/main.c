@@ -0,0 +1,212 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas del formateador entero (text_writer.c) y de la conversión
+ *              del fix GNSS (geo_position.c), comparadas con snprintf sobre los
+ *              double/float originales.
+ */
+
+#include <zephyr/ztest.h>
+#include <stdio.h>
+
+#include "geo_position.h"
+#include "text_writer.h"
+
+static char buf[64];
+static struct text_writer w;
+
+static void before(void *fixture) {
+    ARG_UNUSED(fixture);
+    memset(buf, 'x', sizeof(buf));
+    tw_init(&w, buf, sizeof(buf));
+}
+
+ZTEST_SUITE(text_writer, NULL, NULL, before, NULL, NULL);
+
+ZTEST(text_writer, test_uint_padding_and_64bit) {
+    tw_uint(&w, 7, 3);
+    tw_putc(&w, ' ');
+    tw_uint(&w, 0, 1);
+    tw_putc(&w, ' ');
+    tw_uint(&w, UINT32_MAX, 1);
+    tw_putc(&w, ' ');
+    tw_uint(&w, UINT64_MAX, 1);
+    zassert_str_equal(buf, "007 0 4294967295 18446744073709551615");
+    zassert_equal(w.len, strlen(buf));
+}
+
+ZTEST(text_writer, test_int_limits) {
+    tw_int(&w, -1);
+    tw_putc(&w, ' ');
+    tw_int(&w, INT64_MIN);
+    tw_putc(&w, ' ');
+    tw_int(&w, INT64_MAX);
+    zassert_str_equal(buf, "-1 -9223372036854775808 9223372036854775807");
+}
+
+ZTEST(text_writer, test_udeg_matches_six_decimals) {
+    tw_udeg(&w, 41387917);
+    tw_putc(&w, ' ');
+    tw_udeg(&w, -2168365);
+    tw_putc(&w, ' ');
+    tw_udeg(&w, -500000);
+    tw_putc(&w, ' ');
+    tw_udeg(&w, 0);
+    zassert_str_equal(buf, "41.387917 -2.168365 -0.500000 0.000000");
+}
+
+ZTEST(text_writer, test_dm_is_not_rounded_again) {
+    tw_dm(&w, 123);
+    tw_putc(&w, ' ');
+    tw_dm(&w, 129);
+    tw_putc(&w, ' ');
+    tw_dm(&w, -10);
+    tw_putc(&w, ' ');
+    tw_dm(&w, -5);
+    tw_putc(&w, ' ');
+    tw_dm(&w, 0);
+    zassert_str_equal(buf, "12.3 12.9 -1.0 -0.5 0.0");
+}
+
+// Igual que snprintf: nunca escribe fuera, termina en NUL y len es la longitud requerida
+ZTEST(text_writer, test_truncation_reports_required_length) {
+    char small[8];
+    struct text_writer t;
+
+    memset(small, 'x', sizeof(small));
+    tw_init(&t, small, sizeof(small));
+    tw_str(&t, "{\"ts\":");
+    tw_int(&t, 123456);
+    zassert_equal(t.len, 12);
+    zassert_str_equal(small, "{\"ts\":1");
+
+    memset(small, 'x', sizeof(small));
+    tw_init(&t, small, 0);
+    tw_str(&t, "abc");
+    zassert_equal(t.len, 3);
+    zassert_equal(small[0], 'x', "size 0 must not touch the buffer");
+}
+
+ZTEST(text_writer, test_truncate_drops_optional_field) {
+    tw_str(&w, "{\"a\":1");
+    size_t mark = w.len;
+
+    tw_str(&w, ",\"b\":2");
+    tw_truncate(&w, mark);
+    tw_putc(&w, '}');
+    zassert_str_equal(buf, "{\"a\":1}");
+
+    // Marca posterior a la longitud actual: sin efecto
+    tw_truncate(&w, w.len + 10);
+    zassert_str_equal(buf, "{\"a\":1}");
+}
+
+// Texto de referencia: el que producía la versión con snprintf("%.6f") / ("%.1f").
+// Única diferencia admitida: el entero no distingue -0, así que "-0.0" sale "0.0".
+static void reference(char *out, size_t size, const char *fmt, double value) {
+    snprintf(out, size, fmt, value);
+    if (out[0] == '-' && strspn(out + 1, "0.") == strlen(out + 1)) {
+        memmove(out, out + 1, strlen(out));
+    }
+}
+
+static void check_fix(double lat, double lon, float alt) {
+    struct geo_position pos;
+    struct geo_modem_position modem;
+    char expected[32];
+    struct text_writer t;
+    char text[32];
+
+    geo_position_from_fix(lat, lon, alt, &pos, &modem);
+
+    tw_init(&t, text, sizeof(text));
+    tw_udeg(&t, pos.lat_udeg);
+    reference(expected, sizeof(expected), "%.6f", lat);
+    zassert_str_equal(text, expected, "lat %.17g: %s != %s", lat, text, expected);
+
+    tw_init(&t, text, sizeof(text));
+    tw_udeg(&t, pos.lon_udeg);
+    reference(expected, sizeof(expected), "%.6f", lon);
+    zassert_str_equal(text, expected, "lon %.17g: %s != %s", lon, text, expected);
+
+    tw_init(&t, text, sizeof(text));
+    tw_dm(&t, pos.alt_dm);
+    reference(expected, sizeof(expected), "%.1f", alt);
+    zassert_str_equal(text, expected, "alt %.9g: %s != %s", (double)alt, text, expected);
+
+    // XSETGPSPOS: mismas expresiones truncadas que la versión original (altitud en double)
+    zassert_equal(modem.lat_param, 90000 + (int)(lat * 1000));
+    zassert_equal(modem.lon_param, 180000 + (int)(lon * 1000));
+    zassert_equal(modem.alt_mm, (int)((double)alt * 1000));
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// Uniforme en [lo, hi) con los 53 bits de mantisa aleatorios
+static double rng_double(double lo, double hi) {
+    return lo + (hi - lo) * (double)(rng_next() >> 11) / (double)(1ULL << 53);
+}
+
+ZTEST(text_writer, test_fix_text_matches_snprintf) {
+    static const struct {
+        double lat;
+        double lon;
+        float alt;
+    } edge[] = {
+        { 41.387917, 2.168365, 12.3f },
+        { 41.387917, 2.168365, 1.05f },
+        { 41.3879996, 2.1683649999, 0.05f },
+        { -33.8688, 151.2093, -0.04f },
+        { -0.0000004, -0.0000005, -0.05f },
+        { 89.9999995, -179.9999995, 8848.86f },
+        { -89.9999999, 179.9999999, -430.5f },
+        { 0.0, 0.0, 0.0f },
+        { 1e-300, -1e-300, 1e-30f },
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(edge); i++) {
+        check_fix(edge[i].lat, edge[i].lon, edge[i].alt);
+    }
+    for (int i = 0; i < 100000; i++) {
+        check_fix(rng_double(-90, 90), rng_double(-180, 180), (float)rng_double(-500, 9000));
+    }
+}
+
+// Empates exactos (x.25, x.75 en float): al par, como printf con el redondeo IEEE
+ZTEST(text_writer, test_fix_altitude_ties_round_to_even) {
+    static const struct {
+        float alt;
+        const char *text;
+    } ties[] = {
+        { 0.25f, "0.2" }, { 0.75f, "0.8" }, { 12.25f, "12.2" }, { -12.25f, "-12.2" }, { -0.75f, "-0.8" },
+    };
+    struct geo_position pos;
+    struct geo_modem_position modem;
+
+    for (size_t i = 0; i < ARRAY_SIZE(ties); i++) {
+        geo_position_from_fix(0, 0, ties[i].alt, &pos, &modem);
+        tw_init(&w, buf, sizeof(buf));
+        tw_dm(&w, pos.alt_dm);
+        zassert_str_equal(buf, ties[i].text);
+    }
+}
+
+// El módem recibe el valor truncado aunque el redondeo a µgrados cruce la milésima
+ZTEST(text_writer, test_xsetgpspos_keeps_truncation) {
+    struct geo_position pos;
+    struct geo_modem_position modem;
+
+    geo_position_from_fix(41.3879996, -2.1689996, 12.9999f, &pos, &modem);
+    zassert_equal(pos.lat_udeg, 41388000);
+    zassert_equal(modem.lat_param, 90000 + 41387);
+    zassert_equal(pos.lon_udeg, -2169000);
+    zassert_equal(modem.lon_param, 180000 - 2168);
+    zassert_equal(pos.alt_dm, 130);
+    zassert_equal(modem.alt_mm, 12999);
+}
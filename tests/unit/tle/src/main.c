@@ -0,0 +1,121 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas del parser TLE, de la ingesta desde red y de la política
+ *              de actualización (tle.c).
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+
+#include "tle.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+// SATELIOT_1, el TLE de ejemplo del documento (ver default_tles en src/main.c)
+#define SAT1_LINE1 "1 60550U 24149CL 25071.82076637 .00007488 00000+0 68187-3 0 9999"
+#define SAT1_LINE2 "2 60550 97.7148 150.0635 0007556 170.3117 189.8251 14.95428546 31058"
+
+static const struct sateliot_tle_text sat1 = { SAT1_LINE1, SAT1_LINE2 };
+
+static int ingest_str(const char *text, struct tle_elements *out) {
+    return tle_ingest((const uint8_t *)text, strlen(text), out);
+}
+
+ZTEST_SUITE(tle, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(tle, test_parse_sateliot_1) {
+    struct tle_elements el;
+
+    zassert_ok(parse_tle(&sat1, &el));
+    zassert_true(el.valid);
+    zassert_equal(el.catalog_number, 60550);
+    // 2025, día 71.82076637: 2025-03-12 19:41:53 UTC
+    zassert_equal(el.epoch_s, 1741808513);
+    zassert_equal(el.inclination_e4, 977148);
+    zassert_equal(el.raan_e4, 1500635);
+    zassert_equal(el.eccentricity_e7, 7556);
+    zassert_equal(el.arg_perigee_e4, 1703117);
+    zassert_equal(el.mean_anomaly_e4, 1898251);
+    zassert_equal(el.mean_motion_e8, 1495428546);
+}
+
+ZTEST(tle, test_parse_rejects_bad_checksum_and_mismatch) {
+    struct tle_elements el = { .catalog_number = 0xDEAD };
+    struct sateliot_tle_text bad = sat1;
+
+    bad.line2 = "2 60550 97.7148 150.0635 0007556 170.3117 189.8251 14.95428546 31059";
+    zassert_equal(parse_tle(&bad, &el), -EBADMSG);
+    zassert_equal(el.catalog_number, 0xDEAD, "out must stay untouched on error");
+
+    // Línea 2 de otro satélite con suma de control correcta
+    bad.line2 = "2 60551 97.7148 150.0635 0007556 170.3117 189.8251 14.95428546 31059";
+    zassert_equal(parse_tle(&bad, &el), -EINVAL);
+
+    bad = (struct sateliot_tle_text){ SAT1_LINE2, SAT1_LINE1 };
+    zassert_equal(parse_tle(&bad, &el), -EINVAL);
+    zassert_equal(parse_tle(NULL, &el), -EINVAL);
+}
+
+ZTEST(tle, test_ingest_two_and_three_line_forms) {
+    struct tle_elements ref;
+    struct tle_elements el;
+
+    zassert_ok(parse_tle(&sat1, &ref));
+
+    zassert_ok(ingest_str(SAT1_LINE1 "\n" SAT1_LINE2, &el));
+    zassert_mem_equal(&el, &ref, sizeof(el));
+    zassert_ok(ingest_str("SATELIOT_1\r\n" SAT1_LINE1 "\r\n" SAT1_LINE2 "\r\n", &el));
+    zassert_mem_equal(&el, &ref, sizeof(el));
+    zassert_ok(ingest_str("\n\n" SAT1_LINE1 "\n\n" SAT1_LINE2 "\n", &el));
+    zassert_mem_equal(&el, &ref, sizeof(el));
+}
+
+// Bytes de red: sin NUL, con basura o más largos que el buffer de líneas
+ZTEST(tle, test_ingest_rejects_untrusted_input) {
+    static const uint8_t binary[] = { '1', ' ', 0xff, 0x00, '\n', '2' };
+    char oversized[TLE_INGEST_MAX_LEN + 2];
+    struct tle_elements el;
+
+    zassert_equal(ingest_str(SAT1_LINE1, &el), -EINVAL);
+    zassert_equal(ingest_str("a\nb\nc\nd", &el), -EMSGSIZE);
+    zassert_equal(ingest_str(SAT1_LINE1 "      \n" SAT1_LINE2, &el), -EMSGSIZE);
+    zassert_not_equal(tle_ingest(binary, sizeof(binary), &el), 0);
+
+    memset(oversized, '1', sizeof(oversized));
+    zassert_equal(tle_ingest((const uint8_t *)oversized, sizeof(oversized), &el), -EINVAL);
+    zassert_equal(tle_ingest(NULL, 0, &el), -EINVAL);
+}
+
+ZTEST(tle, test_update_policy) {
+    struct tle_update_config cfg;
+    struct tle_elements sats[2];
+    const int64_t hour_ms = 60 * 60 * 1000;
+    // Intervalo ajustado en campo (PARAM_TLE_UPDATE_INTERVAL_H), distinto del por defecto
+    const uint16_t base_h = 6;
+
+    tle_update_init(&cfg);
+    zassert_true(tle_update_due(&cfg, 0), "first check is forced");
+
+    zassert_ok(parse_tle(&sat1, &sats[0]));
+    sats[1] = sats[0];
+    zassert_ok(tle_update_evaluate(&cfg, base_h, sats, ARRAY_SIZE(sats), hour_ms));
+    zassert_equal(cfg.consecutive_failures, 0);
+    zassert_equal(cfg.update_interval_hours, base_h, "the runtime interval is kept");
+    zassert_false(tle_update_due(&cfg, hour_ms + base_h * hour_ms));
+    zassert_true(tle_update_due(&cfg, hour_ms + base_h * hour_ms + 1));
+
+    // TLE inválido: cuenta fallos y a partir del cuarto alarga el intervalo
+    sats[1].valid = false;
+    for (int i = 1; i <= 4; i++) {
+        cfg.update_needed = true;
+        zassert_ok(tle_update_evaluate(&cfg, base_h, sats, ARRAY_SIZE(sats), (i + 1) * hour_ms));
+        zassert_equal(cfg.consecutive_failures, i);
+        zassert_equal(cfg.update_interval_hours, i > 3 ? base_h * 2 : base_h);
+    }
+
+    sats[1].valid = true;
+    cfg.update_needed = true;
+    zassert_ok(tle_update_evaluate(&cfg, base_h, sats, ARRAY_SIZE(sats), 10 * hour_ms));
+    zassert_equal(cfg.consecutive_failures, 0);
+    zassert_equal(cfg.update_interval_hours, base_h);
+}
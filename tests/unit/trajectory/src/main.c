@@ -0,0 +1,182 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas del simplificador de trayectoria (trajectory.c) sobre recorridos
+ *              sintéticos con ruido GNSS: compresión obtenida y distancia de cada punto
+ *              descartado al tramo entre sus puntos clave.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "trajectory.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+#define TRACK_LEN 5000                  // Un fix cada 10 s: casi 14 h de recorrido
+#define FIX_MS 10000
+#define ORIGIN_LAT 41387917
+#define ORIGIN_LON 2168365
+#define M_PER_UDEG_LAT 0.111195         // Metros por micro-grado (esfera de 6371 km)
+#define M_PER_UDEG_LON 0.083432         // Ídem en longitud a 41.39° N
+#define ROUNDING_M 2.0                  // Redondeo a metros y proyección local del módulo
+
+static struct geo_position track[TRACK_LEN];
+static bool is_key[TRACK_LEN];
+static struct trajectory traj;
+
+static uint32_t noise_state = 99;
+
+static int32_t noise(int32_t amplitude) {
+    noise_state = noise_state * 1664525u + 1013904223u;
+    return (int32_t)((noise_state >> 8) % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+static void put_point(int i, int32_t east_m, int32_t north_m) {
+    track[i].lat_udeg = ORIGIN_LAT + (int32_t)(north_m / M_PER_UDEG_LAT);
+    track[i].lon_udeg = ORIGIN_LON + (int32_t)(east_m / M_PER_UDEG_LON);
+}
+
+// Vehículo: tramos rectos de 1-5 km a 15 m/s con giros en una de 8 direcciones y
+// ±noise_m de ruido en cada eje
+static void build_vehicle_track(int32_t noise_m) {
+    static const int32_t dir_q10[8][2] = {
+        { 1024, 0 }, { 724, 724 }, { 0, 1024 }, { -724, 724 },
+        { -1024, 0 }, { -724, -724 }, { 0, -1024 }, { 724, -724 },
+    };
+    int32_t east = 0, north = 0, leg_left = 0, dir = 0;
+
+    for (int i = 0; i < TRACK_LEN; i++) {
+        if (leg_left <= 0) {
+            dir = (dir + 1 + (noise(2) + 2)) % 8;
+            leg_left = 1000 + noise(2000) + 2000;
+        }
+        east += dir_q10[dir][0] * 150 / 1024;
+        north += dir_q10[dir][1] * 150 / 1024;
+        leg_left -= 150;
+        put_point(i, east + noise(noise_m), north + noise(noise_m));
+    }
+}
+
+// Activo parado con ruido GNSS
+static void build_stationary_track(int32_t noise_m) {
+    for (int i = 0; i < TRACK_LEN; i++) {
+        put_point(i, noise(noise_m), noise(noise_m));
+    }
+}
+
+static void mark_key(const struct uplink_record *out) {
+    int i = (int)(out->timestamp / FIX_MS);
+
+    zassert_true(i >= 0 && i < TRACK_LEN);
+    is_key[i] = true;
+}
+
+// Pasa el recorrido por el simplificador y devuelve el porcentaje de puntos clave
+static uint32_t simplify(uint32_t tolerance_m) {
+    struct uplink_record record = { .kind = UPLINK_RECORD_RAW, .position_valid = true, .sats = 8 };
+    struct uplink_record out;
+
+    trajectory_reset(&traj);
+    memset(is_key, 0, sizeof(is_key));
+    for (int i = 0; i < TRACK_LEN; i++) {
+        record.timestamp = (int64_t)i * FIX_MS;
+        record.position = track[i];
+        if (trajectory_add(&traj, &record, tolerance_m, &out)) {
+            mark_key(&out);
+        }
+    }
+    if (trajectory_flush(&traj, &out)) {
+        mark_key(&out);
+    }
+    zassert_equal(traj.points_in, TRACK_LEN);
+    zassert_true(is_key[0] && is_key[TRACK_LEN - 1]);
+    return traj.points_out * 100 / traj.points_in;
+}
+
+static void to_local_m(const struct geo_position *p, double *x, double *y) {
+    *x = (p->lon_udeg - ORIGIN_LON) * M_PER_UDEG_LON;
+    *y = (p->lat_udeg - ORIGIN_LAT) * M_PER_UDEG_LAT;
+}
+
+// Distancia al cuadrado de c al segmento a-b, en double
+static double segment_dist2(const struct geo_position *a, const struct geo_position *b,
+                            const struct geo_position *c) {
+    double ax, ay, bx, by, cx, cy;
+
+    to_local_m(a, &ax, &ay);
+    to_local_m(b, &bx, &by);
+    to_local_m(c, &cx, &cy);
+
+    double dx = bx - ax, dy = by - ay;
+    double len2 = dx * dx + dy * dy;
+    double u = len2 > 0.0 ? ((cx - ax) * dx + (cy - ay) * dy) / len2 : 0.0;
+
+    u = u < 0.0 ? 0.0 : (u > 1.0 ? 1.0 : u);
+
+    double ex = ax + u * dx - cx, ey = ay + u * dy - cy;
+
+    return ex * ex + ey * ey;
+}
+
+// Cada punto descartado queda a menos de la tolerancia del tramo reportado que lo cubre
+static void assert_within_tolerance(uint32_t tolerance_m) {
+    const double limit = tolerance_m + ROUNDING_M;
+    int prev_key = 0;
+
+    for (int i = 1; i < TRACK_LEN; i++) {
+        if (!is_key[i]) {
+            continue;
+        }
+        zassert_true(i - prev_key <= TRAJECTORY_WINDOW + 1, "tramo %d-%d", prev_key, i);
+        for (int j = prev_key + 1; j < i; j++) {
+            double d2 = segment_dist2(&track[prev_key], &track[i], &track[j]);
+
+            zassert_true(d2 <= limit * limit, "punto %d a %d m² del tramo %d-%d", j,
+                         (int)d2, prev_key, i);
+        }
+        prev_key = i;
+    }
+}
+
+ZTEST_SUITE(trajectory, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(trajectory, test_vehicle_track) {
+    uint32_t pct_10, pct_25;
+
+    build_vehicle_track(5);
+    pct_10 = simplify(10);
+    assert_within_tolerance(10);
+    pct_25 = simplify(25);
+    assert_within_tolerance(25);
+
+    // Más tolerancia, menos puntos; con 10 m el ruido de 5 m aún deja comprimir
+    zassert_true(pct_25 < pct_10);
+    zassert_true(pct_10 <= 15, "%u%% con 10 m", pct_10);
+    zassert_true(pct_25 <= 8, "%u%% con 25 m", pct_25);
+}
+
+ZTEST(trajectory, test_stationary_limited_by_window) {
+    build_stationary_track(5);
+    simplify(25);
+    assert_within_tolerance(25);
+
+    // Todo cabe en la tolerancia: solo cierra la ventana llena
+    zassert_equal(traj.points_out, 1 + DIV_ROUND_UP(TRACK_LEN - 1, TRAJECTORY_WINDOW));
+}
+
+ZTEST(trajectory, test_corner_is_kept) {
+    // Línea recta al este y giro de 90° al norte, sin ruido
+    for (int i = 0; i < 20; i++) {
+        put_point(i, i * 150, 0);
+    }
+    for (int i = 20; i < TRACK_LEN; i++) {
+        put_point(i, 19 * 150, (i - 19) * 150);
+    }
+    simplify(10);
+    assert_within_tolerance(10);
+    zassert_true(is_key[19]);
+    for (int i = 1; i < 19; i++) {
+        zassert_false(is_key[i], "punto %d", i);
+    }
+}
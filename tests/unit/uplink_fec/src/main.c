@@ -0,0 +1,99 @@
+/*
+ * Archivo: main.c
+ * Descripción: Pruebas del codificador de paridad XOR del uplink (uplink_fec.c): la
+ *              paridad solo cubre datagramas enviados y un fallo de envío descarta el
+ *              grupo abierto.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "uplink_fec.h"
+
+LOG_MODULE_REGISTER(ntn_app, LOG_LEVEL_INF);
+
+static uint8_t datagram[UPLINK_FEC_DATAGRAM_MAX];
+
+static uint16_t get_be16(const uint8_t *p) {
+    return ((uint16_t)p[0] << 8) | p[1];
+}
+
+// Codifica y, si sent, confirma el envío como haría send_uplink_payload()
+static int send(const char *payload, bool sent) {
+    size_t len = strlen(payload);
+    int out_len = uplink_fec_encode((const uint8_t *)payload, len, datagram, sizeof(datagram));
+
+    zassert_true(out_len > 0);
+    if (sent) {
+        uplink_fec_commit((const uint8_t *)payload, len);
+    } else {
+        uplink_fec_abort_group();
+    }
+    return out_len;
+}
+
+static void before(void *fixture) {
+    ARG_UNUSED(fixture);
+    uplink_fec_session_begin(4);
+    // Cierra cualquier grupo que dejara a medias la prueba anterior
+    uplink_fec_abort_group();
+}
+
+ZTEST(uplink_fec, test_parity_covers_only_sent_datagrams) {
+    send("AAAA", true);
+    send("BB", true);
+
+    zassert_equal(uplink_fec_encode((const uint8_t *)"CCC", 3, datagram, sizeof(datagram)),
+                  UPLINK_FEC_HDR_LEN + 3);
+    // Sin commit: la paridad forzada es la de los dos enviados
+    int len = uplink_fec_parity(datagram, sizeof(datagram), true);
+
+    zassert_equal(len, UPLINK_FEC_HDR_LEN + 2 + 4);
+    zassert_equal(datagram[5], UPLINK_FEC_PARITY_INDEX);
+    zassert_equal(datagram[6], 2, "k must count the sent datagrams only");
+    zassert_equal(get_be16(&datagram[UPLINK_FEC_HDR_LEN]), 4 ^ 2);
+
+    const uint8_t expected[] = { 'A' ^ 'B', 'A' ^ 'B', 'A', 'A' };
+
+    zassert_mem_equal(&datagram[UPLINK_FEC_HDR_LEN + 2], expected, sizeof(expected));
+}
+
+ZTEST(uplink_fec, test_send_failure_discards_group) {
+    send("AAAA", true);
+    uint16_t group = get_be16(&datagram[3]);
+
+    send("BBBB", false);
+    zassert_equal(uplink_fec_parity(datagram, sizeof(datagram), true), 0, "aborted group has no parity");
+
+    // El reintento abre grupo nuevo con índice 0 y la paridad no arrastra el grupo anterior
+    send("CC", true);
+    zassert_equal(get_be16(&datagram[3]), group + 1);
+    zassert_equal(datagram[5], 0);
+    zassert_equal(uplink_fec_parity(datagram, sizeof(datagram), true), UPLINK_FEC_HDR_LEN + 2 + 2);
+    zassert_equal(datagram[UPLINK_FEC_HDR_LEN + 2], 'C');
+}
+
+ZTEST(uplink_fec, test_failed_send_leaves_no_sequence_gap) {
+    send("AAAA", true);
+    uint16_t seq = get_be16(&datagram[1]);
+
+    send("BBBB", false);
+    zassert_equal(get_be16(&datagram[1]), seq + 1);
+    send("BBBB", true);
+    zassert_equal(get_be16(&datagram[1]), seq + 1, "the resend reuses the unsent sequence number");
+    send("CCCC", true);
+    zassert_equal(get_be16(&datagram[1]), seq + 2);
+}
+
+ZTEST(uplink_fec, test_full_group_emits_parity_without_force) {
+    for (int i = 0; i < 3; i++) {
+        send("XY", true);
+        zassert_equal(uplink_fec_parity(datagram, sizeof(datagram), false), 0);
+    }
+    send("XY", true);
+    zassert_equal(uplink_fec_parity(datagram, sizeof(datagram), false), UPLINK_FEC_HDR_LEN + 2 + 2);
+    zassert_equal(datagram[6], 4);
+}
+
+ZTEST_SUITE(uplink_fec, NULL, NULL, before, NULL, NULL);